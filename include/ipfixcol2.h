@@ -64,6 +64,7 @@
 
 #include <ipfixcol2/plugins.h>
 #include <ipfixcol2/session.h>
+#include <ipfixcol2/template_pool.h>
 #include <ipfixcol2/utils.h>
 #include <ipfixcol2/verbose.h>
 
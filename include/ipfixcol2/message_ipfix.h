@@ -116,6 +116,10 @@ struct ipx_ipfix_record {
  * and IPFIX Sets in the IPFIX Message. This information must be filled separately using IPFIX
  * parser. In case of NetFlow, the parser transforms message to IPFIX.
  *
+ * The wrapper is taken from a pool of the plugin instance and it is returned there when the
+ * message is destroyed. Therefore, the function MUST be called only from the thread of the
+ * instance identified by \p plugin_ctx.
+ *
  * \warning User MUST make sure that \p msg_data represents valid Message header
  * \param[in] plugin_ctx Context of the plugin
  * \param[in] msg_ctx    Message context (info about Transport Session, ODID, etc.)
@@ -127,6 +131,35 @@ IPX_API ipx_msg_ipfix_t *
 ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
     uint8_t *msg_data, uint16_t msg_size);
 
+/**
+ * \brief Callback function that releases a raw IPFIX (or NetFlow) Message
+ * \param[in] arg      User defined argument (see ipx_msg_ipfix_create_ext())
+ * \param[in] msg_data Pointer to the Message
+ */
+typedef void (*ipx_msg_ipfix_free_cb)(void *arg, uint8_t *msg_data);
+
+/**
+ * \brief Create an empty wrapper around IPFIX (or NetFlow) Message with a custom release of
+ *   the Message
+ *
+ * Same as ipx_msg_ipfix_create(), however, the Message \p msg_data is not freed by free(),
+ * but it is passed to the callback \p free_cb when it is not needed anymore. This allows
+ * the producer to receive Messages into its own pre-allocated buffers and reuse them
+ * without copying.
+ * \warning The callback can be called by any thread (usually a thread of the last plugin that
+ *   processed the Message) and even after the instance of the producer has been destroyed.
+ * \param[in] plugin_ctx Context of the plugin
+ * \param[in] msg_ctx    Message context (info about Transport Session, ODID, etc.)
+ * \param[in] msg_data   Pointer to the IPFIX (or NetFlow) Message header
+ * \param[in] msg_size   Total size of the IPFIX (or NetFlow) Message
+ * \param[in] free_cb    Callback function that releases \p msg_data (NULL = use free())
+ * \param[in] free_arg   User defined argument of the callback function
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_msg_ipfix_t *
+ipx_msg_ipfix_create_ext(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *msg_data, uint16_t msg_size, ipx_msg_ipfix_free_cb free_cb, void *free_arg);
+
 /**
  * \brief Destroy a message wrapper with a parsed IPFIX packet
  * \param[out] msg Pointer to the message
@@ -225,6 +258,22 @@ ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg);
 IPX_API struct ipx_ipfix_record *
 ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref);
 
+/**
+ * \brief Reserve space for additional IPFIX Data Record descriptions.
+ *
+ * Make sure that at least \p cnt records can be added by ipx_msg_ipfix_add_drec_ref() without
+ * another reallocation of the wrapper. The function is intended for producers that know (or can
+ * estimate) the number of records in advance.
+ * \warning The wrapper \p msg_ref can be reallocated and different pointer
+ *   can be returned!
+ * \param[in,out] msg_ref IPFIX Message wrapper
+ * \param[in]     cnt     Number of records to be added
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred (the wrapper is untouched)
+ */
+IPX_API int
+ipx_msg_ipfix_reserve_drecs(struct ipx_msg_ipfix **msg_ref, uint32_t cnt);
+
 /**
  * \brief Set the raw size of an IPFIX message.
  *
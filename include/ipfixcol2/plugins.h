@@ -50,6 +50,8 @@ extern "C" {
 typedef struct ipx_ctx ipx_ctx_t;
 /** Internal data structure that represents IPFIXcol record extension                          */
 typedef struct ipx_ctx_ext ipx_ctx_ext_t;
+/** Internal data structure that represents a metric of the collector                          */
+typedef struct ipx_metric ipx_metric_t;
 
 #include <ipfixcol2/api.h>
 #include <ipfixcol2/verbose.h>
@@ -93,6 +95,8 @@ typedef struct ipx_ctx_ext ipx_ctx_ext_t;
  * - plugin_init()
  * - plugin_destroy()
  * - plugin_process()
+ * Optionally, the function plugin_process_batch() can be implemented to process multiple
+ * messages at once.
  *
  * \note
  *   The plugin identification structure and all implemented functions MUST be defined as external
@@ -150,6 +154,19 @@ typedef struct ipx_ctx_ext ipx_ctx_ext_t;
  */
 #define IPX_PF_DEEPBIND 1U
 
+/**
+ * \def IPX_PF_SHARDABLE
+ * \brief Input plugin supports the run-to-completion mode
+ *
+ * In the run-to-completion mode (see "-s" option of the collector), an identical copy of each
+ * input instance is created for every pipeline shard. By this flag, the plugin declares that
+ * the copies can coexist without receiving the same data multiple times, for example, all of
+ * them listen on the same local port with SO_REUSEPORT enabled (see ipx_ctx_shards_get()) and
+ * exporters are distributed among them by the kernel. The collector refuses to run the mode
+ * if any input plugin doesn't have this flag.
+ */
+#define IPX_PF_SHARDABLE 2U
+
 /**
  * \brief Identification of a plugin
  *
@@ -285,6 +302,29 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg);
 IPX_API int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Process multiple messages from the IPFIXcol core (Intermediate and Output plugins ONLY)
+ *
+ * This function is optional. If implemented, the IPFIXcol core prefers it over
+ * ipx_plugin_process() and passes consecutive IPFIX and Transport Session messages, the instance
+ * subscribes to, in batches. Other types of messages (e.g. periodic or termination messages) are
+ * always passed individually using ipx_plugin_process(), therefore, the function
+ * ipx_plugin_process() MUST be implemented anyway.
+ *
+ * The messages MUST be processed in the given order and the same rules as for
+ * ipx_plugin_process() apply to each of them. In other words, _Intermediate plugins_ are
+ * responsible for passing or destroying ALL messages in the batch (even if a failure occurs),
+ * and _Output plugins_ MUST NOT modify them.
+ *
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Private data of the instance prepared by initialization function
+ * \param[in] msgs Array of messages to process
+ * \param[in] cnt  Number of messages in the array (always at least 1)
+ * \return Same as ipx_plugin_process()
+ */
+IPX_API int
+ipx_plugin_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
 /**
  * \brief Request to close a Transport Session (Input plugins only!)
  *
@@ -372,6 +412,52 @@ ipx_ctx_name_get(const ipx_ctx_t *ctx);
 IPX_API int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg);
 
+/**
+ * \brief Get pressure of the pipeline behind the plugin (only Input and Intermediate plugins!)
+ *
+ * The pressure is expressed as the approximate occupancy of the output queue of the instance.
+ * A value close to 100 means that successors of the plugin cannot keep up and
+ * ipx_ctx_msg_pass() is (or will soon be) blocking. The plugin can use it to shed load in
+ * a controlled way, for example. In the run-to-completion mode (see the "-s" option of
+ * the collector), successors in the same pipeline shard process messages immediately,
+ * therefore, the occupancy of the first queue behind them is returned (i.e. the queue of
+ * the output manager shared by all shards).
+ * \note The function can be called from any thread.
+ * \param[in] ctx Current plugin context
+ * \return Occupancy of the output queue in percent (0 - 100). Always 0 if the plugin is not
+ *   connected to a successor.
+ */
+IPX_API unsigned int
+ipx_ctx_pressure_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get a file descriptor of the parser feedback (Input plugins ONLY!)
+ *
+ * The descriptor is readable while the parser has some requests for the plugin (e.g. to close
+ * a Transport Session) or while another internal message waits for it. Input plugins that wait
+ * for new data in their own epoll (or poll) set can add the descriptor to it and return from
+ * ipx_plugin_get() as soon as it becomes readable, so the requests are processed without delay.
+ * \warning The descriptor MUST NOT be read or closed by the plugin. Requests are delivered by
+ *   the collector after the return from ipx_plugin_get().
+ * \param[in] ctx Current plugin context
+ * \return File descriptor or -1 if the plugin doesn't have the feedback.
+ */
+IPX_API int
+ipx_ctx_feedback_fd_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get the number of pipeline shards running an identical copy of the instance
+ *
+ * Without the run-to-completion mode, the value is always 1. Otherwise, input plugins that
+ * support the mode (see #IPX_PF_SHARDABLE) must allow the other copies to share the same
+ * resources, for example, to bind to the same local port.
+ * \note The value is valid already during the instance initialization.
+ * \param[in] ctx Current plugin context
+ * \return Number of shards
+ */
+IPX_API unsigned int
+ipx_ctx_shards_get(const ipx_ctx_t *ctx);
+
 /**
  * \brief Change message subscription (Intermediate and Output plugins ONLY!)
  *
@@ -510,6 +596,68 @@ ipx_ctx_ext_get(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec, void **data,
 IPX_API void
 ipx_ctx_ext_set_filled(ipx_ctx_ext_t *ext, struct ipx_ipfix_record *drec);
 
+/** Type of a metric                                                                          */
+enum ipx_metric_type {
+    /** Monotonically increasing value (e.g. number of processed messages)                    */
+    IPX_METRIC_COUNTER,
+    /** Value that can go up and down (e.g. number of active connections)                     */
+    IPX_METRIC_GAUGE
+};
+
+/**
+ * \brief Create a metric of the plugin instance
+ *
+ * Metrics of all instances are exposed by the collector in the Prometheus text format (if
+ * enabled, see the "-M" option of the collector). The name is prefixed by "ipfixcol2_" and
+ * the metric is automatically labeled by the name of the instance. Metrics of the same name
+ * (but with different labels) MUST have the same type and they share the help text of the
+ * first one. Names of counters should end with "_total".
+ *
+ * Counters are updated by ipx_ctx_metric_add(), which is cheap enough to be called for each
+ * processed message by any number of threads. The value is aggregated only when the metrics
+ * are exposed. Failure to create a metric is usually not fatal, because all functions that
+ * update metrics silently ignore NULL.
+ * \param[in] ctx    Plugin context
+ * \param[in] type   Type of the metric
+ * \param[in] name   Name of the metric (letters, digits, '_' and ':', e.g. "rows_written_total")
+ * \param[in] help   Description of the metric
+ * \param[in] labels Additional labels (NULL terminated array of name and value pairs, e.g.
+ *   {"table", "flows", NULL}) or NULL. Values are escaped automatically.
+ * \return Pointer to the metric or NULL (invalid name, type conflict or memory allocation
+ *   error)
+ */
+IPX_API ipx_metric_t *
+ipx_ctx_metric_create(ipx_ctx_t *ctx, enum ipx_metric_type type, const char *name,
+    const char *help, const char *const *labels);
+
+/**
+ * \brief Add a value to a counter (or a gauge)
+ * \note The function can be called from any thread.
+ * \param[in] metric Metric (can be NULL, i.e. failed to create, then the call is ignored)
+ * \param[in] value  Value to add
+ */
+IPX_API void
+ipx_ctx_metric_add(ipx_metric_t *metric, uint64_t value);
+
+/**
+ * \brief Set a value of a gauge (ONLY gauges!)
+ * \note The function can be called from any thread.
+ * \param[in] metric Metric (can be NULL, i.e. failed to create, then the call is ignored)
+ * \param[in] value  New value
+ */
+IPX_API void
+ipx_ctx_metric_set(ipx_metric_t *metric, int64_t value);
+
+/**
+ * \brief Destroy a metric
+ *
+ * The metric is no longer exposed. Metrics that are not destroyed by the plugin are destroyed
+ * on exit of the collector.
+ * \param[in] metric Metric (can be NULL)
+ */
+IPX_API void
+ipx_ctx_metric_destroy(ipx_metric_t *metric);
+
 /**
  * @}
  * @}
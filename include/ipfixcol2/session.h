@@ -117,6 +117,18 @@ struct ipx_session_udp {
          */
         uint16_t opts_tmplts;
     } lifetime;
+
+    /**
+     * \brief Messages dropped by the input plugin before processing
+     * \note The counters are updated by the thread of the input plugin. Other plugins should
+     *   read them using atomic loads (e.g. when a Session message is received).
+     */
+    struct {
+        /** Messages that exceeded the configured rate limit of the exporter */
+        uint64_t rate_limit;
+        /** Messages shed because the pipeline has been overloaded           */
+        uint64_t overload;
+    } drops;
 };
 
 /** Description of SCTP transport session parameters */
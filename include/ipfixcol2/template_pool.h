@@ -0,0 +1,165 @@
+/**
+ * @file
+ * @brief Pool of interned (Options) Templates (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPX_TEMPLATE_POOL_H
+#define IPX_TEMPLATE_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <libfds.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxTemplatePool Pool of interned Templates
+ * \ingroup publicAPIs
+ * \brief Share byte-identical (Options) Templates across Transport Sessions
+ *
+ * Exporters of the same model usually send exactly the same (Options) Template definitions.
+ * The pool stores only one canonical copy of each distinct definition (identified by its type
+ * and its raw content, i.e. Template ID is part of the key) and counts references to it.
+ *
+ * A plugin can use an interned Template as a key of its caches instead of a combination of
+ * a Transport Session, an ODID and a Template ID. Moreover, each interned Template has a slot
+ * for user data (e.g. a compiled per-Template plan of a record conversion), so such data can
+ * be prepared only once and reused by all Transport Sessions with the same definition.
+ *
+ * \warning The pool is not thread-safe. It's supposed to be owned by a single plugin instance
+ *   (i.e. a single thread).
+ * @{
+ */
+
+/** Internal type of the pool                                                                  */
+typedef struct ipx_tmplt_pool ipx_tmplt_pool_t;
+/** Internal type of an interned Template                                                     */
+typedef struct ipx_tmplt_ref ipx_tmplt_ref_t;
+
+/**
+ * \brief Destructor of user data of an interned Template
+ * \param[in] data User data (never NULL)
+ */
+typedef void (*ipx_tmplt_pool_data_cb)(void *data);
+
+/** Statistics of the pool                                                                     */
+struct ipx_tmplt_pool_stats {
+    /** Number of distinct interned Templates                                                  */
+    uint64_t tmplts;
+    /** Number of references to interned Templates                                             */
+    uint64_t refs;
+    /** Number of lookups that found an already interned Template                              */
+    uint64_t hits;
+    /** Number of lookups that had to intern a new Template                                    */
+    uint64_t misses;
+};
+
+/**
+ * \brief Create a new pool of interned Templates
+ * \param[in] data_free Destructor of user data of interned Templates (can be NULL)
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_tmplt_pool_t *
+ipx_tmplt_pool_create(ipx_tmplt_pool_data_cb data_free);
+
+/**
+ * \brief Destroy a pool of interned Templates
+ *
+ * All interned Templates are freed, even if there are still unreleased references.
+ * \param[in] pool Pool
+ */
+IPX_API void
+ipx_tmplt_pool_destroy(ipx_tmplt_pool_t *pool);
+
+/**
+ * \brief Get a reference to an interned Template defined by its raw definition
+ *
+ * If the same definition has been already interned, only the number of its references is
+ * increased. Otherwise, the definition is parsed and added to the pool.
+ * \param[in]  pool  Pool
+ * \param[in]  type  Type of the Template (FDS_TYPE_TEMPLATE or FDS_TYPE_TEMPLATE_OPTS)
+ * \param[in]  data  Raw (Options) Template record (i.e. starting with its header)
+ * \param[in]  size  Size of the record
+ * \param[out] ref   Interned Template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the definition is not valid
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_tmplt_pool_get_raw(ipx_tmplt_pool_t *pool, enum fds_template_type type, const void *data,
+    uint16_t size, ipx_tmplt_ref_t **ref);
+
+/**
+ * \brief Get a reference to an interned Template identical to a given Template
+ *
+ * If the same definition hasn't been interned yet, a copy of the Template is added to the pool.
+ * \param[in]  pool  Pool
+ * \param[in]  tmplt Template
+ * \param[out] ref   Interned Template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_tmplt_pool_get(ipx_tmplt_pool_t *pool, const struct fds_template *tmplt,
+    ipx_tmplt_ref_t **ref);
+
+/**
+ * \brief Release a reference to an interned Template
+ *
+ * After the last reference has been released, the Template and its user data are freed.
+ * \param[in] pool Pool
+ * \param[in] ref  Interned Template
+ */
+IPX_API void
+ipx_tmplt_pool_put(ipx_tmplt_pool_t *pool, ipx_tmplt_ref_t *ref);
+
+/**
+ * \brief Get the canonical copy of an interned Template
+ *
+ * \note The Template is not bound to any manager of Information Elements, i.e. definitions of
+ *   its fields are not filled.
+ * \param[in] ref Interned Template
+ * \return Pointer to the Template
+ */
+IPX_API const struct fds_template *
+ipx_tmplt_ref_template(const ipx_tmplt_ref_t *ref);
+
+/**
+ * \brief Get user data of an interned Template
+ * \param[in] ref Interned Template
+ * \return Pointer to the data or NULL (not set)
+ */
+IPX_API void *
+ipx_tmplt_ref_data_get(const ipx_tmplt_ref_t *ref);
+
+/**
+ * \brief Set user data of an interned Template
+ *
+ * Previous data (if any) are freed by the destructor of the pool.
+ * \param[in] pool Pool
+ * \param[in] ref  Interned Template
+ * \param[in] data User data (can be NULL)
+ */
+IPX_API void
+ipx_tmplt_ref_data_set(ipx_tmplt_pool_t *pool, ipx_tmplt_ref_t *ref, void *data);
+
+/**
+ * \brief Get statistics of the pool
+ * \param[in]  pool  Pool
+ * \param[out] stats Statistics
+ */
+IPX_API void
+ipx_tmplt_pool_stats_get(const ipx_tmplt_pool_t *pool, struct ipx_tmplt_pool_stats *stats);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_TEMPLATE_POOL_H
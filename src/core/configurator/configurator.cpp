@@ -40,6 +40,8 @@
  */
 
 #include <unistd.h> // STDOUT_FILENO
+#include <algorithm>
+#include <cinttypes>
 #include <memory>
 #include <iostream>
 #include <string>
@@ -58,6 +60,8 @@ extern "C" {
 #include "../plugin_output_mgr.h"
 #include "../verbose.h"
 #include "../context.h"
+#include "../hugepage.h"
+#include "../metrics.h"
 #include "cpipe.h"
 }
 
@@ -103,6 +107,7 @@ ipx_configurator::ipx_configurator()
 {
     m_iemgr = nullptr;
     m_ring_size = RING_DEF_SIZE;
+    m_shards = 0;
 
     // Create a configuration pipe
     if (ipx_cpipe_init() != IPX_OK) {
@@ -126,6 +131,8 @@ ipx_configurator::~ipx_configurator()
 {
     // Make sure that all threads are terminated
     cleanup();
+    // Free metrics not destroyed by their instances
+    ipx_metrics_cleanup();
 
     // Disable the signal handler
     struct sigaction sa;
@@ -238,6 +245,33 @@ ipx_configurator::set_buffer_size(uint32_t size)
     m_ring_size = size;
 }
 
+void
+ipx_configurator::set_shards(unsigned int shards)
+{
+    if (shards > SHARDS_MAX) {
+        throw std::invalid_argument("Number of pipeline shards must be at most "
+            + std::to_string(SHARDS_MAX) + ".");
+    }
+
+    m_shards = shards;
+}
+
+/**
+ * \brief Get the name of an instance in a pipeline shard
+ * \param[in] name  Name of the instance (from the configuration)
+ * \param[in] shard Index of the shard
+ * \return Name
+ */
+std::string
+ipx_configurator::shard_name(const std::string &name, unsigned int shard)
+{
+    if (m_shards <= 1) {
+        return name;
+    }
+
+    return name + "@" + std::to_string(shard);
+}
+
 void
 ipx_configurator::startup(const ipx_config_model &model)
 {
@@ -253,41 +287,90 @@ ipx_configurator::startup(const ipx_config_model &model)
     std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
     std::vector<std::unique_ptr<ipx_instance_input> > inputs;
 
-    // Phase 1. Create all instances (i.e. find plugins)
+    // Without the run-to-completion mode, there is exactly one pipeline
+    const unsigned int shards = (m_shards > 0) ? m_shards : 1;
+    const size_t inputs_cnt = model.inputs.size();
+    const size_t inters_cnt = model.inters.size(); // Per shard (excluding the output manager)
+    const size_t outputs_cnt = model.outputs.size();
+
+    if (m_shards > 0) {
+        IPX_INFO(comp_str, "Run-to-completion mode with %u pipeline shard(s) enabled.", shards);
+    }
+
+    /* Phase 1. Create all instances (i.e. find plugins)
+     * Note: Output instances and the output manager are shared by all pipeline shards, so
+     *   they process all flows and their destinations (files, connections, etc.) cannot collide.
+     */
     for (const auto &output : model.outputs) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_OUTPUT, output.plugin);
         outputs.emplace_back(new ipx_instance_output(output.name, ref, m_ring_size));
     }
 
-    for (const auto &inter : model.inters) {
-        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
-        inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size));
-    }
+    for (unsigned int shard = 0; shard < shards; ++shard) {
+        // Instances of the shard are appended after instances of the previous shards
+        for (const auto &inter : model.inters) {
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE,
+                inter.plugin);
+            std::string name = shard_name(inter.name, shard);
+            if (inter.replicas > 1) {
+                // Process data by multiple replicas of the instance in parallel
+                inters.emplace_back(new ipx_instance_replicated(name, ref, m_ring_size,
+                    inter.replicas));
+            } else {
+                inters.emplace_back(new ipx_instance_intermediate(name, ref, m_ring_size));
+            }
+        }
 
-    for (const auto &input : model.inputs) {
-        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INPUT, input.plugin);
-        inputs.emplace_back(new ipx_instance_input(input.name, ref, m_ring_size));
+        for (const auto &input : model.inputs) {
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INPUT, input.plugin);
+            inputs.emplace_back(new ipx_instance_input(shard_name(input.name, shard), ref,
+                m_ring_size));
+            if (m_shards > 0) {
+                // Copies of the instance must not receive the same data (may throw)
+                inputs.back()->set_shards(shards);
+            }
+        }
     }
 
     // Insert the output manager as the last intermediate plugin
     ipx_instance_outmgr *output_manager = new ipx_instance_outmgr(m_ring_size);
     inters.emplace_back(output_manager);
 
-    IPX_DEBUG(comp_str, "All plugins have been successfully loaded.", '\0');
-
     // Phase 2. Connect instances (input -> inter -> ... -> inter -> output manager -> output)
-    ipx_instance_intermediate *first_inter = inters.front().get();
-    for (auto &input : inputs) {
-        input->connect_to(*first_inter); // This can enable multi-writer mode
-    }
+    for (unsigned int shard = 0; shard < shards; ++shard) {
+        const size_t inputs_base = shard * inputs_cnt;
+        const size_t inters_base = shard * inters_cnt;
+
+        // Without intermediate instances, inputs are connected directly to the output manager
+        ipx_instance_intermediate *first_inter = (inters_cnt > 0)
+            ? inters[inters_base].get() : output_manager;
+        for (size_t i = 0; i < inputs_cnt; ++i) {
+            // This can enable multi-writer mode
+            inputs[inputs_base + i]->connect_to(*first_inter);
+        }
+
+        for (size_t i = 0; i < inters_cnt; ++i) {
+            ipx_instance_intermediate *from = inters[inters_base + i].get();
+            ipx_instance_intermediate *to = (i + 1 < inters_cnt)
+                ? inters[inters_base + i + 1].get() : output_manager;
+            // This can enable multi-writer mode of the output manager (multiple shards)
+            from->connect_to(*to);
+        }
 
-    for (size_t i = 0; i < inters.size() - 1; ++i) { // Skip the last element
-        ipx_instance_intermediate *from = inters[i].get();
-        ipx_instance_intermediate *to = inters[i + 1].get();
-        from->connect_to(*to);
+        if (m_shards == 0) {
+            continue;
+        }
+
+        // All stages of the shard are processed by threads of its input instances
+        for (size_t i = 0; i < inputs_cnt; ++i) {
+            inputs[inputs_base + i]->set_direct();
+        }
+        for (size_t i = 0; i < inters_cnt; ++i) {
+            inters[inters_base + i]->set_direct();
+        }
     }
 
-    for (size_t i = 0; i < model.outputs.size(); ++i) {
+    for (size_t i = 0; i < outputs_cnt; ++i) {
         // First initialize ODID filter, if necessary
         ipx_instance_output *instance = outputs[i].get();
         const ipx_plugin_output &cfg = model.outputs[i];
@@ -299,44 +382,55 @@ ipx_configurator::startup(const ipx_config_model &model)
         output_manager->connect_to(*instance);
     }
 
+    IPX_DEBUG(comp_str, "All plugins have been successfully loaded.", '\0');
+
     // Phase 3. Initialize all instances (call constructors)
-    for (size_t i = 0; i < model.outputs.size(); ++i) {
+    for (size_t i = 0; i < outputs_cnt; ++i) {
         ipx_instance_output *instance = outputs[i].get();
         const ipx_plugin_output &cfg = model.outputs[i];
+        instance->set_placement(cfg.placement);
         instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
     }
 
     output_manager->init(m_iemgr, ipx_verb_level_get());
-    for (size_t i = 0; i < model.inters.size(); ++i) {
+
+    for (size_t i = 0; i + 1 < inters.size(); ++i) { // Skip the output manager
         ipx_instance_intermediate *instance = inters[i].get();
-        const ipx_plugin_inter &cfg = model.inters[i];
+        const ipx_plugin_inter &cfg = model.inters[i % inters_cnt];
+        instance->set_placement(cfg.placement);
         instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
     }
 
-    for (size_t i = 0; i < model.inputs.size(); ++i) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
         ipx_instance_input *instance = inputs[i].get();
-        const ipx_plugin_input &cfg = model.inputs[i];
+        const ipx_plugin_input &cfg = model.inputs[i % inputs_cnt];
+        instance->set_placement(cfg.placement);
         instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
     }
 
     IPX_DEBUG(comp_str, "All instances have been successfully initialized.", '\0');
 
-    // Phase 4. Register and resolved Data Record extensions and dependencies
+    /* Phase 4. Register and resolved Data Record extensions and dependencies
+     * Note: All shards are identical, therefore, only instances of the first one are registered
+     */
     ipx_cfg_extensions ext_mgr;
     size_t pos = 0; // Position of an instance in the collector pipeline
 
-    for (auto &input : inputs) {
-        input->extensions_register(&ext_mgr, pos);
+    for (size_t i = 0; i < inputs_cnt; ++i) {
+        inputs[i]->extensions_register(&ext_mgr, pos);
     }
 
     pos++;
-    for (auto &inter : inters) {
-        inter->extensions_register(&ext_mgr, pos);
+    for (size_t i = 0; i < inters_cnt; ++i) {
+        inters[i]->extensions_register(&ext_mgr, pos);
         pos++;
     }
 
-    for (auto &output : outputs) {
-        output->extensions_register(&ext_mgr, pos);
+    output_manager->extensions_register(&ext_mgr, pos);
+    pos++;
+
+    for (size_t i = 0; i < outputs_cnt; ++i) {
+        outputs[i]->extensions_register(&ext_mgr, pos);
     }
 
     ext_mgr.resolve();
@@ -359,13 +453,62 @@ ipx_configurator::startup(const ipx_config_model &model)
     }
 
     IPX_DEBUG(comp_str, "All threads of instances has been successfully started.", '\0');
+    // Ring buffers are allocated, message pools allocate their slabs on demand
+    ipx_hugepage_report();
     m_running_inputs = std::move(inputs);
     m_running_inter = std::move(inters);
     m_running_outputs = std::move(outputs);
 }
 
+/**
+ * \brief Print statistics of pipeline shards (run-to-completion mode only)
+ *
+ * The number of IPFIX Messages and Data Records processed by each shard show imbalance
+ * of distribution of exporters among the shards.
+ */
+void
+ipx_configurator::shard_stats()
+{
+    if (m_shards == 0 || m_running_inputs.empty()) {
+        return;
+    }
+
+    const size_t inputs_cnt = m_running_inputs.size() / m_shards;
+    std::vector<struct ipx_ctx_stats> stats(m_shards, ipx_ctx_stats{0, 0, 0, 0});
+    uint64_t recs_total = 0;
+    uint64_t recs_max = 0;
+
+    for (size_t i = 0; i < m_running_inputs.size(); ++i) {
+        struct ipx_ctx_stats input_stats;
+        m_running_inputs[i]->get_parser_stats(&input_stats);
+
+        struct ipx_ctx_stats &shard = stats[i / inputs_cnt];
+        shard.ipfix_msgs += input_stats.ipfix_msgs;
+        shard.data_recs += input_stats.data_recs;
+    }
+
+    for (unsigned int shard = 0; shard < m_shards; ++shard) {
+        IPX_INFO(comp_str, "Pipeline shard %u: %" PRIu64 " IPFIX Messages, %" PRIu64 " Data "
+            "Records", shard, stats[shard].ipfix_msgs, stats[shard].data_recs);
+        recs_total += stats[shard].data_recs;
+        recs_max = std::max(recs_max, stats[shard].data_recs);
+    }
+
+    if (recs_total > 0) {
+        // Ratio of the busiest shard to the average shard (1.00 = perfect balance)
+        double imbalance = (double) recs_max * m_shards / recs_total;
+        IPX_INFO(comp_str, "Pipeline shard imbalance (max/avg Data Records): %.2f", imbalance);
+    }
+}
+
 void ipx_configurator::cleanup()
 {
+    shard_stats();
+    if (!m_running_inputs.empty()) {
+        // Including slabs of message pools allocated during processing
+        ipx_hugepage_report();
+    }
+
     // Wait for termination (destructor of smart pointers will call instance destructor)
     m_running_inputs.clear();
     m_running_inter.clear();
@@ -529,12 +672,26 @@ ipx_configurator::termination_stop_partly(const ipx_ctx_t *ctx)
         return;
     }
 
-    // Stop intermediate plugins
+    /* Stop intermediate plugins (in all pipeline shards up to the same position)
+     * Note: The output manager shared by all shards is always the last one
+     */
+    const size_t outmgr_idx = m_running_inter.size() - 1;
+    const size_t inters_cnt = std::max<size_t>(outmgr_idx / std::max(m_shards, 1U), 1);
+    for (size_t i = 0; i < m_running_inter.size(); ++i) {
+        if (!m_running_inter[i]->has_ctx(ctx)) {
+            continue;
+        }
+
+        for (size_t j = 0; j < m_running_inter.size(); ++j) {
+            if (i == outmgr_idx || (j != outmgr_idx && j % inters_cnt <= i % inters_cnt)) {
+                m_running_inter[j]->set_processing(false);
+            }
+        }
+        return;
+    }
+
     for (auto &it : m_running_inter) {
         it->set_processing(false);
-        if (it->get_ctx() == ctx) {
-            return;
-        }
     }
 
     // Stop output plugins
@@ -568,6 +725,10 @@ ipx_configurator::termination_send_msg()
     IPX_DEBUG(comp_str, "Request to terminate the pipeline sent! Waiting for instances to "
         "terminate.", '\0');
     m_term_sent = m_running_inputs.size();
+    for (auto &inter : m_running_inter) {
+        // Some instances make copies of the termination message
+        m_term_sent += inter->term_msg_created();
+    }
 }
 
 void
@@ -50,6 +50,7 @@
 #include "instance_input.hpp"
 #include "instance_intermediate.hpp"
 #include "instance_outmgr.hpp"
+#include "instance_replicated.hpp"
 #include "instance_output.hpp"
 #include "plugin_mgr.hpp"
 #include "controller.hpp"
@@ -66,6 +67,8 @@ public:
     static constexpr uint32_t RING_MIN_SIZE = 128;
     /** Default size of ring buffers between instances of plugins                              */
     static constexpr uint32_t RING_DEF_SIZE = 8192;
+    /** Maximal number of pipeline shards in the run-to-completion mode                         */
+    static constexpr unsigned int SHARDS_MAX = 1024;
 
     /** Constructor */
     ipx_configurator();
@@ -91,6 +94,19 @@ public:
       */
      void
      set_buffer_size(uint32_t size);
+     /**
+      * @brief Enable the run-to-completion mode with a given number of pipeline shards
+      *
+      * Each shard is a separate copy of the input and intermediate part of the pipeline and all
+      * its stages are processed in the thread of its input instance instead of passing messages
+      * among threads of instances. The output manager and output instances are created only
+      * once, run in their own threads and receive messages of all shards. Only input plugins
+      * that support the mode (see #IPX_PF_SHARDABLE) can be used.
+      * @param[in] shards Number of shards (0 = disabled i.e. each instance has its own thread)
+      * @throw invalid_argument if the number is out of range
+      */
+     void
+     set_shards(unsigned int shards);
 
      /**
       * @brief Run the collector based on a configuration from the controller
@@ -118,6 +134,8 @@ private:
 
     /** Size of ring buffers                                                                   */
     uint32_t m_ring_size;
+    /** Number of pipeline shards in the run-to-completion mode (0 = disabled)                 */
+    unsigned int m_shards;
     /** Directory with definitions of Information Elements                                     */
     std::string m_iemgr_dir;
 
@@ -140,6 +158,11 @@ private:
     enum ipx_verb_level
     verbosity_str2level(const std::string &verb);
 
+    std::string
+    shard_name(const std::string &name, unsigned int shard);
+    void
+    shard_stats();
+
     void
     startup(const ipx_config_model &model);
     void
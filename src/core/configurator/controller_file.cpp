@@ -12,6 +12,7 @@
 #include <climits>    // realpath
 #include <cstdlib>    // realpath
 #include <cstdio>     // fread, fseek
+#include <cstdint>    // UINT16_MAX
 #include <sys/stat.h> // stat
 
 #include "controller_file.hpp"
@@ -31,11 +32,18 @@ enum file_xml_nodes {
     IN_PLUGIN_PLUGIN,
     IN_PLUGIN_PARAMS,
     IN_PLUGIN_VERBOSITY,
+    IN_PLUGIN_CPU_AFFINITY,
+    IN_PLUGIN_NUMA_NODE,
+    IN_PLUGIN_PRIORITY,
     // Intermediate plugin parameters
     INTER_PLUGIN_NAME,
     INTER_PLUGIN_PLUGIN,
     INTER_PLUGIN_PARAMS,
     INTER_PLUGIN_VERBOSITY,
+    INTER_PLUGIN_REPLICAS,
+    INTER_PLUGIN_CPU_AFFINITY,
+    INTER_PLUGIN_NUMA_NODE,
+    INTER_PLUGIN_PRIORITY,
     // Output plugin parameters
     OUT_PLUGIN_NAME,
     OUT_PLUGIN_PLUGIN,
@@ -43,6 +51,9 @@ enum file_xml_nodes {
     OUT_PLUGIN_VERBOSITY,
     OUT_PLUGIN_ODID_ONLY,
     OUT_PLUGIN_ODID_EXCEPT,
+    OUT_PLUGIN_CPU_AFFINITY,
+    OUT_PLUGIN_NUMA_NODE,
+    OUT_PLUGIN_PRIORITY,
 };
 
 /**
@@ -53,6 +64,9 @@ static const struct fds_xml_args args_instance_input[] = {
     FDS_OPTS_ELEM(IN_PLUGIN_NAME,      "name",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_CPU_AFFINITY, "cpuAffinity", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_NUMA_NODE, "numaNode",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PRIORITY,  "priority",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( IN_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -74,6 +88,10 @@ static const struct fds_xml_args args_instance_inter[] = {
     FDS_OPTS_ELEM(INTER_PLUGIN_NAME,      "name",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(INTER_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(INTER_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_REPLICAS,  "replicas",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_CPU_AFFINITY, "cpuAffinity", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_NUMA_NODE, "numaNode",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_PRIORITY,  "priority",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( INTER_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -94,6 +112,9 @@ static const struct fds_xml_args args_instance_output[] = {
     FDS_OPTS_ELEM(OUT_PLUGIN_VERBOSITY,   "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_EXCEPT, "odidExcept", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_ONLY,   "odidOnly",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_CPU_AFFINITY, "cpuAffinity", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_NUMA_NODE,   "numaNode",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_PRIORITY,    "priority",   FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( OUT_PLUGIN_PARAMS,      "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -123,6 +144,51 @@ static const struct fds_xml_args args_main[] = {
 
 // -------------------------------------------------------------------------------------------------
 
+/** Parameters of placement of an instance (common for all types of instances)                   */
+enum placement_param {
+    PLACEMENT_CPU_AFFINITY,
+    PLACEMENT_NUMA_NODE,
+    PLACEMENT_PRIORITY
+};
+
+/**
+ * \brief Parse a placement parameter of an instance (\<cpuAffinity\>, \<numaNode\> or
+ *   \<priority\>)
+ * \param[in]  content   Parsed XML node
+ * \param[in]  type      Type of the parameter
+ * \param[out] placement Placement of the instance
+ * \throw std::invalid_argument if the value is not valid
+ */
+static void
+parse_placement(const struct fds_xml_cont *content, enum placement_param type,
+    struct ipx_placement &placement)
+{
+    switch (type) {
+    case PLACEMENT_CPU_AFFINITY:
+        assert(content->type == FDS_OPTS_T_STRING);
+        if (ipx_placement_cpus_parse(content->ptr_string, placement.cpus) != IPX_OK) {
+            throw std::invalid_argument("List of CPUs ('<cpuAffinity>') '"
+                + std::string(content->ptr_string) + "' is not valid (expected e.g. '0-3,8')!");
+        }
+        break;
+    case PLACEMENT_NUMA_NODE:
+        assert(content->type == FDS_OPTS_T_UINT);
+        if (content->val_uint >= IPX_PLACEMENT_CPUS) {
+            throw std::invalid_argument("NUMA node ('<numaNode>') is out of range!");
+        }
+        placement.numa_node = static_cast<int>(content->val_uint);
+        break;
+    case PLACEMENT_PRIORITY:
+        assert(content->type == FDS_OPTS_T_UINT);
+        if (content->val_uint < 1 || content->val_uint > 99) {
+            throw std::invalid_argument("Real-time priority ('<priority>') must be in range "
+                "1 - 99!");
+        }
+        placement.priority = static_cast<int>(content->val_uint);
+        break;
+    }
+}
+
 ipx_controller_file::ipx_controller_file(std::string path)
     : m_path(path)
 {
@@ -314,6 +380,15 @@ ipx_controller_file::parse_instance_input(fds_xml_ctx_t *ctx, ipx_config_model &
         case IN_PLUGIN_PARAMS:
             input.params = content->ptr_string;
             break;
+        case IN_PLUGIN_CPU_AFFINITY:
+            parse_placement(content, PLACEMENT_CPU_AFFINITY, input.placement);
+            break;
+        case IN_PLUGIN_NUMA_NODE:
+            parse_placement(content, PLACEMENT_NUMA_NODE, input.placement);
+            break;
+        case IN_PLUGIN_PRIORITY:
+            parse_placement(content, PLACEMENT_PRIORITY, input.placement);
+            break;
         default:
             // Unexpected XML node within <input>!
             assert(false);
@@ -350,6 +425,23 @@ ipx_controller_file::parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &
         case INTER_PLUGIN_PARAMS:
             inter.params = content->ptr_string;
             break;
+        case INTER_PLUGIN_REPLICAS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                throw std::invalid_argument("Number of replicas ('<replicas>') of the "
+                    "intermediate instance is too big!");
+            }
+            inter.replicas = static_cast<unsigned int>(content->val_uint);
+            break;
+        case INTER_PLUGIN_CPU_AFFINITY:
+            parse_placement(content, PLACEMENT_CPU_AFFINITY, inter.placement);
+            break;
+        case INTER_PLUGIN_NUMA_NODE:
+            parse_placement(content, PLACEMENT_NUMA_NODE, inter.placement);
+            break;
+        case INTER_PLUGIN_PRIORITY:
+            parse_placement(content, PLACEMENT_PRIORITY, inter.placement);
+            break;
         default:
             // "Unexpected XML node within <intermediate>!"
             assert(false);
@@ -403,6 +495,15 @@ ipx_controller_file::parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model
                 break;
             }
             throw std::invalid_argument("Multiple definitions of <odidExcept>/<odidOnly>!");
+        case OUT_PLUGIN_CPU_AFFINITY:
+            parse_placement(content, PLACEMENT_CPU_AFFINITY, output.placement);
+            break;
+        case OUT_PLUGIN_NUMA_NODE:
+            parse_placement(content, PLACEMENT_NUMA_NODE, output.placement);
+            break;
+        case OUT_PLUGIN_PRIORITY:
+            parse_placement(content, PLACEMENT_PRIORITY, output.placement);
+            break;
         default:
             // Unexpected XML node within <output>!
             assert(false);
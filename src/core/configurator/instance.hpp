@@ -157,6 +157,33 @@ public:
     set_processing(bool en) {
         ipx_ctx_processing_set(_ctx, en);
     }
+
+    /**
+     * \brief Process messages in the thread of the previous instance (run-to-completion mode)
+     * \note Must be called after the instance is connected and before it is started.
+     * \see ipx_ctx_direct_set() for more details
+     * \throw runtime_error if the mode cannot be changed
+     */
+    virtual void
+    set_direct() {
+        if (ipx_ctx_direct_set(_ctx) != IPX_OK) {
+            throw std::runtime_error("Failed to disable a thread of the instance '" + _name + "'!");
+        }
+    }
+
+    /**
+     * \brief Set placement of thread(s) of the instance on CPUs and NUMA nodes
+     * \note Must be called before the instance is started.
+     * \see ipx_ctx_placement_set() for more details
+     * \param[in] placement Placement
+     * \throw runtime_error if the placement cannot be changed
+     */
+    virtual void
+    set_placement(const struct ipx_placement &placement) {
+        if (ipx_ctx_placement_set(_ctx, &placement) != IPX_OK) {
+            throw std::runtime_error("Failed to set placement of the instance '" + _name + "'!");
+        }
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_H
@@ -56,6 +56,7 @@ static const struct ipx_ctx_callbacks parser_callbacks = {
     &ipx_plugin_parser_destroy,
     nullptr, // No getter
     &ipx_plugin_parser_process,
+    nullptr, // No batch processing
     nullptr  // No feedback
 };
 
@@ -190,4 +191,45 @@ void
 ipx_instance_input::set_parser_processing(bool en)
 {
     ipx_ctx_processing_set(_parser_ctx, en);
-}
\ No newline at end of file
+}
+
+void
+ipx_instance_input::set_direct()
+{
+    if (ipx_ctx_direct_set(_parser_ctx) != IPX_OK) {
+        throw std::runtime_error("Failed to disable a thread of the parser of the instance '"
+            + _name + "'!");
+    }
+}
+
+void
+ipx_instance_input::set_placement(const struct ipx_placement &placement)
+{
+    ipx_instance::set_placement(placement);
+    if (ipx_ctx_placement_set(_parser_ctx, &placement) != IPX_OK) {
+        throw std::runtime_error("Failed to set placement of the parser of the instance '"
+            + _name + "'!");
+    }
+}
+
+void
+ipx_instance_input::set_shards(unsigned int cnt)
+{
+    const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
+    if ((plugin->get_callbacks()->info->flags & IPX_PF_SHARDABLE) == 0) {
+        throw std::runtime_error("Input plugin '" + plugin->get_name() + "' of the instance '"
+            + _name + "' doesn't support the run-to-completion mode (i.e. multiple instances "
+            "would process the same data)!");
+    }
+
+    if (ipx_ctx_shards_set(_ctx, cnt) != IPX_OK) {
+        throw std::runtime_error("Failed to set the number of shards of the instance '"
+            + _name + "'!");
+    }
+}
+
+void
+ipx_instance_input::get_parser_stats(struct ipx_ctx_stats *stats)
+{
+    ipx_ctx_stats_get(_parser_ctx, stats);
+}
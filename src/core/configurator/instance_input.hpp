@@ -182,6 +182,43 @@ public:
      */
     void
     set_parser_processing(bool en);
+
+    /**
+     * \brief Process messages by the parser in the thread of the input plugin
+     *
+     * \note The input plugin always runs in its own thread.
+     * \throw runtime_error if the mode cannot be changed
+     */
+    void
+    set_direct() override;
+
+    /**
+     * \brief Set placement of threads of the input plugin and its parser
+     *
+     * Both threads are placed on the same CPUs, so the parser processes messages in the cache
+     * (and memory) of the input.
+     * \param[in] placement Placement
+     * \throw runtime_error if the placement cannot be changed
+     */
+    void
+    set_placement(const struct ipx_placement &placement) override;
+
+    /**
+     * \brief Set the number of pipeline shards running an identical copy of the instance
+     *
+     * \param[in] cnt Number of shards
+     * \throw runtime_error if the plugin doesn't support the run-to-completion mode (see
+     *   #IPX_PF_SHARDABLE) or the number cannot be changed
+     */
+    void
+    set_shards(unsigned int cnt);
+
+    /**
+     * \brief Get statistics of IPFIX Messages passed by the parser
+     * \param[out] stats Statistics
+     */
+    void
+    get_parser_stats(struct ipx_ctx_stats *stats);
 };
 
 #endif //IPFIXCOL_INSTANCE_INPUT_HPP
@@ -132,6 +132,15 @@ ipx_instance_intermediate::get_input()
 void
 ipx_instance_intermediate::connect_to(ipx_instance_intermediate &intermediate)
 {
-    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    // Only configuration of uninitialized instances can be changed!
+    assert(_state == state::NEW && intermediate._state == state::NEW);
     ipx_ctx_ring_dst_set(_ctx, intermediate.get_input());
+
+    // Multiple pipeline shards can be connected to the same instance (i.e. output manager)
+    intermediate._inputs_cnt++;
+    if (intermediate._inputs_cnt > 1) {
+        // Multiple writers (it's OK to check these values because instances are not running)
+        ipx_ring_mw_mode(intermediate.get_input(), true);
+        ipx_ctx_term_cnt_set(intermediate._ctx, intermediate._inputs_cnt);
+    }
 }
\ No newline at end of file
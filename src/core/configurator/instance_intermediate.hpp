@@ -73,6 +73,8 @@ private:
 protected:
     /** Allow connector to enable multi-write mode                                               */
     friend void ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate);
+    /** Allow replicas to enable multi-write mode                                                */
+    friend class ipx_instance_replicated;
 
     /** Input ring buffer                                                                        */
     ipx_ring_t *_instance_buffer;
@@ -160,6 +162,26 @@ public:
     get_ctx() {
         return _ctx;
     }
+
+    /**
+     * \brief Check if the plugin context belongs to the instance
+     * \param[in] ctx Plugin context
+     */
+    virtual bool
+    has_ctx(const ipx_ctx_t *ctx) {
+        return _ctx == ctx;
+    }
+
+    /**
+     * \brief Get number of additional termination messages created by the instance
+     *
+     * Each termination message notifies the configurator when it is destroyed. Therefore,
+     * the configurator must know about all termination messages in the pipeline.
+     */
+    virtual size_t
+    term_msg_created() {
+        return 0;
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_INTERMEDIATE_HPP
@@ -55,6 +55,7 @@ static const struct ipx_ctx_callbacks output_mgr_callbacks = {
     &ipx_plugin_output_mgr_destroy,
     nullptr, // No getter
     &ipx_plugin_output_mgr_process,
+    &ipx_plugin_output_mgr_process_batch,
     nullptr  // No feedback
 };
 
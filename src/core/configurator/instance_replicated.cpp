@@ -0,0 +1,258 @@
+/**
+ * @file
+ * @brief Replicated intermediate instance wrapper (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "instance_replicated.hpp"
+#include "../message_terminate.h"
+#include "../verbose.h"
+
+/** Description of the internal splitter                                                         */
+static const struct ipx_ctx_callbacks splitter_callbacks = {
+    // Static plugin, no library handles
+    nullptr,
+    &ipx_plugin_splitter_info,
+    // Only basic functions
+    &ipx_plugin_splitter_init,
+    &ipx_plugin_splitter_destroy,
+    nullptr, // No getter
+    &ipx_plugin_splitter_process,
+    &ipx_plugin_splitter_process_batch,
+    nullptr  // No feedback
+};
+
+ipx_instance_replicated::ipx_instance_replicated(const std::string &name,
+    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize, unsigned int replicas)
+    : ipx_instance_intermediate(name + " (splitter)", &splitter_callbacks, bsize), _list(nullptr)
+{
+    // The base class takes care of the plugin reference from now
+    _name = name;
+    _plugin_ref = ref;
+    assert(replicas > 0);
+
+    // Get the plugin callbacks
+    const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
+    const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
+    assert(cbs != nullptr && plugin->get_type() == IPX_PT_INTERMEDIATE);
+
+    _list = ipx_splitter_list_create();
+    if (!_list) {
+        throw std::runtime_error("Failed to initialize a list of replicas!");
+    }
+
+    try {
+        for (unsigned int i = 0; i < replicas; ++i) {
+            std::string rname = name + "#" + std::to_string(i);
+            unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+            unique_ctx  ctx_wrap(ipx_ctx_create(rname.c_str(), cbs), &ipx_ctx_destroy);
+            if (!ring_wrap || !ctx_wrap) {
+                throw std::runtime_error("Failed to create components of a replica!");
+            }
+
+            if (ipx_splitter_list_add(_list, ring_wrap.get()) != IPX_OK) {
+                throw std::runtime_error("Failed to add a replica to the list of replicas!");
+            }
+
+            // Configure the components (connect them)
+            ipx_ctx_ring_src_set(ctx_wrap.get(), ring_wrap.get());
+            ipx_ctx_replica_set(ctx_wrap.get(), true);
+            _replica_buffers.push_back(ring_wrap.release());
+            _replica_ctxs.push_back(ctx_wrap.release());
+        }
+    } catch (...) {
+        replicas_destroy();
+        throw;
+    }
+}
+
+ipx_instance_replicated::~ipx_instance_replicated()
+{
+    // The splitter must be terminated first
+    ipx_ctx_destroy(_ctx);
+    _ctx = nullptr;
+
+    // Now we can destroy the replicas and private data of the splitter
+    replicas_destroy();
+}
+
+/**
+ * \brief Destroy contexts and ring buffers of all replicas and the list of replicas
+ */
+void
+ipx_instance_replicated::replicas_destroy()
+{
+    // Destroy contexts (if running, wait for termination of threads)
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        ipx_ctx_destroy(ctx);
+    }
+    _replica_ctxs.clear();
+
+    // Now we can destroy buffers
+    for (ipx_ring_t *ring : _replica_buffers) {
+        ipx_ring_destroy(ring);
+    }
+    _replica_buffers.clear();
+
+    if (_list != nullptr) {
+        ipx_splitter_list_destroy(_list);
+        _list = nullptr;
+    }
+}
+
+void
+ipx_instance_replicated::init(const std::string &params, const fds_iemgr_t *iemgr,
+    ipx_verb_level level)
+{
+    assert(iemgr != nullptr);
+    assert(_state == state::NEW); // Only not initialized instance can be initialized
+
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        // Configure
+        ipx_ctx_verb_set(ctx, level);
+        ipx_ctx_iemgr_set(ctx, iemgr);
+
+        // Initialize
+        if (ipx_ctx_init(ctx, params.c_str()) != IPX_OK) {
+            throw std::runtime_error("Failed to initialize a replica of the intermediate plugin!");
+        }
+    }
+
+    // Pass the list of replicas
+    ipx_ctx_private_set(_ctx, _list);
+    ipx_instance_intermediate::init("", iemgr, level);
+}
+
+void
+ipx_instance_replicated::start()
+{
+    assert(_state == state::INITIALIZED); // Only initialized instances can start
+
+    size_t started = 0;
+    while (started < _replica_ctxs.size() && ipx_ctx_run(_replica_ctxs[started]) == IPX_OK) {
+        started++;
+    }
+
+    if (started < _replica_ctxs.size()) {
+        replicas_stop(started);
+        throw std::runtime_error("Failed to start a thread of a replica.");
+    }
+
+    try {
+        ipx_instance_intermediate::start();
+    } catch (...) {
+        replicas_stop(started);
+        throw;
+    }
+}
+
+/**
+ * \brief Stop already started replicas (after a failure of the start)
+ *
+ * Each replica gets a termination message, so its thread terminates and can be joined by
+ * the destructor.
+ * \param[in] cnt Number of started replicas (from the beginning of the list)
+ */
+void
+ipx_instance_replicated::replicas_stop(size_t cnt)
+{
+    for (size_t i = 0; i < cnt; ++i) {
+        ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+        if (!msg) {
+            IPX_ERROR(_name.c_str(), "Failed to stop a replica (memory allocation error)", '\0');
+            continue;
+        }
+
+        ipx_ring_push(_replica_buffers[i], ipx_msg_terminate2base(msg));
+    }
+}
+
+void
+ipx_instance_replicated::connect_to(ipx_instance_intermediate &intermediate)
+{
+    // Only configuration of uninitialized instances can be changed!
+    assert(_state == state::NEW && intermediate._state == state::NEW);
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        ipx_ctx_ring_dst_set(ctx, intermediate.get_input());
+    }
+
+    intermediate._inputs_cnt += _replica_ctxs.size();
+    if (intermediate._inputs_cnt > 1) {
+        // Multiple writers (it's OK to check these values because instances are not running)
+        ipx_ring_mw_mode(intermediate.get_input(), true);
+        ipx_ctx_term_cnt_set(intermediate._ctx, intermediate._inputs_cnt);
+    }
+}
+
+void
+ipx_instance_replicated::extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos)
+{
+    // All replicas have the same extensions, however, only one producer is allowed
+    ext_mgr->register_instance(_replica_ctxs.front(), pos);
+}
+
+void
+ipx_instance_replicated::extensions_resolve(ipx_cfg_extensions *ext_mgr)
+{
+    ext_mgr->update_instance(_ctx);
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        ext_mgr->update_instance(ctx);
+    }
+}
+
+void
+ipx_instance_replicated::set_processing(bool en)
+{
+    ipx_ctx_processing_set(_ctx, en);
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        ipx_ctx_processing_set(ctx, en);
+    }
+}
+
+bool
+ipx_instance_replicated::has_ctx(const ipx_ctx_t *ctx)
+{
+    if (_ctx == ctx) {
+        return true;
+    }
+
+    for (const ipx_ctx_t *replica : _replica_ctxs) {
+        if (replica == ctx) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+ipx_instance_replicated::set_direct()
+{
+    ipx_instance_intermediate::set_direct();
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        if (ipx_ctx_direct_set(ctx) != IPX_OK) {
+            throw std::runtime_error("Failed to disable a thread of a replica of the instance '"
+                + _name + "'!");
+        }
+    }
+}
+
+void
+ipx_instance_replicated::set_placement(const struct ipx_placement &placement)
+{
+    ipx_instance_intermediate::set_placement(placement);
+    for (ipx_ctx_t *ctx : _replica_ctxs) {
+        if (ipx_ctx_placement_set(ctx, &placement) != IPX_OK) {
+            throw std::runtime_error("Failed to set placement of a replica of the instance '"
+                + _name + "'!");
+        }
+    }
+}
+
+size_t
+ipx_instance_replicated::term_msg_created()
+{
+    return _replica_ctxs.size() - 1;
+}
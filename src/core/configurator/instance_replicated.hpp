@@ -0,0 +1,150 @@
+/**
+ * @file
+ * @brief Replicated intermediate instance wrapper (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_INSTANCE_REPLICATED_HPP
+#define IPFIXCOL_INSTANCE_REPLICATED_HPP
+
+#include <vector>
+#include "instance_intermediate.hpp"
+
+extern "C" {
+#include "../plugin_splitter.h"
+}
+
+/**
+ * \brief Instance of an intermediate plugin running in multiple parallel replicas
+ *
+ * The class takes care of (i.e. initialize, configure and destroy):
+ * - an internal splitter (a context of the internal plugin) and its input ring buffer
+ * - plugin contexts of all replicas of the intermediate plugin and their input ring buffers
+ *
+ * The splitter passes all messages of the same Transport Session to the same replica, so the
+ * order of the messages of each Transport Session is preserved. All replicas pass their messages
+ * into the same (multi-writer) input ring buffer of the following instance. Garbage and
+ * termination messages are passed by the replicas only after all previous messages have been
+ * processed by all replicas (see ipx_plugin_splitter_process() for more details).
+ *
+ * \verbatim
+ *                                      +---------+
+ *                                 +----> Inter#0 +---->
+ *                  +----------+   |    +---------+
+ *                  |          +---+        ...
+ *            +-----> Splitter |
+ *             ring |          +---+    +---------+
+ *                  +----------+   +----> Inter#N +---->
+ *                                      +---------+
+ * \endverbatim
+ */
+class ipx_instance_replicated : public ipx_instance_intermediate {
+private:
+    /** Contexts of the replicas                                                                 */
+    std::vector<ipx_ctx_t *> _replica_ctxs;
+    /** Input ring buffers of the replicas                                                       */
+    std::vector<ipx_ring_t *> _replica_buffers;
+    /** List of replicas (private data of the splitter)                                          */
+    ipx_splitter_list_t *_list;
+
+    void replicas_destroy();
+    void replicas_stop(size_t cnt);
+public:
+    /**
+     * \brief Create an instance of an intermediate plugin with multiple replicas
+     *
+     * \note
+     *   The \p ref is plugin reference wrapper of the plugin. The reference will be destroyed
+     *   during this destruction of the object of this class.
+     * \param[in] name     Name of the instance
+     * \param[in] ref      Reference to the plugin (will be automatically delete on destroy)
+     * \param[in] bsize    Size of the input ring buffers
+     * \param[in] replicas Number of replicas (at least 1)
+     * \throw runtime_error if the function fails to create all components
+     */
+    ipx_instance_replicated(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
+        uint32_t bsize, unsigned int replicas);
+
+    /**
+     * \brief Destroy the instance
+     * \note
+     *   If the threads are running (start() has been called), the function blocks until all
+     *   threads are exited.
+     */
+    ~ipx_instance_replicated();
+
+    /**
+     * \brief Initialize the instance
+     *
+     * Initialize contexts of all replicas and the splitter.
+     * \param[in] params XML parameters of the instance (the same for all replicas)
+     * \param[in] iemgr  Reference to the manager of Information Elements
+     * \param[in] level  Verbosity level
+     * \throw runtime_error if the function fails to initialize all components
+     */
+    void init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level) override;
+
+    /**
+     * \brief Start threads of all replicas and the splitter
+     * \throw runtime_error if a thread fails to the start
+     */
+    void start() override;
+
+    /**
+     * \brief Connect all replicas to another instance of an intermediate plugin
+     * \note The input ring buffer of the \p intermediate will be switched to multi-writer mode.
+     * \param[in] intermediate Intermediate plugin to receive our messages
+     */
+    void connect_to(ipx_instance_intermediate &intermediate) override;
+
+    /**
+     * \brief Registered extensions and dependencies
+     * \note Only one replica is registered as all replicas have the same definitions.
+     * \param[in] ext_mgr Extension manager
+     * \param[in] pos     Position of the instance in the pipeline
+     */
+    void extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos) override;
+
+    /**
+     * \brief Resolve definition of the extension/dependency definitions of all replicas
+     * \param[in] ext_mgr Extension manager
+     */
+    void extensions_resolve(ipx_cfg_extensions *ext_mgr) override;
+
+    /**
+     * \brief Enable/disable processing of data messages by all replicas
+     * \param[in] en Enable/disable processing
+     */
+    void set_processing(bool en) override;
+
+    /**
+     * \brief Check if the context belongs to the instance (i.e. the splitter or a replica)
+     * \param[in] ctx Plugin context
+     */
+    bool has_ctx(const ipx_ctx_t *ctx) override;
+
+    /**
+     * \brief Process messages by the splitter and all replicas in the thread of the previous
+     *   instance
+     * \throw runtime_error if the mode cannot be changed
+     */
+    void set_direct() override;
+
+    /**
+     * \brief Set placement of threads of the splitter and all replicas
+     * \note All replicas share the same CPUs (i.e. the scheduler distributes them).
+     * \param[in] placement Placement
+     * \throw runtime_error if the placement cannot be changed
+     */
+    void set_placement(const struct ipx_placement &placement) override;
+
+    /**
+     * \brief Get number of additional termination messages created by the instance
+     * \note The splitter creates a copy of the termination message for each extra replica.
+     */
+    size_t term_msg_created() override;
+};
+
+#endif // IPFIXCOL_INSTANCE_REPLICATED_HPP
@@ -119,6 +119,11 @@ ipx_config_model::add_instance(struct ipx_plugin_inter &instance)
             + instance.name + "' are not allowed!");
     }
 
+    if (instance.replicas == 0) {
+        throw std::invalid_argument("Number of replicas ('<replicas>') of the intermediate "
+            "instance '" + instance.name + "' must be greater than zero!");
+    }
+
     inters.push_back(instance);
 }
 
@@ -163,7 +168,11 @@ ipx_config_model::dump()
     // Intermediate plugins
     std::cout << "Intermediate plugins:\n";
     for (auto &inter : inters) {
-        std::cout << "\t- " << inter.plugin << " / " << inter.name << "\n";
+        std::cout << "\t- " << inter.plugin << " / " << inter.name;
+        if (inter.replicas > 1) {
+            std::cout << " (replicas: " << inter.replicas << ")";
+        }
+        std::cout << "\n";
     }
 
     if (inters.empty()) {
@@ -47,6 +47,7 @@
 
 extern "C" {
 #include "../odid_range.h"
+#include "../placement.h"
 }
 
 /** Common plugin configuration parameters                                  */
@@ -59,13 +60,18 @@ struct ipx_plugin_base {
     std::string params;
     /** Verbosity mode (if empty, use default)                              */
     std::string verbosity;
+    /** Placement of thread(s) of the instance (by default, not restricted)  */
+    struct ipx_placement placement = IPX_PLACEMENT_INIT;
 };
 
 /** Configuration of an input plugin                                          */
 struct ipx_plugin_input  : ipx_plugin_base {};
 
 /** Configuration of an intermediate plugin                                   */
-struct ipx_plugin_inter  : ipx_plugin_base {};
+struct ipx_plugin_inter  : ipx_plugin_base {
+    /** Number of parallel replicas of the instance                           */
+    unsigned int replicas = 1;
+};
 
 /** Configuration of an output plugin                                         */
 struct ipx_plugin_output : ipx_plugin_base {
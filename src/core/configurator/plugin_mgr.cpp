@@ -693,6 +693,10 @@ ipx_plugin_mgr::plugin::symbol_load_all(void *handle, struct ipx_ctx_callbacks &
     if (type == IPX_PT_INTERMEDIATE || type == IPX_PT_OUTPUT) {
         // Try to find the process function
         *(void **) (&cbs.process) = symbol_get(handle, "ipx_plugin_process");
+        *(void **) (&cbs.process_batch) = symbol_get(handle, "ipx_plugin_process_batch", true);
+
+        IPX_DEBUG(comp_str, "Plugin '%s' %s batch processing of messages.",
+            p_info->name, (!cbs.process_batch) ? "does not support" : "supports");
     }
 }
 
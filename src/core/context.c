@@ -40,6 +40,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <inttypes.h>
 #include <pthread.h>
@@ -52,6 +53,7 @@
 #include <sys/prctl.h>
 #endif
 
+#include <build_config.h>
 #include "context.h"
 #include "extension.h"
 #include "verbose.h"
@@ -60,11 +62,25 @@
 #include "ring.h"
 #include "message_ipfix.h"
 #include "message_periodic.h"
+#include "metrics.h"
 #include "configurator/cpipe.h"
+#ifdef ENABLE_LATENCY_TRACE
+#include "latency.h"
+#endif
 
 /** Identification of this component (for log) */
 const char *comp_str = "Context";
 
+/** Maximum number of messages received from an input ring buffer at once */
+#define CTX_BATCH_MAX (64U)
+
+#ifdef ENABLE_LATENCY_TRACE
+/** Only 1 of N IPFIX Messages passed by an input instance is traced (MUST be a power of 2)  */
+#define CTX_TRACE_SAMPLE (1024U)
+/** Interval between reports of latency histograms (in seconds)                              */
+#define CTX_TRACE_REPORT (60U)
+#endif
+
 /** List of permissions */
 enum ipx_ctx_permissions {
     /** Permission to pass a message              */
@@ -80,7 +96,9 @@ enum ipx_ctx_state {
     /** Instance has been successfully initialized, but a thread is not running                  */
     IPX_CS_INIT,
     /** Instance initialized and a thread is running                                             */
-    IPX_CS_RUNNING
+    IPX_CS_RUNNING,
+    /** Instance without its own thread has been terminated (see ipx_ctx_direct_set())           */
+    IPX_CS_DONE
 };
 
 /**
@@ -102,6 +120,36 @@ struct ipx_ctx {
     pthread_t thread_id;
     /** Enable data processing by the plugin (enabled by default)                                */
     bool en_processing;
+    /** Messages are processed by the thread of the writer (see ipx_ctx_direct_set())            */
+    bool direct;
+    /** Placement of the thread of the instance (see ipx_ctx_placement_set())                    */
+    struct ipx_placement placement;
+    /** Sequence number of the next expected periodic message (intermediate instances only)     */
+    uint64_t periodic_seq;
+    /** Statistics of passed messages (see ipx_ctx_stats_get())                                  */
+    struct ipx_ctx_stats stats;
+    /** Pool of wrappers of IPFIX Messages created by the instance                               */
+    ipx_msg_pool_t *msg_pool;
+    struct {
+        /** Number of IPFIX Messages (see #stats)                                                 */
+        ipx_metric_t *ipfix_msgs;
+        /** Number of Data Records (see #stats)                                                   */
+        ipx_metric_t *data_recs;
+        /** Occupancy of the input ring buffer                                                   */
+        ipx_metric_t *ring_usage;
+    } metrics; /**< Built-in metrics of the instance (see ctx_metrics_create())                 */
+#ifdef ENABLE_LATENCY_TRACE
+    struct {
+        /** Number of IPFIX Messages passed by the instance (input instances only)               */
+        uint32_t sample_cnt;
+        /** Time of sampled messages since their previous hand-off (except input instances)      */
+        struct ipx_lat_hist *stage;
+        /** Time of sampled messages since the input instance (output instances only)            */
+        struct ipx_lat_hist *total;
+        /** Monotonic time of the last report [ns]                                               */
+        uint64_t report_ts;
+    } trace; /**< Latency tracing (used only by the thread of the instance)                      */
+#endif
 
     struct {
         /**
@@ -160,6 +208,13 @@ struct ipx_ctx {
          * the input plugins MUST have the value corresponding to the number of input instances.
          */
         unsigned int term_msg_cnt;
+        /**
+         * The instance is one of replicas of the same intermediate instance. Garbage messages
+         * are shared by all replicas and only the last one passes them further.
+         */
+        bool replica;
+        /** Number of pipeline shards running a copy of the instance (see ipx_ctx_shards_set()) */
+        unsigned int shards;
     } cfg_system; /**< System configuration                                                      */
 
     struct {
@@ -170,6 +225,175 @@ struct ipx_ctx {
     } cfg_extension; /**< Extension configuration                                                */
 };
 
+#ifdef ENABLE_LATENCY_TRACE
+/**
+ * \brief Print a latency histogram to the log
+ * \param[in] ctx   Instance context
+ * \param[in] label Description of the histogram
+ * \param[in] hist  Histogram
+ */
+static void
+trace_hist_print(const struct ipx_ctx *ctx, const char *label, const struct ipx_lat_hist *hist)
+{
+    IPX_CTX_INFO(ctx, "Latency (%s, %" PRIu64 " sampled messages): avg %.1f us, p50 %.1f us, "
+        "p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us", label, hist->cnt,
+        (hist->sum / (double) hist->cnt) / 1000.0,
+        ipx_lat_hist_percentile(hist, 50.0) / 1000.0,
+        ipx_lat_hist_percentile(hist, 90.0) / 1000.0,
+        ipx_lat_hist_percentile(hist, 99.0) / 1000.0,
+        ipx_lat_hist_percentile(hist, 99.9) / 1000.0,
+        hist->max / 1000.0);
+}
+
+/**
+ * \brief Print latency histograms of the instance to the log and reset them
+ * \param[in] ctx Instance context
+ */
+static void
+trace_report(struct ipx_ctx *ctx)
+{
+    if (ctx->trace.stage->cnt > 0) {
+        trace_hist_print(ctx, "since previous instance", ctx->trace.stage);
+    }
+    if (ctx->trace.total->cnt > 0) {
+        trace_hist_print(ctx, "since input", ctx->trace.total);
+    }
+
+    ipx_lat_hist_reset(ctx->trace.stage);
+    ipx_lat_hist_reset(ctx->trace.total);
+}
+
+/**
+ * \brief Report latency histograms of the instance, if the report interval has elapsed
+ *
+ * The function is called when a periodic message is received, so it doesn't require any
+ * additional timer.
+ * \param[in] ctx Instance context
+ */
+static void
+trace_report_periodic(struct ipx_ctx *ctx)
+{
+    const uint64_t now = ipx_lat_now();
+    if (now - ctx->trace.report_ts < CTX_TRACE_REPORT * 1000000000ULL) {
+        return;
+    }
+
+    ctx->trace.report_ts = now;
+    trace_report(ctx);
+}
+
+/**
+ * \brief Record that an output instance has finished processing of a message
+ * \param[in] ctx Instance context
+ * \param[in] msg Message (MUST not be released yet)
+ */
+static inline void
+trace_done(struct ipx_ctx *ctx, ipx_msg_t *msg)
+{
+    if (ipx_msg_get_type(msg) != IPX_MSG_IPFIX || !ipx_msg_header_trace_sampled(msg)) {
+        return;
+    }
+
+    // The message can be shared by multiple output instances -> read only
+    const uint64_t now = ipx_lat_now();
+    ipx_lat_hist_add(ctx->trace.stage, now - msg->trace.last);
+    ipx_lat_hist_add(ctx->trace.total, now - msg->trace.first);
+}
+
+void
+ipx_ctx_trace_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
+{
+    if (ipx_msg_get_type(msg) != IPX_MSG_IPFIX) {
+        return;
+    }
+
+    if (ctx->type == IPX_PT_INPUT) {
+        // Sample the message
+        if ((ctx->trace.sample_cnt++ & (CTX_TRACE_SAMPLE - 1)) == 0) {
+            ipx_msg_header_trace_start(msg, ipx_lat_now());
+        }
+        return;
+    }
+
+    if (!ipx_msg_header_trace_sampled(msg)) {
+        return;
+    }
+
+    ipx_lat_hist_add(ctx->trace.stage, ipx_msg_header_trace_lap(msg, ipx_lat_now()));
+}
+#endif
+
+/** Value provider of the metric of IPFIX Messages of an instance */
+static uint64_t
+ctx_metric_ipfix_msgs(const void *arg)
+{
+    const struct ipx_ctx *ctx = (const struct ipx_ctx *) arg;
+    return __atomic_load_n(&ctx->stats.ipfix_msgs, __ATOMIC_RELAXED);
+}
+
+/** Value provider of the metric of Data Records of an instance */
+static uint64_t
+ctx_metric_data_recs(const void *arg)
+{
+    const struct ipx_ctx *ctx = (const struct ipx_ctx *) arg;
+    return __atomic_load_n(&ctx->stats.data_recs, __ATOMIC_RELAXED);
+}
+
+/** Value provider of the metric of occupancy of the input ring buffer of an instance */
+static uint64_t
+ctx_metric_ring_usage(const void *arg)
+{
+    const struct ipx_ctx *ctx = (const struct ipx_ctx *) arg;
+    return (ctx->pipeline.src != NULL) ? ipx_ring_usage(ctx->pipeline.src) : 0;
+}
+
+/**
+ * \brief Create built-in metrics of an initialized instance
+ *
+ * Values of the metrics are read directly from the context, when the metrics are exposed.
+ * Failure to create a metric is not fatal.
+ * \param[in] ctx Instance context
+ */
+static void
+ctx_metrics_create(struct ipx_ctx *ctx)
+{
+    const char *labels[] = {"instance", ctx->name, NULL};
+
+    if (ctx->type != IPX_PT_OUTPUT_MGR) {
+        ctx->metrics.ipfix_msgs = ipx_metric_create_cb(IPX_METRIC_COUNTER,
+            IPX_METRIC_PREFIX "ipfix_messages_total", "IPFIX Messages passed by the instance "
+            "(processed, in case of output instances)", labels, &ctx_metric_ipfix_msgs, ctx);
+    }
+
+    if (ctx->type != IPX_PT_INPUT && ctx->type != IPX_PT_OUTPUT_MGR) {
+        // Input instances pass only unparsed messages
+        ctx->metrics.data_recs = ipx_metric_create_cb(IPX_METRIC_COUNTER,
+            IPX_METRIC_PREFIX "data_records_total", "Data Records passed by the instance "
+            "(processed, in case of output instances)", labels, &ctx_metric_data_recs, ctx);
+    }
+
+    if (ctx->type != IPX_PT_INPUT) {
+        ctx->metrics.ring_usage = ipx_metric_create_cb(IPX_METRIC_GAUGE,
+            IPX_METRIC_PREFIX "ring_usage_percent", "Occupancy of the input ring buffer of "
+            "the instance", labels, &ctx_metric_ring_usage, ctx);
+    }
+}
+
+/**
+ * \brief Destroy built-in metrics of an instance
+ * \param[in] ctx Instance context
+ */
+static void
+ctx_metrics_destroy(struct ipx_ctx *ctx)
+{
+    ipx_ctx_metric_destroy(ctx->metrics.ipfix_msgs);
+    ipx_ctx_metric_destroy(ctx->metrics.data_recs);
+    ipx_ctx_metric_destroy(ctx->metrics.ring_usage);
+    ctx->metrics.ipfix_msgs = NULL;
+    ctx->metrics.data_recs = NULL;
+    ctx->metrics.ring_usage = NULL;
+}
+
 ipx_ctx_t *
 ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
 {
@@ -184,17 +408,43 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
         return NULL;
     }
 
+    ctx->msg_pool = ipx_msg_pool_create();
+    if (!ctx->msg_pool) {
+        free(ctx->name);
+        free(ctx);
+        return NULL;
+    }
+
+#ifdef ENABLE_LATENCY_TRACE
+    ctx->trace.stage = calloc(1, sizeof(*ctx->trace.stage));
+    ctx->trace.total = calloc(1, sizeof(*ctx->trace.total));
+    if (!ctx->trace.stage || !ctx->trace.total) {
+        free(ctx->trace.stage);
+        free(ctx->trace.total);
+        ipx_msg_pool_destroy(ctx->msg_pool);
+        free(ctx->name);
+        free(ctx);
+        return NULL;
+    }
+    ctx->trace.report_ts = ipx_lat_now();
+#endif
+
     ctx->type = 0;           // Undefined type
     ctx->permissions = 0;    // No permissions
     ctx->plugin_cbs = callbacks;
     ctx->state = IPX_CS_NEW;
     ctx->en_processing = true;
+    ctx->direct = false;
+    ctx->placement = (struct ipx_placement) IPX_PLACEMENT_INIT;
+    ctx->periodic_seq = 0;
 
     ctx->cfg_system.vlevel = ipx_verb_level_get();
     ctx->cfg_system.rec_size = IPX_MSG_IPFIX_BASE_REC_SIZE;
     ctx->cfg_system.msg_mask_selected = 0; // No messages to process selected
     ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION | IPX_MSG_PERIODIC;
     ctx->cfg_system.term_msg_cnt = 1; // By default, wait for 1 termination message
+    ctx->cfg_system.replica = false;
+    ctx->cfg_system.shards = 1;
 
     ctx->cfg_extension.items = NULL;
     ctx->cfg_extension.items_cnt = 0;
@@ -210,6 +460,16 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
 void
 ipx_ctx_destroy(ipx_ctx_t *ctx)
 {
+    // Values of the metrics are provided by the context
+    ctx_metrics_destroy(ctx);
+
+    if (ctx->state == IPX_CS_RUNNING && ctx->direct) {
+        /* The instance without its own thread hasn't received a termination message (e.g. the
+         * writer hasn't been started) -> destroy it in the same way as an initialized one
+         */
+        ctx->state = IPX_CS_INIT;
+    }
+
     if (ctx->state == IPX_CS_RUNNING) {
         // Wait for the thread to terminate
         int rc = pthread_join(ctx->thread_id, NULL);
@@ -244,6 +504,22 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
     }
     free(ctx->cfg_extension.items);
 
+    // Unused wrappers are freed now, the rest as soon as the messages are destroyed
+    struct ipx_msg_pool_stats pool_stats;
+    ipx_msg_pool_stats_get(ctx->msg_pool, &pool_stats);
+    if (pool_stats.hits != 0 || pool_stats.misses != 0) {
+        IPX_CTX_DEBUG(ctx, "Pool of IPFIX Messages: %" PRIu64 " hits, %" PRIu64 " misses",
+            pool_stats.hits, pool_stats.misses);
+    }
+    ipx_msg_pool_destroy(ctx->msg_pool);
+
+#ifdef ENABLE_LATENCY_TRACE
+    // Values recorded since the last periodic report
+    trace_report(ctx);
+    free(ctx->trace.stage);
+    free(ctx->trace.total);
+#endif
+
     free(ctx->name);
     free(ctx);
 }
@@ -293,6 +569,12 @@ ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt)
     return IPX_OK;
 }
 
+void
+ipx_ctx_replica_set(ipx_ctx_t *ctx, bool en)
+{
+    ctx->cfg_system.replica = en;
+}
+
 int
 ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t *mask_old)
 {
@@ -338,10 +620,153 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_OK;
     }
 
+    if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+        // Only the thread of the instance updates the counters
+        uint64_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipx_msg_base2ipfix(msg));
+        __atomic_store_n(&ctx->stats.ipfix_msgs, ctx->stats.ipfix_msgs + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&ctx->stats.data_recs, ctx->stats.data_recs + rec_cnt, __ATOMIC_RELAXED);
+    }
+
+#ifdef ENABLE_LATENCY_TRACE
+    ipx_ctx_trace_pass(ctx, msg);
+#endif
     ipx_ring_push(ctx->pipeline.dst, msg);
     return IPX_OK;
 }
 
+unsigned int
+ipx_ctx_pressure_get(const ipx_ctx_t *ctx)
+{
+    /* Successors without their own thread (see ipx_ctx_direct_set()) process messages
+     * immediately and their input buffers stay empty. Therefore, follow the pipeline up to
+     * the first buffer with its own reader (e.g. the output manager shared by pipeline shards).
+     */
+    const ipx_ring_t *ring = ctx->pipeline.dst;
+    while (ring != NULL) {
+        const struct ipx_ctx *next = ipx_ring_direct_arg(ring);
+        if (!next) {
+            break;
+        }
+        ring = next->pipeline.dst;
+    }
+
+    return (ring != NULL) ? ipx_ring_usage(ring) : 0;
+}
+
+int
+ipx_ctx_feedback_fd_get(const ipx_ctx_t *ctx)
+{
+    if (ctx->type != IPX_PT_INPUT || !ctx->pipeline.feedback) {
+        return -1;
+    }
+
+    return ipx_fpipe_fd(ctx->pipeline.feedback);
+}
+
+unsigned int
+ipx_ctx_shards_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.shards;
+}
+
+ipx_metric_t *
+ipx_ctx_metric_create(ipx_ctx_t *ctx, enum ipx_metric_type type, const char *name,
+    const char *help, const char *const *labels)
+{
+    // Prepend the label of the instance
+    size_t labels_cnt = 0;
+    while (labels != NULL && labels[labels_cnt] != NULL) {
+        labels_cnt += 2;
+    }
+
+    const char **labels_all = malloc((labels_cnt + 3) * sizeof(*labels_all));
+    char *name_full = malloc(strlen(IPX_METRIC_PREFIX) + strlen(name) + 1);
+    if (!labels_all || !name_full) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(labels_all);
+        free(name_full);
+        return NULL;
+    }
+
+    labels_all[0] = "instance";
+    labels_all[1] = ctx->name;
+    for (size_t i = 0; i < labels_cnt; ++i) {
+        labels_all[i + 2] = labels[i];
+    }
+    labels_all[labels_cnt + 2] = NULL;
+    strcpy(name_full, IPX_METRIC_PREFIX);
+    strcat(name_full, name);
+
+    ipx_metric_t *metric = ipx_metric_create(type, name_full, help, labels_all);
+    free(labels_all);
+    free(name_full);
+    return metric;
+}
+
+void
+ipx_ctx_stats_get(const ipx_ctx_t *ctx, struct ipx_ctx_stats *stats)
+{
+    stats->ipfix_msgs = __atomic_load_n(&ctx->stats.ipfix_msgs, __ATOMIC_RELAXED);
+    stats->data_recs = __atomic_load_n(&ctx->stats.data_recs, __ATOMIC_RELAXED);
+
+    struct ipx_msg_pool_stats pool_stats;
+    ipx_msg_pool_stats_get(ctx->msg_pool, &pool_stats);
+    stats->pool_hits = pool_stats.hits;
+    stats->pool_misses = pool_stats.misses;
+}
+
+ipx_msg_pool_t *
+ipx_ctx_msg_pool_get(const ipx_ctx_t *ctx)
+{
+    return ctx->msg_pool;
+}
+
+int
+ipx_ctx_direct_set(ipx_ctx_t *ctx)
+{
+    if (ctx->state == IPX_CS_RUNNING || ctx->state == IPX_CS_DONE) {
+        IPX_CTX_ERROR(ctx, "Unable to change the threading mode of a running instance!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    if (ctx->pipeline.src == NULL) {
+        IPX_CTX_ERROR(ctx, "Input ring buffer is not defined!", '\0');
+        return IPX_ERR_ARG;
+    }
+
+    ctx->direct = true;
+    return IPX_OK;
+}
+
+int
+ipx_ctx_shards_set(ipx_ctx_t *ctx, unsigned int cnt)
+{
+    if (ctx->state != IPX_CS_NEW) {
+        IPX_CTX_ERROR(ctx, "Unable to change the number of shards of an initialized instance!",
+            '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    if (cnt == 0) {
+        return IPX_ERR_ARG;
+    }
+
+    ctx->cfg_system.shards = cnt;
+    return IPX_OK;
+}
+
+int
+ipx_ctx_placement_set(ipx_ctx_t *ctx, const struct ipx_placement *placement)
+{
+    if (ctx->state == IPX_CS_RUNNING || ctx->state == IPX_CS_DONE) {
+        IPX_CTX_ERROR(ctx, "Unable to change the placement of a running instance!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    ctx->placement = *placement;
+    return IPX_OK;
+}
+
 void
 ipx_ctx_private_set(ipx_ctx_t *ctx, void *data)
 {
@@ -680,6 +1105,45 @@ thread_get_name(char ident[16])
 #endif
 }
 
+/**
+ * \brief Apply placement of the instance to the current thread and log it
+ *
+ * Failures are not fatal, the thread just keeps its default placement.
+ * \param[in] ctx Instance context
+ */
+static void
+thread_placement_apply(struct ipx_ctx *ctx)
+{
+    const struct ipx_placement *placement = &ctx->placement;
+    int rc = ipx_placement_affinity_set(placement);
+    if (rc == IPX_ERR_NOTFOUND) {
+        IPX_CTX_WARNING(ctx, "Unable to place the thread on NUMA node %d (the node doesn't exist "
+            "or doesn't have any CPU).", placement->numa_node);
+    } else if (rc == IPX_ERR_ARG) {
+        IPX_CTX_WARNING(ctx, "Unable to place the thread on the CPUs (none of them belongs to "
+            "NUMA node %d).", placement->numa_node);
+    } else if (rc != IPX_OK) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Failed to set CPU affinity of the thread: %s", err_str);
+    }
+
+    if (placement->priority > 0 && ipx_placement_priority_set(placement->priority) != IPX_OK) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Failed to set real-time priority %d of the thread (missing "
+            "CAP_SYS_NICE capability?): %s", placement->priority, err_str);
+    }
+
+    char desc[512];
+    ipx_placement_describe(desc, sizeof(desc));
+    if (ipx_placement_is_default(placement)) {
+        IPX_CTX_DEBUG(ctx, "Thread placement: %s", desc);
+    } else {
+        IPX_CTX_INFO(ctx, "Thread placement: %s", desc);
+    }
+}
+
 int
 ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
 {
@@ -792,6 +1256,7 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         IPX_CTX_WARNING(ctx, "The instance didn't set its private data.", '\0');
     }
 
+    ctx_metrics_create(ctx);
     ctx->state = IPX_CS_INIT;
     return IPX_OK;
 }
@@ -914,6 +1379,7 @@ thread_input(void *arg)
     struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
     assert(ctx->type == IPX_PT_INPUT);
     thread_set_name(ctx->name);
+    thread_placement_apply(ctx);
 
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the input plugin '%s' has started!", plugin_name);
@@ -942,11 +1408,147 @@ thread_input(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Pass a batch of IPFIX and Session messages to an intermediate plugin
+ *
+ * If the plugin doesn't support batch processing, messages are passed one by one and if data
+ * processing is disabled meanwhile (e.g. due to a failure), remaining messages are dropped.
+ * \param[in]     ctx  Instance context
+ * \param[in]     msgs Array of messages
+ * \param[in,out] cnt  Number of messages in the array (will be set to zero)
+ */
+static void
+thread_intermediate_flush(struct ipx_ctx *ctx, ipx_msg_t **msgs, uint32_t *cnt)
+{
+    if (*cnt == 0) {
+        return;
+    }
+
+    if (ctx->plugin_cbs->process_batch != NULL) {
+        int rc = ctx->plugin_cbs->process_batch(ctx, ctx->cfg_plugin.private, msgs, *cnt);
+        thread_handle_rc(ctx, rc);
+        *cnt = 0;
+        return;
+    }
+
+    for (uint32_t i = 0; i < *cnt; ++i) {
+        if (!ipx_ctx_processing_get(ctx) && ctx->type != IPX_PT_OUTPUT_MGR) {
+            // Data processing is disabled -> drop IPFIX and Session messages
+            ipx_msg_destroy(msgs[i]);
+            continue;
+        }
+
+        int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msgs[i]);
+        thread_handle_rc(ctx, rc);
+    }
+
+    *cnt = 0;
+}
+
+/**
+ * \brief Process a message by an intermediate instance (except collected messages)
+ *
+ * The function handles termination, periodic and other messages that are not collected for
+ * batch processing (see thread_intermediate()). The message is passed to the plugin or to the
+ * following instance, if necessary. If the instance has received all expected termination
+ * messages, the plugin is destroyed and the termination message is passed as the last message.
+ * \param[in] ctx     Instance context
+ * \param[in] msg_ptr Message to process
+ * \return True if the instance has been terminated. Otherwise false.
+ */
+static bool
+intermediate_msg_process(struct ipx_ctx *ctx, ipx_msg_t *msg_ptr)
+{
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+    bool processed = false; // only not processed messages are automatically passed
+    bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+    bool terminate = false;
+
+    if (msg_type == IPX_MSG_TERMINATE) {
+        ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
+        enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
+
+        if (type == IPX_MSG_TERMINATE_INSTANCE && (--ctx->cfg_system.term_msg_cnt) != 0) {
+            // Drop the message, we are still waiting for another termination request
+            IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining input "
+                "plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
+            ipx_msg_terminate_destroy(terminate_msg);
+            return false;
+        }
+
+        if (type == IPX_MSG_TERMINATE_INSTANCE) {
+            terminate = true;
+        }
+    }
+
+    if (msg_type == IPX_MSG_PERIODIC) {
+        ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
+        if (ipx_msg_periodic_get_seq_num(periodic_message) != ctx->periodic_seq) {
+            ipx_msg_periodic_destroy(periodic_message);
+            return false;
+        }
+        ctx->periodic_seq++;
+        ipx_msg_periodic_update_last_processed(periodic_message);
+#ifdef ENABLE_LATENCY_TRACE
+        trace_report_periodic(ctx);
+#endif
+    }
+
+    if (!ipx_ctx_processing_get(ctx)
+            && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
+        // Data processing is disabled -> drop IPFIX and Session messages
+        ipx_msg_destroy(msg_ptr);
+        return false;
+    }
+
+    if ((ipx_ctx_processing_get(ctx) || ctx->type == IPX_PT_OUTPUT_MGR) && msg_for_plugin) {
+        // Pass data to the plugin
+        int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
+        thread_handle_rc(ctx, rc);
+        processed = true;
+    }
+
+    if (msg_type == IPX_MSG_GARBAGE && ctx->cfg_system.replica
+            && !ipx_msg_header_cnt_dec(msg_ptr)) {
+        // Shared by all replicas, only the last one passes the message
+        return false;
+    }
+
+    // The message hasn't been processed by the plugin
+    if (!processed && terminate != true) {
+        /* Not processed by the instance, pass the message.
+         * Note: Termination message is passed after intermediate instance destructor! */
+        assert(ctx->type != IPX_PT_OUTPUT_MGR);
+        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    }
+
+    if (!terminate) {
+        return false;
+    }
+
+    // Destroy the instance (usually produce garbage messages)
+    const char *plugin_name = ctx->plugin_cbs->info->name;
+    IPX_CTX_DEBUG(ctx, "Calling instance destructor of the intermediate plugin '%s'", plugin_name);
+    ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
+
+    // Pass the termination message as the last message to the buffer
+    if (ctx->type != IPX_PT_OUTPUT_MGR) {
+        // All intermediate plugins (except the output manager) have to pass the message here
+        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    }
+
+    return true;
+}
+
 /**
  * \brief Intermediate instance control thread
  *
  * Infinite loop that process messages from an input ring buffer and eventually pass them to
  * an output ring buffer.
+ *
+ * Consecutive IPFIX and Session messages for the plugin are collected and passed to the plugin
+ * at once (see thread_intermediate_flush()). Any other message is processed only after all
+ * collected messages to preserve order of messages.
  * \param[in] arg Instance context
  * \return NULL
  */
@@ -956,93 +1558,187 @@ thread_intermediate(void *arg)
     struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
     assert(ctx->type == IPX_PT_INTERMEDIATE || ctx->type == IPX_PT_OUTPUT_MGR);
     thread_set_name(ctx->name);
+    thread_placement_apply(ctx);
 
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has started!", plugin_name);
 
-    ipx_msg_t *msg_ptr;
-    enum ipx_msg_type msg_type;
-
-    uint64_t waiting_for_seq = 0;
+    // Messages received from the input ring buffer
+    ipx_msg_t *msg_recv[CTX_BATCH_MAX];
+    uint32_t msg_recv_cnt = 0;
+    uint32_t msg_recv_idx = 0;
+    // Messages waiting for the plugin
+    ipx_msg_t *msg_batch[CTX_BATCH_MAX];
+    uint32_t msg_batch_cnt = 0;
 
     bool terminate = false;
     while (!terminate) {
-        // Get a new message for the buffer
-        msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        msg_type = ipx_msg_get_type(msg_ptr);
-        bool processed = false; // only not processed messages are automatically passed
-
-        if (msg_type == IPX_MSG_TERMINATE) {
-            ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
-            enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
-
-            if (type == IPX_MSG_TERMINATE_INSTANCE && (--ctx->cfg_system.term_msg_cnt) != 0) {
-                // Drop the message, we are still waiting for another termination request
-                IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining input "
-                    "plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
-                ipx_msg_terminate_destroy(terminate_msg);
-                continue;
-            }
-
-            if (type == IPX_MSG_TERMINATE_INSTANCE) {
-                terminate = true;
-            }
+        if (msg_recv_idx == msg_recv_cnt) {
+            // Pass collected messages to the plugin before waiting for new ones
+            thread_intermediate_flush(ctx, msg_batch, &msg_batch_cnt);
+            // Get new messages from the buffer
+            msg_recv_cnt = ipx_ring_pop_batch(ctx->pipeline.src, msg_recv, CTX_BATCH_MAX);
+            msg_recv_idx = 0;
         }
 
-        if (msg_type == IPX_MSG_PERIODIC) {
-            ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
-            if (ipx_msg_periodic_get_seq_num(periodic_message) != waiting_for_seq) {
-                ipx_msg_periodic_destroy(periodic_message);
-                continue;
-            }
-            waiting_for_seq++;
-            ipx_msg_periodic_update_last_processed(periodic_message);
-        }
+        ipx_msg_t *msg_ptr = msg_recv[msg_recv_idx++];
+        enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
 
-        if (!ipx_ctx_processing_get(ctx)
-                && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
-            // Data processing is disabled -> drop IPFIX and Session messages
-            ipx_msg_destroy(msg_ptr);
+        if ((msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION) && msg_for_plugin
+                && ipx_ctx_processing_get(ctx)) {
+            // Collect the message for the plugin
+            msg_batch[msg_batch_cnt++] = msg_ptr;
             continue;
         }
 
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-        if ((ipx_ctx_processing_get(ctx) || ctx->type == IPX_PT_OUTPUT_MGR) && msg_for_plugin) {
-            // Pass data to the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
+        // Any other message can be processed only after previous messages
+        thread_intermediate_flush(ctx, msg_batch, &msg_batch_cnt);
+        terminate = intermediate_msg_process(ctx, msg_ptr);
+    }
+
+    IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has been terminated!",
+        plugin_name);
+    pthread_exit(NULL);
+}
+
+/**
+ * \brief Process a message by an intermediate instance in the thread of its writer
+ *
+ * \see ipx_ctx_direct_set()
+ * \param[in] arg Instance context
+ * \param[in] msg Message to process
+ */
+static void
+direct_intermediate(void *arg, ipx_msg_t *msg)
+{
+    struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+
+    if ((msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION) && msg_for_plugin
+            && ipx_ctx_processing_get(ctx)) {
+        uint32_t cnt = 1;
+        thread_intermediate_flush(ctx, &msg, &cnt);
+        return;
+    }
+
+    if (intermediate_msg_process(ctx, msg)) {
+        ctx->state = IPX_CS_DONE;
+    }
+}
+
+/**
+ * \brief Pass a batch of IPFIX and Session messages to an output plugin and release them
+ *
+ * If the plugin doesn't support batch processing, messages are passed one by one. After that,
+ * the reference counter of each message is decremented.
+ * \param[in]     ctx  Instance context
+ * \param[in]     msgs Array of messages
+ * \param[in,out] cnt  Number of messages in the array (will be set to zero)
+ */
+static void
+thread_output_flush(struct ipx_ctx *ctx, ipx_msg_t **msgs, uint32_t *cnt)
+{
+    if (*cnt == 0) {
+        return;
+    }
+
+    if (ctx->plugin_cbs->process_batch != NULL) {
+        int rc = ctx->plugin_cbs->process_batch(ctx, ctx->cfg_plugin.private, msgs, *cnt);
+        thread_handle_rc(ctx, rc);
+    } else {
+        for (uint32_t i = 0; i < *cnt && ipx_ctx_processing_get(ctx); ++i) {
+            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msgs[i]);
             thread_handle_rc(ctx, rc);
-            processed = true;
         }
+    }
 
-        // The message hasn't been processed by the plugin
-        if (!processed && terminate != true) {
-            /* Not processed by the instance, pass the message.
-             * Note: Termination message is passed after intermediate instance destructor! */
-            assert(ctx->type != IPX_PT_OUTPUT_MGR);
-            ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    uint64_t ipfix_msgs = 0;
+    uint64_t data_recs = 0;
+    for (uint32_t i = 0; i < *cnt; ++i) {
+        if (ipx_msg_get_type(msgs[i]) == IPX_MSG_IPFIX) {
+            ipfix_msgs++;
+            data_recs += ipx_msg_ipfix_get_drec_cnt(ipx_msg_base2ipfix(msgs[i]));
+        }
+#ifdef ENABLE_LATENCY_TRACE
+        trace_done(ctx, msgs[i]);
+#endif
+        // Decrement the counter - DO NOT TOUCH the message from this point beyond
+        if (ipx_msg_header_cnt_dec(msgs[i])) {
+            // This instance is the last user, destroy it
+            ipx_msg_destroy(msgs[i]);
         }
     }
 
-    // Destroy the instance (usually produce garbage messages)
-    IPX_CTX_DEBUG(ctx, "Calling instance destructor of the intermediate plugin '%s'", plugin_name);
-    ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
+    // Once per batch (in the direct mode, the function might be called from multiple threads)
+    __atomic_fetch_add(&ctx->stats.ipfix_msgs, ipfix_msgs, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->stats.data_recs, data_recs, __ATOMIC_RELAXED);
+    *cnt = 0;
+}
 
-    // Pass the termination message as the last message to the buffer
-    assert(msg_type == IPX_MSG_TERMINATE);
-    if (ctx->type != IPX_PT_OUTPUT_MGR) {
-        // All intermediate plugins (except the output manager) have to pass the message here
-        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+/**
+ * \brief Process a message by an output instance (except collected messages) and release it
+ *
+ * If a termination message has been received, the plugin is destroyed.
+ * \param[in] ctx     Instance context
+ * \param[in] msg_ptr Message to process
+ * \return True if the instance has been terminated. Otherwise false.
+ */
+static bool
+output_msg_process(struct ipx_ctx *ctx, ipx_msg_t *msg_ptr)
+{
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+    bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+    bool terminate = false;
+
+    if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
+        // Process the message by the plugin
+        int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
+        thread_handle_rc(ctx, rc);
     }
 
-    IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has been terminated!",
-        plugin_name);
-    pthread_exit(NULL);
+    if (msg_type == IPX_MSG_PERIODIC) {
+        ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
+        ipx_msg_periodic_update_last_processed(periodic_message);
+#ifdef ENABLE_LATENCY_TRACE
+        trace_report_periodic(ctx);
+#endif
+    }
+
+    if (msg_type == IPX_MSG_TERMINATE) {
+        ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
+        enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
+        if (type == IPX_MSG_TERMINATE_INSTANCE) {
+            // We received a request to terminate the instance
+            terminate = true;
+        }
+    }
+
+    // Decrement the counter - DO NOT TOUCH the message from this point beyond
+    if (ipx_msg_header_cnt_dec(msg_ptr)) {
+        // This instance is the last user, destroy it
+        ipx_msg_destroy(msg_ptr);
+    }
+
+    if (!terminate) {
+        return false;
+    }
+
+    // Destroy the instance
+    const char *plugin_name = ctx->plugin_cbs->info->name;
+    IPX_CTX_DEBUG(ctx, "Calling instance destructor of the output plugin '%s'", plugin_name);
+    ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
+    return true;
 }
 
 /**
  * \brief Output instance control thread
  *
  * Infinite loop that process messages from an input ring buffer.
+ *
+ * Consecutive IPFIX and Session messages for the plugin are collected and passed to the plugin
+ * at once (see thread_output_flush()).
  * \param[in] arg Instance context
  * \return NULL
  */
@@ -1052,53 +1748,76 @@ thread_output(void *arg)
     struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
     assert(ctx->type == IPX_PT_OUTPUT);
     thread_set_name(ctx->name);
+    thread_placement_apply(ctx);
 
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has started!", plugin_name);
 
+    // Messages received from the input ring buffer
+    ipx_msg_t *msg_recv[CTX_BATCH_MAX];
+    uint32_t msg_recv_cnt = 0;
+    uint32_t msg_recv_idx = 0;
+    // Messages waiting for the plugin
+    ipx_msg_t *msg_batch[CTX_BATCH_MAX];
+    uint32_t msg_batch_cnt = 0;
+
     bool terminate = false;
     while (!terminate) {
-        // Get a new message for the buffer
-        ipx_msg_t *msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-
-        if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
-            // Process the message by the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
-            thread_handle_rc(ctx, rc);
+        if (msg_recv_idx == msg_recv_cnt) {
+            // Pass collected messages to the plugin before waiting for new ones
+            thread_output_flush(ctx, msg_batch, &msg_batch_cnt);
+            // Get new messages from the buffer
+            msg_recv_cnt = ipx_ring_pop_batch(ctx->pipeline.src, msg_recv, CTX_BATCH_MAX);
+            msg_recv_idx = 0;
         }
 
-        if (msg_type == IPX_MSG_PERIODIC) {
-            ipx_msg_periodic_t *periodic_message = ipx_msg_base2periodic(msg_ptr);
-            ipx_msg_periodic_update_last_processed(periodic_message);
-        }
+        ipx_msg_t *msg_ptr = msg_recv[msg_recv_idx++];
+        enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
 
-        if (msg_type == IPX_MSG_TERMINATE) {
-            ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
-            enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
-            if (type == IPX_MSG_TERMINATE_INSTANCE) {
-                // We received a request to terminate the instance
-                terminate = true;
-            }
+        if ((msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION) && msg_for_plugin
+                && ipx_ctx_processing_get(ctx)) {
+            // Collect the message for the plugin
+            msg_batch[msg_batch_cnt++] = msg_ptr;
+            continue;
         }
 
-        // Decrement the counter - DO NOT TOUCH the message from this point beyond
-        if (ipx_msg_header_cnt_dec(msg_ptr)) {
-            // This instance is the last user, destroy it
-            ipx_msg_destroy(msg_ptr);
-        }
+        // Any other message can be processed only after previous messages
+        thread_output_flush(ctx, msg_batch, &msg_batch_cnt);
+        terminate = output_msg_process(ctx, msg_ptr);
     }
 
-    // Destroy the instance
-    IPX_CTX_DEBUG(ctx, "Calling instance destructor of the output plugin '%s'", plugin_name);
-    ctx->plugin_cbs->destroy(ctx, ctx->cfg_plugin.private);
-
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has been terminated!",
         plugin_name);
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Process a message by an output instance in the thread of its writer
+ *
+ * \see ipx_ctx_direct_set()
+ * \param[in] arg Instance context
+ * \param[in] msg Message to process
+ */
+static void
+direct_output(void *arg, ipx_msg_t *msg)
+{
+    struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+
+    if ((msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION) && msg_for_plugin
+            && ipx_ctx_processing_get(ctx)) {
+        uint32_t cnt = 1;
+        thread_output_flush(ctx, &msg, &cnt);
+        return;
+    }
+
+    if (output_msg_process(ctx, msg)) {
+        ctx->state = IPX_CS_DONE;
+    }
+}
+
 int
 ipx_ctx_run(ipx_ctx_t *ctx)
 {
@@ -1108,6 +1827,33 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         return IPX_ERR_DENIED;
     }
 
+    if (ctx->direct) {
+        // No thread, messages are processed by the writer of the input ring buffer
+        ipx_ring_direct_cb direct_func = NULL;
+        switch (ctx->type) {
+        case IPX_PT_INTERMEDIATE:
+        case IPX_PT_OUTPUT_MGR:
+            direct_func = &direct_intermediate;
+            break;
+        case IPX_PT_OUTPUT:
+            direct_func = &direct_output;
+            break;
+        default:
+            IPX_CTX_ERROR(ctx, "Unable to start the instance without its own thread because of "
+                "unsupported plugin type (%" PRIu16 ")", ctx->type);
+            return IPX_ERR_DENIED;
+        }
+
+        if (!ipx_placement_is_default(&ctx->placement)) {
+            IPX_CTX_WARNING(ctx, "Placement of the instance is ignored as it doesn't have its own "
+                "thread.", '\0');
+        }
+
+        ipx_ring_direct_set(ctx->pipeline.src, direct_func, ctx);
+        ctx->state = IPX_CS_RUNNING;
+        return IPX_OK;
+    }
+
     void *(*thread_func)(void *) = NULL;
     switch (ctx->type) {
     case IPX_PT_INPUT:
@@ -1126,6 +1872,16 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         return IPX_ERR_DENIED;
     }
 
+    if (ctx->pipeline.src != NULL && ctx->placement.numa_node >= 0) {
+        // The thread is the reader of the ring buffer
+        if (ipx_ring_mem_bind(ctx->pipeline.src, ctx->placement.numa_node) != IPX_OK) {
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_CTX_WARNING(ctx, "Failed to move the input ring buffer to NUMA node %d: %s",
+                ctx->placement.numa_node, err_str);
+        }
+    }
+
     // Block processing all signals
     sigset_t set_new, set_old;
     sigfillset(&set_new);
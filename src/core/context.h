@@ -46,6 +46,8 @@
 #include <libfds.h>
 #include "fpipe.h"
 #include "ring.h"
+#include "message_pool.h"
+#include "placement.h"
 
 /** List of plugin callbacks  */
 struct ipx_ctx_callbacks {
@@ -63,6 +65,8 @@ struct ipx_ctx_callbacks {
     int  (*get)     (ipx_ctx_t *, void *);
     /** Process function (INTERMEDIATE and OUTPUT plugins only)                 */
     int  (*process) (ipx_ctx_t *, void *, ipx_msg_t *);
+    /** Batch process function (INTERMEDIATE and OUTPUT plugins only, can be NULL) */
+    int  (*process_batch)(ipx_ctx_t *, void *, ipx_msg_t **, size_t);
     /** Close session request (INPUT plugins only, can be NULL)                 */
     void  (*ts_close)(ipx_ctx_t *, void *, const struct ipx_session *);
 };
@@ -70,6 +74,18 @@ struct ipx_ctx_callbacks {
 /** Identification number of output manager plugin */
 #define IPX_PT_OUTPUT_MGR 255
 
+/** Statistics of messages passed by an instance to the following one */
+struct ipx_ctx_stats {
+    /** Number of passed IPFIX Messages                                         */
+    uint64_t ipfix_msgs;
+    /** Number of Data Records in the passed IPFIX Messages                     */
+    uint64_t data_recs;
+    /** Number of IPFIX Message wrappers reused from the pool of the instance  */
+    uint64_t pool_hits;
+    /** Number of IPFIX Message wrappers newly allocated by the instance       */
+    uint64_t pool_misses;
+};
+
 /**
  * \brief Create a context
  *
@@ -264,6 +280,113 @@ ipx_ctx_verb_set(ipx_ctx_t *ctx, enum ipx_verb_level verb);
 IPX_API int
 ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt);
 
+/**
+ * \brief Process messages in the thread of the writer of the input ring buffer
+ *
+ * The instance doesn't get its own thread after ipx_ctx_run(). Instead, the input ring buffer
+ * is switched to the direct mode (see ipx_ring_direct_set()), so each message is processed by
+ * the instance immediately in the thread that passed the message. This allows to run a whole
+ * pipeline to completion in the thread of an input instance.
+ *
+ * \note Only intermediate and output instances are supported.
+ * \warning The function MUST be called before the ipx_ctx_run() and after the input ring
+ *   buffer is set.
+ * \param[in] ctx Plugin context
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the input ring buffer is not defined
+ * \return #IPX_ERR_DENIED if the instance is already running
+ */
+IPX_API int
+ipx_ctx_direct_set(ipx_ctx_t *ctx);
+
+/**
+ * \brief Set the number of pipeline shards running an identical copy of the instance
+ *
+ * The value is provided to the plugin by ipx_ctx_shards_get(), so it can share its resources
+ * (e.g. listening ports) with the other copies.
+ * \warning The function MUST be called before the ipx_ctx_init().
+ * \param[in] ctx Plugin context
+ * \param[in] cnt Number of shards (at least 1)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the number is zero
+ * \return #IPX_ERR_DENIED if the instance is already initialized
+ */
+IPX_API int
+ipx_ctx_shards_set(ipx_ctx_t *ctx, unsigned int cnt);
+
+/**
+ * \brief Set placement of the thread of the instance
+ *
+ * The thread is restricted to the given CPUs and/or NUMA node and its scheduling policy is
+ * changed when it starts. Memory allocated by the thread and its input ring buffer are
+ * preferably placed on the NUMA node. Instances without their own thread (see
+ * ipx_ctx_direct_set()) ignore the placement.
+ * \warning The function MUST be called before the ipx_ctx_run().
+ * \param[in] ctx       Plugin context
+ * \param[in] placement Placement of the thread
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the instance is already running
+ */
+IPX_API int
+ipx_ctx_placement_set(ipx_ctx_t *ctx, const struct ipx_placement *placement);
+
+/**
+ * \brief Get statistics of messages passed by the instance
+ *
+ * Only IPFIX Messages passed by ipx_ctx_msg_pass() are counted. In case of output instances,
+ * IPFIX Messages processed by the instance are counted instead. Pool statistics refer to
+ * IPFIX Messages created by the instance (see ipx_ctx_msg_pool_get()). The function can be
+ * called from any thread, however, the values might be slightly outdated.
+ * \param[in]  ctx   Plugin context
+ * \param[out] stats Statistics
+ */
+IPX_API void
+ipx_ctx_stats_get(const ipx_ctx_t *ctx, struct ipx_ctx_stats *stats);
+
+/**
+ * \brief Record a hand-off of a message to the following instance (latency tracing)
+ *
+ * Input instances select a sample of IPFIX Messages to trace, other instances record the time
+ * since the previous hand-off of each sampled message. Histograms of the times are periodically
+ * printed to the log. The function MUST be called only by the thread of the instance, before
+ * the message is pushed into the output ring buffer. It's called automatically by
+ * ipx_ctx_msg_pass(), so only instances that push messages directly have to call it.
+ *
+ * \note Available only if the collector is built with ENABLE_LATENCY_TRACE.
+ * \param[in] ctx Plugin context
+ * \param[in] msg Message
+ */
+IPX_API void
+ipx_ctx_trace_pass(ipx_ctx_t *ctx, ipx_msg_t *msg);
+
+/**
+ * \brief Get the pool of IPFIX Message wrappers of the instance
+ *
+ * Wrappers of IPFIX Messages created by the instance are taken from the pool and returned to
+ * it when the messages are destroyed (by any plugin). The pool is closed when the context is
+ * destroyed.
+ * \warning Only the thread of the instance is allowed to take wrappers out of the pool.
+ * \param[in] ctx Plugin context
+ * \return Pointer to the pool
+ */
+IPX_API ipx_msg_pool_t *
+ipx_ctx_msg_pool_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Mark the context as one of replicas of the same intermediate instance
+ *
+ * Replicas receive the same garbage messages, which have the reference counter set to the
+ * number of the replicas. Each replica decrements the counter and only the replica that
+ * releases the last reference passes the message to the following plugin. Therefore, the
+ * message cannot overtake messages still being processed by other replicas.
+ *
+ * \note By default, the context is not a replica.
+ * \param[in] ctx Plugin context
+ * \param[in] en  Enable/disable
+ */
+IPX_API void
+ipx_ctx_replica_set(ipx_ctx_t *ctx, bool en);
+
 /**
  * \brief Enable/disable data processing
  *
@@ -44,48 +44,201 @@
 #include <unistd.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdalign.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <time.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
 
 #include "fpipe.h"
 #include "utils.h"
 #include "verbose.h"
 
+#ifndef IPX_CLINE_SIZE
+/** Expected CPU cache-line size        */
+#define IPX_CLINE_SIZE 64
+#endif
+
+/** Cache-line alignment                */
+#define __ipx_cache_aligned __attribute__((__aligned__(IPX_CLINE_SIZE)))
+
+/** Number of cells of the queue (MUST be a power of 2) */
+#define FPIPE_SIZE 8192U
+
 /** Internal identification of the feedback pipe */
 static const char *fpipe_str = "Feedback pipe";
 
-/** \brief Parser feedback pipe */
+/** \brief Cell of the feedback queue */
+struct fpipe_cell {
+    /**
+     * Sequence number of the cell
+     * - equal to the position          -> the cell is free for a writer
+     * - equal to the position + 1      -> the cell holds a message for the reader
+     */
+    uint32_t seq;
+    /** Message                                                                      */
+    ipx_msg_t *msg;
+};
+
+/**
+ * \brief Parser feedback pipe
+ *
+ * Messages are stored in a bounded lock-free queue (multiple writers, single reader).
+ * Moreover, each message is signalized by incrementing a counter of an eventfd (or by writing
+ * a byte into a pipe on platforms without eventfd), so the descriptor is readable if and only
+ * if some messages are waiting. However, the reader checks the queue first, therefore, a check
+ * of an empty pipe costs only an atomic load.
+ */
 struct ipx_fpipe {
-    /** Pipe file descriptor for an input plugin that supports parser's feedback     */
-    int fd_read;
-    /** Pipe file descriptor for an IPFIX message parser                             */
+    /** Position of the next write (shared by writers)                               */
+    uint32_t tail                   __ipx_cache_aligned;
+    /** Position of the next read (reader only)                                      */
+    uint32_t head                   __ipx_cache_aligned;
+    /** Descriptor for readiness notification (readable if messages are waiting)     */
+    int fd_read                     __ipx_cache_aligned;
+    /** Descriptor for writers (same as fd_read for eventfd)                         */
     int fd_write;
-
-    /** Control variable that will be set when a request is ready                    */
-    volatile unsigned int lock;
-    /** Records in the pipe                                                          */
-    volatile uint32_t cnt;
+    /** Cells of the queue                                                           */
+    struct fpipe_cell cells[FPIPE_SIZE];
 };
 
+/**
+ * \brief Create a descriptor pair for notification of the reader
+ * \param[in] fpipe Feedback pipe
+ * \return 0 on success, otherwise -1
+ */
+static int
+fpipe_signal_init(struct ipx_fpipe *fpipe)
+{
+#if defined(__linux__)
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+    if (fd == -1) {
+        return -1;
+    }
+
+    fpipe->fd_read = fd;
+    fpipe->fd_write = fd;
+    return 0;
+#else
+    int pipefd[2];
+    if (pipe(pipefd) != 0) {
+        return -1;
+    }
+
+    // Only the reader MUST NOT block
+    int flags = fcntl(pipefd[0], F_GETFL);
+    if (flags == -1 || fcntl(pipefd[0], F_SETFL, flags | O_NONBLOCK) == -1) {
+        close(pipefd[0]);
+        close(pipefd[1]);
+        return -1;
+    }
+
+    fpipe->fd_read = pipefd[0];
+    fpipe->fd_write = pipefd[1];
+    return 0;
+#endif
+}
+
+/**
+ * \brief Close the notification descriptors
+ * \param[in] fpipe Feedback pipe
+ */
+static void
+fpipe_signal_close(struct ipx_fpipe *fpipe)
+{
+    close(fpipe->fd_read);
+    if (fpipe->fd_write != fpipe->fd_read) {
+        close(fpipe->fd_write);
+    }
+}
+
+/**
+ * \brief Signalize one more message to the reader
+ * \param[in] fpipe Feedback pipe
+ */
+static void
+fpipe_signal_post(struct ipx_fpipe *fpipe)
+{
+#if defined(__linux__)
+    const uint64_t value = 1;
+#else
+    const uint8_t value = 1;
+#endif
+
+    while (true) {
+        ssize_t rc = write(fpipe->fd_write, &value, sizeof(value));
+        if (rc == (ssize_t) sizeof(value)) {
+            return;
+        }
+
+        if (rc == -1 && errno == EINTR) {
+            // Interrupted, try again
+            continue;
+        }
+
+        // The message will be still delivered, only the descriptor is not readable
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(fpipe_str, "Failed to signalize an internal message: %s", err_str);
+        return;
+    }
+}
+
+/**
+ * \brief Take the signalization of one message
+ * \param[in] fpipe Feedback pipe
+ */
+static void
+fpipe_signal_take(struct ipx_fpipe *fpipe)
+{
+#if defined(__linux__)
+    uint64_t value; // EFD_SEMAPHORE -> decrements the counter by one
+#else
+    uint8_t value;
+#endif
+
+    while (true) {
+        ssize_t rc = read(fpipe->fd_read, &value, sizeof(value));
+        if (rc == (ssize_t) sizeof(value)) {
+            return;
+        }
+
+        if (rc == -1 && errno == EINTR) {
+            // Interrupted, try again
+            continue;
+        }
+
+        // Writers signalize before publishing, so this should never happen
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(fpipe_str, "Failed to take a signalization of an internal message: %s", err_str);
+        return;
+    }
+}
+
 ipx_fpipe_t *
 ipx_fpipe_create()
 {
-    struct ipx_fpipe *ret = malloc(sizeof(*ret));
+    struct ipx_fpipe *ret = aligned_alloc(alignof(struct ipx_fpipe), sizeof(*ret));
     if (!ret) {
         return NULL;
     }
 
-    int pipefd[2];
-    if (pipe(pipefd) != 0) {
+    if (fpipe_signal_init(ret) != 0) {
         // Failed
         free(ret);
         return NULL;
     }
 
-    ret->fd_write = pipefd[1];
-    ret->fd_read = pipefd[0];
-    ret->lock = 0; // unlocked by default
-    ret->cnt = 0;
+    ret->tail = 0;
+    ret->head = 0;
+    for (uint32_t i = 0; i < FPIPE_SIZE; ++i) {
+        ret->cells[i].seq = i;
+        ret->cells[i].msg = NULL;
+    }
 
     return ret;
 }
@@ -104,13 +257,12 @@ ipx_fpipe_destroy(ipx_fpipe_t *fpipe)
     }
 
     if (err_cnt > 0) {
-        IPX_WARNING(fpipe_str, "Destroying of a pipe that still contains %" PRIu32 " unprocessed "
-            "non-periodic message(s)!", fpipe->cnt);
+        IPX_WARNING(fpipe_str, "Destroying of a pipe that still contains %d unprocessed "
+            "non-periodic message(s)!", err_cnt);
     }
 
-    // Close the pipe and destroy the structure
-    close(fpipe->fd_read);
-    close(fpipe->fd_write);
+    // Close the descriptors and destroy the structure
+    fpipe_signal_close(fpipe);
     free(fpipe);
 }
 
@@ -119,85 +271,61 @@ ipx_fpipe_write(ipx_fpipe_t *fpipe, ipx_msg_t *msg)
 {
     assert(msg != NULL);
 
-    // Send a pointer to the session (write of less than 4096 bytes is atomic - man 7 pipe)
-    while (true) {
-        ssize_t rc = write(fpipe->fd_write, &msg, sizeof(msg));
-        if (rc > 0 && ((size_t) rc) == sizeof(msg)) {
-            // Success
-            break;
-        }
+    // Signalize first, so the counter of the descriptor is never behind the queue
+    fpipe_signal_post(fpipe);
 
-        if (rc == -1 && errno == EINTR) {
-            // Interrupted, try again
-            continue;
-        }
+    // Reserve a cell
+    struct fpipe_cell *cell;
+    uint32_t pos = __atomic_load_n(&fpipe->tail, __ATOMIC_RELAXED);
+    while (true) {
+        cell = &fpipe->cells[pos & (FPIPE_SIZE - 1)];
+        uint32_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t) (seq - pos);
 
-        // Something bad happened
-        if (rc == -1) {
-            const char *err_str;
-            ipx_strerror(errno, err_str);
-            IPX_ERROR(fpipe_str, "An internal message has been lost. Failed to write: %s", err_str);
+        if (diff == 0) {
+            // The cell is free, try to reserve it
+            if (__atomic_compare_exchange_n(&fpipe->tail, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            // "pos" has been updated by the failed exchange
+        } else if (diff < 0) {
+            // The queue is full, wait for the reader
+            struct timespec ts = {0, 100000L}; // 100 us
+            nanosleep(&ts, NULL);
+            pos = __atomic_load_n(&fpipe->tail, __ATOMIC_RELAXED);
         } else {
-            IPX_ERROR(fpipe_str, "An internal message has been probably lost. Invalid return code "
-                "of write(): %ld", rc);
+            // Another writer has reserved the cell
+            pos = __atomic_load_n(&fpipe->tail, __ATOMIC_RELAXED);
         }
-
-        return;
     }
 
-    // Success - spin until the lock is acquired
-    while (__sync_lock_test_and_set(&fpipe->lock, 1));
-    fpipe->cnt++;
-    __sync_lock_release(&fpipe->lock);
-    return;
+    // Publish the message
+    cell->msg = msg;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
 }
 
 ipx_msg_t *
 ipx_fpipe_read(ipx_fpipe_t *fpipe)
 {
-    // Spin until the lock is acquired
-    while (__sync_lock_test_and_set(&fpipe->lock, 1));
-    uint32_t cnt = fpipe->cnt;
-    if (fpipe->cnt > 0) {
-        fpipe->cnt--;
-    }
-    // Release the lock
-    __sync_lock_release(&fpipe->lock);
-
-    if (cnt == 0) {
+    const uint32_t pos = fpipe->head;
+    struct fpipe_cell *cell = &fpipe->cells[pos & (FPIPE_SIZE - 1)];
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+        // Empty (or the next message hasn't been published yet)
         return NULL;
     }
 
-    // Read from the pipe
-    ipx_msg_t *msg;
-    void *buffer = &msg;
-    size_t buffer_size = sizeof(msg);
-    size_t read_size = 0;
-
-    errno = 0;
-    while (read_size < buffer_size) { // Read is not atomic and can be interrupted
-        ssize_t rc = read(fpipe->fd_read, ((uint8_t *)buffer) + read_size, buffer_size - read_size);
-        if (rc > 0) {
-            read_size += (size_t) rc;
-            continue;
-        }
-
-        if (rc == -1 && errno == EINTR) {
-            // Try again
-            continue;
-        }
-
-        // Unable to read
-        if (rc == 0) {
-            IPX_ERROR(fpipe_str, "End of file has been reached!", '\0');
-        } else {
-            const char *err_str;
-            ipx_strerror(errno, err_str);
-            IPX_ERROR(fpipe_str, "Failed to read: %s", err_str);
-        }
-
-        return NULL;
-    }
+    ipx_msg_t *msg = cell->msg;
+    fpipe->head = pos + 1;
+    // Release the cell for writers in the next round
+    __atomic_store_n(&cell->seq, pos + FPIPE_SIZE, __ATOMIC_RELEASE);
 
+    fpipe_signal_take(fpipe);
     return msg;
 }
+
+int
+ipx_fpipe_fd(const ipx_fpipe_t *fpipe)
+{
+    return fpipe->fd_read;
+}
@@ -65,6 +65,7 @@ ipx_fpipe_destroy(ipx_fpipe_t *fpipe);
  * \brief Send a message
  *
  * It's safe for multiple writers to write to the pipe at the same time. (thread-safe)
+ * If the pipe is full, the function waits until the reader makes free space.
  * \param[in] fpipe Feedback pipe
  * \param[in] msg   A message to send
  */
@@ -75,6 +76,7 @@ ipx_fpipe_write(ipx_fpipe_t *fpipe, ipx_msg_t *msg);
  * \brief Try to get a message
  *
  * The function is non-blocking and can be used by only one thread at the same time!
+ * If the pipe is empty, no system call is performed.
  * \param[in]  fpipe   Feedback pipe
  * \return NULL if no message is available
  * \return Otherwise a message to process
@@ -82,4 +84,16 @@ ipx_fpipe_write(ipx_fpipe_t *fpipe, ipx_msg_t *msg);
 IPX_API ipx_msg_t *
 ipx_fpipe_read(ipx_fpipe_t *fpipe);
 
+/**
+ * \brief Get a file descriptor for readiness notification
+ *
+ * The descriptor is readable if and only if some messages are waiting in the pipe, so it can be
+ * added to an epoll (or poll/select) set of the reader. The descriptor MUST NOT be read or
+ * closed by the user, messages MUST be always received by ipx_fpipe_read().
+ * \param[in] fpipe Feedback pipe
+ * \return File descriptor
+ */
+IPX_API int
+ipx_fpipe_fd(const ipx_fpipe_t *fpipe);
+
 #endif // IPFIXCOL_FPIPE_H
@@ -0,0 +1,312 @@
+/**
+ * @file
+ * @brief Memory backed by huge pages (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// MAP_ANONYMOUS, MAP_HUGETLB and MADV_HUGEPAGE are not part of POSIX
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "hugepage.h"
+#include "verbose.h"
+
+/** Alignment of heap allocations (cache line) */
+#define HUGEPAGE_HEAP_ALIGN 64U
+/** File with summary of memory mappings of the process */
+#define HUGEPAGE_ROLLUP_FILE "/proc/self/smaps_rollup"
+/** Conversion of bytes to MiB (for printing) */
+#define HUGEPAGE_MIB(bytes) ((double) (bytes) / (1024.0 * 1024.0))
+
+/** Internal identification of the module */
+static const char *module = "Huge pages";
+
+/** Global state (all counters are in bytes) */
+static struct {
+    /** Allocation from huge pages is enabled     */
+    bool enabled;
+    /** All memory mapped by the module           */
+    uint64_t total;
+    /** Memory backed by reserved huge pages      */
+    uint64_t hugetlb;
+    /** Memory advised to use transparent huge pages */
+    uint64_t thp;
+    /** Failure of reserved huge pages has been already reported */
+    bool hugetlb_warned;
+} hugepage = {false, 0, 0, 0, false};
+
+void
+ipx_hugepage_enable(bool enable)
+{
+    __atomic_store_n(&hugepage.enabled, enable, __ATOMIC_RELAXED);
+}
+
+bool
+ipx_hugepage_enabled()
+{
+    return __atomic_load_n(&hugepage.enabled, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Get a counter of a type of backing memory
+ * @param[in] backing Type of backing memory
+ * @return Pointer to the counter or NULL (not counted separately)
+ */
+static uint64_t *
+hugepage_counter(enum ipx_hugepage_backing backing)
+{
+    switch (backing) {
+    case IPX_HUGEPAGE_HUGETLB:
+        return &hugepage.hugetlb;
+    case IPX_HUGEPAGE_THP:
+        return &hugepage.thp;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief Map reserved huge pages
+ * @param[in] size Size of the memory (multiple of #IPX_HUGEPAGE_SIZE)
+ * @return Pointer to the memory or NULL
+ */
+static void *
+hugepage_map_hugetlb(size_t size)
+{
+#if defined(MAP_HUGETLB)
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE;
+#if defined(MAP_HUGE_2MB)
+    // The default size of huge pages might be different (e.g. 1 GiB)
+    flags |= MAP_HUGE_2MB;
+#endif
+
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (addr != MAP_FAILED) {
+        return addr;
+    }
+
+    if (!__atomic_exchange_n(&hugepage.hugetlb_warned, true, __ATOMIC_RELAXED)) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_INFO(module, "Reserved huge pages are not available (%s), falling back to "
+            "transparent huge pages. Reserve huge pages using /proc/sys/vm/nr_hugepages.",
+            err_str);
+    }
+#else
+    (void) size;
+#endif
+    return NULL;
+}
+
+/**
+ * @brief Map memory aligned to a huge page and advise the kernel to use transparent huge pages
+ * @param[in]  size    Size of the memory (multiple of #IPX_HUGEPAGE_SIZE)
+ * @param[out] backing Type of backing memory
+ * @return Pointer to the memory or NULL
+ */
+static void *
+hugepage_map_thp(size_t size, enum ipx_hugepage_backing *backing)
+{
+    // Transparent huge pages can be used only within aligned regions -> map more and trim it
+    const size_t map_size = size + IPX_HUGEPAGE_SIZE;
+    void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const uintptr_t map_begin = (uintptr_t) map;
+    const uintptr_t align_mask = (uintptr_t) IPX_HUGEPAGE_SIZE - 1;
+    const uintptr_t begin = (map_begin + align_mask) & ~align_mask;
+    const uintptr_t end = begin + size;
+    if (begin > map_begin) {
+        munmap(map, begin - map_begin);
+    }
+    if (map_begin + map_size > end) {
+        munmap((void *) end, map_begin + map_size - end);
+    }
+
+    void *addr = (void *) begin;
+    *backing = IPX_HUGEPAGE_REGULAR;
+#if defined(MADV_HUGEPAGE)
+    if (madvise(addr, size, MADV_HUGEPAGE) == 0) {
+        *backing = IPX_HUGEPAGE_THP;
+    }
+#endif
+
+    // Allocate all pages now (preferably huge pages)
+    memset(addr, 0, size);
+    return addr;
+}
+
+/**
+ * @brief Allocate memory from huge pages (if possible)
+ * @param[out] mem  Allocated memory
+ * @param[in]  size Size of the memory (must not be zero)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+hugepage_alloc(struct ipx_hugepage_mem *mem, size_t size)
+{
+    const size_t map_size = (size + IPX_HUGEPAGE_SIZE - 1) & ~((size_t) IPX_HUGEPAGE_SIZE - 1);
+    enum ipx_hugepage_backing backing = IPX_HUGEPAGE_HUGETLB;
+    void *addr = hugepage_map_hugetlb(map_size);
+    if (!addr) {
+        addr = hugepage_map_thp(map_size, &backing);
+    }
+
+    if (!addr) {
+        return IPX_ERR_NOMEM;
+    }
+
+    uint64_t *counter = hugepage_counter(backing);
+    if (counter != NULL) {
+        __atomic_add_fetch(counter, map_size, __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&hugepage.total, map_size, __ATOMIC_RELAXED);
+
+    mem->addr = addr;
+    mem->size = map_size;
+    mem->backing = backing;
+    return IPX_OK;
+}
+
+int
+ipx_hugepage_alloc(struct ipx_hugepage_mem *mem, size_t size)
+{
+    mem->addr = NULL;
+    mem->size = 0;
+    mem->backing = IPX_HUGEPAGE_HEAP;
+
+    if (!ipx_hugepage_enabled()) {
+        const size_t heap_size = (size + HUGEPAGE_HEAP_ALIGN - 1) & ~(HUGEPAGE_HEAP_ALIGN - 1);
+        mem->addr = aligned_alloc(HUGEPAGE_HEAP_ALIGN, heap_size);
+        if (!mem->addr) {
+            return IPX_ERR_NOMEM;
+        }
+        mem->size = heap_size;
+        return IPX_OK;
+    }
+
+    return hugepage_alloc(mem, size);
+}
+
+int
+ipx_hugepage_alloc_mapped(struct ipx_hugepage_mem *mem, size_t size)
+{
+    mem->addr = NULL;
+    mem->size = 0;
+    mem->backing = IPX_HUGEPAGE_HEAP;
+
+    if (ipx_hugepage_enabled()) {
+        return hugepage_alloc(mem, size);
+    }
+
+    const size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t map_size = (size + page_size - 1) & ~(page_size - 1);
+    void *addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        return IPX_ERR_NOMEM;
+    }
+
+    mem->addr = addr;
+    mem->size = map_size;
+    mem->backing = IPX_HUGEPAGE_PAGES;
+    return IPX_OK;
+}
+
+void
+ipx_hugepage_free(struct ipx_hugepage_mem *mem)
+{
+    if (!mem->addr) {
+        return;
+    }
+
+    if (mem->backing == IPX_HUGEPAGE_HEAP) {
+        free(mem->addr);
+    } else if (mem->backing == IPX_HUGEPAGE_PAGES) {
+        // Not allocated from huge pages, i.e. not counted
+        munmap(mem->addr, mem->size);
+    } else {
+        munmap(mem->addr, mem->size);
+
+        uint64_t *counter = hugepage_counter(mem->backing);
+        if (counter != NULL) {
+            __atomic_sub_fetch(counter, mem->size, __ATOMIC_RELAXED);
+        }
+        __atomic_sub_fetch(&hugepage.total, mem->size, __ATOMIC_RELAXED);
+    }
+
+    mem->addr = NULL;
+    mem->size = 0;
+    mem->backing = IPX_HUGEPAGE_HEAP;
+}
+
+/**
+ * @brief Get size of transparent huge pages used by the process
+ * @return Size in bytes (0 if unknown)
+ */
+static uint64_t
+hugepage_thp_process()
+{
+    FILE *file = fopen(HUGEPAGE_ROLLUP_FILE, "r");
+    if (!file) {
+        return 0;
+    }
+
+    char line[256];
+    uint64_t size_kb = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "AnonHugePages: %" SCNu64 " kB", &size_kb) == 1) {
+            break;
+        }
+    }
+
+    fclose(file);
+    return size_kb * 1024U;
+}
+
+void
+ipx_hugepage_stats_get(struct ipx_hugepage_stats *stats)
+{
+    stats->total = __atomic_load_n(&hugepage.total, __ATOMIC_RELAXED);
+    stats->hugetlb = __atomic_load_n(&hugepage.hugetlb, __ATOMIC_RELAXED);
+    stats->thp = __atomic_load_n(&hugepage.thp, __ATOMIC_RELAXED);
+    stats->thp_process = hugepage_thp_process();
+}
+
+void
+ipx_hugepage_report()
+{
+    if (!ipx_hugepage_enabled()) {
+        return;
+    }
+
+    struct ipx_hugepage_stats stats;
+    ipx_hugepage_stats_get(&stats);
+    const uint64_t regular = stats.total - stats.hugetlb - stats.thp;
+
+    IPX_INFO(module, "%.1f MiB of ring buffers and message pools allocated: %.1f MiB backed by "
+        "reserved huge pages (MAP_HUGETLB), %.1f MiB advised to use transparent huge pages, "
+        "%.1f MiB backed by regular pages.", HUGEPAGE_MIB(stats.total),
+        HUGEPAGE_MIB(stats.hugetlb), HUGEPAGE_MIB(stats.thp), HUGEPAGE_MIB(regular));
+    if (stats.thp > 0) {
+        IPX_INFO(module, "Transparent huge pages actually used by the process: %.1f MiB",
+            HUGEPAGE_MIB(stats.thp_process));
+    }
+
+    if (stats.total > 0 && stats.hugetlb == 0 && stats.thp == 0) {
+        IPX_WARNING(module, "No memory is backed by huge pages! Reserve huge pages "
+            "(/proc/sys/vm/nr_hugepages) or enable transparent huge pages "
+            "(/sys/kernel/mm/transparent_hugepage/enabled).", '\0');
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief Memory backed by huge pages (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_HUGEPAGE_H
+#define IPFIXCOL_HUGEPAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/** Size of a huge page (all huge page allocations are rounded up to its multiple) */
+#define IPX_HUGEPAGE_SIZE (2U * 1024U * 1024U)
+
+/** Type of memory backing an allocation */
+enum ipx_hugepage_backing {
+    /** Ordinary heap allocation (huge pages disabled)                              */
+    IPX_HUGEPAGE_HEAP,
+    /** Anonymous mapping of regular pages (huge pages disabled)                    */
+    IPX_HUGEPAGE_PAGES,
+    /** Anonymous mapping of regular pages (huge pages are not available)           */
+    IPX_HUGEPAGE_REGULAR,
+    /** Anonymous mapping advised to use transparent huge pages (madvise)           */
+    IPX_HUGEPAGE_THP,
+    /** Mapping of reserved huge pages (MAP_HUGETLB)                                */
+    IPX_HUGEPAGE_HUGETLB
+};
+
+/** Memory allocated by ipx_hugepage_alloc() */
+struct ipx_hugepage_mem {
+    /** Start of the memory (NULL if not allocated)   */
+    void *addr;
+    /** Size of the memory (after rounding)           */
+    size_t size;
+    /** Type of backing memory                        */
+    enum ipx_hugepage_backing backing;
+};
+
+/** Initializer of unallocated memory */
+#define IPX_HUGEPAGE_MEM_INIT {NULL, 0, IPX_HUGEPAGE_HEAP}
+
+/** Summary of memory currently allocated from huge pages */
+struct ipx_hugepage_stats {
+    /** Total size of memory allocated while huge pages were enabled (bytes)        */
+    uint64_t total;
+    /** Size of memory backed by reserved huge pages (bytes)                        */
+    uint64_t hugetlb;
+    /** Size of memory advised to use transparent huge pages (bytes)                */
+    uint64_t thp;
+    /**
+     * Size of transparent huge pages actually used by the whole process (bytes)
+     * \note The kernel doesn't guarantee that advised memory is backed by transparent huge
+     *   pages, therefore, the value is taken from "/proc/self/smaps_rollup" (0 if unknown).
+     */
+    uint64_t thp_process;
+};
+
+/**
+ * @brief Enable or disable allocation from huge pages
+ *
+ * The setting affects only future allocations (i.e. it should be changed before any ring
+ * buffers and message pools are created). Disabled by default.
+ * @param[in] enable Enable/disable
+ */
+void
+ipx_hugepage_enable(bool enable);
+
+/**
+ * @brief Check if allocation from huge pages is enabled
+ * @return True or false
+ */
+bool
+ipx_hugepage_enabled();
+
+/**
+ * @brief Allocate memory
+ *
+ * If huge pages are disabled, the memory is allocated on the heap. Otherwise, the size is
+ * rounded up to a multiple of #IPX_HUGEPAGE_SIZE and the memory is preferably mapped from
+ * reserved huge pages (MAP_HUGETLB). If no reserved huge page is available, an anonymous
+ * mapping is advised to use transparent huge pages and, if even that is not supported,
+ * regular pages are used. Mapped memory is touched (i.e. zeroed) so that its pages are
+ * allocated immediately.
+ *
+ * The memory is aligned at least to a cache line and must be freed by ipx_hugepage_free().
+ * @param[out] mem  Allocated memory
+ * @param[in]  size Size of the memory (must not be zero)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+ipx_hugepage_alloc(struct ipx_hugepage_mem *mem, size_t size);
+
+/**
+ * @brief Allocate memory that doesn't share pages with any other object
+ *
+ * The same as ipx_hugepage_alloc(), however, if huge pages are disabled, the memory is mapped
+ * from regular pages (i.e. the size is rounded up to a multiple of the page size) instead of
+ * being allocated on the heap. Therefore, the memory is always aligned to a page and it can be
+ * safely moved to another NUMA node (see ipx_placement_mem_bind()).
+ * @param[out] mem  Allocated memory
+ * @param[in]  size Size of the memory (must not be zero)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+ipx_hugepage_alloc_mapped(struct ipx_hugepage_mem *mem, size_t size);
+
+/**
+ * @brief Free memory allocated by ipx_hugepage_alloc()
+ *
+ * The structure is reset, therefore, it is safe to call the function multiple times.
+ * @param[in] mem Memory
+ */
+void
+ipx_hugepage_free(struct ipx_hugepage_mem *mem);
+
+/**
+ * @brief Get summary of memory currently allocated from huge pages
+ * @param[out] stats Summary
+ */
+void
+ipx_hugepage_stats_get(struct ipx_hugepage_stats *stats);
+
+/**
+ * @brief Print summary of memory currently allocated from huge pages (if enabled)
+ */
+void
+ipx_hugepage_report();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IPFIXCOL_HUGEPAGE_H
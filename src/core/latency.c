@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief Latency histograms (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+#include "latency.h"
+
+/** Number of sub-buckets of each power of 2 */
+#define SUB_CNT (1U << IPX_LAT_SUB_BITS)
+
+/**
+ * @brief Get the index of the bucket of a value
+ * @param[in] value Value
+ * @return Index
+ */
+static inline unsigned int
+bucket_idx(uint64_t value)
+{
+    if (value < SUB_CNT) {
+        return (unsigned int) value;
+    }
+
+    // Position of the most significant bit (>= IPX_LAT_SUB_BITS)
+    const unsigned int msb = 63U - (unsigned int) __builtin_clzll(value);
+    const unsigned int shift = msb - IPX_LAT_SUB_BITS;
+    const unsigned int sub = (unsigned int) (value >> shift) & (SUB_CNT - 1);
+    return ((shift + 1) << IPX_LAT_SUB_BITS) + sub;
+}
+
+/**
+ * @brief Get the highest value that belongs to a bucket
+ * @param[in] idx Index of the bucket
+ * @return Value
+ */
+static inline uint64_t
+bucket_upper(unsigned int idx)
+{
+    if (idx < SUB_CNT) {
+        return idx;
+    }
+
+    const unsigned int shift = (idx >> IPX_LAT_SUB_BITS) - 1;
+    const uint64_t sub = idx & (SUB_CNT - 1);
+    const uint64_t lower = (SUB_CNT + sub) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+void
+ipx_lat_hist_reset(struct ipx_lat_hist *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+void
+ipx_lat_hist_add(struct ipx_lat_hist *hist, uint64_t value)
+{
+    hist->buckets[bucket_idx(value)]++;
+    hist->cnt++;
+    hist->sum += value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+uint64_t
+ipx_lat_hist_percentile(const struct ipx_lat_hist *hist, double pct)
+{
+    if (hist->cnt == 0) {
+        return 0;
+    }
+
+    // Rank of the value (at least the first one)
+    uint64_t rank = (uint64_t) ((pct / 100.0) * (double) hist->cnt + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (unsigned int idx = 0; idx < IPX_LAT_BUCKETS; ++idx) {
+        seen += hist->buckets[idx];
+        if (seen < rank) {
+            continue;
+        }
+
+        const uint64_t upper = bucket_upper(idx);
+        return (upper < hist->max) ? upper : hist->max;
+    }
+
+    return hist->max;
+}
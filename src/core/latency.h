@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Latency histograms (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_LATENCY_H
+#define IPFIXCOL_LATENCY_H
+
+#include <stdint.h>
+#include <time.h>
+
+/** Number of linear sub-buckets of each power of 2 (relative precision ~6%)        */
+#define IPX_LAT_SUB_BITS 4U
+/** Total number of buckets of a histogram (covers the whole range of uint64_t)     */
+#define IPX_LAT_BUCKETS ((64U - IPX_LAT_SUB_BITS + 1U) << IPX_LAT_SUB_BITS)
+
+/**
+ * @brief Latency histogram with logarithmic buckets (HDR-style)
+ *
+ * Values below 2^#IPX_LAT_SUB_BITS are recorded exactly, each higher power of 2 is split into
+ * 2^#IPX_LAT_SUB_BITS buckets of the same width. Therefore, the relative error of a recorded
+ * value is constant over the whole range. The histogram is not thread-safe.
+ */
+struct ipx_lat_hist {
+    /** Number of recorded values      */
+    uint64_t cnt;
+    /** Sum of recorded values         */
+    uint64_t sum;
+    /** Maximum recorded value         */
+    uint64_t max;
+    /** Number of values in buckets    */
+    uint64_t buckets[IPX_LAT_BUCKETS];
+};
+
+/**
+ * @brief Get the current monotonic time
+ * @return Number of nanoseconds
+ */
+static inline uint64_t
+ipx_lat_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief Remove all values from a histogram
+ * @param[in] hist Histogram
+ */
+void
+ipx_lat_hist_reset(struct ipx_lat_hist *hist);
+
+/**
+ * @brief Record a value
+ * @param[in] hist  Histogram
+ * @param[in] value Value to record
+ */
+void
+ipx_lat_hist_add(struct ipx_lat_hist *hist, uint64_t value);
+
+/**
+ * @brief Get a percentile of recorded values
+ *
+ * The result is the upper bound of the bucket that contains the percentile (but never more
+ * than the maximum recorded value).
+ * @param[in] hist Histogram
+ * @param[in] pct  Percentile (0.0 - 100.0)
+ * @return Value or 0 if the histogram is empty
+ */
+uint64_t
+ipx_lat_hist_percentile(const struct ipx_lat_hist *hist, double pct);
+
+#endif // IPFIXCOL_LATENCY_H
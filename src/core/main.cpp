@@ -45,6 +45,7 @@
 #include <sys/types.h> // getpid()
 #include <unistd.h>
 #include <cstdlib>
+#include <cstring>
 #include <cinttypes>
 
 #include <ipfixcol2.h>
@@ -55,6 +56,9 @@
 
 extern "C" {
 #include "verbose.h"
+#include "ring.h"
+#include "metrics_server.h"
+#include "hugepage.h"
 #include <build_config.h>
 }
 
@@ -84,7 +88,7 @@ print_help()
 {
     std::cout
         << "IPFIX Collector daemon\n"
-        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-vVhLdu]\n"
+        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-R TYPE] [-s NUM] [-M ADDR] [-vVhLdHu]\n"
         << "  -c FILE   Path to the startup configuration file\n"
         << "            (default: " << IPX_DEFAULT_STARTUP_CONFIG << ")\n"
         << "  -p PATH   Add path to a directory with plugins or to a file\n"
@@ -94,6 +98,12 @@ print_help()
         << "  -P FILE   Path to a PID file (without this option, no PID file is created)\n"
         << "  -d        Run as a standalone daemon process\n"
         << "  -r SIZE   Ring buffer size (default: " << ipx_configurator::RING_DEF_SIZE << ")\n"
+        << "  -R TYPE   Ring buffer type: \"locked\" or \"lockfree\" (default: "
+        << ((ipx_ring_type_get() == IPX_RING_TYPE_LOCKFREE) ? "lockfree" : "locked") << ")\n"
+        << "  -s NUM    Run-to-completion mode with NUM pipeline shards (default: disabled)\n"
+        << "  -M ADDR   Expose metrics in the Prometheus text format over HTTP on [HOST:]PORT\n"
+        << "            (default host: 127.0.0.1, without this option, metrics are not exposed)\n"
+        << "  -H        Allocate ring buffers and message pools from huge pages (2 MiB)\n"
         << "  -h        Show this help message and exit\n"
         << "  -V        Show version information and exit\n"
         << "  -L        List all available plugins and exit\n"
@@ -190,6 +200,59 @@ ring_size_change(ipx_configurator &conf, const char *new_size)
     return IPX_OK;
 }
 
+/**
+ * \brief Change type of ring buffers
+ * \param[in] new_type New type (from command line)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the \p new_type is not valid type
+ */
+static int
+ring_type_change(const char *new_type)
+{
+    enum ipx_ring_type type;
+    if (strcmp(new_type, "locked") == 0) {
+        type = IPX_RING_TYPE_LOCKED;
+    } else if (strcmp(new_type, "lockfree") == 0) {
+        type = IPX_RING_TYPE_LOCKFREE;
+    } else {
+        IPX_ERROR(module, "Type '%s' of the ring buffers is not valid (expected \"locked\" or "
+            "\"lockfree\")!", new_type);
+        return IPX_ERR_FORMAT;
+    }
+
+    ipx_ring_type_set(type);
+    IPX_INFO(module, "Ring buffer type set to '%s'", new_type);
+    return IPX_OK;
+}
+
+/**
+ * \brief Enable the run-to-completion mode
+ * \param[in] conf   IPFIXcol configurator
+ * \param[in] shards Number of pipeline shards (from command line)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the \p shards is not valid number
+ */
+static int
+shards_change(ipx_configurator &conf, const char *shards)
+{
+    char *end_ptr = nullptr;
+    errno = 0;
+    unsigned long cnt = std::strtoul(shards, &end_ptr, 10);
+    if (errno != 0 || (end_ptr != nullptr && (*end_ptr) != '\0')) {
+        IPX_ERROR(module, "Number of pipeline shards '%s' is not a valid number!", shards);
+        return IPX_ERR_FORMAT;
+    }
+
+    const unsigned int max_cnt = ipx_configurator::SHARDS_MAX;
+    if (cnt < 1 || cnt > max_cnt) {
+        IPX_ERROR(module, "Number of pipeline shards must be between 1 and %u.", max_cnt);
+        return IPX_ERR_FORMAT;
+    }
+
+    conf.set_shards(static_cast<unsigned int>(cnt));
+    return IPX_OK;
+}
+
 /**
  * \brief Main function
  * \param[in] argc Number of arguments
@@ -202,6 +265,9 @@ int main(int argc, char *argv[])
     const char *cfg_iedir = nullptr;
     const char *pid_file = nullptr;
     const char *ring_size = nullptr;
+    const char *ring_type = nullptr;
+    const char *shards = nullptr;
+    const char *metrics_addr = nullptr;
     bool daemon_en = false;
     bool list_only = false;
     ipx_configurator configurator;
@@ -209,7 +275,7 @@ int main(int argc, char *argv[])
     // Parse configuration
     int opt;
     opterr = 0; // Disable default error messages
-    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:u")) != -1) {
+    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:R:s:M:Hu")) != -1) {
         switch (opt) {
         case 'c': // Configuration file
             cfg_startup = optarg;
@@ -241,6 +307,18 @@ int main(int argc, char *argv[])
         case 'r': // Change ring size
             ring_size = optarg;
             break;
+        case 'R': // Change ring type
+            ring_type = optarg;
+            break;
+        case 's': // Enable run-to-completion mode
+            shards = optarg;
+            break;
+        case 'M': // Expose metrics
+            metrics_addr = optarg;
+            break;
+        case 'H': // Allocate from huge pages
+            ipx_hugepage_enable(true);
+            break;
         case 'u': // Disable automatic plugin unload
             configurator.plugins.auto_unload(false);
             break;
@@ -285,6 +363,21 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (ring_type != nullptr && ring_type_change(ring_type) != IPX_OK) {
+        // Failed to set the type
+        return EXIT_FAILURE;
+    }
+
+    if (shards != nullptr && shards_change(configurator, shards) != IPX_OK) {
+        // Failed to enable the mode
+        return EXIT_FAILURE;
+    }
+
+    if (metrics_addr != nullptr && ipx_metrics_server_start(metrics_addr) != IPX_OK) {
+        // Failed to start the server
+        return EXIT_FAILURE;
+    }
+
     // Create a PID file
     if (pid_file != nullptr && pid_create(pid_file) != IPX_OK) {
         pid_file = nullptr; // Prevent removing the file
@@ -297,12 +390,15 @@ int main(int argc, char *argv[])
         rc = configurator.run(&ctrl_file);
     } catch (std::exception &ex) {
         std::cerr << "An unexpected error has occurred: " << ex.what() << std::endl;
-        return EXIT_FAILURE;
+        rc = EXIT_FAILURE;
     } catch (...) {
         std::cerr << "An unexpected exception has occurred!" << std::endl;
-        return EXIT_FAILURE;
+        rc = EXIT_FAILURE;
     }
 
+    // Stop exposing metrics (must be stopped before the configurator destroys them)
+    ipx_metrics_server_stop();
+
     // Destroy a PID file
     if (pid_file != nullptr) {
         pid_remove(pid_file);
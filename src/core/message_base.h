@@ -44,6 +44,7 @@
 
 #include <ipfixcol2.h>
 #include <assert.h>
+#include <build_config.h>
 #include "message_terminate.h"
 
 /**
@@ -68,6 +69,18 @@ struct ipx_msg {
     enum ipx_msg_type type;
     /** Reference counter (set by the output manager, decremented by output plugins)  */
     unsigned int ref_cnt;
+#ifdef ENABLE_LATENCY_TRACE
+    /**
+     * Latency tracing of sampled messages (see ipx_msg_header_trace_start())
+     * \note Only IPFIX Messages are traced and their wrappers are always zeroed on creation.
+     */
+    struct {
+        /** Monotonic time when the message left the input instance [ns] (0 = not sampled) */
+        uint64_t first;
+        /** Monotonic time of the last hand-off between instances [ns]                      */
+        uint64_t last;
+    } trace;
+#endif
 }; // TODO: 64 bytes alignment
 
 static_assert(offsetof(struct ipx_msg, type) == 0,
@@ -120,6 +133,52 @@ ipx_msg_header_cnt_dec(struct ipx_msg *header)
     return (__atomic_sub_fetch(&header->ref_cnt, 1U, __ATOMIC_SEQ_CST) == 0);
 }
 
+#ifdef ENABLE_LATENCY_TRACE
+/**
+ * \brief Start latency tracing of a message (only for input instances)
+ *
+ * Each following instance measures the time between its hand-off and the previous one (see
+ * ipx_msg_header_trace_lap()), i.e. the time spent in its input queue and in its plugin.
+ * \param[in] header Pointer to the header of the message
+ * \param[in] now    Current monotonic time [ns]
+ */
+static inline void
+ipx_msg_header_trace_start(struct ipx_msg *header, uint64_t now)
+{
+    header->trace.first = now;
+    header->trace.last = now;
+}
+
+/**
+ * \brief Check if the message has been sampled for latency tracing
+ * \param[in] header Pointer to the header of the message
+ */
+static inline bool
+ipx_msg_header_trace_sampled(const struct ipx_msg *header)
+{
+    return header->trace.first != 0;
+}
+
+/**
+ * \brief Get the time since the last hand-off of a sampled message and record a new hand-off
+ * \param[in] header Pointer to the header of the message
+ * \param[in] now    Current monotonic time [ns]
+ * \return Elapsed time [ns]
+ */
+static inline uint64_t
+ipx_msg_header_trace_lap(struct ipx_msg *header, uint64_t now)
+{
+    uint64_t elapsed = now - header->trace.last;
+    header->trace.last = now;
+    return elapsed;
+}
+#else
+// Latency tracing is disabled, messages are never sampled
+#define ipx_msg_header_trace_start(header, now) ((void) (header), (void) (now))
+#define ipx_msg_header_trace_sampled(header)    ((void) (header), false)
+#define ipx_msg_header_trace_lap(header, now)   ((void) (header), (void) (now), (uint64_t) 0)
+#endif
+
 /**
  * \brief Cast from a base message to an IPFIX message
  * \param[in] msg Pointer to the base message
@@ -44,6 +44,7 @@
 #include <libfds.h>
 #include "message_base.h"
 #include "message_ipfix.h"
+#include "message_pool.h"
 #include "context.h"
 
 #include <stddef.h> // offsetof
@@ -59,24 +60,66 @@ ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size)
     return offsetof(struct ipx_msg_ipfix, recs) + (rec_cnt * rec_size);
 }
 
+/**
+ * \brief Release the raw IPFIX (or NetFlow) Message of a wrapper
+ * \param[in] msg Message wrapper
+ */
+static inline void
+ipx_msg_ipfix_raw_release(struct ipx_msg_ipfix *msg)
+{
+    if (msg->raw_free.cb != NULL) {
+        msg->raw_free.cb(msg->raw_free.arg, msg->raw_pkt);
+    } else {
+        free(msg->raw_pkt);
+    }
+}
+
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *msg_data)
+{
+    ipx_msg_ipfix_raw_release(msg);
+    msg->raw_pkt = msg_data;
+    msg->raw_free.cb = NULL;
+    msg->raw_free.arg = NULL;
+}
+
 ipx_msg_ipfix_t *
 ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
     uint8_t *msg_data, uint16_t msg_size)
+{
+    return ipx_msg_ipfix_create_ext(plugin_ctx, msg_ctx, msg_data, msg_size, NULL, NULL);
+}
+
+ipx_msg_ipfix_t *
+ipx_msg_ipfix_create_ext(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *msg_data, uint16_t msg_size, ipx_msg_ipfix_free_cb free_cb, void *free_arg)
 {
     const size_t rec_size = ipx_ctx_recsize_get(plugin_ctx);
-    const size_t new_size = ipx_msg_ipfix_size(REC_DEF_CNT, rec_size);
-    struct ipx_msg_ipfix *wrapper = calloc(1, new_size);
-    if (!wrapper) {
-        return NULL;
+    ipx_msg_pool_t *pool = ipx_ctx_msg_pool_get(plugin_ctx);
+    struct ipx_msg_ipfix *wrapper;
+
+    if (pool != NULL) {
+        // Reuse a wrapper of an already processed message, if possible
+        wrapper = ipx_msg_pool_ipfix_get(pool, rec_size);
+        if (!wrapper) {
+            return NULL;
+        }
+    } else {
+        wrapper = calloc(1, ipx_msg_ipfix_size(REC_DEF_CNT, rec_size));
+        if (!wrapper) {
+            return NULL;
+        }
+        wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
+        wrapper->rec_info.rec_size = rec_size;
     }
 
     ipx_msg_header_init(&wrapper->msg_header, IPX_MSG_IPFIX);
     wrapper->ctx = *msg_ctx;
     wrapper->raw_pkt = msg_data;
     wrapper->raw_size = msg_size;
+    wrapper->raw_free.cb = free_cb;
+    wrapper->raw_free.arg = free_arg;
     wrapper->sets.cnt_alloc = SET_DEF_CNT;
-    wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
-    wrapper->rec_info.rec_size = rec_size;
     return wrapper;
 }
 
@@ -84,14 +127,19 @@ void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
 {
     // Destroy the IPFIX packet
-    free(msg->raw_pkt);
+    ipx_msg_ipfix_raw_release(msg);
 
     // Destroy the wrapper
     if (msg->sets.extended) {
         free(msg->sets.extended);
     }
     ipx_msg_header_destroy((ipx_msg_t *) msg);
-    free(msg);
+    if (msg->pool.owner != NULL) {
+        // Return the wrapper to the pool of the producer
+        ipx_msg_pool_ipfix_put(msg);
+    } else {
+        free(msg);
+    }
 }
 
 uint8_t *
@@ -169,28 +217,69 @@ ipx_msg_ipfix_add_set_ref(struct ipx_msg_ipfix *msg)
     return &msg->sets.extended[msg->sets.cnt_valid++];
 }
 
+/**
+ * \brief Reallocate the wrapper to hold the given number of records
+ * \param[in,out] msg_ref   IPFIX Message wrapper
+ * \param[in]     alloc_new New number of allocated records
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+ipx_msg_ipfix_drecs_realloc(struct ipx_msg_ipfix **msg_ref, uint32_t alloc_new)
+{
+    struct ipx_msg_ipfix *msg = *msg_ref;
+    assert(alloc_new >= msg->rec_info.cnt_valid);
+
+    const size_t alloc_size = ipx_msg_ipfix_size(alloc_new, msg->rec_info.rec_size);
+    struct ipx_msg_ipfix *msg_new = (msg->pool.slab)
+        ? ipx_msg_pool_ipfix_move(msg, alloc_size) // Wrappers of slabs cannot be reallocated
+        : realloc(msg, alloc_size);
+    if (!msg_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    msg_new->rec_info.cnt_alloc = alloc_new;
+    *msg_ref = msg_new;
+    return IPX_OK;
+}
+
+int
+ipx_msg_ipfix_reserve_drecs(struct ipx_msg_ipfix **msg_ref, uint32_t cnt)
+{
+    const struct ipx_msg_ipfix *msg = *msg_ref;
+    const uint64_t cnt_required = (uint64_t) msg->rec_info.cnt_valid + cnt;
+    if (cnt_required <= msg->rec_info.cnt_alloc) {
+        // Nothing to do
+        return IPX_OK;
+    }
+
+    if (cnt_required > UINT32_MAX) {
+        return IPX_ERR_NOMEM;
+    }
+
+    return ipx_msg_ipfix_drecs_realloc(msg_ref, (uint32_t) cnt_required);
+}
+
 struct ipx_ipfix_record *
 ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
 {
     struct ipx_msg_ipfix *msg = *msg_ref;
     if (msg->rec_info.cnt_valid == msg->rec_info.cnt_alloc) {
         // Reallocation of the message is necessary
-        const uint32_t alloc_new = 2U * msg->rec_info.cnt_valid;
-        const size_t alloc_size = ipx_msg_ipfix_size(alloc_new, msg->rec_info.rec_size);
-        struct ipx_msg_ipfix *msg_new = realloc(msg, alloc_size);
-        if (!msg_new) {
+        if (ipx_msg_ipfix_drecs_realloc(msg_ref, 2U * msg->rec_info.cnt_valid) != IPX_OK) {
             return NULL;
         }
-
-        msg_new->rec_info.cnt_alloc = alloc_new;
-        msg = msg_new;
-        *msg_ref = msg_new;
+        msg = *msg_ref;
     }
 
     assert(msg->rec_info.cnt_valid < msg->rec_info.cnt_alloc);
     const size_t offset = msg->rec_info.cnt_valid * msg->rec_info.rec_size;
     msg->rec_info.cnt_valid++;
-    return ((struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset));
+
+    // Records of reallocated or reused wrappers are not zeroed
+    struct ipx_ipfix_record *rec = (struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset);
+    rec->ext_mask = 0;
+    return rec;
 }
 
 void
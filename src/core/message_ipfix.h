@@ -69,6 +69,13 @@ struct ipx_msg_ipfix {
     uint8_t *raw_pkt;
     /** Size of raw message                                                  */
     uint16_t raw_size;
+    /** Release of the raw message (callback NULL = free())                  */
+    struct {
+        /** Callback function                                                */
+        ipx_msg_ipfix_free_cb cb;
+        /** Argument of the callback function                                */
+        void *arg;
+    } raw_free;
 
     struct {
         /** Array of sets (valid only when #cnt_valid <= SET_DEF_CNT)       */
@@ -82,6 +89,15 @@ struct ipx_msg_ipfix {
         uint32_t cnt_alloc;
     } sets; /**< Parsed IPFIX (Data/Template/Options Template) Sets          */
 
+    struct {
+        /** Pool that owns the wrapper (NULL if not allocated from a pool)   */
+        struct ipx_msg_pool *owner;
+        /** Next wrapper in a list of unused wrappers of the pool            */
+        struct ipx_msg_ipfix *next;
+        /** Wrapper is a slot of a huge page slab (cannot be reallocated)     */
+        bool slab;
+    } pool; /**< Recycling of the wrapper (see message_pool.h)               */
+
     struct {
         /** Size of a single record (depends on registered extensions)       */
         size_t rec_size;
@@ -116,4 +132,15 @@ struct ipx_msg_ipfix {
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size);
 
+/**
+ * \brief Replace the raw IPFIX (or NetFlow) Message of a wrapper
+ *
+ * The previous Message is released (see ipx_msg_ipfix_create_ext()) and the new one will be
+ * freed by free(). Size of the message is not changed.
+ * \param[in] msg      Message wrapper
+ * \param[in] msg_data New raw Message (allocated by malloc())
+ */
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *msg_data);
+
 #endif // IPFIXCOL_MESSAGE_IPFIX_INTERNAL_H
@@ -48,6 +48,19 @@ ipx_msg_periodic_create(uint64_t seq)
     return msg;
 }
 
+ipx_msg_periodic_t *
+ipx_msg_periodic_copy(const ipx_msg_periodic_t *msg)
+{
+    struct ipx_msg_periodic *copy = ipx_msg_periodic_create(msg->seq);
+    if (!copy) {
+        return NULL;
+    }
+
+    copy->created = msg->created;
+    copy->last_processed = msg->last_processed;
+    return copy;
+}
+
 void
 ipx_msg_periodic_destroy(ipx_msg_periodic_t *msg)
 {
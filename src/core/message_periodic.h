@@ -22,6 +22,16 @@
 ipx_msg_periodic_t *
 ipx_msg_periodic_create(uint64_t seq);
 
+/**
+ * \brief Create a copy of a periodic message
+ *
+ * The sequence number and both timestamps of the original message are preserved.
+ * \param[in] msg   Pointer to the periodic message to copy
+ * \return On success returns a pointer to the new message. Otherwise returns NULL.
+ */
+ipx_msg_periodic_t *
+ipx_msg_periodic_copy(const ipx_msg_periodic_t *msg);
+
 /**
  * \brief Destroy a periodic message
  *
@@ -0,0 +1,394 @@
+/**
+ * @file
+ * @brief Pool of reusable IPFIX Message wrappers
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hugepage.h"
+#include "message_pool.h"
+#include "message_ipfix.h"
+
+/** Number of size classes (class K holds wrappers for REC_DEF_CNT * 2^K records) */
+#define POOL_CLASS_CNT (4U)
+/** Maximum number of unused wrappers in a size class                           */
+#define POOL_CLASS_MAX (256U)
+/** Special value of the return stack of a closed pool                          */
+#define POOL_CLOSED ((struct ipx_msg_ipfix *) (uintptr_t) 1)
+/** Alignment of wrappers in slabs (cache line)                                 */
+#define POOL_SLOT_ALIGN (64U)
+
+/** Slab of wrappers backed by huge pages */
+struct pool_slab {
+    /** Memory of the slab              */
+    struct ipx_hugepage_mem mem;
+    /** Next slab of the pool           */
+    struct pool_slab *next;
+};
+
+/** Pool of wrappers */
+struct ipx_msg_pool {
+    /** Lists of unused wrappers (accessed only by the producer)                */
+    struct {
+        /** First wrapper in the list                                           */
+        struct ipx_msg_ipfix *head;
+        /** Number of wrappers in the list                                      */
+        uint32_t cnt;
+    } classes[POOL_CLASS_CNT];
+
+    /** Slabs of wrappers backed by huge pages (accessed only by the producer)  */
+    struct {
+        /** Wrappers are allocated from slabs                                   */
+        bool enabled;
+        /** Size of a wrapper in slabs (0 = not determined yet)                 */
+        size_t slot_size;
+        /** List of all slabs                                                   */
+        struct pool_slab *list;
+        /** Unused part of the last slab                                        */
+        uint8_t *pos;
+        /** End of the last slab                                                */
+        uint8_t *end;
+        /** List of unused wrappers of slabs                                    */
+        struct ipx_msg_ipfix *free;
+    } slabs;
+
+    /** Statistics (modified only by the producer)                              */
+    struct ipx_msg_pool_stats stats;
+
+    /**
+     * Lock-free stack of wrappers returned by other threads
+     * \note Wrappers are pushed one by one, however, the producer always takes all of them at
+     *   once. The stack is set to #POOL_CLOSED after the pool has been closed.
+     */
+    struct ipx_msg_ipfix *returned;
+    /** Number of references (the producer + all wrappers allocated by the pool) */
+    unsigned int refs;
+};
+
+ipx_msg_pool_t *
+ipx_msg_pool_create()
+{
+    struct ipx_msg_pool *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->returned = NULL;
+    pool->refs = 1;
+    pool->slabs.enabled = ipx_hugepage_enabled();
+    return pool;
+}
+
+/**
+ * @brief Release a reference to the pool and free it if it was the last one
+ * @param[in] pool Pool
+ */
+static void
+pool_unref(struct ipx_msg_pool *pool)
+{
+    if (__atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    // No wrapper exists anymore -> slabs can be freed
+    struct pool_slab *slab = pool->slabs.list;
+    while (slab != NULL) {
+        struct pool_slab *next = slab->next;
+        ipx_hugepage_free(&slab->mem);
+        free(slab);
+        slab = next;
+    }
+
+    free(pool);
+}
+
+/**
+ * @brief Free a wrapper allocated by the pool
+ * @param[in] msg Wrapper
+ */
+static void
+pool_wrapper_free(struct ipx_msg_ipfix *msg)
+{
+    struct ipx_msg_pool *pool = msg->pool.owner;
+    if (!msg->pool.slab) {
+        // Wrappers of slabs are freed together with the pool
+        free(msg);
+    }
+    pool_unref(pool);
+}
+
+/**
+ * @brief Get a size class of a wrapper
+ * @param[in] msg Wrapper
+ * @return Index of the class or #POOL_CLASS_CNT if the wrapper is too big to be kept
+ */
+static unsigned int
+pool_class_idx(const struct ipx_msg_ipfix *msg)
+{
+    uint32_t mult = msg->rec_info.cnt_alloc / REC_DEF_CNT;
+    assert(mult > 0);
+
+    unsigned int idx = 0;
+    while (mult > 1 && idx < POOL_CLASS_CNT) {
+        mult >>= 1;
+        idx++;
+    }
+    return idx;
+}
+
+/**
+ * @brief Move wrappers returned by other threads into lists of unused wrappers
+ * @param[in] pool Pool
+ */
+static void
+pool_collect(struct ipx_msg_pool *pool)
+{
+    // Avoid modification of the shared cache line if nothing has been returned
+    if (__atomic_load_n(&pool->returned, __ATOMIC_RELAXED) == NULL) {
+        return;
+    }
+
+    struct ipx_msg_ipfix *msg = __atomic_exchange_n(&pool->returned, NULL, __ATOMIC_ACQUIRE);
+    assert(msg != POOL_CLOSED);
+
+    while (msg != NULL) {
+        struct ipx_msg_ipfix *next = msg->pool.next;
+        if (msg->pool.slab) {
+            // Wrappers of slabs are always kept as their memory cannot be freed anyway
+            msg->pool.next = pool->slabs.free;
+            pool->slabs.free = msg;
+            msg = next;
+            continue;
+        }
+
+        unsigned int idx = pool_class_idx(msg);
+        if (idx < POOL_CLASS_CNT && pool->classes[idx].cnt < POOL_CLASS_MAX) {
+            msg->pool.next = pool->classes[idx].head;
+            pool->classes[idx].head = msg;
+            pool->classes[idx].cnt++;
+        } else {
+            pool_wrapper_free(msg);
+        }
+        msg = next;
+    }
+}
+
+void
+ipx_msg_pool_destroy(ipx_msg_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    // From now, returned wrappers are immediately freed
+    struct ipx_msg_ipfix *msg = __atomic_exchange_n(&pool->returned, POOL_CLOSED,
+        __ATOMIC_ACQ_REL);
+    while (msg != NULL) {
+        struct ipx_msg_ipfix *next = msg->pool.next;
+        pool_wrapper_free(msg);
+        msg = next;
+    }
+
+    for (unsigned int i = 0; i < POOL_CLASS_CNT; ++i) {
+        msg = pool->classes[i].head;
+        while (msg != NULL) {
+            struct ipx_msg_ipfix *next = msg->pool.next;
+            pool_wrapper_free(msg);
+            msg = next;
+        }
+        pool->classes[i].head = NULL;
+        pool->classes[i].cnt = 0;
+    }
+
+    msg = pool->slabs.free;
+    while (msg != NULL) {
+        struct ipx_msg_ipfix *next = msg->pool.next;
+        pool_wrapper_free(msg);
+        msg = next;
+    }
+    pool->slabs.free = NULL;
+
+    // Release the reference of the producer
+    pool_unref(pool);
+}
+
+/**
+ * @brief Add a new slab to the pool
+ * @param[in] pool Pool
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+pool_slab_add(struct ipx_msg_pool *pool)
+{
+    struct pool_slab *slab = malloc(sizeof(*slab));
+    if (!slab) {
+        return IPX_ERR_NOMEM;
+    }
+
+    if (ipx_hugepage_alloc(&slab->mem, IPX_HUGEPAGE_SIZE) != IPX_OK) {
+        free(slab);
+        return IPX_ERR_NOMEM;
+    }
+
+    slab->next = pool->slabs.list;
+    pool->slabs.list = slab;
+    pool->slabs.pos = slab->mem.addr;
+    pool->slabs.end = pool->slabs.pos + slab->mem.size;
+    return IPX_OK;
+}
+
+/**
+ * @brief Get a wrapper from slabs of the pool
+ *
+ * All wrappers of slabs have the same size, which is determined by the first request.
+ * @param[in] pool     Pool
+ * @param[in] rec_size Size of a single Data Record
+ * @return Pointer to the wrapper or NULL (records too big or memory allocation error)
+ */
+static struct ipx_msg_ipfix *
+pool_slab_get(struct ipx_msg_pool *pool, size_t rec_size)
+{
+    const size_t hdr_size = offsetof(struct ipx_msg_ipfix, recs);
+    if (pool->slabs.slot_size == 0) {
+        const size_t size = ipx_msg_ipfix_size(REC_DEF_CNT, rec_size);
+        pool->slabs.slot_size = (size + POOL_SLOT_ALIGN - 1) & ~((size_t) POOL_SLOT_ALIGN - 1);
+    }
+
+    const size_t slot_size = pool->slabs.slot_size;
+    const size_t cnt_alloc = (slot_size - hdr_size) / rec_size;
+    if (cnt_alloc < REC_DEF_CNT || slot_size > IPX_HUGEPAGE_SIZE) {
+        // Records don't fit into the slot (e.g. new extensions) -> use the heap
+        return NULL;
+    }
+
+    struct ipx_msg_ipfix *msg = pool->slabs.free;
+    if (msg != NULL) {
+        pool->slabs.free = msg->pool.next;
+        __atomic_store_n(&pool->stats.hits, pool->stats.hits + 1, __ATOMIC_RELAXED);
+    } else {
+        if ((size_t) (pool->slabs.end - pool->slabs.pos) < slot_size
+                && pool_slab_add(pool) != IPX_OK) {
+            return NULL;
+        }
+
+        msg = (struct ipx_msg_ipfix *) pool->slabs.pos;
+        pool->slabs.pos += slot_size;
+        __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&pool->stats.misses, pool->stats.misses + 1, __ATOMIC_RELAXED);
+    }
+
+    memset(msg, 0, hdr_size);
+    msg->pool.owner = pool;
+    msg->pool.slab = true;
+    msg->rec_info.rec_size = rec_size;
+    msg->rec_info.cnt_alloc = (uint32_t) cnt_alloc;
+    return msg;
+}
+
+struct ipx_msg_ipfix *
+ipx_msg_pool_ipfix_get(ipx_msg_pool_t *pool, size_t rec_size)
+{
+    pool_collect(pool);
+
+    // Prefer bigger wrappers as they are less likely to be reallocated
+    for (unsigned int i = POOL_CLASS_CNT; i-- > 0;) {
+        struct ipx_msg_ipfix *msg = pool->classes[i].head;
+        if (!msg) {
+            continue;
+        }
+
+        pool->classes[i].head = msg->pool.next;
+        pool->classes[i].cnt--;
+
+        if (msg->rec_info.rec_size != rec_size) {
+            // Size of records has been changed (e.g. new extensions) -> cannot be reused
+            pool_wrapper_free(msg);
+            continue;
+        }
+
+        const uint32_t cnt_alloc = msg->rec_info.cnt_alloc;
+        memset(msg, 0, offsetof(struct ipx_msg_ipfix, recs));
+        msg->pool.owner = pool;
+        msg->rec_info.rec_size = rec_size;
+        msg->rec_info.cnt_alloc = cnt_alloc;
+        __atomic_store_n(&pool->stats.hits, pool->stats.hits + 1, __ATOMIC_RELAXED);
+        return msg;
+    }
+
+    if (pool->slabs.enabled) {
+        struct ipx_msg_ipfix *msg = pool_slab_get(pool, rec_size);
+        if (msg != NULL) {
+            return msg;
+        }
+    }
+
+    struct ipx_msg_ipfix *msg = calloc(1, ipx_msg_ipfix_size(REC_DEF_CNT, rec_size));
+    if (!msg) {
+        return NULL;
+    }
+
+    __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+    msg->pool.owner = pool;
+    msg->rec_info.rec_size = rec_size;
+    msg->rec_info.cnt_alloc = REC_DEF_CNT;
+    __atomic_store_n(&pool->stats.misses, pool->stats.misses + 1, __ATOMIC_RELAXED);
+    return msg;
+}
+
+void
+ipx_msg_pool_ipfix_put(struct ipx_msg_ipfix *msg)
+{
+    struct ipx_msg_pool *pool = msg->pool.owner;
+    assert(pool != NULL);
+
+    struct ipx_msg_ipfix *head = __atomic_load_n(&pool->returned, __ATOMIC_RELAXED);
+    do {
+        if (head == POOL_CLOSED) {
+            // The producer doesn't exist anymore
+            pool_wrapper_free(msg);
+            return;
+        }
+        msg->pool.next = head;
+    } while (!__atomic_compare_exchange_n(&pool->returned, &head, msg, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // Since now the pool cannot be accessed (it might be already closed and freed)
+}
+
+struct ipx_msg_ipfix *
+ipx_msg_pool_ipfix_move(struct ipx_msg_ipfix *msg, size_t size)
+{
+    struct ipx_msg_pool *pool = msg->pool.owner;
+    assert(pool != NULL);
+
+    struct ipx_msg_ipfix *msg_new = malloc(size);
+    if (!msg_new) {
+        return NULL;
+    }
+
+    // Same as realloc() i.e. copy all allocated records that fit
+    size_t copy_size = ipx_msg_ipfix_size(msg->rec_info.cnt_alloc, msg->rec_info.rec_size);
+    if (copy_size > size) {
+        copy_size = size;
+    }
+    memcpy(msg_new, msg, copy_size);
+    msg_new->pool.slab = false;
+
+    // The new wrapper holds its own reference, so the pool cannot be freed by the return
+    __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+    ipx_msg_pool_ipfix_put(msg);
+    return msg_new;
+}
+
+void
+ipx_msg_pool_stats_get(const ipx_msg_pool_t *pool, struct ipx_msg_pool_stats *stats)
+{
+    stats->hits = __atomic_load_n(&pool->stats.hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&pool->stats.misses, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Pool of reusable IPFIX Message wrappers (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_MESSAGE_POOL_H
+#define IPFIXCOL_MESSAGE_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/** Internal type of the pool */
+typedef struct ipx_msg_pool ipx_msg_pool_t;
+
+/** Statistics of the pool */
+struct ipx_msg_pool_stats {
+    /** Number of wrappers reused from the pool                       */
+    uint64_t hits;
+    /** Number of wrappers that had to be allocated                   */
+    uint64_t misses;
+};
+
+/**
+ * @brief Create a new pool of IPFIX Message wrappers
+ *
+ * The pool belongs to a single producer (usually a thread of a plugin instance) that is the
+ * only one allowed to take wrappers out of the pool. However, wrappers can be returned into
+ * the pool by any thread (see ipx_msg_pool_ipfix_put()).
+ *
+ * If allocation from huge pages is enabled (see ipx_hugepage_enable()), wrappers are carved
+ * out of huge page slabs of the pool. Such wrappers cannot be reallocated and must be moved
+ * by ipx_msg_pool_ipfix_move() instead.
+ * @return Pointer or NULL (memory allocation error)
+ */
+ipx_msg_pool_t *
+ipx_msg_pool_create();
+
+/**
+ * @brief Close the pool
+ *
+ * All unused wrappers are freed immediately. Wrappers still in use (e.g. held by other
+ * plugins in the pipeline) are freed as soon as they are returned. The pool itself is freed
+ * after the last wrapper has been returned, therefore, the function can be called while
+ * messages are still processed by other threads.
+ * @param[in] pool Pool
+ */
+void
+ipx_msg_pool_destroy(ipx_msg_pool_t *pool);
+
+/**
+ * @brief Get an IPFIX Message wrapper from the pool
+ *
+ * The returned wrapper is able to hold at least #REC_DEF_CNT Data Records of the given size.
+ * All fields, except the records themselves, are zeroed and the record size and the number of
+ * allocated records are set.
+ * @warning Only the producer of the pool is allowed to call this function.
+ * @param[in] pool     Pool
+ * @param[in] rec_size Size of a single Data Record
+ * @return Pointer to the wrapper or NULL (memory allocation error)
+ */
+struct ipx_msg_ipfix *
+ipx_msg_pool_ipfix_get(ipx_msg_pool_t *pool, size_t rec_size);
+
+/**
+ * @brief Return an IPFIX Message wrapper into its pool
+ *
+ * The function is thread-safe and can be called by any thread. The wrapper must have been
+ * obtained by ipx_msg_pool_ipfix_get() and all its other resources (e.g. the raw packet)
+ * must be already freed.
+ * @param[in] msg Wrapper
+ */
+void
+ipx_msg_pool_ipfix_put(struct ipx_msg_ipfix *msg);
+
+/**
+ * @brief Move an IPFIX Message wrapper into a bigger memory block
+ *
+ * The content of the wrapper (including all valid records) is copied into a newly allocated
+ * memory block, which also belongs to the pool, and the original wrapper is returned into the
+ * pool. The function is thread-safe and can be called by any thread that owns the wrapper.
+ * @param[in] msg  Wrapper
+ * @param[in] size Size of the new memory block (must be able to hold all valid records)
+ * @return Pointer to the new wrapper or NULL (memory allocation error, the original wrapper
+ *   is unchanged)
+ */
+struct ipx_msg_ipfix *
+ipx_msg_pool_ipfix_move(struct ipx_msg_ipfix *msg, size_t size);
+
+/**
+ * @brief Get statistics of the pool
+ * @param[in]  pool  Pool
+ * @param[out] stats Statistics
+ */
+void
+ipx_msg_pool_stats_get(const ipx_msg_pool_t *pool, struct ipx_msg_pool_stats *stats);
+
+#endif // IPFIXCOL_MESSAGE_POOL_H
@@ -0,0 +1,440 @@
+/**
+ * @file
+ * @brief Registry of metrics of the collector (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "metrics.h"
+#include "verbose.h"
+
+#ifndef IPX_CLINE_SIZE
+/** Expected CPU cache-line size        */
+#define IPX_CLINE_SIZE 64
+#endif
+
+/** Number of cells of each counter (threads are distributed among them) */
+#define METRIC_CELLS 8U
+
+/** Internal identification of the module */
+static const char *module = "Metrics";
+
+/** Part of a counter updated by a subset of threads (padded to a cache line) */
+struct metric_cell {
+    /** Value */
+    uint64_t value;
+} __attribute__((__aligned__(IPX_CLINE_SIZE)));
+
+/** Metric */
+struct ipx_metric {
+    /** Family of the metric                                              */
+    struct metric_family *family;
+    /** Next metric of the same family                                    */
+    struct ipx_metric *next;
+    /** Rendered labels (e.g. 'name="value",name2="value2"' or empty)     */
+    char *labels;
+    /** Value provider (NULL if the value is stored)                      */
+    ipx_metric_cb cb;
+    /** Argument of the value provider                                    */
+    const void *cb_arg;
+    /** Value of a gauge                                                  */
+    int64_t gauge;
+    /** Cells of a counter (NULL for other types)                         */
+    struct metric_cell *cells;
+};
+
+/** Metrics of the same name */
+struct metric_family {
+    /** Name                                                              */
+    char *name;
+    /** Description                                                       */
+    char *help;
+    /** Type of all metrics of the family                                 */
+    enum ipx_metric_type type;
+    /** Metrics (in order of creation)                                    */
+    struct ipx_metric *metrics;
+    /** Next family                                                       */
+    struct metric_family *next;
+};
+
+/** Registry of all metrics */
+static struct {
+    /** Protects the lists of families and metrics (not values)           */
+    pthread_mutex_t lock;
+    /** Families (in order of creation)                                   */
+    struct metric_family *families;
+} registry = {PTHREAD_MUTEX_INITIALIZER, NULL};
+
+/** Counter cell of the current thread (index + 1, 0 = not assigned yet) */
+static _Thread_local unsigned int cell_idx = 0;
+/** Index of the cell for the next thread */
+static unsigned int cell_next = 0;
+
+/**
+ * @brief Check if a name of a metric or a label is valid
+ * @param[in] name  Name
+ * @param[in] colon Allow colons (only names of metrics)
+ * @return True or false
+ */
+static bool
+metric_name_valid(const char *name, bool colon)
+{
+    if (name == NULL || *name == '\0' || (*name >= '0' && *name <= '9')) {
+        return false;
+    }
+
+    for (const char *c = name; *c != '\0'; ++c) {
+        bool valid = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z')
+            || (*c >= '0' && *c <= '9') || *c == '_' || (colon && *c == ':');
+        if (!valid) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write a string with escaped backslashes, newlines and (optionally) double quotes
+ * @param[in] out   Output stream
+ * @param[in] str   String
+ * @param[in] quote Escape double quotes
+ */
+static void
+metric_escape(FILE *out, const char *str, bool quote)
+{
+    for (const char *c = str; *c != '\0'; ++c) {
+        switch (*c) {
+        case '\\':
+            fputs("\\\\", out);
+            break;
+        case '\n':
+            fputs("\\n", out);
+            break;
+        case '"':
+            fputs(quote ? "\\\"" : "\"", out);
+            break;
+        default:
+            fputc(*c, out);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Render labels
+ * @param[in] labels NULL terminated array of name and value pairs (can be NULL)
+ * @return Rendered labels (empty if there are no labels) or NULL (invalid name of a label or
+ *   memory allocation error)
+ */
+static char *
+metric_labels_render(const char *const *labels)
+{
+    char *res = NULL;
+    size_t res_size = 0;
+    FILE *out = open_memstream(&res, &res_size);
+    if (!out) {
+        return NULL;
+    }
+
+    bool valid = true;
+    for (size_t i = 0; labels != NULL && labels[i] != NULL; i += 2) {
+        const char *name = labels[i];
+        const char *value = labels[i + 1];
+        if (!metric_name_valid(name, false) || value == NULL) {
+            valid = false;
+            break;
+        }
+
+        fprintf(out, "%s%s=\"", (i == 0) ? "" : ",", name);
+        metric_escape(out, value, true);
+        fputc('"', out);
+    }
+
+    if (fclose(out) != 0 || !valid) {
+        free(res);
+        return NULL;
+    }
+
+    return res;
+}
+
+/**
+ * @brief Find a family of metrics (or create a new one)
+ * @warning The registry MUST be locked.
+ * @param[in] type Type of metrics
+ * @param[in] name Name of metrics
+ * @param[in] help Description of metrics
+ * @return Pointer to the family or NULL (type conflict or memory allocation error)
+ */
+static struct metric_family *
+metric_family_get(enum ipx_metric_type type, const char *name, const char *help)
+{
+    struct metric_family **next = &registry.families;
+    for (; *next != NULL; next = &(*next)->next) {
+        struct metric_family *family = *next;
+        if (strcmp(family->name, name) != 0) {
+            continue;
+        }
+
+        if (family->type != type) {
+            IPX_ERROR(module, "Metric '%s' already exists with a different type!", name);
+            return NULL;
+        }
+        return family;
+    }
+
+    struct metric_family *family = calloc(1, sizeof(*family));
+    if (!family) {
+        return NULL;
+    }
+
+    family->name = strdup(name);
+    family->help = strdup((help != NULL) ? help : "");
+    if (!family->name || !family->help) {
+        free(family->name);
+        free(family->help);
+        free(family);
+        return NULL;
+    }
+
+    family->type = type;
+    *next = family;
+    return family;
+}
+
+/**
+ * @brief Remove a family of metrics from the registry and free it
+ * @warning The registry MUST be locked and the family MUST be empty.
+ * @param[in] family Family
+ */
+static void
+metric_family_remove(struct metric_family *family)
+{
+    assert(family->metrics == NULL);
+    struct metric_family **next = &registry.families;
+    while (*next != family) {
+        next = &(*next)->next;
+    }
+
+    *next = family->next;
+    free(family->name);
+    free(family->help);
+    free(family);
+}
+
+/**
+ * @brief Free a metric (without removing it from the registry)
+ * @param[in] metric Metric
+ */
+static void
+metric_free(struct ipx_metric *metric)
+{
+    free(metric->cells);
+    free(metric->labels);
+    free(metric);
+}
+
+ipx_metric_t *
+ipx_metric_create_cb(enum ipx_metric_type type, const char *name, const char *help,
+    const char *const *labels, ipx_metric_cb cb, const void *arg)
+{
+    if (!metric_name_valid(name, true)) {
+        IPX_ERROR(module, "Invalid name of a metric '%s'!", (name != NULL) ? name : "(null)");
+        return NULL;
+    }
+
+    struct ipx_metric *metric = calloc(1, sizeof(*metric));
+    if (!metric) {
+        return NULL;
+    }
+
+    metric->labels = metric_labels_render(labels);
+    if (!metric->labels) {
+        IPX_ERROR(module, "Failed to create labels of the metric '%s'!", name);
+        free(metric);
+        return NULL;
+    }
+
+    if (type == IPX_METRIC_COUNTER && cb == NULL) {
+        const size_t size = METRIC_CELLS * sizeof(*metric->cells);
+        metric->cells = aligned_alloc(IPX_CLINE_SIZE, size);
+        if (!metric->cells) {
+            metric_free(metric);
+            return NULL;
+        }
+        memset(metric->cells, 0, size);
+    }
+
+    metric->cb = cb;
+    metric->cb_arg = arg;
+
+    pthread_mutex_lock(&registry.lock);
+    struct metric_family *family = metric_family_get(type, name, help);
+    if (!family) {
+        pthread_mutex_unlock(&registry.lock);
+        metric_free(metric);
+        return NULL;
+    }
+
+    struct ipx_metric **next = &family->metrics;
+    while (*next != NULL) {
+        next = &(*next)->next;
+    }
+    *next = metric;
+    metric->family = family;
+    pthread_mutex_unlock(&registry.lock);
+    return metric;
+}
+
+ipx_metric_t *
+ipx_metric_create(enum ipx_metric_type type, const char *name, const char *help,
+    const char *const *labels)
+{
+    return ipx_metric_create_cb(type, name, help, labels, NULL, NULL);
+}
+
+void
+ipx_ctx_metric_destroy(ipx_metric_t *metric)
+{
+    if (!metric) {
+        return;
+    }
+
+    pthread_mutex_lock(&registry.lock);
+    struct metric_family *family = metric->family;
+    struct ipx_metric **next = &family->metrics;
+    while (*next != metric) {
+        next = &(*next)->next;
+    }
+
+    *next = metric->next;
+    if (family->metrics == NULL) {
+        metric_family_remove(family);
+    }
+    pthread_mutex_unlock(&registry.lock);
+
+    metric_free(metric);
+}
+
+void
+ipx_ctx_metric_add(ipx_metric_t *metric, uint64_t value)
+{
+    if (!metric) {
+        // Failed to create the metric
+        return;
+    }
+
+    if (!metric->cells) {
+        assert(metric->cb == NULL && "Value of the metric is provided by a callback!");
+        __atomic_add_fetch(&metric->gauge, (int64_t) value, __ATOMIC_RELAXED);
+        return;
+    }
+
+    unsigned int idx = cell_idx;
+    if (idx == 0) {
+        // The first update by this thread
+        idx = (__atomic_fetch_add(&cell_next, 1U, __ATOMIC_RELAXED) % METRIC_CELLS) + 1;
+        cell_idx = idx;
+    }
+
+    // Usually, no other thread updates the same cell, so the cache line is not shared
+    __atomic_add_fetch(&metric->cells[idx - 1].value, value, __ATOMIC_RELAXED);
+}
+
+void
+ipx_ctx_metric_set(ipx_metric_t *metric, int64_t value)
+{
+    if (!metric) {
+        // Failed to create the metric
+        return;
+    }
+
+    assert(metric->family->type == IPX_METRIC_GAUGE && metric->cb == NULL);
+    __atomic_store_n(&metric->gauge, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Write a value of a metric
+ * @param[in] out    Output stream
+ * @param[in] metric Metric
+ */
+static void
+metric_value_write(FILE *out, const struct ipx_metric *metric)
+{
+    if (metric->cb != NULL) {
+        fprintf(out, "%" PRIu64, metric->cb(metric->cb_arg));
+        return;
+    }
+
+    if (metric->cells != NULL) {
+        // Aggregate the counter
+        uint64_t sum = 0;
+        for (unsigned int i = 0; i < METRIC_CELLS; ++i) {
+            sum += __atomic_load_n(&metric->cells[i].value, __ATOMIC_RELAXED);
+        }
+        fprintf(out, "%" PRIu64, sum);
+        return;
+    }
+
+    fprintf(out, "%" PRId64, __atomic_load_n(&metric->gauge, __ATOMIC_RELAXED));
+}
+
+int
+ipx_metrics_write(FILE *out)
+{
+    pthread_mutex_lock(&registry.lock);
+    for (const struct metric_family *family = registry.families; family != NULL;
+            family = family->next) {
+        fprintf(out, "# HELP %s ", family->name);
+        metric_escape(out, family->help, false);
+        fprintf(out, "\n# TYPE %s %s\n", family->name,
+            (family->type == IPX_METRIC_COUNTER) ? "counter" : "gauge");
+
+        for (const struct ipx_metric *metric = family->metrics; metric != NULL;
+                metric = metric->next) {
+            if (metric->labels[0] != '\0') {
+                fprintf(out, "%s{%s} ", family->name, metric->labels);
+            } else {
+                fprintf(out, "%s ", family->name);
+            }
+            metric_value_write(out, metric);
+            fputc('\n', out);
+        }
+    }
+    pthread_mutex_unlock(&registry.lock);
+
+    return ferror(out) ? IPX_ERR_DENIED : IPX_OK;
+}
+
+void
+ipx_metrics_cleanup()
+{
+    pthread_mutex_lock(&registry.lock);
+    struct metric_family *family = registry.families;
+    registry.families = NULL;
+    pthread_mutex_unlock(&registry.lock);
+
+    while (family != NULL) {
+        struct metric_family *family_next = family->next;
+        struct ipx_metric *metric = family->metrics;
+        while (metric != NULL) {
+            struct ipx_metric *metric_next = metric->next;
+            metric_free(metric);
+            metric = metric_next;
+        }
+
+        free(family->name);
+        free(family->help);
+        free(family);
+        family = family_next;
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Registry of metrics of the collector (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_METRICS_H
+#define IPFIXCOL_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <ipfixcol2.h>
+
+/** Prefix of names of all metrics */
+#define IPX_METRIC_PREFIX "ipfixcol2_"
+
+/**
+ * @brief Callback that provides the current value of a metric
+ * @param[in] arg User defined argument
+ * @return Current value
+ */
+typedef uint64_t (*ipx_metric_cb)(const void *arg);
+
+/**
+ * @brief Create a metric and add it to the registry
+ *
+ * @note Unlike ipx_ctx_metric_create(), the name is used as is (i.e. including the prefix).
+ * @param[in] type   Type of the metric
+ * @param[in] name   Name of the metric
+ * @param[in] help   Description of the metric
+ * @param[in] labels NULL terminated array of label name and value pairs (can be NULL)
+ * @return Pointer to the metric or NULL (invalid name, type conflict or memory allocation
+ *   error)
+ */
+ipx_metric_t *
+ipx_metric_create(enum ipx_metric_type type, const char *name, const char *help,
+    const char *const *labels);
+
+/**
+ * @brief Create a metric whose value is provided by a callback and add it to the registry
+ *
+ * The callback is called (from any thread) only when the metrics are exposed, so it must be
+ * thread-safe. The metric MUST be destroyed before the argument of the callback.
+ * @param[in] type   Type of the metric
+ * @param[in] name   Name of the metric
+ * @param[in] help   Description of the metric
+ * @param[in] labels NULL terminated array of label name and value pairs (can be NULL)
+ * @param[in] cb     Callback
+ * @param[in] arg    Argument of the callback
+ * @return Pointer to the metric or NULL (invalid name, type conflict or memory allocation
+ *   error)
+ */
+ipx_metric_t *
+ipx_metric_create_cb(enum ipx_metric_type type, const char *name, const char *help,
+    const char *const *labels, ipx_metric_cb cb, const void *arg);
+
+/**
+ * @brief Write all metrics in the Prometheus text exposition format
+ * @param[in] out Output stream
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED if the write failed
+ */
+int
+ipx_metrics_write(FILE *out);
+
+/**
+ * @brief Destroy all remaining metrics
+ * @warning No metric can be used after this call.
+ */
+void
+ipx_metrics_cleanup();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IPFIXCOL_METRICS_H
@@ -0,0 +1,356 @@
+/**
+ * @file
+ * @brief HTTP endpoint exposing metrics of the collector (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "metrics_server.h"
+#include "verbose.h"
+
+/** Default listening host (only local access)  */
+#define SERVER_DEF_HOST "127.0.0.1"
+/** Maximum size of a request (only the request line is needed) */
+#define SERVER_REQ_SIZE 1024U
+/** Timeout of receiving a request and sending a response (seconds) */
+#define SERVER_TIMEOUT 1
+
+/** Internal identification of the module */
+static const char *module = "Metrics server";
+
+/** Global instance of the server */
+static struct {
+    /** Thread of the server                    */
+    pthread_t thread;
+    /** Listening socket (-1 if not running)    */
+    int fd_listen;
+    /** Pipe for stopping the thread ([0] read end, [1] write end) */
+    int fd_stop[2];
+} server = {.fd_listen = -1, .fd_stop = {-1, -1}};
+
+/**
+ * @brief Parse a listening address
+ *
+ * @param[in]  addr Address in the format "PORT", "HOST:PORT" or "[IPv6]:PORT"
+ * @param[out] host Newly allocated host
+ * @param[out] port Pointer to the port (within @p addr)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_ARG if the address is not valid
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+server_addr_parse(const char *addr, char **host, const char **port)
+{
+    const char *host_begin = SERVER_DEF_HOST;
+    size_t host_len = strlen(SERVER_DEF_HOST);
+    const char *sep = strrchr(addr, ':');
+
+    if (addr[0] == '[') {
+        // IPv6 address in brackets
+        const char *end = strchr(addr, ']');
+        if (!end || end[1] != ':') {
+            return IPX_ERR_ARG;
+        }
+
+        host_begin = addr + 1;
+        host_len = (size_t) (end - host_begin);
+        *port = end + 2;
+    } else if (sep != NULL) {
+        host_begin = addr;
+        host_len = (size_t) (sep - addr);
+        *port = sep + 1;
+    } else {
+        *port = addr;
+    }
+
+    if (host_len == 0 || (*port)[0] == '\0') {
+        return IPX_ERR_ARG;
+    }
+
+    *host = strndup(host_begin, host_len);
+    return (*host != NULL) ? IPX_OK : IPX_ERR_NOMEM;
+}
+
+/**
+ * @brief Create a listening socket
+ * @param[in] host Host
+ * @param[in] port Port
+ * @return Socket or -1 on failure
+ */
+static int
+server_listen(const char *host, const char *port)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *result;
+    int rc = getaddrinfo(host, port, &hints, &result);
+    if (rc != 0) {
+        IPX_ERROR(module, "Failed to resolve '%s' (port %s): %s", host, port, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *it = result; it != NULL; it = it->ai_next) {
+        fd = socket(it->ai_family, it->ai_socktype | SOCK_CLOEXEC, it->ai_protocol);
+        if (fd == -1) {
+            continue;
+        }
+
+        int yes = 1;
+        (void) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (bind(fd, it->ai_addr, it->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+            break;
+        }
+
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(module, "Failed to listen on '%s' (port %s): %s", host, port, err_str);
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(result);
+    return fd;
+}
+
+/**
+ * @brief Send a whole buffer to a client
+ * @param[in] fd   Socket of the client
+ * @param[in] data Data to send
+ * @param[in] size Size of the data
+ * @return True on success, false otherwise
+ */
+static bool
+server_send(int fd, const char *data, size_t size)
+{
+    while (size > 0) {
+        ssize_t rc = send(fd, data, size, MSG_NOSIGNAL);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (rc <= 0) {
+            return false;
+        }
+
+        data += rc;
+        size -= (size_t) rc;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Send a response with all metrics
+ * @param[in] fd Socket of the client
+ */
+static void
+server_respond_metrics(int fd)
+{
+    static const char *hdr_fmt = "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Connection: close\r\n\r\n";
+
+    char *body = NULL;
+    size_t body_size = 0;
+    FILE *out = open_memstream(&body, &body_size);
+    if (!out) {
+        IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+
+    int rc = ipx_metrics_write(out);
+    fclose(out);
+    if (rc != IPX_OK) {
+        IPX_ERROR(module, "Failed to format metrics!", '\0');
+        free(body);
+        return;
+    }
+
+    char hdr[256];
+    int hdr_size = snprintf(hdr, sizeof(hdr), hdr_fmt, body_size);
+    if (server_send(fd, hdr, (size_t) hdr_size)) {
+        (void) server_send(fd, body, body_size);
+    }
+
+    free(body);
+}
+
+/**
+ * @brief Handle a request of a client
+ *
+ * Only the request line is processed, the rest of the request is ignored.
+ * @param[in] fd Socket of the client
+ */
+static void
+server_handle(int fd)
+{
+    static const char *not_found = "HTTP/1.1 404 Not Found\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n\r\n";
+
+    struct timeval timeout = {.tv_sec = SERVER_TIMEOUT, .tv_usec = 0};
+    // A stalled client must not block the server (and its stop) forever
+    (void) setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    (void) setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Receive at least the request line
+    char req[SERVER_REQ_SIZE];
+    size_t req_size = 0;
+    while (req_size < sizeof(req) - 1) {
+        ssize_t rc = recv(fd, req + req_size, sizeof(req) - 1 - req_size, 0);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (rc <= 0) {
+            return;
+        }
+
+        req_size += (size_t) rc;
+        req[req_size] = '\0';
+        if (strstr(req, "\r\n") != NULL) {
+            break;
+        }
+    }
+
+    req[req_size] = '\0';
+    if (strncmp(req, "GET /metrics ", 13) == 0 || strncmp(req, "GET / ", 6) == 0) {
+        server_respond_metrics(fd);
+    } else {
+        (void) server_send(fd, not_found, strlen(not_found));
+    }
+}
+
+/**
+ * @brief Main function of the server thread
+ * @param[in] arg Unused
+ * @return Always NULL
+ */
+static void *
+server_main(void *arg)
+{
+    (void) arg;
+
+    struct pollfd fds[2] = {
+        {.fd = server.fd_listen, .events = POLLIN, .revents = 0},
+        {.fd = server.fd_stop[0], .events = POLLIN, .revents = 0}
+    };
+
+    while (true) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_ERROR(module, "poll() failed: %s", err_str);
+            break;
+        }
+
+        if (fds[1].revents != 0) {
+            // Stop request
+            break;
+        }
+
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int fd = accept(server.fd_listen, NULL, NULL);
+        if (fd == -1) {
+            continue;
+        }
+
+        server_handle(fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+int
+ipx_metrics_server_start(const char *addr)
+{
+    if (server.fd_listen != -1) {
+        return IPX_ERR_DENIED;
+    }
+
+    char *host;
+    const char *port;
+    int rc = server_addr_parse(addr, &host, &port);
+    if (rc == IPX_ERR_NOMEM) {
+        IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    } else if (rc != IPX_OK) {
+        IPX_ERROR(module, "Invalid listening address '%s'!", addr);
+        return IPX_ERR_ARG;
+    }
+
+    server.fd_listen = server_listen(host, port);
+    free(host);
+    if (server.fd_listen == -1) {
+        IPX_ERROR(module, "Failed to start the server on '%s'!", addr);
+        return IPX_ERR_DENIED;
+    }
+
+    if (pipe(server.fd_stop) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(module, "Failed to create a pipe: %s", err_str);
+        close(server.fd_listen);
+        server.fd_listen = -1;
+        return IPX_ERR_DENIED;
+    }
+
+    rc = pthread_create(&server.thread, NULL, &server_main, NULL);
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_ERROR(module, "Failed to start a thread of the server: %s", err_str);
+        close(server.fd_stop[0]);
+        close(server.fd_stop[1]);
+        close(server.fd_listen);
+        server.fd_stop[0] = server.fd_stop[1] = server.fd_listen = -1;
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_INFO(module, "Listening for HTTP requests of metrics on '%s'", addr);
+    return IPX_OK;
+}
+
+void
+ipx_metrics_server_stop()
+{
+    if (server.fd_listen == -1) {
+        return;
+    }
+
+    // Wake up the thread
+    close(server.fd_stop[1]);
+    pthread_join(server.thread, NULL);
+
+    close(server.fd_stop[0]);
+    close(server.fd_listen);
+    server.fd_stop[0] = server.fd_stop[1] = server.fd_listen = -1;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief HTTP endpoint exposing metrics of the collector (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_METRICS_SERVER_H
+#define IPFIXCOL_METRICS_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start a server exposing all metrics in the Prometheus text format
+ *
+ * The server runs in its own thread and responds to HTTP GET requests of "/metrics" (or "/").
+ * Only one request is handled at a time, as the endpoint is supposed to be scraped
+ * periodically by a monitoring system.
+ *
+ * @param[in] addr Listening address in the format "PORT", "HOST:PORT" or "[IPv6]:PORT"
+ *   (if the host is not specified, the server listens only on 127.0.0.1)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_ARG if the address is not valid
+ * @return #IPX_ERR_DENIED if the server failed to start
+ */
+int
+ipx_metrics_server_start(const char *addr);
+
+/**
+ * @brief Stop the server (if running)
+ */
+void
+ipx_metrics_server_stop();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IPFIXCOL_METRICS_SERVER_H
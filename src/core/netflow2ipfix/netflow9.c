@@ -1200,6 +1200,15 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
         return IPX_ERR_FORMAT;
     }
 
+    /* Allocate the new IPFIX Message at once. Converted records are usually a little bit longer
+     * (e.g. relative timestamps are replaced with absolute ones), but hardly ever more than
+     * twice as long, therefore, the buffer is usually not reallocated during conversion.
+     */
+    if (conv_mem_reserve(conv, 2U * (size_t) nf9_size) != IPX_OK) {
+        CONV_ERROR(conv, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
     // Check Sequence number
     uint32_t msg_seq = ntohl(nf9_hdr->seq_number);
     CONV_DEBUG(conv, "Converting a NetFlow Message v9 (seq. num. %" PRIu32 ") to an IPFIX Message "
@@ -1265,8 +1274,7 @@ ipx_nf9_conv_process(ipx_nf9_conv_t *conv, ipx_msg_ipfix_t *wrapper)
     conv->ipx_seq_next += conv->data.drecs_converted;
 
     // Finally, replace the converted NetFlow Message with the new IPFIX Message
-    free(wrapper->raw_pkt);
-    wrapper->raw_pkt = conv_mem_release(conv);
+    ipx_msg_ipfix_raw_replace(wrapper, conv_mem_release(conv));
     wrapper->raw_size = (uint16_t) ipx_size;
     return IPX_OK;
 }
@@ -39,6 +39,7 @@
  *
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
 #include <libfds.h>
@@ -49,13 +50,22 @@
 #include "parser.h"
 #include "verbose.h"
 #include "fpipe.h"
+#include "metrics.h"
 #include "netflow2ipfix/netflow2ipfix.h"
 #include "netflow2ipfix/netflow_structs.h"
 
 /** Default record of the parser structure */
 #define PARSER_DEF_RECS 8
+/** Default size of the index of parser records (MUST be a power of two, at least 2x records) */
+#define PARSER_DEF_INDEX (2 * PARSER_DEF_RECS)
+/** Invalid position of a record (e.g. no last hit) */
+#define PARSER_NO_REC SIZE_MAX
 /** Default record of the stream structure */
 #define STREAM_DEF_RECS 1
+/** Maximum number of Data Records pre-allocated at once based on an estimation */
+#define PARSER_RESERVE_MAX 4096U
+/** Number of entries of the Set ID to Template cache (MUST be a power of two) */
+#define TCACHE_SIZE 16U
 
 /** Auxiliary flags specific to each Stream ID within a Stream context */
 enum stream_info_flags {
@@ -111,10 +121,28 @@ struct stream_ctx {
         ipx_nf9_conv_t *nf9;
     } converter;
 
+    struct {
+        /**
+         * Snapshot to which the cached Templates belong (NULL = empty cache)
+         * \note Snapshots are freed only as garbage of the Template manager, therefore, the
+         *   cache MUST be flushed whenever the garbage is taken from the manager.
+         */
+        const fds_tsnapshot_t *snap;
+        /** Direct-mapped entries (indexed by lower bits of the Set ID)              */
+        struct {
+            /** Set ID (0 = empty entry)                                             */
+            uint16_t id;
+            /** Template                                                             */
+            const struct fds_template *tmplt;
+        } items[TCACHE_SIZE];
+    } tcache; /**< Cache of recently used Templates (see parser_template_get())      */
+
     /** Number of pre-allocated stream records    */
     size_t infos_alloc;
     /** Number of valid stream records            */
     size_t infos_valid;
+    /** Position of the last found stream record (see stream_ctx_rec_find()) */
+    size_t infos_last;
     /** Array of sorted information about Streams */
     struct stream_info infos[1];
 };
@@ -131,6 +159,11 @@ struct parser_rec {
 
     /** Context common for all streams            */
     struct stream_ctx *ctx;
+
+    /** Metric of sequence number gaps (created on the first gap) */
+    ipx_metric_t *seq_gaps;
+    /** Metric of lost Data Records (created on the first gap)    */
+    ipx_metric_t *seq_lost;
 };
 
 /** Main structure of IPFIX message parser         */
@@ -147,8 +180,21 @@ struct ipx_parser {
     size_t recs_alloc;
     /** Number of valid records                    */
     size_t recs_valid;
-    /** Array of records                           */
+    /** Array of records (unordered)               */
     struct parser_rec *recs;
+    /** Position of the last found record (or #PARSER_NO_REC) */
+    size_t recs_last;
+
+    /**
+     * Hash index of the records (open addressing with linear probing)
+     * \note Each slot contains a position of a record in the array + 1 (0 = empty slot)
+     */
+    size_t *index;
+    /** Number of slots in the index (power of two)  */
+    size_t index_size;
+
+    /** Statistics                                 */
+    struct ipx_parser_stats stats;
 };
 
 /**
@@ -229,6 +275,7 @@ stream_ctx_create(const struct ipx_parser *parser, const struct ipx_session *ses
     }
     ctx->infos_alloc = STREAM_DEF_RECS;
     ctx->infos_valid = 0;
+    ctx->infos_last = 0;
     ctx->flags = 0;
     ctx->type = ST_UNKNOWN; // type of flows is unknown
 
@@ -278,35 +325,47 @@ stream_ctx_destroy(struct stream_ctx *ctx)
 }
 
 /**
- * \brief Compare two stream_info structures
- * \param[in] p1 First structure
- * \param[in] p2 Second structure
- * \return An integer less than, equal to, or greater than zero if the first argument is considered
- *   to be respectively less than, equal to, or greater than the second.
+ * \brief Flush the cache of Templates of a stream context
+ *
+ * MUST be called whenever garbage (i.e. old snapshots and Templates) is taken from the
+ * Template manager of the context.
+ * \param[in] ctx Stream context
  */
-static int
-stream_ctx_rec_cmp(const void *p1, const void *p2)
+static inline void
+stream_ctx_tcache_flush(struct stream_ctx *ctx)
 {
-    const struct stream_info *stream_l = p1;
-    const struct stream_info *stream_r = p2;
-
-    if (stream_l->id == stream_r->id) {
-        return 0;
-    } else {
-        return (stream_l->id < stream_r->id) ? (-1) : 1;
-    }
+    ctx->tcache.snap = NULL;
 }
 
 /**
- * \brief Sort an array of records within a stream_ctx structure
- * \param[in] ctx Stream context
+ * \brief Find a position of a stream_info record in a sorted array within a stream context
+ * \param[in]  ctx Stream context structure
+ * \param[in]  id  Stream ID
+ * \param[out] pos Position of the record (if found) or position where it should be inserted
+ * \return True if the record has been found, false otherwise.
  */
-static void
-stream_ctx_rec_sort(struct stream_ctx *ctx)
+static bool
+stream_ctx_rec_pos(const struct stream_ctx *ctx, ipx_stream_t id, size_t *pos)
 {
-    const size_t rec_size = sizeof(*ctx->infos);
-    const size_t rec_cnt = ctx->infos_valid;
-    qsort(ctx->infos, rec_cnt, rec_size, &stream_ctx_rec_cmp);
+    size_t low = 0;
+    size_t high = ctx->infos_valid;
+
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (ctx->infos[mid].id == id) {
+            *pos = mid;
+            return true;
+        }
+
+        if (ctx->infos[mid].id < id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    *pos = low;
+    return false;
 }
 
 /**
@@ -319,22 +378,18 @@ stream_ctx_rec_sort(struct stream_ctx *ctx)
 static struct stream_info *
 stream_ctx_rec_find(struct stream_ctx *ctx, ipx_stream_t id)
 {
-    if (ctx->infos_valid == 0) {
-        return NULL;
+    // Consecutive messages usually belong to the same stream (TCP and UDP use only stream 0)
+    if (ctx->infos_last < ctx->infos_valid && ctx->infos[ctx->infos_last].id == id) {
+        return &ctx->infos[ctx->infos_last];
     }
 
-    // TCP and UDP works only with stream 0 and the array is always sorted...
-    if (ctx->infos[0].id == id) {
-        return &ctx->infos[0];
+    size_t pos;
+    if (!stream_ctx_rec_pos(ctx, id, &pos)) {
+        return NULL;
     }
 
-    // Find manually
-    const size_t rec_size = sizeof(*ctx->infos);
-    const size_t rec_cnt = ctx->infos_valid;
-
-    struct stream_info key;
-    key.id = id;
-    return bsearch(&key, ctx->infos, rec_cnt, rec_size, &stream_ctx_rec_cmp);
+    ctx->infos_last = pos;
+    return &ctx->infos[pos];
 }
 
 /**
@@ -369,54 +424,165 @@ stream_ctx_rec_get(struct stream_ctx **ctx, ipx_stream_t id)
         *ctx = ctx_new;
     }
 
-    // Create a new record, sort and return the record
-    info = &(*ctx)->infos[(*ctx)->infos_valid++];
+    // Insert a new record to keep the array sorted
+    size_t pos;
+    bool found = stream_ctx_rec_pos(*ctx, id, &pos);
+    assert(!found);
+    (void) found;
+
+    info = &(*ctx)->infos[pos];
+    const size_t move_cnt = (*ctx)->infos_valid - pos;
+    memmove(info + 1, info, move_cnt * sizeof(*info));
+    (*ctx)->infos_valid++;
+    (*ctx)->infos_last = pos;
+
     info->id = id;
     info->seq_num = 0;
     info->flags = 0;
-
-    stream_ctx_rec_sort(*ctx);
-    // Position has been changed... find it again
-    info = stream_ctx_rec_find(*ctx, id);
-    assert(info != NULL);
     return info;
 }
 
 /**
- * \brief Compare two parser_rec structures
- * \param[in] rec1 First structure
- * \param[in] rec2 Second structure
- * \return An integer less than, equal to, or greater than zero if the first argument is considered
- *   to be respectively less than, equal to, or greater than the second.
+ * \brief Get a hash of a parser record key
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \return Hash value
+ */
+static inline size_t
+parser_rec_hash(const struct ipx_session *session, uint32_t odid)
+{
+    // Mix bits of the address and ODID (a finalizer of MurmurHash3)
+    uint64_t hash = ((uint64_t) (uintptr_t) session) ^ ((uint64_t) odid << 32);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return (size_t) hash;
+}
+
+/**
+ * \brief Find a slot of the index with a parser record or an empty slot where it belongs
+ * \param[in] parser  Parser structure
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \return Position of the slot
+ */
+static size_t
+parser_index_slot(const struct ipx_parser *parser, const struct ipx_session *session,
+    uint32_t odid)
+{
+    const size_t mask = parser->index_size - 1;
+    size_t slot = parser_rec_hash(session, odid) & mask;
+
+    while (parser->index[slot] != 0) {
+        const struct parser_rec *rec = &parser->recs[parser->index[slot] - 1];
+        if (rec->session == session && rec->odid == odid) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * \brief Rebuild the index of parser records with a new number of slots
+ * \param[in] parser Parser structure
+ * \param[in] size   New number of slots (power of two, greater than number of records)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred (the index is untouched)
  */
 static int
-parser_rec_cmp(const void *rec1, const void *rec2)
+parser_index_rebuild(struct ipx_parser *parser, size_t size)
 {
-    const struct parser_rec *rec_l = rec1;
-    const struct parser_rec *rec_r = rec2;
+    assert((size & (size - 1)) == 0 && size > parser->recs_valid);
+    size_t *index_new = calloc(size, sizeof(*index_new));
+    if (!index_new) {
+        return IPX_ERR_NOMEM;
+    }
+
+    free(parser->index);
+    parser->index = index_new;
+    parser->index_size = size;
 
-    // Array MUST be sorted primary by Transport Session
-    if (rec_l->session != rec_r->session) {
-        return (rec_l->session < rec_r->session) ? (-1) : 1;
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        const struct parser_rec *rec = &parser->recs[idx];
+        const size_t slot = parser_index_slot(parser, rec->session, rec->odid);
+        assert(parser->index[slot] == 0);
+        parser->index[slot] = idx + 1;
     }
 
-    if (rec_l->odid == rec_r->odid) {
-        return 0;
+    return IPX_OK;
+}
+
+/**
+ * \brief Remove a slot from the index of parser records
+ *
+ * Following records in the same cluster are shifted back, so no tombstones are necessary.
+ * \param[in] parser Parser structure
+ * \param[in] slot   Slot to remove
+ */
+static void
+parser_index_remove(struct ipx_parser *parser, size_t slot)
+{
+    const size_t mask = parser->index_size - 1;
+    size_t next = slot;
+
+    while (true) {
+        next = (next + 1) & mask;
+        if (parser->index[next] == 0) {
+            break;
+        }
+
+        // Can the record be moved to the free slot? (i.e. its home is not in (slot, next])
+        const struct parser_rec *rec = &parser->recs[parser->index[next] - 1];
+        const size_t home = parser_rec_hash(rec->session, rec->odid) & mask;
+        const bool keep = (slot <= next)
+            ? (slot < home && home <= next)
+            : (slot < home || home <= next);
+        if (keep) {
+            continue;
+        }
+
+        parser->index[slot] = parser->index[next];
+        slot = next;
     }
 
-    return (rec_l->odid < rec_r->odid) ? (-1) : 1;
+    parser->index[slot] = 0;
 }
 
 /**
- * \brief Sort an array of parser records
- * \param parser Parser structure
+ * \brief Remove a parser record from the parser
+ *
+ * The last record is moved to the position of the removed one.
+ * \warning Stream context of the record is NOT freed!
+ * \param[in] parser Parser structure
+ * \param[in] idx    Position of the record
  */
 static void
-parser_rec_sort(struct ipx_parser *parser)
+parser_rec_remove(struct ipx_parser *parser, size_t idx)
 {
-    const size_t rec_cnt = parser->recs_valid;
-    const size_t rec_size = sizeof(*parser->recs);
-    qsort(parser->recs, rec_cnt, rec_size, &parser_rec_cmp);
+    assert(idx < parser->recs_valid);
+    const struct parser_rec *rec = &parser->recs[idx];
+    ipx_ctx_metric_destroy(rec->seq_gaps);
+    ipx_ctx_metric_destroy(rec->seq_lost);
+    size_t slot = parser_index_slot(parser, rec->session, rec->odid);
+    assert(parser->index[slot] == idx + 1);
+    parser_index_remove(parser, slot);
+
+    const size_t last = parser->recs_valid - 1;
+    if (idx != last) {
+        // Move the last record to the free position
+        rec = &parser->recs[last];
+        slot = parser_index_slot(parser, rec->session, rec->odid);
+        assert(parser->index[slot] == last + 1);
+        parser->index[slot] = idx + 1;
+        parser->recs[idx] = parser->recs[last];
+    }
+
+    parser->recs_valid--;
+    parser->recs_last = PARSER_NO_REC;
 }
 
 /**
@@ -430,13 +596,21 @@ parser_rec_sort(struct ipx_parser *parser)
 static struct parser_rec *
 parser_rec_find(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
 {
-    const size_t rec_cnt = parser->recs_valid;
-    const size_t rec_size = sizeof(*parser->recs);
-    struct parser_rec key;
-    key.session = ctx->session;
-    key.odid = ctx->odid;
+    // Consecutive messages usually come from the same exporter
+    if (parser->recs_last < parser->recs_valid) {
+        struct parser_rec *rec = &parser->recs[parser->recs_last];
+        if (rec->session == ctx->session && rec->odid == ctx->odid) {
+            return rec;
+        }
+    }
 
-    return bsearch(&key, parser->recs, rec_cnt, rec_size, &parser_rec_cmp);
+    const size_t slot = parser_index_slot(parser, ctx->session, ctx->odid);
+    if (parser->index[slot] == 0) {
+        return NULL;
+    }
+
+    parser->recs_last = parser->index[slot] - 1;
+    return &parser->recs[parser->recs_last];
 }
 
 /**
@@ -470,10 +644,19 @@ parser_rec_get(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
         parser->recs_alloc = alloc_new;
     }
 
-    // Add a new record, sort and return it
-    rec = &parser->recs[parser->recs_valid];
+    // Keep the load factor of the index at most 50%
+    if (2 * (parser->recs_valid + 1) > parser->index_size
+            && parser_index_rebuild(parser, 2 * parser->index_size) != IPX_OK) {
+        return NULL;
+    }
+
+    // Add a new record
+    const size_t idx = parser->recs_valid;
+    rec = &parser->recs[idx];
     rec->session = ctx->session;
     rec->odid = ctx->odid;
+    rec->seq_gaps = NULL;
+    rec->seq_lost = NULL;
     rec->ctx = stream_ctx_create(parser, ctx->session);
     if (!rec->ctx) {
         return NULL;
@@ -481,14 +664,48 @@ parser_rec_get(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
 
     PARSER_INFO(parser, ctx, "New connection detected!", '\0');
 
+    const size_t slot = parser_index_slot(parser, ctx->session, ctx->odid);
+    assert(parser->index[slot] == 0);
+    parser->index[slot] = idx + 1;
     parser->recs_valid++;
-    parser_rec_sort(parser);
-    // Position has been changes... find it again
-    rec = parser_rec_find(parser, ctx);
-    assert(rec != NULL);
+    parser->recs_last = idx;
     return rec;
 }
 
+/**
+ * \brief Create metrics of sequence number gaps of a parser record (if not created yet)
+ *
+ * The metrics are created lazily, so only exporters with gaps are exposed. Failure to create
+ * them is not fatal (i.e. they are left NULL and updates of NULL metrics are ignored).
+ * \param[in] parser  Parser structure
+ * \param[in] rec     Parser record
+ * \param[in] msg_ctx IPFIX Message context (info about Transport Session, ODID)
+ */
+static void
+parser_rec_metrics(struct ipx_parser *parser, struct parser_rec *rec,
+    const struct ipx_msg_ctx *msg_ctx)
+{
+    if (rec->seq_gaps != NULL) {
+        return;
+    }
+
+    char odid[16];
+    snprintf(odid, sizeof(odid), "%" PRIu32, msg_ctx->odid);
+    const char *labels[] = {
+        "instance", parser->ident,
+        "exporter", msg_ctx->session->ident,
+        "odid", odid,
+        NULL
+    };
+
+    rec->seq_gaps = ipx_metric_create(IPX_METRIC_COUNTER,
+        IPX_METRIC_PREFIX "parser_sequence_gaps_total",
+        "IPFIX Messages with an unexpected Sequence number", labels);
+    rec->seq_lost = ipx_metric_create(IPX_METRIC_COUNTER,
+        IPX_METRIC_PREFIX "parser_lost_records_total",
+        "Data Records missing according to Sequence numbers", labels);
+}
+
 /** Auxiliary structure for garbage after Transport Session removal */
 struct session_gabage {
     /** Number of records */
@@ -517,48 +734,74 @@ session_garbage_destroy(struct session_gabage *grb)
 }
 
 /**
- * \brief Create a garbage message with selected parser records
+ * \brief Move all parser records of a Transport Session into a garbage message
  *
- * \warning Selected records remains in the parser. They must be removed manually.
- * \param[in] parser Parser
- * \param[in] begin  Index of the first record to be included
- * \param[in] end    Index of "past-the-last" record to be included
- * \return Pointer or NULL (memory allocation error)
+ * \note If a memory allocation fails, the records are removed anyway, but stream contexts
+ *   cannot be freed because someone still could use them. (This will cause a memory leak but
+ *   its better that segfault!)
+ * \param[in]  parser  Parser
+ * \param[in]  session Transport Session
+ * \param[out] garbage Garbage message (NULL in case of a memory allocation error)
+ * \return Number of removed records
  */
-static ipx_msg_garbage_t *
-parser_rec_to_garbage(struct ipx_parser *parser, size_t begin, size_t end)
+static size_t
+parser_rec_to_garbage(struct ipx_parser *parser, const struct ipx_session *session,
+    ipx_msg_garbage_t **garbage)
 {
-    assert(begin < end);
+    *garbage = NULL;
+
+    // Count records of the session
+    size_t rec_cnt = 0;
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        if (parser->recs[idx].session == session) {
+            rec_cnt++;
+        }
+    }
+
+    if (rec_cnt == 0) {
+        return 0;
+    }
 
     // Prepare data structures
-    struct session_gabage *garbage = malloc(sizeof(*garbage));
-    if (!garbage) {
-        return NULL;
+    struct session_gabage *grb = malloc(sizeof(*grb));
+    struct stream_ctx **grb_recs = malloc(rec_cnt * sizeof(*grb_recs));
+    if (!grb || !grb_recs) {
+        free(grb_recs);
+        free(grb);
+        grb = NULL;
     }
 
-    garbage->rec_cnt = end - begin;
-    garbage->recs = malloc(garbage->rec_cnt * sizeof(*garbage->recs));
-    if (!garbage->recs) {
-        free(garbage);
-        return NULL;
+    /* Move records (backwards, so the last record moved to a position of a removed one has been
+     * already checked)
+     */
+    size_t pos = 0;
+    for (size_t idx = parser->recs_valid; idx-- > 0;) {
+        if (parser->recs[idx].session != session) {
+            continue;
+        }
+
+        if (grb != NULL) {
+            assert(pos < rec_cnt);
+            grb_recs[pos++] = parser->recs[idx].ctx;
+        }
+        parser_rec_remove(parser, idx);
     }
 
-    // Copy records
-    for (size_t idx = begin, pos = 0; idx < end; ++idx, ++pos) {
-        assert(pos < garbage->rec_cnt);
-        garbage->recs[pos] = parser->recs[idx].ctx;
+    if (!grb) {
+        return rec_cnt;
     }
 
     // Wrap the garbage
+    grb->rec_cnt = rec_cnt;
+    grb->recs = grb_recs;
     ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &session_garbage_destroy;
-    ipx_msg_garbage_t *msg = ipx_msg_garbage_create(garbage, cb);
-    if (!msg) {
-        free(garbage->recs);
-        free(garbage);
-        return NULL;
+    *garbage = ipx_msg_garbage_create(grb, cb);
+    if (*garbage == NULL) {
+        free(grb->recs);
+        free(grb);
     }
 
-    return msg;
+    return rec_cnt;
 }
 
 /**
@@ -591,6 +834,10 @@ struct ipx_parser_data {
     struct ipx_msg_ipfix *ipfix_msg;
     /** Template manager                                */
     fds_tmgr_t *tmgr;
+    /** Stream context (Template cache)                 */
+    struct stream_ctx *stream;
+    /** Snapshot of the manager (NULL = not acquired yet or outdated by a Template Set) */
+    const fds_tsnapshot_t *snap;
 
     /** Number of parser data records                   */
     uint16_t data_recs;
@@ -598,6 +845,67 @@ struct ipx_parser_data {
     bool tmplt_changes;
 };
 
+/**
+ * \brief Get a snapshot of the Template manager for the processed IPFIX Message
+ *
+ * The snapshot is acquired only once per message and reused by all Data Sets, unless it has
+ * been outdated by a Template Set of the same message.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[out]    snap  Snapshot
+ * \return #FDS_OK on success
+ * \return Other codes of fds_tmgr_snapshot_get() on failure
+ */
+static inline int
+parser_snapshot_get(struct ipx_parser_data *pdata, const fds_tsnapshot_t **snap)
+{
+    if (pdata->snap == NULL) {
+        int rc = fds_tmgr_snapshot_get(pdata->tmgr, &pdata->snap);
+        if (rc != FDS_OK) {
+            pdata->snap = NULL;
+            return rc;
+        }
+    }
+
+    *snap = pdata->snap;
+    return FDS_OK;
+}
+
+/**
+ * \brief Find an (Options) Template in a snapshot
+ *
+ * Recently used Templates are stored in a small direct-mapped cache of the stream context,
+ * so lookups of repeated Set IDs are cheap. The cache is flushed whenever a different
+ * snapshot is used.
+ * \param[in,out] pdata  Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     snap   Snapshot
+ * \param[in]     set_id Set ID (i.e. Template ID)
+ * \return Pointer to the Template or NULL (not found)
+ */
+static inline const struct fds_template *
+parser_template_get(struct ipx_parser_data *pdata, const fds_tsnapshot_t *snap, uint16_t set_id)
+{
+    struct stream_ctx *stream = pdata->stream;
+    if (stream->tcache.snap != snap) {
+        // Cached Templates belong to another snapshot
+        for (size_t i = 0; i < TCACHE_SIZE; ++i) {
+            stream->tcache.items[i].id = 0;
+        }
+        stream->tcache.snap = snap;
+    }
+
+    const size_t idx = set_id & (TCACHE_SIZE - 1U);
+    if (stream->tcache.items[idx].id == set_id) {
+        return stream->tcache.items[idx].tmplt;
+    }
+
+    const struct fds_template *tmplt = fds_tsnapshot_template_get(snap, set_id);
+    if (tmplt != NULL) {
+        stream->tcache.items[idx].id = set_id;
+        stream->tcache.items[idx].tmplt = tmplt;
+    }
+    return tmplt;
+}
+
 /**
  * \brief Process an (All) (Options) Template Withdrawal record
  *
@@ -628,6 +936,10 @@ parser_parse_withdrawal(struct ipx_parser_data *pdata, struct fds_ipfix_wdrl_tre
         return IPX_OK;
     }
 
+    // Templates will be removed (the current snapshot will be outdated)
+    pdata->tmplt_changes = true;
+    pdata->snap = NULL;
+
     int rc;
     if (tid >= FDS_IPFIX_SET_MIN_DSET) {
         // (Options) Template Withdrawal
@@ -697,10 +1009,62 @@ parser_parse_withdrawal(struct ipx_parser_data *pdata, struct fds_ipfix_wdrl_tre
     }
 }
 
+/**
+ * \brief Check if an (Options) Template definition is only a refresh of the current one
+ *
+ * Exporters over UDP periodically resend all definitions. If the definition is byte-identical
+ * to the Template already present in the snapshot, it's not necessary to add it to the Template
+ * manager again, which would create a new snapshot and garbage. However, the lifetime of the
+ * Template must be still refreshed before it expires. Therefore, the Template manager is used
+ * again as soon as the half of the lifetime has elapsed since the last refresh.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     rec   Start of (Options) Template record (header)
+ * \param[in]     type  Type of the template (FDS_TYPE_TEMPLATE or FDS_TYPE_TEMPLATE_OPTS)
+ * \param[in]     size  Size of the template
+ * \return True if the definition can be ignored, false otherwise.
+ */
+static inline bool
+parser_def_is_refresh(struct ipx_parser_data *pdata, const void *rec,
+    enum fds_template_type type, uint16_t size)
+{
+    const fds_tsnapshot_t *snap;
+    if (parser_snapshot_get(pdata, &snap) != FDS_OK) {
+        return false;
+    }
+
+    const uint16_t tid = ntohs(((const struct fds_ipfix_trec *) rec)->template_id);
+    const struct fds_template *tmplt = parser_template_get(pdata, snap, tid);
+    if (!tmplt || tmplt->type != type || tmplt->raw.length != size
+            || memcmp(tmplt->raw.data, rec, size) != 0) {
+        // Not defined or a different definition
+        return false;
+    }
+
+    const struct ipx_session *session = pdata->ipfix_msg->ctx.session;
+    if (session->type != FDS_SESSION_UDP) {
+        // Templates never expire
+        return true;
+    }
+
+    const uint16_t lifetime = (type == FDS_TYPE_TEMPLATE)
+        ? session->udp.lifetime.tmplts : session->udp.lifetime.opts_tmplts;
+    if (lifetime == 0) {
+        // Timeout is disabled
+        return true;
+    }
+
+    // Note: Messages with Export Time in the history are never suppressed (underflow)
+    const struct fds_ipfix_msg_hdr *hdr;
+    hdr = (const struct fds_ipfix_msg_hdr *) pdata->ipfix_msg->raw_pkt;
+    const uint32_t elapsed = ntohl(hdr->export_time) - tmplt->time.last_seen;
+    return elapsed < lifetime / 2U;
+}
+
 /**
  * \brief Process an (Options) Template definition
  *
- * Parse a template definition and try to add it into a Template manager
+ * Parse a template definition and try to add it into a Template manager. Identical refreshes
+ * of the current definitions are skipped (see parser_def_is_refresh()).
  * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
  * \param[in]     rec   Start of (Options) Template record (header)
  * \param[in]     type  Type of the template (FDS_TYPE_TEMPLATE or FDS_TYPE_TEMPLATE_OPTS)
@@ -722,6 +1086,14 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
     PARSER_DEBUG(pdata->parser, msg_ctx, "Processing a definition of %s ID %" PRIu16 " ...",
         (type == FDS_TYPE_TEMPLATE) ? "Template" : "Options Template", tid);
 
+    pdata->parser->stats.tmplt_defs++;
+    if (parser_def_is_refresh(pdata, rec, type, size)) {
+        pdata->parser->stats.tmplt_refresh_suppressed++;
+        PARSER_DEBUG(pdata->parser, msg_ctx, "The definition is identical to the current one "
+            "(refresh skipped).", '\0');
+        return IPX_OK;
+    }
+
     // Parse the (Options) Template
     if ((rc = fds_template_parse(type, rec, &size, &tmplt)) != FDS_OK) {
         // Something bad happened
@@ -744,7 +1116,9 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
         }
     }
 
-    // Add (Options) Template
+    // Add (Options) Template (the current snapshot will be outdated)
+    pdata->tmplt_changes = true;
+    pdata->snap = NULL;
     if ((rc = fds_tmgr_template_add(pdata->tmgr, tmplt)) != FDS_OK) {
         // Something bad happened
         fds_template_destroy(tmplt);
@@ -788,9 +1162,6 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
 static inline int
 parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
 {
-    // Processing templates
-    pdata->tmplt_changes = true;
-
     uint16_t set_id = ntohs(tset->flowset_id);
     assert(set_id == FDS_IPFIX_SET_TMPLT || set_id == FDS_IPFIX_SET_OPTS_TMPLT);
     // Get type of the templates
@@ -833,6 +1204,70 @@ parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
     return IPX_OK;
 }
 
+/**
+ * \brief Estimate the maximum number of Data Records in a Data Set
+ *
+ * The estimation is based on the minimal length of a Data Record described by the Template.
+ * Therefore, it's exact for Templates without variable-length fields (ignoring padding) and an
+ * upper bound otherwise.
+ * \param[in] dset  Pointer to the Set header
+ * \param[in] tmplt Template of Data Records in the Set
+ * \return Number of records
+ */
+static inline uint32_t
+parser_dset_rec_estimate(const struct fds_ipfix_set_hdr *dset, const struct fds_template *tmplt)
+{
+    const uint16_t set_len = ntohs(dset->length);
+    if (set_len <= FDS_IPFIX_SET_HDR_LEN) {
+        return 0;
+    }
+
+    const uint16_t rec_len = (tmplt->data_length > 0) ? tmplt->data_length : 1U;
+    return (uint32_t) (set_len - FDS_IPFIX_SET_HDR_LEN) / rec_len;
+}
+
+/**
+ * \brief Pre-allocate Data Record descriptions for the whole IPFIX Message
+ *
+ * Estimate the number of Data Records in all Data Sets described by already known Templates
+ * and reallocate the wrapper at once, instead of growing it gradually while the records
+ * are added. Data Sets described by Templates defined in the same message are reserved later
+ * by parser_parse_dset(). Formatting errors are ignored here as they are reported during
+ * parsing.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ */
+static inline void
+parser_reserve_drecs(struct ipx_parser_data *pdata)
+{
+    const fds_tsnapshot_t *snap;
+    if (parser_snapshot_get(pdata, &snap) != FDS_OK) {
+        return;
+    }
+
+    struct fds_sets_iter it;
+    fds_sets_iter_init(&it, (struct fds_ipfix_msg_hdr *) pdata->ipfix_msg->raw_pkt);
+
+    uint32_t rec_cnt = 0;
+    while (rec_cnt < PARSER_RESERVE_MAX && fds_sets_iter_next(&it) == FDS_OK) {
+        const uint16_t set_id = ntohs(it.set->flowset_id);
+        if (set_id < FDS_IPFIX_SET_MIN_DSET) {
+            continue;
+        }
+
+        const struct fds_template *tmplt = parser_template_get(pdata, snap, set_id);
+        if (tmplt != NULL) {
+            rec_cnt += parser_dset_rec_estimate(it.set, tmplt);
+        }
+    }
+
+    if (rec_cnt > PARSER_RESERVE_MAX) {
+        rec_cnt = PARSER_RESERVE_MAX;
+    }
+
+    // On failure, records are allocated gradually (and the failure is reported later)
+    (void) ipx_msg_ipfix_reserve_drecs(&pdata->ipfix_msg, rec_cnt);
+}
+
 /**
  * \brief Parser Data Records in an IPFIX Set
  *
@@ -851,10 +1286,10 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
     uint16_t set_id = ntohs(dset->flowset_id);
     assert(set_id >= FDS_IPFIX_SET_MIN_DSET);
 
-    // Find a Snapshot
+    // Find a Snapshot (usually shared by all Data Sets in the message)
     int rc;
     const fds_tsnapshot_t *snap;
-    if ((rc = fds_tmgr_snapshot_get(pdata->tmgr, &snap)) != FDS_OK) {
+    if ((rc = parser_snapshot_get(pdata, &snap)) != FDS_OK) {
         // Something bad happened
         const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
         if (rc == FDS_ERR_NOMEM) {
@@ -871,7 +1306,7 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
     }
 
     // Find an (Options) Template
-    const struct fds_template *tmplt = fds_tsnapshot_template_get(snap, set_id);
+    const struct fds_template *tmplt = parser_template_get(pdata, snap, set_id);
     if (!tmplt) {
         const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
         PARSER_WARNING(pdata->parser, msg_ctx, "Unable to parse IPFIX Data Set %" PRIu16 " "
@@ -883,6 +1318,18 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
     rec.tmplt = tmplt;
     rec.snap = snap;
 
+    // Usually already reserved by parser_reserve_drecs(), except for Templates from this message
+    uint32_t rec_cnt = parser_dset_rec_estimate(dset, tmplt);
+    if (rec_cnt > PARSER_RESERVE_MAX) {
+        rec_cnt = PARSER_RESERVE_MAX;
+    }
+    if (ipx_msg_ipfix_reserve_drecs(&pdata->ipfix_msg, rec_cnt) != IPX_OK) {
+        const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+        PARSER_ERROR(pdata->parser, msg_ctx, "Memory allocation failed (%s:%d).",
+            __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
     // Parse Data Records in the Set
     struct fds_dset_iter it;
     fds_dset_iter_init(&it, dset, tmplt);
@@ -916,6 +1363,7 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
         "%" PRIu16 " (%s).", set_id, fds_dset_iter_err(&it));
 
     // Try to remove the Template definition
+    pdata->snap = NULL;
     rc = fds_tmgr_template_remove(pdata->tmgr, set_id, FDS_TYPE_TEMPLATE_UNDEF);
     switch (rc) {
     case FDS_OK:
@@ -957,6 +1405,9 @@ parser_parse_message(struct ipx_parser_data *pdata)
     int rc_iter;
     int rc_parse = IPX_OK;
 
+    // Allocate descriptions of all Data Records at once
+    parser_reserve_drecs(pdata);
+
     struct fds_sets_iter it;
     fds_sets_iter_init(&it, (struct fds_ipfix_msg_hdr *) pdata->ipfix_msg->raw_pkt);
 
@@ -1152,13 +1603,11 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
 
     const size_t alloc_size = PARSER_DEF_RECS * sizeof(*parser->recs);
     parser->recs = malloc(alloc_size);
-    if (!parser->recs) {
-        free(parser);
-        return NULL;
-    }
-
+    parser->index = calloc(PARSER_DEF_INDEX, sizeof(*parser->index));
     parser->ident = strdup(ident);
-    if (!parser->ident) {
+    if (!parser->recs || !parser->index || !parser->ident) {
+        free(parser->ident);
+        free(parser->index);
         free(parser->recs);
         free(parser);
         return NULL;
@@ -1166,6 +1615,8 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
 
     parser->vlevel = vlevel;
     parser->recs_alloc = PARSER_DEF_RECS;
+    parser->recs_last = PARSER_NO_REC;
+    parser->index_size = PARSER_DEF_INDEX;
     parser->ie_mgr = NULL;
     return parser;
 }
@@ -1176,13 +1627,22 @@ ipx_parser_destroy(ipx_parser_t *parser)
     // Destroy all stream contexts
     for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
         stream_ctx_destroy(parser->recs[idx].ctx);
+        ipx_ctx_metric_destroy(parser->recs[idx].seq_gaps);
+        ipx_ctx_metric_destroy(parser->recs[idx].seq_lost);
     }
 
     free(parser->ident);
+    free(parser->index);
     free(parser->recs);
     free(parser);
 }
 
+void
+ipx_parser_stats_get(const ipx_parser_t *parser, struct ipx_parser_stats *stats)
+{
+    *stats = parser->stats;
+}
+
 void
 ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_level *v_old)
 {
@@ -1271,7 +1731,11 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
             // Out of sequence message
             PARSER_WARNING(parser, msg_ctx, "Unexpected Sequence number (expected: "
                 "%" PRIu32 ", got: %" PRIu32 ").", info->seq_num, msg_seq);
+            parser_rec_metrics(parser, rec, msg_ctx);
+            ipx_ctx_metric_add(rec->seq_gaps, 1);
             if (parser_seq_num_cmp(msg_seq, info->seq_num) > 0) {
+                // Sequence number counts Data Records, i.e. the difference are the lost ones
+                ipx_ctx_metric_add(rec->seq_lost, (uint32_t) (msg_seq - info->seq_num));
                 info->seq_num = msg_seq; // Newer than expected
             } else {
                 old_oos = true; // Older than expected
@@ -1314,6 +1778,8 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         .parser = parser,
         .ipfix_msg = *ipfix,
         .tmgr = tmgr,
+        .stream = rec->ctx,
+        .snap = NULL,
         .data_recs = 0,
         .tmplt_changes = false
     };
@@ -1343,6 +1809,7 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
     if (parser_data.tmplt_changes) {
         // There is potentially garbage to destroy
         fds_tgarbage_t *fds_garbage;
+        stream_ctx_tcache_flush(rec->ctx);
         if (fds_tmgr_garbage_get(tmgr, &fds_garbage) == FDS_OK && fds_garbage != NULL) {
             ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy;
             garbage_msg = ipx_msg_garbage_create(fds_garbage, cb);
@@ -1393,6 +1860,7 @@ ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_gar
         struct stream_ctx *ctx = parser->recs[idx].ctx;
         fds_tgarbage_t *fds_garbage;
 
+        stream_ctx_tcache_flush(ctx);
         if (fds_tmgr_garbage_get(ctx->mgr, &fds_garbage) != FDS_OK) {
             // Garbage lost (memory leak)
             IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
@@ -1429,41 +1897,17 @@ int
 ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *session,
     ipx_msg_garbage_t **garbage)
 {
-    size_t idx_start; // Index of the first occurrence of the session records
-    size_t idx_end;   // Index of the "past-the-last" occurrence of the session records
-
-    // Find records to remove (the array is primary sorted by Transport Session)
-    for (idx_start = 0; idx_start < parser->recs_valid; ++idx_start) {
-        if (parser->recs[idx_start].session == session) {
-            break;
-        }
-    }
-
-    if (idx_start == parser->recs_valid) {
+    // Move session data into garbage
+    ipx_msg_garbage_t *garbage_msg;
+    if (parser_rec_to_garbage(parser, session, &garbage_msg) == 0) {
         // Not found
         return IPX_ERR_NOTFOUND;
     }
 
-    for (idx_end = idx_start + 1; idx_end < parser->recs_valid; ++idx_end) {
-        if (parser->recs[idx_end].session != session) {
-            break;
-        }
-    }
-
-    // Move session data into garbage
-    ipx_msg_garbage_t *garbage_msg = parser_rec_to_garbage(parser, idx_start, idx_end);
     /* Note: If the garbage message is NULL, allocation of the memory failed and information about
      * session will be lost. We cannot free structures here because someone still could use them.
      * (This will cause a memory leak but its better that segfault!)
      */
-
-    // Remove old records (order will remain still the same -> sort is not necessary)
-    while (idx_end < parser->recs_valid) {
-        parser->recs[idx_start++] = parser->recs[idx_end++];
-    }
-
-    // Update number of valid records
-    parser->recs_valid = idx_start;
     *garbage = garbage_msg;
     return IPX_OK;
 }
@@ -1471,32 +1915,40 @@ ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *sessio
 int
 ipx_parser_session_block(ipx_parser_t *parser, const struct ipx_session *session)
 {
-    size_t idx_start; // Index of the first occurrence of the session records
+    bool found = false;
 
-    // Find records to remove (the array is primary sorted by Transport Session)
-    for (idx_start = 0; idx_start < parser->recs_valid; ++idx_start) {
-        if (parser->recs[idx_start].session == session) {
-            break;
+    // Set "block" flag to all records of the session
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        struct parser_rec *rec = &parser->recs[idx];
+        if (rec->session != session) {
+            continue;
         }
-    }
 
-    if (idx_start == parser->recs_valid) {
-        // Not found
-        return IPX_ERR_NOTFOUND;
+        rec->ctx->flags |= SCF_BLOCK;
+        found = true;
     }
 
-    for (size_t idx = idx_start; idx < parser->recs_valid; ++idx) {
-        struct parser_rec *rec = &parser->recs[idx];
-        if (rec->session != session) {
-            // Stop, found a different session
-            break;
-        }
+    return found ? IPX_OK : IPX_ERR_NOTFOUND;
+}
+
+/**
+ * \brief Compare two Transport Session pointers
+ * \param[in] p1 First pointer
+ * \param[in] p2 Second pointer
+ * \return An integer less than, equal to, or greater than zero if the first argument is considered
+ *   to be respectively less than, equal to, or greater than the second.
+ */
+static int
+parser_session_cmp(const void *p1, const void *p2)
+{
+    const struct ipx_session *session_l = *(const struct ipx_session * const *) p1;
+    const struct ipx_session *session_r = *(const struct ipx_session * const *) p2;
 
-        // Set "block" flag
-        parser->recs[idx].ctx->flags |= SCF_BLOCK;
+    if (session_l == session_r) {
+        return 0;
     }
 
-    return IPX_OK;
+    return (session_l < session_r) ? (-1) : 1;
 }
 
 void
@@ -1504,19 +1956,32 @@ ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data)
 {
     /* Keep on mind that ipx_parser_session_block() and ipx_parser_session_remove() can be
      * called within the callback function i.e. records can be removed from the parser during for
-     * loop!
+     * loop! Therefore, get a list of unique Transport Sessions first.
      */
-    const struct ipx_session *now = NULL;
-    size_t idx = 0;
-    while (idx < parser->recs_valid) {
-        struct parser_rec *rec = &parser->recs[idx];
-        if (rec->session == now) {
+    if (parser->recs_valid == 0) {
+        return;
+    }
+
+    const struct ipx_session **sessions = malloc(parser->recs_valid * sizeof(*sessions));
+    if (!sessions) {
+        IPX_ERROR(parser->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return;
+    }
+
+    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
+        sessions[idx] = parser->recs[idx].session;
+    }
+    qsort(sessions, parser->recs_valid, sizeof(*sessions), &parser_session_cmp);
+
+    const size_t session_cnt = parser->recs_valid;
+    for (size_t idx = 0; idx < session_cnt; ++idx) {
+        if (idx > 0 && sessions[idx] == sessions[idx - 1]) {
             // Skip already processed sessions
-            idx++;
             continue;
         }
 
-        now = rec->session;
-        cb(parser, now, data); // Number of valid records can be changed here!
+        cb(parser, sessions[idx], data); // Number of valid records can be changed here!
     }
+
+    free(sessions);
 }
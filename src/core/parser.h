@@ -64,6 +64,14 @@
 /** Internal data type of parser                                                                 */
 typedef struct ipx_parser ipx_parser_t;
 
+/** Statistics of the parser                                                                     */
+struct ipx_parser_stats {
+    /** Number of processed (Options) Template definitions                                       */
+    uint64_t tmplt_defs;
+    /** Number of definitions identical to the current ones that haven't been added again      */
+    uint64_t tmplt_refresh_suppressed;
+};
+
 /**
  * \brief Create a IPFIX parser
  *
@@ -214,6 +222,15 @@ typedef void (*ipx_parser_for_cb)(ipx_parser_t *parser, const struct ipx_session
 IPX_API void
 ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data);
 
+/**
+ * \brief Get statistics of the parser
+ *
+ * \param[in]  parser Parser
+ * \param[out] stats  Statistics
+ */
+IPX_API void
+ipx_parser_stats_get(const ipx_parser_t *parser, struct ipx_parser_stats *stats);
+
 /**
  * @}
  */
@@ -0,0 +1,356 @@
+/**
+ * @file
+ * @brief Placement of threads and memory on CPUs and NUMA nodes (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+// CPU sets and scheduling functions are GNU extensions
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ipfixcol2.h>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+#include "placement.h"
+
+/** Directory with descriptions of NUMA nodes */
+#define PLACEMENT_NODE_DIR "/sys/devices/system/node"
+
+/** Check if a CPU is in a bitmap */
+static inline bool
+cpus_isset(const uint64_t cpus[IPX_PLACEMENT_WORDS], unsigned int cpu)
+{
+    return (cpus[cpu / 64U] >> (cpu % 64U)) & 1U;
+}
+
+/** Check if a bitmap is empty */
+static bool
+cpus_empty(const uint64_t cpus[IPX_PLACEMENT_WORDS])
+{
+    for (unsigned int i = 0; i < IPX_PLACEMENT_WORDS; ++i) {
+        if (cpus[i] != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+ipx_placement_is_default(const struct ipx_placement *placement)
+{
+    return cpus_empty(placement->cpus) && placement->numa_node < 0 && placement->priority == 0;
+}
+
+/**
+ * @brief Parse a CPU index
+ * @param[in]  str Position in the string
+ * @param[out] end Position after the index
+ * @param[out] cpu CPU index
+ * @return True on success, false otherwise
+ */
+static bool
+cpus_parse_idx(const char *str, const char **end, unsigned int *cpu)
+{
+    if (*str < '0' || *str > '9') {
+        return false;
+    }
+
+    char *idx_end;
+    errno = 0;
+    unsigned long value = strtoul(str, &idx_end, 10);
+    if (errno != 0 || value >= IPX_PLACEMENT_CPUS) {
+        return false;
+    }
+
+    *end = idx_end;
+    *cpu = (unsigned int) value;
+    return true;
+}
+
+int
+ipx_placement_cpus_parse(const char *str, uint64_t cpus[IPX_PLACEMENT_WORDS])
+{
+    memset(cpus, 0, IPX_PLACEMENT_WORDS * sizeof(*cpus));
+
+    const char *pos = str;
+    while (true) {
+        unsigned int first;
+        unsigned int last;
+        while (*pos == ' ') {
+            pos++;
+        }
+
+        if (!cpus_parse_idx(pos, &pos, &first)) {
+            return IPX_ERR_FORMAT;
+        }
+
+        last = first;
+        if (*pos == '-' && (!cpus_parse_idx(pos + 1, &pos, &last) || last < first)) {
+            return IPX_ERR_FORMAT;
+        }
+
+        for (unsigned int cpu = first; cpu <= last; ++cpu) {
+            cpus[cpu / 64U] |= UINT64_C(1) << (cpu % 64U);
+        }
+
+        while (*pos == ' ' || *pos == '\n') {
+            pos++;
+        }
+
+        if (*pos == '\0') {
+            return IPX_OK;
+        }
+
+        if (*pos != ',') {
+            return IPX_ERR_FORMAT;
+        }
+        pos++;
+    }
+}
+
+void
+ipx_placement_cpus_print(const uint64_t cpus[IPX_PLACEMENT_WORDS], char *buf, size_t size)
+{
+    size_t len = 0;
+    buf[0] = '\0';
+
+    unsigned int cpu = 0;
+    while (cpu < IPX_PLACEMENT_CPUS && len < size) {
+        if (!cpus_isset(cpus, cpu)) {
+            cpu++;
+            continue;
+        }
+
+        unsigned int last = cpu;
+        while (last + 1 < IPX_PLACEMENT_CPUS && cpus_isset(cpus, last + 1)) {
+            last++;
+        }
+
+        const char *sep = (len == 0) ? "" : ",";
+        int rc = (last == cpu)
+            ? snprintf(buf + len, size - len, "%s%u", sep, cpu)
+            : snprintf(buf + len, size - len, "%s%u-%u", sep, cpu, last);
+        if (rc < 0) {
+            break;
+        }
+
+        len += (size_t) rc;
+        cpu = last + 1;
+    }
+}
+
+#if defined(__linux__)
+
+/**
+ * @brief Get CPUs of a NUMA node
+ * @param[in]  node NUMA node
+ * @param[out] cpus Bitmap of CPUs
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOTFOUND if the node doesn't exist
+ */
+static int
+node_cpus_get(int node, uint64_t cpus[IPX_PLACEMENT_WORDS])
+{
+    char path[128];
+    snprintf(path, sizeof(path), PLACEMENT_NODE_DIR "/node%d/cpulist", node);
+
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    char line[4096];
+    bool valid = (fgets(line, sizeof(line), file) != NULL);
+    fclose(file);
+    if (!valid || ipx_placement_cpus_parse(line, cpus) != IPX_OK) {
+        // Nodes without CPUs (e.g. only memory) are not usable
+        return IPX_ERR_NOTFOUND;
+    }
+
+    return IPX_OK;
+}
+
+int
+ipx_placement_affinity_set(const struct ipx_placement *placement)
+{
+    uint64_t cpus[IPX_PLACEMENT_WORDS];
+    const bool cpus_set = !cpus_empty(placement->cpus);
+    memcpy(cpus, placement->cpus, sizeof(cpus));
+
+    if (placement->numa_node >= 0) {
+        if (placement->numa_node >= (int) IPX_PLACEMENT_CPUS) {
+            return IPX_ERR_NOTFOUND;
+        }
+
+        uint64_t node_cpus[IPX_PLACEMENT_WORDS];
+        if (node_cpus_get(placement->numa_node, node_cpus) != IPX_OK) {
+            return IPX_ERR_NOTFOUND;
+        }
+
+        for (unsigned int i = 0; i < IPX_PLACEMENT_WORDS; ++i) {
+            cpus[i] = cpus_set ? (cpus[i] & node_cpus[i]) : node_cpus[i];
+        }
+    } else if (!cpus_set) {
+        // Nothing to restrict
+        return IPX_OK;
+    }
+
+    if (cpus_empty(cpus)) {
+        return IPX_ERR_ARG;
+    }
+
+    cpu_set_t *set = CPU_ALLOC(IPX_PLACEMENT_CPUS);
+    if (!set) {
+        return IPX_ERR_DENIED;
+    }
+
+    const size_t set_size = CPU_ALLOC_SIZE(IPX_PLACEMENT_CPUS);
+    CPU_ZERO_S(set_size, set);
+    for (unsigned int cpu = 0; cpu < IPX_PLACEMENT_CPUS; ++cpu) {
+        if (cpus_isset(cpus, cpu)) {
+            CPU_SET_S(cpu, set_size, set);
+        }
+    }
+
+    int rc = pthread_setaffinity_np(pthread_self(), set_size, set);
+    CPU_FREE(set);
+    if (rc != 0) {
+        errno = rc;
+        return IPX_ERR_DENIED;
+    }
+
+    if (placement->numa_node < 0) {
+        return IPX_OK;
+    }
+
+    // Prefer memory of the node for all future allocations of the thread
+    unsigned long nodes[IPX_PLACEMENT_CPUS / (8 * sizeof(unsigned long))] = {0};
+    const unsigned int node = (unsigned int) placement->numa_node;
+    nodes[node / (8 * sizeof(*nodes))] |= 1UL << (node % (8 * sizeof(*nodes)));
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodes, IPX_PLACEMENT_CPUS + 1) != 0) {
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+int
+ipx_placement_mem_bind(const void *addr, size_t size, int node)
+{
+    const uintptr_t page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    if (node < 0 || node >= (int) IPX_PLACEMENT_CPUS || ((uintptr_t) addr & (page_size - 1))) {
+        errno = EINVAL;
+        return IPX_ERR_ARG;
+    }
+
+    if (size == 0) {
+        return IPX_OK;
+    }
+
+    // Never round the start down, pages before the memory might belong to other objects
+    const size_t len = (size + page_size - 1) & ~(page_size - 1);
+    unsigned long nodes[IPX_PLACEMENT_CPUS / (8 * sizeof(unsigned long))] = {0};
+    nodes[(unsigned int) node / (8 * sizeof(*nodes))] |= 1UL << (node % (8 * sizeof(*nodes)));
+    if (syscall(SYS_mbind, addr, len, MPOL_PREFERRED, nodes, IPX_PLACEMENT_CPUS + 1,
+            MPOL_MF_MOVE) != 0) {
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+#else
+
+int
+ipx_placement_affinity_set(const struct ipx_placement *placement)
+{
+    if (cpus_empty(placement->cpus) && placement->numa_node < 0) {
+        return IPX_OK;
+    }
+
+    errno = ENOSYS;
+    return IPX_ERR_DENIED;
+}
+
+int
+ipx_placement_mem_bind(const void *addr, size_t size, int node)
+{
+    // Not supported
+    (void) addr;
+    (void) size;
+    (void) node;
+    errno = ENOSYS;
+    return IPX_ERR_DENIED;
+}
+
+#endif // defined(__linux__)
+
+int
+ipx_placement_priority_set(int priority)
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (rc != 0) {
+        errno = rc;
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_placement_describe(char *buf, size_t size)
+{
+    char cpus_str[256] = "any";
+
+#if defined(__linux__)
+    cpu_set_t *set = CPU_ALLOC(IPX_PLACEMENT_CPUS);
+    const size_t set_size = CPU_ALLOC_SIZE(IPX_PLACEMENT_CPUS);
+    if (set != NULL && pthread_getaffinity_np(pthread_self(), set_size, set) == 0) {
+        uint64_t cpus[IPX_PLACEMENT_WORDS] = {0};
+        for (unsigned int cpu = 0; cpu < IPX_PLACEMENT_CPUS; ++cpu) {
+            if (CPU_ISSET_S(cpu, set_size, set)) {
+                cpus[cpu / 64U] |= UINT64_C(1) << (cpu % 64U);
+            }
+        }
+        ipx_placement_cpus_print(cpus, cpus_str, sizeof(cpus_str));
+    }
+    CPU_FREE(set);
+
+    unsigned int cpu_now;
+    unsigned int node_now;
+    char node_str[32] = "unknown";
+    if (syscall(SYS_getcpu, &cpu_now, &node_now, NULL) == 0) {
+        snprintf(node_str, sizeof(node_str), "%u", node_now);
+    }
+#else
+    const char *node_str = "unknown";
+#endif
+
+    int policy;
+    struct sched_param param;
+    char sched_str[32] = "default";
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && policy == SCHED_FIFO) {
+        snprintf(sched_str, sizeof(sched_str), "SCHED_FIFO (priority %d)", param.sched_priority);
+    }
+
+    snprintf(buf, size, "CPUs: %s, current NUMA node: %s, scheduling: %s", cpus_str, node_str,
+        sched_str);
+}
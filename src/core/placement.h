@@ -0,0 +1,121 @@
+/**
+ * @file
+ * @brief Placement of threads and memory on CPUs and NUMA nodes (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_PLACEMENT_H
+#define IPFIXCOL_PLACEMENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/** Maximum number of CPUs (and NUMA nodes) that can be addressed */
+#define IPX_PLACEMENT_CPUS 1024U
+/** Number of words of a CPU set */
+#define IPX_PLACEMENT_WORDS (IPX_PLACEMENT_CPUS / 64U)
+/** Initializer of a placement without any restriction */
+#define IPX_PLACEMENT_INIT {{0}, -1, 0}
+
+/** Placement of a thread */
+struct ipx_placement {
+    /** Bitmap of CPUs the thread can run on (no CPU = not restricted)          */
+    uint64_t cpus[IPX_PLACEMENT_WORDS];
+    /** NUMA node of the thread and its memory (negative = not restricted)     */
+    int numa_node;
+    /** Real-time priority (SCHED_FIFO) of the thread (0 = default scheduling)  */
+    int priority;
+};
+
+/**
+ * @brief Check if a placement doesn't restrict anything
+ * @param[in] placement Placement
+ * @return True or false
+ */
+bool
+ipx_placement_is_default(const struct ipx_placement *placement);
+
+/**
+ * @brief Parse a list of CPUs
+ *
+ * The list consists of comma separated CPU indexes and ranges (e.g. "0-3,8,10-11"), i.e.
+ * the format of the "cpulist" files in sysfs.
+ * @param[in]  str  List of CPUs
+ * @param[out] cpus Bitmap of CPUs
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_FORMAT if the list is malformed, empty or contains a CPU out of range
+ */
+int
+ipx_placement_cpus_parse(const char *str, uint64_t cpus[IPX_PLACEMENT_WORDS]);
+
+/**
+ * @brief Format a list of CPUs (see ipx_placement_cpus_parse())
+ * @param[in]  cpus Bitmap of CPUs
+ * @param[out] buf  Output buffer
+ * @param[in]  size Size of the output buffer (the output is truncated if it doesn't fit)
+ */
+void
+ipx_placement_cpus_print(const uint64_t cpus[IPX_PLACEMENT_WORDS], char *buf, size_t size);
+
+/**
+ * @brief Restrict the calling thread to its CPUs and to the CPUs of its NUMA node
+ *
+ * If both are defined, the thread can run only on their intersection. Memory of the thread
+ * is preferably allocated on the NUMA node (if defined).
+ * @param[in] placement Placement
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOTFOUND if the NUMA node doesn't exist
+ * @return #IPX_ERR_ARG if no CPU is left
+ * @return #IPX_ERR_DENIED if the system call failed (see errno) or it is not supported
+ */
+int
+ipx_placement_affinity_set(const struct ipx_placement *placement);
+
+/**
+ * @brief Change scheduling policy of the calling thread to real-time (SCHED_FIFO)
+ * @note Usually, the process must have CAP_SYS_NICE capability.
+ * @param[in] priority Priority (1 - 99)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED if the system call failed (see errno)
+ */
+int
+ipx_placement_priority_set(int priority);
+
+/**
+ * @brief Describe the actual placement of the calling thread (for logging)
+ * @param[out] buf  Output buffer
+ * @param[in]  size Size of the output buffer
+ */
+void
+ipx_placement_describe(char *buf, size_t size);
+
+/**
+ * @brief Move memory to a NUMA node
+ *
+ * All pages of the memory range are preferably placed on the node, already allocated pages
+ * are migrated. The memory must be mapped separately from other objects (e.g. by
+ * ipx_hugepage_alloc_mapped()), otherwise, unrelated objects sharing the same pages would be
+ * moved too. Failure is not fatal as it affects only performance.
+ * @param[in] addr Start of the memory (must be aligned to a page)
+ * @param[in] size Size of the memory
+ * @param[in] node NUMA node
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_ARG if the address is not aligned or the node is not valid (errno is set)
+ * @return #IPX_ERR_DENIED if the memory cannot be moved (errno is set)
+ */
+int
+ipx_placement_mem_bind(const void *addr, size_t size, int node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IPFIXCOL_PLACEMENT_H
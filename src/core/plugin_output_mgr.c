@@ -41,10 +41,14 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <build_config.h>
 #include "plugin_output_mgr.h"
 #include "message_base.h"
 #include "context.h"
 
+/** Maximum number of messages passed to output instances at once */
+#define OUTPUT_MGR_BATCH_MAX (64U)
+
 /** Definition of a connection with an output instance      */
 struct ipx_output_mgr_rec {
     /** Ring buffer connection (writer only)                */
@@ -155,34 +159,21 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) cfg;
 }
 
-int
-ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+/**
+ * \brief Get output instances that want to receive an IPFIX Message
+ *
+ * \param[in] list List of output destinations
+ * \param[in] msg  IPFIX Message
+ * \return Bit mask of the output instances (i-th bit represents i-th output instance)
+ */
+static uint64_t
+output_mgr_dest_mask(const struct ipx_output_mgr_list *list, ipx_msg_t *msg)
 {
-    (void) ctx;
-    // List of output destination is prepared by the configurator
-    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
-    assert(list != NULL);
-
-    // Only IPFIX messages are filtered
-    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
-    if (msg_type != IPX_MSG_IPFIX) {
-        // Set the number of references and pass the message to all output instances
-        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
-
-        for (size_t i = 0; i < list->size; ++i) {
-            ipx_ring_push(list->recs[i].ring, msg);
-        }
-
-        return IPX_OK;
-    }
-
-    // First, get number of destinations...
     uint64_t dest_mask = 0;
-    unsigned int dest_cnt = 0;
     uint32_t odid = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
 
     for (size_t i = 0; i < list->size; ++i) {
-        struct ipx_output_mgr_rec *rec = &list->recs[i];
+        const struct ipx_output_mgr_rec *rec = &list->recs[i];
         switch (rec->type) {
         case IPX_ODID_FILTER_NONE:
             // Add to the destinations
@@ -202,17 +193,46 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         }
 
         dest_mask |= (1ULL << i);
-        dest_cnt++;
     }
 
-    if (dest_cnt == 0) {
+    return dest_mask;
+}
+
+int
+ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    // List of output destination is prepared by the configurator
+    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
+    assert(list != NULL);
+
+    // Only IPFIX messages are filtered
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    if (msg_type != IPX_MSG_IPFIX) {
+        // Set the number of references and pass the message to all output instances
+        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+
+        for (size_t i = 0; i < list->size; ++i) {
+            ipx_ring_push(list->recs[i].ring, msg);
+        }
+
+        return IPX_OK;
+    }
+
+    // First, get number of destinations...
+    uint64_t dest_mask = output_mgr_dest_mask(list, msg);
+    if (dest_mask == 0) {
         // No-one wants the message -> destroy
         ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
         return IPX_OK;
     }
 
+#ifdef ENABLE_LATENCY_TRACE
+    ipx_ctx_trace_pass(ctx, msg);
+#endif
+
     // Set the number of references and send to all selected destinations
-    ipx_msg_header_cnt_set(msg, dest_cnt);
+    ipx_msg_header_cnt_set(msg, (unsigned int) __builtin_popcountll(dest_mask));
     for (size_t dest_idx = 0; dest_mask != 0; dest_idx++, dest_mask >>= 1) {
         if ((dest_mask & 0x1) == 0) {
             // Skip
@@ -224,4 +244,71 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     }
 
     return IPX_OK;
-}
\ No newline at end of file
+}
+
+int
+ipx_plugin_output_mgr_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt)
+{
+    (void) ctx;
+    // List of output destination is prepared by the configurator
+    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
+    assert(list != NULL);
+
+    ipx_msg_t *dest_msgs[OUTPUT_MGR_BATCH_MAX];
+    uint64_t dest_masks[OUTPUT_MGR_BATCH_MAX];
+
+    while (cnt > 0) {
+        const size_t part_cnt = (cnt < OUTPUT_MGR_BATCH_MAX) ? cnt : OUTPUT_MGR_BATCH_MAX;
+        uint64_t all_mask = 0;
+
+        // First, set the number of references of all messages before passing any of them
+        for (size_t i = 0; i < part_cnt; ++i) {
+            ipx_msg_t *msg = msgs[i];
+            uint64_t mask;
+
+            if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+                mask = output_mgr_dest_mask(list, msg);
+            } else {
+                // All output instances
+                mask = (list->size < 64) ? ((1ULL << list->size) - 1) : UINT64_MAX;
+            }
+
+            dest_masks[i] = mask;
+            all_mask |= mask;
+            if (mask != 0) {
+#ifdef ENABLE_LATENCY_TRACE
+                ipx_ctx_trace_pass(ctx, msg);
+#endif
+                ipx_msg_header_cnt_set(msg, (unsigned int) __builtin_popcountll(mask));
+            }
+        }
+
+        // Pass all messages for the same output instance at once
+        for (size_t dest_idx = 0; all_mask != 0; dest_idx++, all_mask >>= 1) {
+            if ((all_mask & 0x1) == 0) {
+                continue;
+            }
+
+            uint32_t dest_cnt = 0;
+            for (size_t i = 0; i < part_cnt; ++i) {
+                if (dest_masks[i] & (1ULL << dest_idx)) {
+                    dest_msgs[dest_cnt++] = msgs[i];
+                }
+            }
+
+            ipx_ring_push_batch(list->recs[dest_idx].ring, dest_msgs, dest_cnt);
+        }
+
+        // No-one wants these messages -> destroy
+        for (size_t i = 0; i < part_cnt; ++i) {
+            if (dest_masks[i] == 0) {
+                ipx_msg_destroy(msgs[i]);
+            }
+        }
+
+        msgs += part_cnt;
+        cnt -= part_cnt;
+    }
+
+    return IPX_OK;
+}
@@ -127,4 +127,19 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg);
 int
 ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Pass multiple messages to output plugins
+ *
+ * Same as ipx_plugin_output_mgr_process(), however, messages for each output instance are
+ * passed at once.
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Private instance data
+ * \param[in] msgs IPFIX or Transport Session Messages to process
+ * \param[in] cnt  Number of messages
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_output_mgr_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
 #endif //IPFIXCOL_PLUGIN_OUTPUT_MGR_H
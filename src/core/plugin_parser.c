@@ -39,6 +39,7 @@
  *
  */
 
+#include <inttypes.h>
 #include "fpipe.h"
 #include "context.h"
 #include "plugin_parser.h"
@@ -97,6 +98,11 @@ ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     ipx_parser_t *parser = (ipx_parser_t *) cfg;
 
+    struct ipx_parser_stats stats;
+    ipx_parser_stats_get(parser, &stats);
+    IPX_CTX_INFO(ctx, "Processed (Options) Template definitions: %" PRIu64 " (identical "
+        "refreshes suppressed: %" PRIu64 ")", stats.tmplt_defs, stats.tmplt_refresh_suppressed);
+
     // Create a garbage message
     ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
     ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(parser, cb);
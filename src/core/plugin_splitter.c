@@ -0,0 +1,241 @@
+/**
+ * @file
+ * @brief Internal splitter of messages among replicas of an intermediate instance
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <build_config.h>
+#include "plugin_splitter.h"
+#include "message_base.h"
+#include "message_periodic.h"
+#include "message_terminate.h"
+#include "context.h"
+
+/** Maximum number of messages passed to replicas at once */
+#define SPLITTER_BATCH_MAX (64U)
+
+/** List of replicas */
+struct ipx_splitter_list {
+    /** Number of replicas                                  */
+    size_t size;
+    /** Array of input ring buffers of replicas (writer only) */
+    ipx_ring_t **rings;
+};
+
+ipx_splitter_list_t *
+ipx_splitter_list_create()
+{
+    struct ipx_splitter_list *result = calloc(1, sizeof(*result));
+    if (!result) {
+        return NULL;
+    }
+
+    result->size = 0;
+    result->rings = NULL;
+    return result;
+}
+
+void
+ipx_splitter_list_destroy(ipx_splitter_list_t *list)
+{
+    free(list->rings);
+    free(list);
+}
+
+size_t
+ipx_splitter_list_size(const ipx_splitter_list_t *list)
+{
+    return list->size;
+}
+
+int
+ipx_splitter_list_add(ipx_splitter_list_t *list, ipx_ring_t *ring)
+{
+    if (list == NULL || ring == NULL) {
+        return IPX_ERR_ARG;
+    }
+
+    size_t new_size = list->size + 1;
+    ipx_ring_t **new_rings = realloc(list->rings, new_size * sizeof(*new_rings));
+    if (!new_rings) {
+        return IPX_ERR_NOMEM;
+    }
+
+    new_rings[new_size - 1] = ring;
+    list->rings = new_rings;
+    list->size = new_size;
+    return IPX_OK;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const struct ipx_plugin_info ipx_plugin_splitter_info = {
+    .name    = "Replica splitter",
+    .dsc     = "Internal IPFIXcol plugin for distributing messages among replicas of an instance.",
+    // Same as the output manager, it passes messages to multiple ring buffers
+    .type    = IPX_PT_OUTPUT_MGR,
+    .flags   = 0,
+    .version = "1.0.0",
+    .ipx_min = "2.0.0"
+};
+
+int
+ipx_plugin_splitter_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+
+    // Check that all message types are subscribed
+    ipx_msg_mask_t mask = IPX_MSG_MASK_ALL;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Unable to subscribe to all message types!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_splitter_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    // Do nothing, private data should be freed by the configurator
+    (void) ctx;
+    (void) cfg;
+}
+
+/**
+ * @brief Select a replica for an IPFIX or Transport Session Message
+ * @param[in] list List of replicas
+ * @param[in] msg  IPFIX or Transport Session Message
+ * @return Index of the replica
+ */
+static size_t
+splitter_replica_idx(const struct ipx_splitter_list *list, ipx_msg_t *msg)
+{
+    const struct ipx_session *session;
+    if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+        session = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->session;
+    } else {
+        session = ipx_msg_session_get_session(ipx_msg_base2session(msg));
+    }
+
+    // Mix bits of the address of the Session structure (a finalizer of MurmurHash3)
+    uint64_t hash = (uint64_t) (uintptr_t) session;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return (size_t) (hash % list->size);
+}
+
+/**
+ * @brief Create a copy of a periodic or termination message for another replica
+ * @param[in] msg Original message
+ * @return Pointer to the copy or NULL (memory allocation error)
+ */
+static ipx_msg_t *
+splitter_msg_copy(ipx_msg_t *msg)
+{
+    if (ipx_msg_get_type(msg) == IPX_MSG_PERIODIC) {
+        ipx_msg_periodic_t *copy = ipx_msg_periodic_copy(ipx_msg_base2periodic(msg));
+        return (copy != NULL) ? ipx_msg_periodic2base(copy) : NULL;
+    }
+
+    assert(ipx_msg_get_type(msg) == IPX_MSG_TERMINATE);
+    ipx_msg_terminate_t *orig = ipx_msg_base2terminate(msg);
+    ipx_msg_terminate_t *copy = ipx_msg_terminate_create(ipx_msg_terminate_get_type(orig));
+    return (copy != NULL) ? ipx_msg_terminate2base(copy) : NULL;
+}
+
+int
+ipx_plugin_splitter_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    // List of replicas is prepared by the configurator
+    struct ipx_splitter_list *list = (struct ipx_splitter_list *) cfg;
+    assert(list != NULL && list->size > 0);
+
+    enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
+    switch (msg_type) {
+    case IPX_MSG_IPFIX:
+    case IPX_MSG_SESSION:
+#ifdef ENABLE_LATENCY_TRACE
+        ipx_ctx_trace_pass(ctx, msg);
+#endif
+        // Only one replica is responsible for the Transport Session
+        ipx_ring_push(list->rings[splitter_replica_idx(list, msg)], msg);
+        return IPX_OK;
+    case IPX_MSG_GARBAGE:
+        // The replica that releases the last reference passes the message further
+        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+        for (size_t i = 0; i < list->size; ++i) {
+            ipx_ring_push(list->rings[i], msg);
+        }
+        return IPX_OK;
+    default:
+        break;
+    }
+
+    // Each replica must get its own copy (the original message is passed to the first one)
+    for (size_t i = 1; i < list->size; ++i) {
+        ipx_msg_t *copy = splitter_msg_copy(msg);
+        if (!copy) {
+            IPX_CTX_ERROR(ctx, "Failed to copy a message for a replica (%s:%d)", __FILE__,
+                __LINE__);
+            ipx_msg_destroy(msg);
+            return IPX_ERR_DENIED;
+        }
+
+        ipx_ring_push(list->rings[i], copy);
+    }
+
+    ipx_ring_push(list->rings[0], msg);
+    return IPX_OK;
+}
+
+int
+ipx_plugin_splitter_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt)
+{
+    (void) ctx;
+    // List of replicas is prepared by the configurator
+    struct ipx_splitter_list *list = (struct ipx_splitter_list *) cfg;
+    assert(list != NULL && list->size > 0);
+
+    ipx_msg_t *dest_msgs[SPLITTER_BATCH_MAX];
+    size_t dest_idx[SPLITTER_BATCH_MAX];
+
+    while (cnt > 0) {
+        const size_t part_cnt = (cnt < SPLITTER_BATCH_MAX) ? cnt : SPLITTER_BATCH_MAX;
+        for (size_t i = 0; i < part_cnt; ++i) {
+            // Only IPFIX and Transport Session Messages are passed in batches
+            assert(ipx_msg_get_type(msgs[i]) == IPX_MSG_IPFIX
+                || ipx_msg_get_type(msgs[i]) == IPX_MSG_SESSION);
+            dest_idx[i] = splitter_replica_idx(list, msgs[i]);
+#ifdef ENABLE_LATENCY_TRACE
+            ipx_ctx_trace_pass(ctx, msgs[i]);
+#endif
+        }
+
+        // Pass all messages for the same replica at once
+        for (size_t replica = 0; replica < list->size; ++replica) {
+            uint32_t dest_cnt = 0;
+            for (size_t i = 0; i < part_cnt; ++i) {
+                if (dest_idx[i] == replica) {
+                    dest_msgs[dest_cnt++] = msgs[i];
+                }
+            }
+
+            if (dest_cnt > 0) {
+                ipx_ring_push_batch(list->rings[replica], dest_msgs, dest_cnt);
+            }
+        }
+
+        msgs += part_cnt;
+        cnt -= part_cnt;
+    }
+
+    return IPX_OK;
+}
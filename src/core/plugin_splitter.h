@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @brief Internal splitter of messages among replicas of an intermediate instance (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIXCOL_PLUGIN_SPLITTER_H
+#define IPFIXCOL_PLUGIN_SPLITTER_H
+
+#include <ipfixcol2.h>
+#include "ring.h"
+
+/** Internal type of list of replicas */
+typedef struct ipx_splitter_list ipx_splitter_list_t;
+
+/**
+ * @brief Create a new list of replicas
+ *
+ * After initialization the list is empty
+ * @return Pointer or NULL (memory allocation error)
+ */
+ipx_splitter_list_t *
+ipx_splitter_list_create();
+
+/**
+ * @brief Destroy the list
+ *
+ * @note Ring buffers are NOT freed by this function!
+ * @param[in] list List of replicas
+ */
+void
+ipx_splitter_list_destroy(ipx_splitter_list_t *list);
+
+/**
+ * @brief Get number of replicas in the list
+ * @param[in] list List of replicas
+ */
+size_t
+ipx_splitter_list_size(const ipx_splitter_list_t *list);
+
+/**
+ * @brief Add a new replica to the list
+ * @param[in] list List of replicas
+ * @param[in] ring Input ring buffer of the replica (for a writer)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_ARG in case of invalid arguments
+ * @return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+int
+ipx_splitter_list_add(ipx_splitter_list_t *list, ipx_ring_t *ring);
+
+// ------------------------------------------------------------------------------------------------
+
+/** Description of the splitter plugin */
+extern const struct ipx_plugin_info ipx_plugin_splitter_info;
+
+/**
+ * @brief Initialize the splitter
+ * @param[in] ctx    Plugin context
+ * @param[in] params Ignored (should be NULL)
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_splitter_init(ipx_ctx_t *ctx, const char *params);
+
+/**
+ * @brief Destroy the splitter
+ * @note The list of replicas must be freed by the configurator.
+ * @param[in] ctx Plugin context
+ * @param[in] cfg Private instance data
+ */
+void
+ipx_plugin_splitter_destroy(ipx_ctx_t *ctx, void *cfg);
+
+/**
+ * @brief Pass a message to replicas
+ *
+ * IPFIX and Transport Session Messages are passed to exactly one replica selected by a hash of
+ * the Transport Session, so all messages of the same Session are always processed by the same
+ * replica in the original order.
+ *
+ * Other messages are passed to all replicas. Each replica gets its own copy of periodic and
+ * termination messages. Garbage messages are shared i.e. the reference counter is set to the
+ * number of replicas and the replica that releases the last reference passes the message
+ * further. Therefore, the garbage cannot overtake messages still processed by other replicas.
+ * @param[in] ctx Plugin context
+ * @param[in] cfg Private instance data
+ * @param[in] msg Message to process
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_splitter_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
+
+/**
+ * @brief Pass multiple IPFIX or Transport Session Messages to replicas
+ *
+ * Same as ipx_plugin_splitter_process(), however, messages for each replica are passed at once.
+ * @param[in] ctx  Plugin context
+ * @param[in] cfg  Private instance data
+ * @param[in] msgs Messages to process
+ * @param[in] cnt  Number of messages
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_splitter_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
+#endif // IPFIXCOL_PLUGIN_SPLITTER_H
@@ -40,11 +40,19 @@
  */
 
 #include <stdlib.h> // aligned_malloc
-//#include <unistd.h>
+#include <unistd.h> // sysconf
 #include <pthread.h>
 #include <time.h>
+#include <limits.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
+#include <build_config.h>
 #include "ring.h"
+#include "hugepage.h"
+#include "placement.h"
 #include "verbose.h"
 
 
@@ -67,6 +75,18 @@
 /** Internal identification of the ring buffer */
 static const char *module = "Ring buffer";
 
+/** Number of busy-wait iterations of the lock-free ring before a thread is parked */
+#define RING_LF_SPIN_CNT  (256U)
+/** Maximum time of parking (in milliseconds), i.e. maximum delay of a not yet woken thread */
+#define RING_LF_PARK_MSEC (10L)
+
+/** Type of newly created ring buffers */
+#ifdef ENABLE_LOCKFREE_RING
+static enum ipx_ring_type ring_type_default = IPX_RING_TYPE_LOCKFREE;
+#else
+static enum ipx_ring_type ring_type_default = IPX_RING_TYPE_LOCKED;
+#endif
+
 /** \brief Data structure for a reader only */
 struct ring_reader {
     /**
@@ -160,6 +180,27 @@ struct ring_sync {
     pthread_cond_t     cond_writer;
 };
 
+/** \brief Slot of the lock-free ring buffer */
+struct ring_lf_slot {
+    /**
+     * \brief Sequence number of the slot
+     * \note If equal to a writer position, the slot is empty and the writer can fill it.
+     *   If equal to the writer position + 1, the slot is filled and the reader can read it.
+     *   After reading, the reader moves the sequence number by size of the ring to the next lap.
+     */
+    uint32_t   seq;
+    /** \brief Stored message                                                               */
+    ipx_msg_t *msg;
+};
+
+/** \brief Parking place for threads of the lock-free ring buffer (empty/full buffer) */
+struct ring_lf_park {
+    /** \brief Futex word (incremented on every wake-up)                                    */
+    uint32_t event;
+    /** \brief Number of parked (or about to be parked) threads                             */
+    uint32_t waiters;
+};
+
 /** \brief Ring buffer */
 struct ipx_ring {
     /** A Reader only structure (cache aligned)         */
@@ -174,8 +215,89 @@ struct ipx_ring {
     bool               mw_mode;
     /** Ring data (array of pointers)                   */
     ipx_msg_t        **data;
+    /** Memory of the ring data or lock-free slots      */
+    struct ipx_hugepage_mem mem;
+
+    /** Consumer called directly by writers (see ipx_ring_direct_set()) */
+    struct {
+        /** Callback function (NULL, if disabled)       */
+        ipx_ring_direct_cb cb;
+        /** Argument of the callback function           */
+        void *arg;
+    } direct;
+
+    /** Implementation of the ring                      */
+    enum ipx_ring_type type;
+    struct {
+        /** Writer head i.e. position of the next write (cache aligned)     */
+        uint32_t             head        __ipx_cache_aligned;
+        /** Reader tail i.e. position of the next read (cache aligned)      */
+        uint32_t             tail        __ipx_cache_aligned;
+        /** Parking place of the reader (cache aligned)                     */
+        struct ring_lf_park  park_reader __ipx_cache_aligned;
+        /** Parking place of writers (cache aligned)                        */
+        struct ring_lf_park  park_writer __ipx_cache_aligned;
+        /** Size of the ring minus 1 (size is always power of two)          */
+        uint32_t             mask        __ipx_cache_aligned;
+        /** Size of a wake-up block (power of two), parked threads are woken up after each block */
+        uint32_t             div_block;
+        /** Number of busy-wait iterations before parking (0 on uniprocessors)     */
+        uint32_t             spin_cnt;
+        /** Array of slots                                                  */
+        struct ring_lf_slot *slots;
+    } lf; /**< Lock-free implementation (valid only for #IPX_RING_TYPE_LOCKFREE) */
 };
 
+void
+ipx_ring_type_set(enum ipx_ring_type type)
+{
+    ring_type_default = type;
+}
+
+enum ipx_ring_type
+ipx_ring_type_get()
+{
+    return ring_type_default;
+}
+
+/**
+ * \brief Initialize the lock-free part of a ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] size Requested size of the ring (will be rounded up to the power of two)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of memory allocation failure
+ */
+static int
+ring_lf_init(ipx_ring_t *ring, uint32_t size)
+{
+    uint32_t lf_size = 1;
+    while (lf_size < size) {
+        lf_size <<= 1;
+    }
+
+    if (ipx_hugepage_alloc_mapped(&ring->mem, sizeof(*ring->lf.slots) * lf_size) != IPX_OK) {
+        return IPX_ERR_NOMEM;
+    }
+    ring->lf.slots = ring->mem.addr;
+
+    for (uint32_t i = 0; i < lf_size; ++i) {
+        ring->lf.slots[i].seq = i;
+        ring->lf.slots[i].msg = NULL;
+    }
+
+    ring->lf.head = 0;
+    ring->lf.tail = 0;
+    ring->lf.mask = lf_size - 1;
+    ring->lf.div_block = (lf_size / 8 > 0) ? (lf_size / 8) : 1;
+    // Busy-waiting makes sense only if the other side can run in parallel
+    ring->lf.spin_cnt = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? RING_LF_SPIN_CNT : 0;
+    ring->lf.park_reader.event = 0;
+    ring->lf.park_reader.waiters = 0;
+    ring->lf.park_writer.event = 0;
+    ring->lf.park_writer.waiters = 0;
+    return IPX_OK;
+}
+
 ipx_ring_t *
 ipx_ring_init(uint32_t size, bool mw_mode)
 {
@@ -188,10 +310,25 @@ ipx_ring_init(uint32_t size, bool mw_mode)
         return NULL;
     }
 
-    ring->data = aligned_alloc(alignof(*ring->data), sizeof(*ring->data) * size);
-    if (!ring->data) {
-        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
-        goto exit_A;
+    ring->type = ring_type_default;
+    ring->data = NULL;
+    ring->mem = (struct ipx_hugepage_mem) IPX_HUGEPAGE_MEM_INIT;
+    ring->direct.cb = NULL;
+    ring->direct.arg = NULL;
+    ring->lf.slots = NULL;
+
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        // Only slots of the lock-free ring are required
+        if (ring_lf_init(ring, size) != IPX_OK) {
+            IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            goto exit_A;
+        }
+    } else {
+        if (ipx_hugepage_alloc_mapped(&ring->mem, sizeof(*ring->data) * size) != IPX_OK) {
+            IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            goto exit_A;
+        }
+        ring->data = ring->mem.addr;
     }
 
     // Initialize writers' spin lock
@@ -263,7 +400,7 @@ exit_D:
 exit_C:
     pthread_spin_destroy(&ring->writer_lock);
 exit_B:
-    free(ring->data);
+    ipx_hugepage_free(&ring->mem);
 exit_A:
     free(ring);
     return NULL;
@@ -272,8 +409,14 @@ exit_A:
 void
 ipx_ring_destroy(ipx_ring_t *ring)
 {
-    // The last read message is not confirmed by the reader, it is 1 index behind -> "+ 1"
-    if (ring->reader.read_idx + 1 != ring->writer.write_idx) {
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        if (ring->lf.head != ring->lf.tail) {
+            uint32_t cnt = ring->lf.head - ring->lf.tail;
+            IPX_WARNING(module, "Destroying of a ring buffer that still contains %" PRIu32
+                " unprocessed message(s)!", cnt);
+        }
+    } else if (ring->reader.read_idx + 1 != ring->writer.write_idx) {
+        // The last read message is not confirmed by the reader, it is 1 index behind -> "+ 1"
         uint32_t cnt = ring->writer.write_idx - ring->reader.read_idx + 1;
         IPX_WARNING(module, "Destroying of a ring buffer that still contains %" PRIu32
             " unprocessed message(s)!", cnt);
@@ -283,7 +426,7 @@ ipx_ring_destroy(ipx_ring_t *ring)
     pthread_cond_destroy(&ring->sync.cond_reader);
     pthread_mutex_destroy(&ring->sync.mutex);
     pthread_spin_destroy(&ring->writer_lock);
-    free(ring->data);
+    ipx_hugepage_free(&ring->mem);
     free(ring);
 }
 
@@ -373,11 +516,263 @@ ipx_ring_commit(ipx_ring_t *ring)
     }
 }
 
+/** \brief Hint to the CPU that the thread is in a busy-wait loop */
+static inline void
+ring_cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * \brief Wait until a futex word changes or a timeout expires
+ *
+ * \note On platforms without futex support, the thread just sleeps for a short time.
+ * \param[in] addr Futex word
+ * \param[in] val  Expected value of the word (if different, returns immediately)
+ * \param[in] msec Maximum number of milliseconds to wait
+ */
+static inline void
+ring_futex_wait(uint32_t *addr, uint32_t val, long msec)
+{
+#if defined(__linux__)
+    struct timespec ts = {msec / 1000, (msec % 1000) * 1000000L};
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, &ts, NULL, 0);
+#else
+    (void) msec;
+    if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) == val) {
+        struct timespec ts = {0, 100000L}; // 100 us
+        nanosleep(&ts, NULL);
+    }
+#endif
+}
+
+/**
+ * \brief Wake up threads waiting on a futex word
+ * \param[in] addr Futex word
+ * \param[in] cnt  Maximum number of threads to wake up
+ */
+static inline void
+ring_futex_wake(uint32_t *addr, int cnt)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, cnt, NULL, NULL, 0);
+#else
+    (void) addr;
+    (void) cnt;
+#endif
+}
+
+/**
+ * \brief Wait until a sequence number of a slot (lock-free ring) is changed
+ *
+ * First, the thread busy-waits for a short time. If the sequence number is still the same,
+ * the thread is parked until another thread wakes it up (see ring_lf_wake()) or a short timeout
+ * expires. The caller MUST check the sequence number again after return.
+ * \param[in] ring Ring buffer
+ * \param[in] park Parking place
+ * \param[in] seq  Sequence number of the slot
+ * \param[in] old  Last seen value of the sequence number
+ */
+static void
+ring_lf_wait(const ipx_ring_t *ring, struct ring_lf_park *park, const uint32_t *seq, uint32_t old)
+{
+    for (uint32_t i = 0; i < ring->lf.spin_cnt; ++i) {
+        if (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != old) {
+            return;
+        }
+        ring_cpu_relax();
+    }
+
+    uint32_t event = __atomic_load_n(&park->event, __ATOMIC_ACQUIRE);
+    __atomic_fetch_add(&park->waiters, 1, __ATOMIC_SEQ_CST);
+    // Check again to prevent lost wake-ups (see the fence in ring_lf_wake())
+    if (__atomic_load_n(seq, __ATOMIC_SEQ_CST) == old) {
+        ring_futex_wait(&park->event, event, RING_LF_PARK_MSEC);
+    }
+    __atomic_fetch_sub(&park->waiters, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Wake up threads parked on a parking place (lock-free ring), if any
+ * \note If nobody is parked, no system call is performed.
+ * \param[in] park Parking place
+ * \param[in] cnt  Maximum number of threads to wake up
+ */
+static inline void
+ring_lf_wake(struct ring_lf_park *park, int cnt)
+{
+    // Make the previous update of a slot visible before checking number of waiters
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&park->waiters, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+
+    __atomic_fetch_add(&park->event, 1, __ATOMIC_RELEASE);
+    ring_futex_wake(&park->event, cnt);
+}
+
+/**
+ * \brief Add a message into the lock-free ring buffer
+ * \note The function blocks until the message is added.
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added
+ */
+static inline void
+ring_lf_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    struct ring_lf_slot *slot;
+    uint32_t pos = __atomic_load_n(&ring->lf.head, __ATOMIC_RELAXED);
+
+    while (1) {
+        slot = &ring->lf.slots[pos & ring->lf.mask];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t) (seq - pos);
+
+        if (diff == 0) {
+            // The slot is empty -> try to reserve it
+            if (!ring->mw_mode) {
+                __atomic_store_n(&ring->lf.head, pos + 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if (__atomic_compare_exchange_n(&ring->lf.head, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            // Another writer was faster (the position has been updated by the CAS)
+            continue;
+        }
+
+        if (diff < 0) {
+            // The buffer is full -> wait until the reader releases the slot
+            ring_lf_wait(ring, &ring->lf.park_writer, &slot->seq, seq);
+        }
+
+        pos = __atomic_load_n(&ring->lf.head, __ATOMIC_RELAXED);
+    }
+
+    slot->msg = msg;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    // Wake up the reader only after each block of messages (same as sync of the locked ring),
+    // a parked reader also wakes up after a short timeout
+    if (((pos + 1) & (ring->lf.div_block - 1)) == 0) {
+        ring_lf_wake(&ring->lf.park_reader, 1);
+    }
+}
+
+/**
+ * \brief Take a message from a filled slot of the lock-free ring buffer and release the slot
+ * \param[in] ring Ring buffer
+ * \param[in] slot Filled slot at the reader position
+ * \param[in] pos  Reader position
+ * \return Pointer to the message
+ */
+static inline ipx_msg_t *
+ring_lf_take(ipx_ring_t *ring, struct ring_lf_slot *slot, uint32_t pos)
+{
+    ipx_msg_t *msg = slot->msg;
+    // Release the slot for the next lap of writers
+    __atomic_store_n(&slot->seq, pos + ring->lf.mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->lf.tail, pos + 1, __ATOMIC_RELAXED);
+
+    // Wake up writers only after each block of messages (they wait for a full buffer, therefore,
+    // the reader always has at least one block of messages to read)
+    if (((pos + 1) & (ring->lf.div_block - 1)) == 0) {
+        ring_lf_wake(&ring->lf.park_writer, INT_MAX);
+    }
+    return msg;
+}
+
+/**
+ * \brief Get a message from the lock-free ring buffer
+ * \note The function blocks until the message is ready.
+ * \param[in] ring Ring buffer
+ * \return Pointer to the message
+ */
+static inline ipx_msg_t *
+ring_lf_pop(ipx_ring_t *ring)
+{
+    const uint32_t pos = ring->lf.tail;
+    struct ring_lf_slot *slot = &ring->lf.slots[pos & ring->lf.mask];
+    uint32_t seq;
+
+    while ((seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE)) != pos + 1) {
+        // The buffer is empty -> wait for a writer
+        ring_lf_wait(ring, &ring->lf.park_reader, &slot->seq, seq);
+    }
+
+    return ring_lf_take(ring, slot, pos);
+}
+
+/**
+ * \brief Get multiple messages from the lock-free ring buffer
+ * \note The function blocks until at least one message is ready.
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array of messages to fill
+ * \param[in]  max  Maximum number of messages (must be at least 1)
+ * \return Number of messages
+ */
+static inline uint32_t
+ring_lf_pop_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    uint32_t cnt = 0;
+    msgs[cnt++] = ring_lf_pop(ring);
+
+    while (cnt < max) {
+        // Take only messages that are already available
+        const uint32_t pos = ring->lf.tail;
+        struct ring_lf_slot *slot = &ring->lf.slots[pos & ring->lf.mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+            break;
+        }
+
+        msgs[cnt++] = ring_lf_take(ring, slot, pos);
+    }
+
+    return cnt;
+}
+
+/**
+ * @brief Pass a message directly to the consumer of the ring
+ *
+ * In the multi-writer mode, only one writer at time can call the consumer.
+ * @param[in] ring Ring buffer
+ * @param[in] msg  Message to be passed
+ */
+static inline void
+ring_direct_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    if (ring->mw_mode) {
+        pthread_mutex_lock(&ring->sync.mutex);
+        ring->direct.cb(ring->direct.arg, msg);
+        pthread_mutex_unlock(&ring->sync.mutex);
+        return;
+    }
+
+    ring->direct.cb(ring->direct.arg, msg);
+}
+
 void
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
 {
     ipx_msg_t **msg_space;
 
+    if (ring->direct.cb != NULL) {
+        ring_direct_push(ring, msg);
+        return;
+    }
+
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        ring_lf_push(ring, msg);
+        return;
+    }
+
     if (ring->mw_mode) {
         pthread_spin_lock(&ring->writer_lock);
     }
@@ -392,9 +787,46 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
 }
 
 
+void
+ipx_ring_push_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    if (ring->direct.cb != NULL) {
+        for (uint32_t i = 0; i < cnt; ++i) {
+            ring_direct_push(ring, msgs[i]);
+        }
+        return;
+    }
+
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        for (uint32_t i = 0; i < cnt; ++i) {
+            ring_lf_push(ring, msgs[i]);
+        }
+        return;
+    }
+
+    // The writer lock is acquired only once for all messages
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ipx_msg_t **msg_space = ipx_ring_begin(ring);
+        *msg_space = msgs[i];
+        ipx_ring_commit(ring);
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+}
+
 ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring)
 {
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        return ring_lf_pop(ring);
+    }
+
     // Consider previous memory block as processed
     ring->reader.data_idx += ring->reader.last;
     ring->reader.read_idx += ring->reader.last;
@@ -453,8 +885,80 @@ ipx_ring_pop(ipx_ring_t *ring)
     }
 }
 
+uint32_t
+ipx_ring_pop_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    assert(max > 0);
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        return ring_lf_pop_batch(ring, msgs, max);
+    }
+
+    uint32_t cnt = 0;
+    msgs[cnt++] = ipx_ring_pop(ring);
+
+    // Take only messages from the part of the buffer that already belongs to the reader
+    // (the previous message is confirmed during the next pop, i.e. "+ last")
+    while (cnt < max
+            && ring->reader.exchange_idx - (ring->reader.read_idx + ring->reader.last) > 0) {
+        msgs[cnt++] = ipx_ring_pop(ring);
+    }
+
+    return cnt;
+}
+
 void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode)
 {
     ring->mw_mode = mode;
-}
\ No newline at end of file
+}
+
+unsigned int
+ipx_ring_usage(const ipx_ring_t *ring)
+{
+    if (ring->direct.cb != NULL) {
+        // Messages are never stored
+        return 0;
+    }
+
+    uint32_t size;
+    uint32_t used;
+    if (ring->type == IPX_RING_TYPE_LOCKFREE) {
+        const uint32_t tail = __atomic_load_n(&ring->lf.tail, __ATOMIC_RELAXED);
+        const uint32_t head = __atomic_load_n(&ring->lf.head, __ATOMIC_RELAXED);
+        size = ring->lf.mask + 1;
+        used = head - tail;
+    } else {
+        // Free space is between the writer head and the last reader head known to writers
+        const uint32_t write_idx = __atomic_load_n(&ring->writer.write_idx, __ATOMIC_RELAXED);
+        const uint32_t read_idx = __atomic_load_n(&ring->sync.write_idx, __ATOMIC_RELAXED);
+        size = ring->writer.size;
+        used = size - (read_idx - write_idx);
+    }
+
+    if (used > size) {
+        // Inconsistent snapshot
+        used = (used > UINT32_MAX / 2) ? 0 : size;
+    }
+
+    return (unsigned int) ((100ULL * used) / size);
+}
+
+int
+ipx_ring_mem_bind(const ipx_ring_t *ring, int node)
+{
+    // Ring data or lock-free slots
+    return ipx_placement_mem_bind(ring->mem.addr, ring->mem.size, node);
+}
+
+void
+ipx_ring_direct_set(ipx_ring_t *ring, ipx_ring_direct_cb cb, void *arg)
+{
+    ring->direct.cb = cb;
+    ring->direct.arg = arg;
+}
+
+void *
+ipx_ring_direct_arg(const ipx_ring_t *ring)
+{
+    return (ring->direct.cb != NULL) ? ring->direct.arg : NULL;
+}
@@ -65,6 +65,37 @@ extern "C" {
 /** Internal ring buffer type  */
 typedef struct ipx_ring ipx_ring_t;
 
+/** Implementation of the ring buffer synchronization */
+enum ipx_ring_type {
+    /**
+     * Reader and writers exchange their positions under a mutex in blocks and wait on
+     * condition variables when the buffer is empty/full
+     */
+    IPX_RING_TYPE_LOCKED,
+    /**
+     * Lock-free ring with per-slot sequence numbers. Threads park on a futex only when the
+     * buffer is really empty/full.
+     */
+    IPX_RING_TYPE_LOCKFREE
+};
+
+/**
+ * \brief Set the type of ring buffers created by future calls of ipx_ring_init()
+ *
+ * \note Already existing ring buffers are not affected.
+ * \note By default, the type is determined by the build configuration (see ENABLE_LOCKFREE_RING)
+ * \param[in] type New type
+ */
+IPX_API void
+ipx_ring_type_set(enum ipx_ring_type type);
+
+/**
+ * \brief Get the type of ring buffers created by ipx_ring_init()
+ * \return Current type
+ */
+IPX_API enum ipx_ring_type
+ipx_ring_type_get();
+
 /**
  * \brief Create a new ring buffer
  *
@@ -72,6 +103,8 @@ typedef struct ipx_ring ipx_ring_t;
  *   time, result is undefined!
  * \note Enabling \p mw_mode has significant impact on performance in case the protection is not
  *   necessary.
+ * \note The implementation is selected by ipx_ring_type_set(). Size of a lock-free ring buffer
+ *   is rounded up to the nearest power of two.
  * \param[in] size    Size of the ring buffer (number of pointers)
  * \param[in] mw_mode Multi-writer mode (multiple writers can writer into the buffer)
  * \return A pointer to the buffer or NULL (in case of an error).
@@ -99,6 +132,19 @@ ipx_ring_destroy(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 
+/**
+ * \brief Add multiple messages into the ring buffer
+ *
+ * The messages are added in the same order as in the array. In the multi-writer mode, they can be
+ * interleaved with messages of other writers.
+ * \note The function blocks until all messages are added.
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added into the ring buffer
+ * \param[in] cnt  Number of messages in the array
+ */
+IPX_API void
+ipx_ring_push_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt);
+
 /**
  * \brief Get a message from the ring buffer
  *
@@ -110,6 +156,21 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 IPX_API ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring);
 
+/**
+ * \brief Get multiple messages from the ring buffer
+ *
+ * The function waits only for the first message. Other messages are added only if they are
+ * already available, i.e. the function never waits for the whole batch.
+ * \note The function blocks until at least one message is ready.
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array to be filled with messages
+ * \param[in]  max  Maximum number of messages (size of the array, MUST be at least 1)
+ * \return Number of messages in the array (at least 1)
+ */
+IPX_API uint32_t
+ipx_ring_pop_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max);
+
 /**
  * \brief Change (i.e. disable/enable) multi-writer mode
  *
@@ -122,6 +183,62 @@ ipx_ring_pop(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode);
 
+/**
+ * \brief Get approximate occupancy of the ring buffer
+ *
+ * The value is not synchronized with readers and writers, therefore, it might be slightly
+ * outdated (e.g. the locked implementation exchanges positions only in blocks). It's supposed
+ * to be used only as an indicator of pressure of the pipeline.
+ * \note The function can be called by any thread.
+ * \param[in] ring Ring buffer
+ * \return Occupancy in percent (0 - 100)
+ */
+IPX_API unsigned int
+ipx_ring_usage(const ipx_ring_t *ring);
+
+/**
+ * \brief Move memory of the ring buffer to a NUMA node
+ *
+ * The buffer should be placed on the node of its reader, as it's the most frequent user of
+ * the buffer. Only the storage of messages is moved (it's mapped separately from other
+ * objects). Failure is not fatal (the memory stays where it is).
+ * \param[in] ring Ring buffer
+ * \param[in] node NUMA node
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG or #IPX_ERR_DENIED on failure (see ipx_placement_mem_bind())
+ */
+IPX_API int
+ipx_ring_mem_bind(const ipx_ring_t *ring, int node);
+
+/** Consumer of messages called directly by writers of a ring buffer */
+typedef void (*ipx_ring_direct_cb)(void *arg, ipx_msg_t *msg);
+
+/**
+ * \brief Pass messages directly to a consumer instead of storing them in the ring buffer
+ *
+ * If enabled, the callback is called by a writer (i.e. in the thread of the writer) for each
+ * message added by ipx_ring_push() or ipx_ring_push_batch() and the function returns only
+ * after the callback is finished. The ring buffer stays empty, therefore, the reader must not
+ * try to get messages from it. In the multi-writer mode, calls of the callback are serialized.
+ *
+ * \warning
+ *   During this function call, the user MUST make sure that nobody is pushing or getting
+ *   messages from the buffer.
+ * \param[in] ring Ring buffer
+ * \param[in] cb   Consumer callback (NULL to disable)
+ * \param[in] arg  Argument passed to the consumer
+ */
+IPX_API void
+ipx_ring_direct_set(ipx_ring_t *ring, ipx_ring_direct_cb cb, void *arg);
+
+/**
+ * \brief Get the argument of the consumer called directly by writers
+ * \param[in] ring Ring buffer
+ * \return Argument passed to the consumer or NULL (messages are not passed directly)
+ */
+IPX_API void *
+ipx_ring_direct_arg(const ipx_ring_t *ring);
+
 /**
  * @}
  */
@@ -0,0 +1,326 @@
+/**
+ * @file
+ * @brief Pool of interned (Options) Templates
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ipfixcol2.h>
+
+/** Default number of buckets (MUST be a power of two)                         */
+#define TPOOL_DEF_BUCKETS (64U)
+
+/** Interned Template                                                          */
+struct ipx_tmplt_ref {
+    /** Next Template in the same bucket                                       */
+    struct ipx_tmplt_ref *next;
+    /** Hash of the definition                                                 */
+    uint64_t hash;
+    /** Number of references                                                   */
+    uint64_t refs;
+    /** Canonical copy of the Template                                         */
+    struct fds_template *tmplt;
+    /** User data                                                              */
+    void *data;
+};
+
+/** Pool of interned Templates                                                 */
+struct ipx_tmplt_pool {
+    /** Destructor of user data                                                */
+    ipx_tmplt_pool_data_cb data_free;
+    /** Number of buckets (power of two)                                       */
+    size_t buckets_cnt;
+    /** Buckets (lists of interned Templates)                                  */
+    struct ipx_tmplt_ref **buckets;
+    /** Statistics                                                             */
+    struct ipx_tmplt_pool_stats stats;
+};
+
+/**
+ * \brief Calculate a hash of a Template definition (FNV-1a)
+ * \param[in] type Type of the Template
+ * \param[in] data Raw definition
+ * \param[in] size Size of the definition
+ * \return Hash value
+ */
+static uint64_t
+tpool_hash(enum fds_template_type type, const uint8_t *data, uint16_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL ^ (uint64_t) type;
+    for (uint16_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * \brief Find an interned Template
+ * \param[in] pool Pool
+ * \param[in] hash Hash of the definition
+ * \param[in] type Type of the Template
+ * \param[in] data Raw definition
+ * \param[in] size Size of the definition
+ * \return Pointer or NULL (not found)
+ */
+static struct ipx_tmplt_ref *
+tpool_find(const struct ipx_tmplt_pool *pool, uint64_t hash, enum fds_template_type type,
+    const uint8_t *data, uint16_t size)
+{
+    struct ipx_tmplt_ref *ref = pool->buckets[hash & (pool->buckets_cnt - 1)];
+    for (; ref != NULL; ref = ref->next) {
+        const struct fds_template *tmplt = ref->tmplt;
+        if (ref->hash == hash && tmplt->type == type && tmplt->raw.length == size
+                && memcmp(tmplt->raw.data, data, size) == 0) {
+            return ref;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Double the number of buckets
+ *
+ * If a memory allocation fails, the pool keeps its current buckets (i.e. only lookups are
+ * slower).
+ * \param[in] pool Pool
+ */
+static void
+tpool_grow(struct ipx_tmplt_pool *pool)
+{
+    const size_t cnt_new = 2 * pool->buckets_cnt;
+    struct ipx_tmplt_ref **buckets_new = calloc(cnt_new, sizeof(*buckets_new));
+    if (!buckets_new) {
+        return;
+    }
+
+    for (size_t i = 0; i < pool->buckets_cnt; ++i) {
+        struct ipx_tmplt_ref *ref = pool->buckets[i];
+        while (ref != NULL) {
+            struct ipx_tmplt_ref *next = ref->next;
+            const size_t idx = ref->hash & (cnt_new - 1);
+            ref->next = buckets_new[idx];
+            buckets_new[idx] = ref;
+            ref = next;
+        }
+    }
+
+    free(pool->buckets);
+    pool->buckets = buckets_new;
+    pool->buckets_cnt = cnt_new;
+}
+
+/**
+ * \brief Insert a new Template into the pool
+ * \param[in] pool  Pool
+ * \param[in] hash  Hash of the definition
+ * \param[in] tmplt Template (the pool takes responsibility for it only on success)
+ * \return Pointer or NULL (memory allocation error)
+ */
+static struct ipx_tmplt_ref *
+tpool_insert(struct ipx_tmplt_pool *pool, uint64_t hash, struct fds_template *tmplt)
+{
+    struct ipx_tmplt_ref *ref = malloc(sizeof(*ref));
+    if (!ref) {
+        return NULL;
+    }
+
+    if (pool->stats.tmplts >= pool->buckets_cnt) {
+        // Keep the load factor at most 1
+        tpool_grow(pool);
+    }
+
+    const size_t idx = hash & (pool->buckets_cnt - 1);
+    ref->next = pool->buckets[idx];
+    ref->hash = hash;
+    ref->refs = 1;
+    ref->tmplt = tmplt;
+    ref->data = NULL;
+    pool->buckets[idx] = ref;
+
+    pool->stats.tmplts++;
+    pool->stats.refs++;
+    pool->stats.misses++;
+    return ref;
+}
+
+/**
+ * \brief Free an interned Template
+ * \param[in] pool Pool
+ * \param[in] ref  Interned Template
+ */
+static void
+tpool_ref_free(struct ipx_tmplt_pool *pool, struct ipx_tmplt_ref *ref)
+{
+    if (ref->data != NULL && pool->data_free != NULL) {
+        pool->data_free(ref->data);
+    }
+
+    fds_template_destroy(ref->tmplt);
+    free(ref);
+}
+
+ipx_tmplt_pool_t *
+ipx_tmplt_pool_create(ipx_tmplt_pool_data_cb data_free)
+{
+    struct ipx_tmplt_pool *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->buckets = calloc(TPOOL_DEF_BUCKETS, sizeof(*pool->buckets));
+    if (!pool->buckets) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->buckets_cnt = TPOOL_DEF_BUCKETS;
+    pool->data_free = data_free;
+    return pool;
+}
+
+void
+ipx_tmplt_pool_destroy(ipx_tmplt_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    for (size_t i = 0; i < pool->buckets_cnt; ++i) {
+        struct ipx_tmplt_ref *ref = pool->buckets[i];
+        while (ref != NULL) {
+            struct ipx_tmplt_ref *next = ref->next;
+            tpool_ref_free(pool, ref);
+            ref = next;
+        }
+    }
+
+    free(pool->buckets);
+    free(pool);
+}
+
+int
+ipx_tmplt_pool_get_raw(ipx_tmplt_pool_t *pool, enum fds_template_type type, const void *data,
+    uint16_t size, ipx_tmplt_ref_t **ref)
+{
+    const uint64_t hash = tpool_hash(type, data, size);
+    struct ipx_tmplt_ref *item = tpool_find(pool, hash, type, data, size);
+    if (item != NULL) {
+        item->refs++;
+        pool->stats.refs++;
+        pool->stats.hits++;
+        *ref = item;
+        return IPX_OK;
+    }
+
+    struct fds_template *tmplt;
+    uint16_t tmplt_size = size;
+    switch (fds_template_parse(type, data, &tmplt_size, &tmplt)) {
+    case FDS_OK:
+        break;
+    case FDS_ERR_NOMEM:
+        return IPX_ERR_NOMEM;
+    default:
+        return IPX_ERR_FORMAT;
+    }
+
+    if (tmplt->raw.length != size) {
+        // The size of the definition doesn't match
+        fds_template_destroy(tmplt);
+        return IPX_ERR_FORMAT;
+    }
+
+    item = tpool_insert(pool, hash, tmplt);
+    if (!item) {
+        fds_template_destroy(tmplt);
+        return IPX_ERR_NOMEM;
+    }
+
+    *ref = item;
+    return IPX_OK;
+}
+
+int
+ipx_tmplt_pool_get(ipx_tmplt_pool_t *pool, const struct fds_template *tmplt,
+    ipx_tmplt_ref_t **ref)
+{
+    const uint64_t hash = tpool_hash(tmplt->type, tmplt->raw.data, tmplt->raw.length);
+    struct ipx_tmplt_ref *item = tpool_find(pool, hash, tmplt->type, tmplt->raw.data,
+        tmplt->raw.length);
+    if (item != NULL) {
+        item->refs++;
+        pool->stats.refs++;
+        pool->stats.hits++;
+        *ref = item;
+        return IPX_OK;
+    }
+
+    struct fds_template *tmplt_cpy = fds_template_copy(tmplt);
+    if (!tmplt_cpy) {
+        return IPX_ERR_NOMEM;
+    }
+
+    item = tpool_insert(pool, hash, tmplt_cpy);
+    if (!item) {
+        fds_template_destroy(tmplt_cpy);
+        return IPX_ERR_NOMEM;
+    }
+
+    *ref = item;
+    return IPX_OK;
+}
+
+void
+ipx_tmplt_pool_put(ipx_tmplt_pool_t *pool, ipx_tmplt_ref_t *ref)
+{
+    assert(ref->refs > 0 && pool->stats.refs > 0);
+    pool->stats.refs--;
+    if (--ref->refs > 0) {
+        return;
+    }
+
+    // Remove the Template from its bucket
+    struct ipx_tmplt_ref **prev = &pool->buckets[ref->hash & (pool->buckets_cnt - 1)];
+    while (*prev != ref) {
+        assert(*prev != NULL);
+        prev = &(*prev)->next;
+    }
+
+    *prev = ref->next;
+    pool->stats.tmplts--;
+    tpool_ref_free(pool, ref);
+}
+
+const struct fds_template *
+ipx_tmplt_ref_template(const ipx_tmplt_ref_t *ref)
+{
+    return ref->tmplt;
+}
+
+void *
+ipx_tmplt_ref_data_get(const ipx_tmplt_ref_t *ref)
+{
+    return ref->data;
+}
+
+void
+ipx_tmplt_ref_data_set(ipx_tmplt_pool_t *pool, ipx_tmplt_ref_t *ref, void *data)
+{
+    if (ref->data != NULL && ref->data != data && pool->data_free != NULL) {
+        pool->data_free(ref->data);
+    }
+
+    ref->data = data;
+}
+
+void
+ipx_tmplt_pool_stats_get(const ipx_tmplt_pool_t *pool, struct ipx_tmplt_pool_stats *stats)
+{
+    *stats = pool->stats;
+}
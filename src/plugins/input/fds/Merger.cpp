@@ -0,0 +1,235 @@
+/**
+ * \file src/plugins/input/fds/Merger.cpp
+ * \brief Merger of messages generated by readers of files read in parallel
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+
+#include "Merger.hpp"
+
+Merger::Merger(size_t streams, size_t capacity, bool time_order)
+    : m_streams(streams), m_capacity(capacity), m_time_order(time_order)
+{
+    for (size_t i = 0; i < streams; ++i) {
+        m_streams[i].output.reset(new StreamOutput(*this, i));
+    }
+}
+
+Merger::~Merger()
+{
+    for (auto &stream : m_streams) {
+        for (auto &event : stream.events) {
+            if (event.type == Type::IPFIX) {
+                free(event.msg);
+            }
+        }
+    }
+}
+
+Output &
+Merger::output(size_t idx)
+{
+    return *m_streams[idx].output;
+}
+
+void
+Merger::finish(size_t idx, bool failed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_streams[idx].finished = true;
+    m_failed |= failed;
+    m_cv_consumer.notify_one();
+}
+
+void
+Merger::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_cv_producer.notify_all();
+}
+
+bool
+Merger::stopped()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stop;
+}
+
+/**
+ * @brief Add a message to the queue of a stream
+ *
+ * If the queue is full, the function waits until the consumer makes free space in it or until
+ * the producers are stopped.
+ * @param[in] idx   Index of the stream
+ * @param[in] event Message
+ */
+void
+Merger::push(size_t idx, const Event &event)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    Stream &stream = m_streams[idx];
+    m_cv_producer.wait(lock, [&]() {
+        return m_stop || stream.events.size() < m_capacity;
+    });
+
+    stream.events.push_back(event);
+    m_cv_consumer.notify_one();
+}
+
+/**
+ * @brief Select the stream from which the next message will be taken
+ *
+ * @warning The mutex MUST be locked.
+ * @param[out] idx Index of the selected stream
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_NOTFOUND if the consumer must wait for more messages
+ * @return #IPX_ERR_EOF if all streams have been finished and are empty
+ */
+int
+Merger::select(size_t &idx)
+{
+    const size_t cnt = m_streams.size();
+    bool found = false;
+    bool all_finished = true;
+    uint32_t found_time = 0;
+
+    // Streams are visited in turn, starting after the last selected one
+    for (size_t i = 1; i <= cnt; ++i) {
+        const size_t stream_idx = (m_last + i) % cnt;
+        const Stream &stream = m_streams[stream_idx];
+        all_finished &= stream.finished;
+
+        if (stream.events.empty()) {
+            if (m_time_order && !stream.finished) {
+                // The next message of the stream might be older than the others
+                return IPX_ERR_NOTFOUND;
+            }
+            continue;
+        }
+
+        const Event &event = stream.events.front();
+        if (!m_time_order || event.type != Type::IPFIX) {
+            // Session notifications are not delayed
+            idx = stream_idx;
+            return IPX_OK;
+        }
+
+        struct fds_ipfix_msg_hdr hdr;
+        memcpy(&hdr, event.msg, FDS_IPFIX_MSG_HDR_LEN);
+        const uint32_t exp_time = ntohl(hdr.export_time);
+        if (!found || exp_time < found_time) {
+            idx = stream_idx;
+            found_time = exp_time;
+            found = true;
+        }
+    }
+
+    if (found) {
+        return IPX_OK;
+    }
+
+    return all_finished ? IPX_ERR_EOF : IPX_ERR_NOTFOUND;
+}
+
+int
+Merger::forward(Output &out)
+{
+    Event event;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        size_t idx;
+        int ret;
+
+        while (!m_failed && (ret = select(idx)) == IPX_ERR_NOTFOUND) {
+            m_cv_consumer.wait(lock);
+        }
+
+        if (m_failed) {
+            return IPX_ERR_DENIED;
+        }
+
+        if (ret == IPX_ERR_EOF) {
+            return IPX_ERR_EOF;
+        }
+
+        Stream &stream = m_streams[idx];
+        event = stream.events.front();
+        stream.events.pop_front();
+        m_last = idx;
+        m_cv_producer.notify_all();
+    }
+
+    // Pass the message without holding the lock (it can block)
+    pass(out, event);
+    return IPX_OK;
+}
+
+void
+Merger::drain(Output &out)
+{
+    std::deque<Event> events;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &stream : m_streams) {
+            events.insert(events.end(), stream.events.begin(), stream.events.end());
+            stream.events.clear();
+        }
+    }
+
+    for (const auto &event : events) {
+        if (event.type == Type::IPFIX) {
+            free(event.msg);
+            continue;
+        }
+
+        pass(out, event);
+    }
+}
+
+/**
+ * @brief Pass a message to an output
+ * @param[in] out   Output
+ * @param[in] event Message
+ * @throw FDS_exception if the output fails
+ */
+void
+Merger::pass(Output &out, const Event &event)
+{
+    switch (event.type) {
+    case Type::SESSION_OPEN:
+        out.session_open(event.ts);
+        break;
+    case Type::SESSION_CLOSE:
+        out.session_close(event.ts);
+        break;
+    case Type::IPFIX:
+        out.ipfix(event.msg, event.ts, event.odid);
+        break;
+    }
+}
+
+void
+Merger::StreamOutput::session_open(struct ipx_session *ts)
+{
+    m_merger.push(m_idx, Event{Type::SESSION_OPEN, ts, nullptr, 0});
+}
+
+void
+Merger::StreamOutput::session_close(struct ipx_session *ts)
+{
+    m_merger.push(m_idx, Event{Type::SESSION_CLOSE, ts, nullptr, 0});
+}
+
+void
+Merger::StreamOutput::ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid)
+{
+    m_merger.push(m_idx, Event{Type::IPFIX, const_cast<struct ipx_session *>(ts), msg, odid});
+}
@@ -0,0 +1,178 @@
+/**
+ * \file src/plugins/input/fds/Merger.hpp
+ * \brief Merger of messages generated by readers of files read in parallel
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef FDS_MERGER_HPP
+#define FDS_MERGER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <ipfixcol2.h>
+#include <stdint.h>
+
+#include "Output.hpp"
+
+/**
+ * @brief Merger of streams of messages
+ *
+ * Each stream is produced by a different thread (through the output of the stream) and all
+ * streams are consumed by the thread of the plugin instance, which passes the messages to the
+ * pipeline. Each stream has a queue of limited size, so a producer waits if the consumer cannot
+ * keep up.
+ *
+ * Without time ordering, the streams are consumed in turn as soon as they have any messages.
+ * With time ordering, the consumer waits until all unfinished streams have at least one message
+ * and the IPFIX Message with the lowest Export Time is selected (i.e. k-way merge). Therefore,
+ * the output is ordered, if each stream is ordered by itself.
+ */
+class Merger {
+public:
+    /**
+     * @brief Constructor
+     * @param[in] streams    Number of streams
+     * @param[in] capacity   Maximum number of messages in the queue of each stream
+     * @param[in] time_order Merge the streams by the Export Time of IPFIX Messages
+     */
+    Merger(size_t streams, size_t capacity, bool time_order);
+    /**
+     * @brief Destructor
+     * @note Unprocessed IPFIX Messages are freed.
+     */
+    ~Merger();
+
+    /**
+     * @brief Get the output of a stream (for its producer)
+     * @param[in] idx Index of the stream
+     */
+    Output &
+    output(size_t idx);
+    /**
+     * @brief Mark a stream as finished (by its producer)
+     *
+     * No more messages can be added to the stream.
+     * @param[in] idx    Index of the stream
+     * @param[in] failed The stream has been finished due to a fatal failure
+     */
+    void
+    finish(size_t idx, bool failed = false);
+
+    /**
+     * @brief Stop the producers
+     *
+     * Producers no longer wait for free space in their queues and they should finish their
+     * streams as soon as possible.
+     */
+    void
+    stop();
+    /**
+     * @brief Check if the producers have been stopped
+     */
+    bool
+    stopped();
+
+    /**
+     * @brief Pass the next message to an output (consumer only)
+     *
+     * Waits until the next message is available (see the class description).
+     * @param[in] out Output to which the message is passed
+     * @return #IPX_OK on success
+     * @return #IPX_ERR_EOF if all streams have been finished and all messages have been passed
+     * @return #IPX_ERR_DENIED if any stream has been finished due to a fatal failure
+     * @throw FDS_exception if the output fails
+     */
+    int
+    forward(Output &out);
+    /**
+     * @brief Pass all remaining Transport Session notifications to an output (consumer only)
+     *
+     * IPFIX Messages are dropped. All streams MUST be already finished.
+     * @param[in] out Output to which the notifications are passed
+     * @throw FDS_exception if the output fails
+     */
+    void
+    drain(Output &out);
+
+private:
+    /// Type of a message in a stream
+    enum class Type {
+        SESSION_OPEN,
+        SESSION_CLOSE,
+        IPFIX
+    };
+
+    /// Message in a stream
+    struct Event {
+        /// Type of the message
+        Type type;
+        /// Transport Session
+        struct ipx_session *ts;
+        /// Raw IPFIX Message (only Type::IPFIX)
+        uint8_t *msg;
+        /// Observation Domain ID (only Type::IPFIX)
+        uint32_t odid;
+    };
+
+    /// Output of a stream
+    class StreamOutput : public Output {
+    public:
+        StreamOutput(Merger &merger, size_t idx) : m_merger(merger), m_idx(idx) {};
+
+        void
+        session_open(struct ipx_session *ts) override;
+        void
+        session_close(struct ipx_session *ts) override;
+        void
+        ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid) override;
+
+    private:
+        Merger &m_merger;
+        size_t m_idx;
+    };
+
+    /// Stream of messages
+    struct Stream {
+        /// Queue of messages
+        std::deque<Event> events;
+        /// Output of the stream
+        std::unique_ptr<StreamOutput> output;
+        /// No more messages will be added
+        bool finished = false;
+    };
+
+    /// Protects all members below
+    std::mutex m_mutex;
+    /// Signalization of new messages (or finished streams) for the consumer
+    std::condition_variable m_cv_consumer;
+    /// Signalization of free space for producers
+    std::condition_variable m_cv_producer;
+
+    /// Streams
+    std::vector<Stream> m_streams;
+    /// Maximum number of messages in a queue
+    size_t m_capacity;
+    /// Merge the streams by the Export Time
+    bool m_time_order;
+    /// Index of the stream from which the last message has been taken
+    size_t m_last = 0;
+    /// Producers have been stopped
+    bool m_stop = false;
+    /// Any stream has failed
+    bool m_failed = false;
+
+    void
+    push(size_t idx, const Event &event);
+    int
+    select(size_t &idx);
+
+    static void
+    pass(Output &out, const Event &event);
+};
+
+#endif // FDS_MERGER_HPP
@@ -0,0 +1,112 @@
+/**
+ * \file src/plugins/input/fds/Output.cpp
+ * \brief Destination of messages generated by a FDS file reader
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cstdlib>
+#include <netinet/in.h>
+
+#include "Exception.hpp"
+#include "Output.hpp"
+
+/**
+ * @brief Notify other plugins about a new Transport Session
+ *
+ * A new Session Message is generated and send to other plugins in the pipeline.
+ * @param[in] ts Transport Session
+ * @throw FDS_exception in case of failure
+ */
+void
+CtxOutput::session_open(struct ipx_session *ts)
+{
+    struct ipx_msg_session *msg;
+
+    // Notify plugins further in the pipeline about the new session
+    msg = ipx_msg_session_create(ts, IPX_MSG_SESSION_OPEN);
+    if (!msg) {
+        throw FDS_exception("Failed to create a Transport Session notification");
+    }
+
+    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg)) != IPX_OK) {
+        ipx_msg_session_destroy(msg);
+        throw  FDS_exception("Failed to pass a Transport Session notification");
+    }
+}
+
+/**
+ * @brief Notify other plugins about a close of a Transport Session
+ *
+ * @warning
+ *   User MUST stop using the Session as it is send in a garbage message to the
+ *   pipeline and it will be automatically freed later.
+ * @param[in] ts Transport Session
+ * @throw FDS_exception in case of failure
+ */
+void
+CtxOutput::session_close(struct ipx_session *ts)
+{
+    ipx_msg_session_t *msg_session;
+    ipx_msg_garbage_t *msg_garbage;
+    ipx_msg_garbage_cb garbage_cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+
+    msg_session = ipx_msg_session_create(ts, IPX_MSG_SESSION_CLOSE);
+    if (!msg_session) {
+        throw FDS_exception("Failed to create a Transport Session notification");
+    }
+
+    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg_session)) != IPX_OK) {
+        ipx_msg_session_destroy(msg_session);
+        throw FDS_exception("Failed to pass a Transport Session notification");
+    }
+
+    msg_garbage = ipx_msg_garbage_create(ts, garbage_cb);
+    if (!msg_garbage) {
+        /* Memory leak... We cannot destroy the session as it can be used
+         * by other plugins further in the pipeline. */
+        throw FDS_exception("Failed to create a garbage message with a Transport Session");
+    }
+
+    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(msg_garbage)) != IPX_OK) {
+        /* Memory leak... We cannot destroy the message as it also destroys
+         * the session structure. */
+        throw FDS_exception("Failed to pass a garbage message with a Transport Session");
+    }
+}
+
+/**
+ * Send an IPFIX Message to the pipeline
+ *
+ * @note
+ *   The function takes responsibility for the Message. Therefore, in case of
+ *   failure, the Message will be freed.
+ * @param[in] msg  Raw IPFIX Message to send
+ * @param[in] ts   Transport Session
+ * @param[in] odid Observation Domain ID (of the message)
+ * @throw FDS_exception in case of failure
+ */
+void
+CtxOutput::ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid)
+{
+    uint16_t msg_size = ntohs(reinterpret_cast<fds_ipfix_msg_hdr *>(msg)->length);
+    ipx_msg_ipfix_t *msg_ptr;
+    struct ipx_msg_ctx msg_ctx;
+
+    msg_ctx.session = ts;
+    msg_ctx.odid = odid;
+    msg_ctx.stream = 0; // stream is not stored in the file
+
+    msg_ptr = ipx_msg_ipfix_create(m_ctx, &msg_ctx, msg, msg_size);
+    if (!msg_ptr) {
+        free(msg);
+        throw FDS_exception("Failed to allocate an IPFIX Message!");
+    }
+
+    // Send it to the pipeline
+    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg_ptr)) != IPX_OK) {
+        ipx_msg_ipfix_destroy(msg_ptr);
+        throw FDS_exception("Failed to pass an IPFIX Message!");
+    }
+}
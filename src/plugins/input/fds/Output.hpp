@@ -0,0 +1,75 @@
+/**
+ * \file src/plugins/input/fds/Output.hpp
+ * \brief Destination of messages generated by a FDS file reader
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef FDS_OUTPUT_HPP
+#define FDS_OUTPUT_HPP
+
+#include <ipfixcol2.h>
+#include <stdint.h>
+
+/// Destination of messages generated by a reader
+class Output {
+public:
+    virtual ~Output() = default;
+
+    /**
+     * @brief Notify other plugins about a new Transport Session
+     * @param[in] ts Transport Session
+     * @throw FDS_exception in case of failure
+     */
+    virtual void
+    session_open(struct ipx_session *ts) = 0;
+    /**
+     * @brief Notify other plugins about a close of a Transport Session
+     *
+     * @warning
+     *   User MUST stop using the Session as it is send in a garbage message to the
+     *   pipeline and it will be automatically freed later.
+     * @param[in] ts Transport Session
+     * @throw FDS_exception in case of failure
+     */
+    virtual void
+    session_close(struct ipx_session *ts) = 0;
+    /**
+     * @brief Send an IPFIX Message
+     *
+     * @note
+     *   The function takes responsibility for the Message. Therefore, in case of
+     *   failure, the Message will be freed.
+     * @param[in] msg  Raw IPFIX Message to send
+     * @param[in] ts   Transport Session
+     * @param[in] odid Observation Domain ID (of the message)
+     * @throw FDS_exception in case of failure
+     */
+    virtual void
+    ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid) = 0;
+};
+
+/// Output that passes messages directly to the pipeline
+class CtxOutput : public Output {
+public:
+    /**
+     * @brief Constructor
+     * @param[in] ctx Plugin context (for passing messages)
+     */
+    CtxOutput(ipx_ctx_t *ctx) : m_ctx(ctx) {};
+    ~CtxOutput() = default;
+
+    void
+    session_open(struct ipx_session *ts) override;
+    void
+    session_close(struct ipx_session *ts) override;
+    void
+    ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid) override;
+
+private:
+    /// Plugin context
+    ipx_ctx_t *m_ctx;
+};
+
+#endif // FDS_OUTPUT_HPP
@@ -64,8 +64,8 @@ static inline bool in6_is_addr_v4mapped(const uint8_t addr[16])
         addr[11] == 0xFF;
 }
 
-Reader::Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path)
-    : m_ctx(ctx), m_cfg(cfg)
+Reader::Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path, Output &out)
+    : m_ctx(ctx), m_cfg(cfg), m_out(out)
 {
     uint32_t flags = FDS_FILE_READ;
     flags |= (m_cfg->async) ? 0 : FDS_FILE_NOASYNC;
@@ -84,7 +84,7 @@ Reader::~Reader()
 {
     // Send notification about closing of all Transport Sessions
     for (auto &it : m_sessions) {
-        session_close(it.second.info);
+        m_out.session_close(it.second.info);
         it.second.info = nullptr;
     }
 }
@@ -148,70 +148,6 @@ Reader::session_from_sid(fds_file_sid_t sid)
     return session;
 }
 
-/**
- * @brief Notify other plugins about a new Transport Session
- *
- * A new Session Message is generated and send to other plugins in the pipeline.
- * @param[in] ts Transport Session
- * @throw FDS_exception in case of failure
- */
-void
-Reader::session_open(struct ipx_session *ts)
-{
-    struct ipx_msg_session *msg;
-
-    // Notify plugins further in the pipeline about the new session
-    msg = ipx_msg_session_create(ts, IPX_MSG_SESSION_OPEN);
-    if (!msg) {
-        throw FDS_exception("Failed to create a Transport Session notification");
-    }
-
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg)) != IPX_OK) {
-        ipx_msg_session_destroy(msg);
-        throw  FDS_exception("Failed to pass a Transport Session notification");
-    }
-}
-
-/**
- * @brief Notify other plugins about a close of a Transport Session
- *
- * @warning
- *   User MUST stop using the Session as it is send in a garbage message to the
- *   pipeline and it will be automatically freed later.
- * @param[in] ts Transport Session
- * @throw FDS_exception in case of failure
- */
-void
-Reader::session_close(struct ipx_session *ts)
-{
-    ipx_msg_session_t *msg_session;
-    ipx_msg_garbage_t *msg_garbage;
-    ipx_msg_garbage_cb garbage_cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
-
-    msg_session = ipx_msg_session_create(ts, IPX_MSG_SESSION_CLOSE);
-    if (!msg_session) {
-        throw FDS_exception("Failed to create a Transport Session notification");
-    }
-
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg_session)) != IPX_OK) {
-        ipx_msg_session_destroy(msg_session);
-        throw FDS_exception("Failed to pass a Transport Session notification");
-    }
-
-    msg_garbage = ipx_msg_garbage_create(ts, garbage_cb);
-    if (!msg_garbage) {
-        /* Memory leak... We cannot destroy the session as it can be used
-         * by other plugins further in the pipeline. */
-        throw FDS_exception("Failed to create a garbage message with a Transport Session");
-    }
-
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(msg_garbage)) != IPX_OK) {
-        /* Memory leak... We cannot destroy the message as it also destroys
-         * the session structure. */
-        throw FDS_exception("Failed to pass a garbage message with a Transport Session");
-    }
-}
-
 /// Auxiliary data for snapshot interator callback
 struct tmplt_cb_data {
     std::vector<Builder> msg_vec;    ///< Vector of generated IPFIX Messages
@@ -315,42 +251,7 @@ Reader::send_templates(const struct ipx_session *ts, const fds_tsnapshot_t *tsna
         msg.set_seqnum(seq_num);
 
         // Send it
-        send_ipfix(msg.release(), ts, odid);
-    }
-}
-
-/**
- * Send an IPFIX Message to the pipeline
- *
- * @note
- *   The function takes responsibility for the Message. Therefore, in case of
- *   failure, the Message will be freed.
- * @param[in] msg  Raw IPFIX Message to send
- * @param[in] ts   Transport Session
- * @param[in] odid Observation Domain ID (of the message)
- * @throw FDS_exception in case of failure
- */
-void
-Reader::send_ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid)
-{
-    uint16_t msg_size = ntohs(reinterpret_cast<fds_ipfix_msg_hdr *>(msg)->length);
-    ipx_msg_ipfix_t *msg_ptr;
-    struct ipx_msg_ctx msg_ctx;
-
-    msg_ctx.session = ts;
-    msg_ctx.odid = odid;
-    msg_ctx.stream = 0; // stream is not stored in the file
-
-    msg_ptr = ipx_msg_ipfix_create(m_ctx, &msg_ctx, msg, msg_size);
-    if (!msg_ptr) {
-        free(msg);
-        throw FDS_exception("Failed to allocate an IPFIX Message!");
-    }
-
-    // Send it to the pipeline
-    if (ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(msg_ptr)) != IPX_OK) {
-        ipx_msg_ipfix_destroy(msg_ptr);
-        throw FDS_exception("Failed to pass an IPFIX Message!");
+        m_out.ipfix(msg.release(), ts, odid);
     }
 }
 
@@ -433,7 +334,7 @@ Reader::send_batch()
     if (!ptr_session->info) {
         ptr_session->info = session_from_sid(msg_sid);
         IPX_CTX_DEBUG(m_ctx, "New TS '%s' detected!", ptr_session->info->ident);
-        session_open(ptr_session->info);
+        m_out.session_open(ptr_session->info);
     }
 
     if (ptr_odid->tsnap != drec->snap) {
@@ -493,7 +394,7 @@ Reader::send_batch()
     new_msg.set_seqnum(msg_seqnum);
     ptr_odid->seq_num += rec_cnt;
 
-    send_ipfix(new_msg.release(), ptr_session->info, msg_odid);
+    m_out.ipfix(new_msg.release(), ptr_session->info, msg_odid);
     IPX_CTX_DEBUG(m_ctx, "New IPFIX Message with %" PRIu16 " records from '%s:%" PRIu32 "' sent!",
         rec_cnt, ptr_session->info->ident, msg_odid);
     return IPX_OK;
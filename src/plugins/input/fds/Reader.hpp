@@ -49,6 +49,7 @@
 #include <stdint.h>
 
 #include "config.h"
+#include "Output.hpp"
 
 /// Observation Domain ID (contextual information)
 struct ODID {
@@ -79,12 +80,13 @@ public:
      * @brief Instance constructor
      *
      * Open a FDS File and initialize the reader
-     * @param[in] ctx  Plugin context (for log and message passing)
+     * @param[in] ctx  Plugin context (for log)
      * @param[in] cfg  Parsed plugin configuration
      * @param[in] path File to read
+     * @param[in] out  Destination of generated messages
      * @throw FDS_exception in case of failure (e.g. invalid file)
      */
-    Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path);
+    Reader(ipx_ctx_t *ctx, const fds_config *cfg, const char *path, Output &out);
     /**
      * @brief Instance destructor
      * @note Close the file and send "close" notifications of all Transport Sessions
@@ -113,10 +115,12 @@ public:
     send_batch();
 
 private:
-    /// Plugin context (log and passing messages)
+    /// Plugin context (log only)
     ipx_ctx_t *m_ctx;
     /// Plugin configuration
     const fds_config *m_cfg;
+    /// Destination of generated messages
+    Output &m_out;
     /// File handler (of the file current file)
     std::unique_ptr<fds_file_t, decltype(&fds_file_close)> m_file = {nullptr, &fds_file_close};
     /// Transport Sessions (from the current file)
@@ -131,16 +135,9 @@ private:
 
     struct ipx_session *
     session_from_sid(fds_file_sid_t sid);
-    void
-    session_open(struct ipx_session *ts);
-    void
-    session_close(struct ipx_session *ts);
-
     void
     send_templates(const struct ipx_session *ts, const fds_tsnapshot_t *tsnap,
         uint32_t odid, uint32_t exp_time, uint32_t seq_num);
-    void
-    send_ipfix(uint8_t *msg, const struct ipx_session *ts, uint32_t odid);
 
     int
     record_get(const struct fds_drec **rec, const struct fds_file_read_ctx **ctx);
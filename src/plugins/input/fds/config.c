@@ -48,6 +48,8 @@
  * <params>
  *  <path>...</path>      // required, exactly once
  *  <bufferSize>...</bufferSize>      // optional
+ *  <parallelFiles>...</parallelFiles> // optional
+ *  <timeOrder>...</timeOrder>        // optional
  * </params>
  */
 
@@ -55,20 +57,26 @@
 #define MSG_SIZE_DEF (32768U)
 /** Minimal message size */
 #define MSG_SIZE_MIN   (512U)
+/** Maximum number of files read in parallel */
+#define PARALLEL_MAX (64U)
 
 /** XML nodes */
 enum params_xml_nodes {
     NODE_PATH = 1,
     NODE_MSIZE,
-    NODE_ASYNCIO
+    NODE_ASYNCIO,
+    NODE_PARALLEL,
+    NODE_TIME_ORDER
 };
 
 /** Definition of the \<params\> node  */
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
-    FDS_OPTS_ELEM(NODE_PATH,    "path",    FDS_OPTS_T_STRING, 0),
-    FDS_OPTS_ELEM(NODE_MSIZE,   "msgSize", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
-    FDS_OPTS_ELEM(NODE_ASYNCIO, "asyncIO", FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_PATH,       "path",          FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_MSIZE,      "msgSize",       FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_ASYNCIO,    "asyncIO",       FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_PARALLEL,   "parallelFiles", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIME_ORDER, "timeOrder",     FDS_OPTS_T_BOOL, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -108,6 +116,19 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct fds_config *cfg)
             assert(content->type == FDS_OPTS_T_BOOL);
             cfg->async = content->val_bool;
             break;
+        case NODE_PARALLEL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint == 0 || content->val_uint > PARALLEL_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of parallel files must be between 1 and %u!",
+                    (unsigned int) PARALLEL_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->parallel = (uint32_t) content->val_uint;
+            break;
+        case NODE_TIME_ORDER:
+            assert(content->type == FDS_OPTS_T_BOOL);
+            cfg->time_order = content->val_bool;
+            break;
         default:
             // Internal error
             assert(false);
@@ -132,6 +153,8 @@ config_default_set(struct fds_config *cfg)
     cfg->path = NULL;
     cfg->msize = MSG_SIZE_DEF;
     cfg->async = true;
+    cfg->parallel = 1;
+    cfg->time_order = false;
 }
 
 struct fds_config *
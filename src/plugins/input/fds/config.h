@@ -57,6 +57,10 @@ struct fds_config {
     uint16_t msize;
     /** Enable asynchronous I/O                                                                  */
     bool async;
+    /** Number of files read in parallel                                                         */
+    uint32_t parallel;
+    /** Merge messages from files read in parallel by their Export Time                         */
+    bool time_order;
 };
 
 /**
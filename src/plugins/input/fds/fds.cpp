@@ -39,6 +39,7 @@
  *
  */
 
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cstdlib>
@@ -49,11 +50,18 @@
 #include <memory>
 #include <netinet/in.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "config.h"
 #include "Exception.hpp"
+#include "Merger.hpp"
+#include "Output.hpp"
 #include "Reader.hpp"
 
+/// Maximum number of messages waiting in the queue of each file read in parallel
+static const size_t PARALLEL_QUEUE_SIZE = 16;
+
 /// Plugin description
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
     // Plugin identification name
@@ -79,11 +87,18 @@ struct Instance {
 
     /// List of files to read
     glob_t m_list;
-    /// Index of the next file to read
-    size_t m_next_file = 0;
+    /// Index of the next file to read (shared by threads reading files in parallel)
+    std::atomic<size_t> m_next_file{0};
 
+    /// Output to the pipeline
+    std::unique_ptr<CtxOutput> m_output = nullptr;
     // Current file reader
     std::unique_ptr<Reader> m_file = nullptr;
+
+    /// Merger of files read in parallel (nullptr if files are read one by one)
+    std::unique_ptr<Merger> m_merger = nullptr;
+    /// Threads reading files in parallel
+    std::vector<std::thread> m_threads;
 };
 
 /**
@@ -193,7 +208,8 @@ file_next(Instance *inst)
         }
 
         try {
-            reader_new.reset(new Reader(inst->m_ctx, inst->m_cfg.get(), file_name));
+            reader_new.reset(new Reader(inst->m_ctx, inst->m_cfg.get(), file_name,
+                *inst->m_output));
         } catch (const FDS_exception &ex) {
             IPX_CTX_ERROR(inst->m_ctx, "%s", ex.what());
             continue;
@@ -213,6 +229,106 @@ file_next(Instance *inst)
     return IPX_OK;
 }
 
+/**
+ * @brief Main function of a thread that reads files in parallel
+ *
+ * The thread takes files from the list one by one and generates messages from them into its
+ * stream of the merger until there are no more files or the merger is stopped.
+ * @param[in] inst Plugin instance
+ * @param[in] idx  Index of the stream of the thread
+ */
+static void
+thread_main(Instance *inst, size_t idx)
+{
+    Merger &merger = *inst->m_merger;
+    bool failed = false;
+
+    try {
+        while (!merger.stopped()) {
+            const size_t file_idx = inst->m_next_file++;
+            if (file_idx >= inst->m_list.gl_pathc) {
+                break;
+            }
+
+            const char *file_name = inst->m_list.gl_pathv[file_idx];
+            if (file_is_dir(file_name)) {
+                continue;
+            }
+
+            std::unique_ptr<Reader> reader = nullptr;
+            try {
+                reader.reset(new Reader(inst->m_ctx, inst->m_cfg.get(), file_name,
+                    merger.output(idx)));
+            } catch (const FDS_exception &ex) {
+                IPX_CTX_ERROR(inst->m_ctx, "%s", ex.what());
+                continue;
+            }
+
+            IPX_CTX_INFO(inst->m_ctx, "Reading from file '%s'...", file_name);
+            while (!merger.stopped() && reader->send_batch() == IPX_OK) {
+                // Until the end of the file
+            }
+        }
+    } catch (const std::exception &ex) {
+        IPX_CTX_ERROR(inst->m_ctx, "Unable to extract data from a FDS file: %s", ex.what());
+        failed = true;
+    }
+
+    merger.finish(idx, failed);
+}
+
+/**
+ * @brief Stop threads reading files in parallel (if any)
+ *
+ * Transport Session notifications that haven't been passed yet are passed to the pipeline,
+ * the rest of the messages are dropped.
+ * @param[in] inst Plugin instance
+ */
+static void
+threads_stop(Instance *inst)
+{
+    if (!inst->m_merger) {
+        return;
+    }
+
+    inst->m_merger->stop();
+    for (auto &thread : inst->m_threads) {
+        thread.join();
+    }
+    inst->m_threads.clear();
+    inst->m_merger->drain(*inst->m_output);
+}
+
+/**
+ * @brief Start threads reading files in parallel
+ * @param[in] inst Plugin instance
+ * @throw std::exception if the threads cannot be started
+ */
+static void
+threads_start(Instance *inst)
+{
+    const size_t cnt = inst->m_cfg->parallel;
+    inst->m_merger.reset(new Merger(cnt, PARALLEL_QUEUE_SIZE, inst->m_cfg->time_order));
+
+    try {
+        for (size_t i = 0; i < cnt; ++i) {
+            inst->m_threads.emplace_back(&thread_main, inst, i);
+        }
+    } catch (...) {
+        // Make sure that started threads will not be waiting for the other ones
+        for (size_t i = inst->m_threads.size(); i < cnt; ++i) {
+            inst->m_merger->finish(i);
+        }
+        inst->m_merger->stop();
+        for (auto &thread : inst->m_threads) {
+            thread.join();
+        }
+        inst->m_threads.clear();
+        inst->m_merger.reset();
+        throw;
+    }
+}
+
 // -------------------------------------------------------------------------
 
 int
@@ -226,6 +342,15 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
             throw FDS_exception("Failed to parse the instance configuration!");
         }
         file_list_init(inst.get(), inst->m_cfg->path);
+        inst->m_output.reset(new CtxOutput(ctx));
+        if (inst->m_cfg->parallel > 1) {
+            try {
+                threads_start(inst.get());
+            } catch (...) {
+                file_list_clean(inst.get());
+                throw;
+            }
+        }
         // Everything seems OK
         ipx_ctx_private_set(ctx, inst.release());
     } catch (const FDS_exception &ex) {
@@ -247,6 +372,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     try {
         auto *inst = reinterpret_cast<Instance *>(cfg);
+        threads_stop(inst);
         file_list_clean(inst);
         delete inst;
     } catch (...) {
@@ -261,6 +387,11 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
     try {
         auto inst = reinterpret_cast<Instance *>(cfg);
 
+        if (inst->m_merger) {
+            // Files are read in parallel by other threads
+            return inst->m_merger->forward(*inst->m_output);
+        }
+
         while (true) {
             // Try to send an IPFIX Message with batch of Data Records
             int ret = IPX_ERR_EOF;
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Reference counted memory mapping of an IPFIX File
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ipfixcol2.h>
+#include "file_map.h"
+
+int
+file_map_open(const char *name, struct file_map **map)
+{
+    int fd = open(name, O_RDONLY);
+    if (fd == -1) {
+        return IPX_ERR_DENIED;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return IPX_ERR_DENIED;
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        return IPX_ERR_EOF;
+    }
+
+    struct file_map *res = calloc(1, sizeof(*res));
+    if (!res) {
+        close(fd);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Private writable mapping, so plugins further in the pipeline can modify the messages
+    const size_t size = (size_t) st.st_size;
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        int err = errno;
+        close(fd);
+        free(res);
+        errno = err;
+        return IPX_ERR_DENIED;
+    }
+
+    // Just a hint, failure is not fatal
+    (void) madvise(addr, size, MADV_SEQUENTIAL);
+
+    res->name = name;
+    res->fd = fd;
+    res->data = addr;
+    res->len = size;
+    res->size = size;
+    res->advised = 0;
+    res->refs = 1;
+    *map = res;
+    return IPX_OK;
+}
+
+int
+file_map_advise(struct file_map *map, size_t offset, size_t window)
+{
+    // Request the next window when the reader passes the middle of the current one
+    if (map->advised >= map->size || map->advised >= offset + window / 2) {
+        return IPX_OK;
+    }
+
+    // Access to the mapping beyond the end of the file would raise SIGBUS
+    struct stat st;
+    if (fstat(map->fd, &st) == 0 && (size_t) st.st_size < map->size) {
+        map->size = (size_t) st.st_size;
+        map->advised = map->size;
+        return IPX_ERR_EOF;
+    }
+
+    const size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    size_t begin = offset > map->advised ? offset : map->advised;
+    begin -= begin % page_size;
+
+    size_t end = offset + window;
+    if (end > map->size) {
+        end = map->size;
+    }
+
+    (void) madvise(map->data + begin, end - begin, MADV_WILLNEED);
+    map->advised = end;
+    return IPX_OK;
+}
+
+void
+file_map_ref(struct file_map *map)
+{
+    __atomic_add_fetch(&map->refs, 1, __ATOMIC_RELAXED);
+}
+
+void
+file_map_unref(struct file_map *map)
+{
+    if (__atomic_sub_fetch(&map->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    munmap(map->data, map->len);
+    close(map->fd);
+    free(map);
+}
+
+void
+file_map_msg_free(void *arg, uint8_t *data)
+{
+    (void) data;
+    file_map_unref((struct file_map *) arg);
+}
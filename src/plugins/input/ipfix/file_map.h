@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief Reference counted memory mapping of an IPFIX File (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IPFIX_FILE_MAP_H
+#define IPFIX_FILE_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Memory mapped file */
+struct file_map {
+    /** Path to the file                                                    */
+    const char *name;
+    /** File descriptor (kept open to detect truncation of the file)        */
+    int fd;
+    /** Beginning of the mapping                                            */
+    uint8_t *data;
+    /** Size of the mapping (i.e. size of the file when it was opened)      */
+    size_t len;
+    /** Size of the valid part of the mapping (reduced if the file shrinks) */
+    size_t size;
+    /** End of the part of the mapping already requested for readahead      */
+    size_t advised;
+    /** Number of references (the reader + all messages in the mapping)     */
+    unsigned int refs;
+};
+
+/**
+ * @brief Map a file into memory
+ *
+ * The file is mapped privately (copy-on-write), therefore, plugins further in the pipeline can
+ * modify the messages without affecting the file. The kernel is advised that the mapping will be
+ * read sequentially. The returned mapping holds one reference of the caller.
+ *
+ * @warning Pages of the mapping are still backed by the file, so any access to a part of the
+ *   mapping beyond the end of a truncated file raises SIGBUS. File truncation is detected by
+ *   file_map_advise() before the reader enters the next readahead window, however, the file
+ *   MUST NOT be truncated while its content is being processed (i.e. messages which have
+ *   been already passed to other plugins and the window around the reader).
+ * @param[in]  name Path to the file (must exist until the mapping is freed)
+ * @param[out] map  Mapping
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_EOF if the file is empty
+ * @return #IPX_ERR_DENIED if the file cannot be opened or mapped (errno is set)
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+int
+file_map_open(const char *name, struct file_map **map);
+
+/**
+ * @brief Request asynchronous readahead of the content following the given offset
+ *
+ * The readahead is requested only if the offset is getting close to the end of the part for
+ * which it has already been requested. Before that, the current size of the file is checked
+ * and if the file has been truncated, the valid size of the mapping is reduced.
+ * @param[in] map    Mapping
+ * @param[in] offset Current position of the reader
+ * @param[in] window Size of the readahead window
+ * @return #IPX_OK on success
+ * @return #IPX_ERR_EOF if the file has been truncated (the reader must not access data beyond
+ *   the new valid size)
+ */
+int
+file_map_advise(struct file_map *map, size_t offset, size_t window);
+
+/**
+ * @brief Add a reference to the mapping
+ *
+ * The function is thread-safe.
+ * @param[in] map Mapping
+ */
+void
+file_map_ref(struct file_map *map);
+
+/**
+ * @brief Remove a reference of the mapping and unmap it if it was the last one
+ *
+ * The function is thread-safe.
+ * @param[in] map Mapping
+ */
+void
+file_map_unref(struct file_map *map);
+
+/**
+ * @brief Release a message in a mapping
+ *
+ * The prototype matches #ipx_msg_ipfix_free_cb, so it can be used directly as a callback of
+ * ipx_msg_ipfix_create_ext(). The message itself is left untouched and only the reference of
+ * the message to the mapping is removed.
+ * @param[in] arg  Mapping
+ * @param[in] data Message (ignored)
+ */
+void
+file_map_msg_free(void *arg, uint8_t *data);
+
+#endif // IPFIX_FILE_MAP_H
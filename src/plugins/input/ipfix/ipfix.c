@@ -39,13 +39,15 @@
  *
  */
 
+#include <assert.h>
 #include <errno.h>
 #include <glob.h>
 #include <ipfixcol2.h>
+#include <pthread.h>
 #include <stdlib.h>
-#include <stdio.h>  // fopen, fclose
 
 #include "config.h"
+#include "file_map.h"
 
 /// Plugin description
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -63,6 +65,21 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .ipx_min = "2.2.0"
 };
 
+/// Background preparation of the next file
+struct file_prefetch {
+    /// The thread is running and must be joined
+    bool running;
+    /// Thread
+    pthread_t thread;
+
+    /// Return code of the search (see file_find())
+    int rc;
+    /// Mapping of the found file (valid only if #rc is #IPX_OK)
+    struct file_map *map;
+    /// Index of the next file to read after the found one
+    size_t idx_next;
+};
+
 /// Plugin instance data
 struct plugin_data {
     /// Plugin context (log only!)
@@ -75,21 +92,17 @@ struct plugin_data {
     /// Index of the next file to read (see file_list->gl_pathv)
     size_t file_next_idx;
 
-    /// Handler of the currently file
-    FILE *current_file;
+    /// Mapping of the current file
+    struct file_map *current_map;
     /// Name/path of the current file
     const char *current_name;
     /// Transport Session identification
     struct ipx_session *current_ts;
+    /// Position of the reader in the mapping
+    size_t current_offset;
 
-    /// Buffer of preloaded data
-    uint8_t *buffer_data;
-    /// Size of the buffer
-    size_t buffer_size;
-    /// Valid size of the buffer
-    size_t buffer_valid;
-    /// Position of the reader in the buffer
-    size_t buffer_offset;
+    /// Preparation of the file that follows the current one
+    struct file_prefetch prefetch;
 };
 
 /**
@@ -270,157 +283,230 @@ session_close(ipx_ctx_t *ctx, struct ipx_session *session)
 }
 
 /**
- * @brief Open the next file for reading
+ * @brief Check if a mapped file starts with an IPFIX Message header
  *
- * If any file is already opened, it will be closed and a session message (close notification)
- * will be send too. The function will try to open the next file in the list and makes sure
- * that it contains at least one IPFIX Message. Otherwise, it will be skipped and another file
- * will be used. When a suitable file is found, a new Transport Session will created and
- * particular session message (open notification) will be sent.
+ * @param[in] map Mapping of the file
+ * @return True or false
+ */
+static bool
+file_is_ipfix(const struct file_map *map)
+{
+    struct fds_ipfix_msg_hdr ipfix_hdr;
+    if (map->size < FDS_IPFIX_MSG_HDR_LEN) {
+        return false;
+    }
+
+    memcpy(&ipfix_hdr, map->data, FDS_IPFIX_MSG_HDR_LEN);
+    return ntohs(ipfix_hdr.version) == FDS_IPFIX_VERSION
+        && ntohs(ipfix_hdr.length) >= FDS_IPFIX_MSG_HDR_LEN;
+}
+
+/**
+ * @brief Find and map the next readable IPFIX File in the list
  *
- * @warning
- *   As the function sends notification to other plugins further in the pipeline, it must have
- *   permission to pass messages. Therefore, this function cannot be called within
- *   ipx_plugin_init().
- * @param[in] data Plugin data
+ * Files that cannot be opened or that don't start with an IPFIX Message are skipped. When
+ * a suitable file is found, readahead of its beginning is requested.
+ *
+ * @note The function doesn't modify the plugin data, so it can be called from any thread.
+ * @param[in]  ctx      Plugin context (log only)
+ * @param[in]  list     List of files
+ * @param[in]  idx      Index of the first file to try
+ * @param[in]  window   Size of the readahead window
+ * @param[out] map      Mapping of the found file
+ * @param[out] idx_next Index of the next file to read after the found one
  * @return #IPX_OK on success
  * @return #IPX_ERR_EOF if no more files are available
- * @return #iPX_ERR_NOMEM in case of a memory allocation error
+ * @return #IPX_ERR_NOMEM in case of a memory allocation error
  */
 static int
-next_file(struct plugin_data *data)
+file_find(ipx_ctx_t *ctx, const glob_t *list, size_t idx, size_t window, struct file_map **map,
+    size_t *idx_next)
 {
-    size_t idx_next;
-    size_t idx_max = data->file_list.gl_pathc;
-    FILE *file_new = NULL;
-    const char *name_new = NULL;
-
-    // Signalize close of the current Transport Session
-    session_close(data->ctx, data->current_ts);
-    data->current_ts = NULL;
-    if (data->current_file) {
-        fclose(data->current_file);
-        data->current_file = NULL;
-        data->current_name = NULL;
-    }
-
-    // Open new file
-    for (idx_next = data->file_next_idx; idx_next < idx_max; ++idx_next) {
-        name_new = data->file_list.gl_pathv[idx_next];
-        if (filename_is_dir(name_new)) {
+    for (; idx < list->gl_pathc; ++idx) {
+        const char *name = list->gl_pathv[idx];
+        if (filename_is_dir(name)) {
             continue;
         }
 
-        file_new = fopen(name_new, "rb");
-        if (!file_new) {
+        struct file_map *map_new;
+        int rc = file_map_open(name, &map_new);
+        if (rc == IPX_ERR_NOMEM) {
+            IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+
+        if (rc == IPX_ERR_DENIED) {
             const char *err_str;
             ipx_strerror(errno, err_str);
-            IPX_CTX_ERROR(data->ctx, "Failed to open '%s': %s", name_new, err_str);
+            IPX_CTX_ERROR(ctx, "Failed to open '%s': %s", name, err_str);
+            continue;
+        }
+
+        if (rc == IPX_OK && !file_is_ipfix(map_new)) {
+            file_map_unref(map_new);
+            rc = IPX_ERR_FORMAT;
+        }
+
+        if (rc != IPX_OK) {
+            IPX_CTX_ERROR(ctx, "Skipping non-IPFIX File '%s'", name);
             continue;
         }
 
-        struct fds_ipfix_msg_hdr ipfix_hdr;
-        if (fread(&ipfix_hdr, FDS_IPFIX_MSG_HDR_LEN, 1, file_new) != 1
-                || ntohs(ipfix_hdr.version) != FDS_IPFIX_VERSION
-                || ntohs(ipfix_hdr.length) < FDS_IPFIX_MSG_HDR_LEN) {
-            IPX_CTX_ERROR(data->ctx, "Skipping non-IPFIX File '%s'", name_new);
-            fclose(file_new);
-            file_new = NULL;
+        if (file_map_advise(map_new, 0, window) != IPX_OK) {
+            IPX_CTX_ERROR(ctx, "Skipping IPFIX File '%s' truncated while being opened", name);
+            file_map_unref(map_new);
             continue;
         }
 
         // Success
-        rewind(file_new);
-        break;
+        *map = map_new;
+        *idx_next = idx + 1;
+        return IPX_OK;
     }
 
-    data->file_next_idx = idx_next + 1;
-    if (!file_new) {
-        return IPX_ERR_EOF;
+    return IPX_ERR_EOF;
+}
+
+/**
+ * @brief Main function of the thread that prepares the next file
+ * @param[in] arg Plugin data
+ * @return Always NULL
+ */
+static void *
+prefetch_main(void *arg)
+{
+    struct plugin_data *data = (struct plugin_data *) arg;
+    struct file_prefetch *prefetch = &data->prefetch;
+
+    prefetch->rc = file_find(data->ctx, &data->file_list, data->file_next_idx, data->cfg->bsize,
+        &prefetch->map, &prefetch->idx_next);
+    return NULL;
+}
+
+/**
+ * @brief Start preparation of the next file in the background
+ *
+ * The file is opened, mapped and its readahead is requested, while the current file is being
+ * processed. If the thread cannot be started, the next file will be prepared synchronously.
+ * @param[in] data Plugin data
+ */
+static void
+prefetch_start(struct plugin_data *data)
+{
+    struct file_prefetch *prefetch = &data->prefetch;
+    assert(!prefetch->running);
+
+    if (data->file_next_idx >= data->file_list.gl_pathc) {
+        // No more files
+        return;
     }
 
-    // Signalize open of the new Transport Session
-    data->current_ts = session_open(data->ctx, name_new);
-    if (!data->current_ts) {
-        fclose(file_new);
-        return IPX_ERR_NOMEM;
+    prefetch->rc = IPX_ERR_EOF;
+    prefetch->map = NULL;
+    int rc = pthread_create(&prefetch->thread, NULL, &prefetch_main, data);
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_CTX_WARNING(data->ctx, "Failed to start a thread that prepares the next file: %s",
+            err_str);
+        return;
     }
 
-    IPX_CTX_INFO(data->ctx, "Reading from file '%s'...", name_new);
-    data->current_file = file_new;
-    data->current_name = name_new;
+    prefetch->running = true;
+}
 
-    data->buffer_valid = 0;
-    data->buffer_offset = 0;
-    return IPX_OK;
+/**
+ * @brief Wait for the preparation of the next file to finish (if running)
+ * @param[in] data Plugin data
+ * @return True if the preparation has been started and its result is available
+ */
+static bool
+prefetch_finish(struct plugin_data *data)
+{
+    struct file_prefetch *prefetch = &data->prefetch;
+    if (!prefetch->running) {
+        return false;
+    }
+
+    pthread_join(prefetch->thread, NULL);
+    prefetch->running = false;
+    return true;
 }
 
 /**
- * @brief Get the next chunk of data
- *
- * Reads the chunk from the internal buffer with preloaded content of the file.
- * If the buffer doesn't contain required amount of data, new content will be
- * loaded from the file. Nevertheless, if the end-of-file has been reached, return
- * codes #IPX_ERR_EOF or #IPX_ERR_FORMAT might be returned.
+ * @brief Open the next file for reading
  *
- * @param[in]  data     Plugin data
- * @param[out] out      Output buffer to fill
- * @param[in]  out_size Size of the output buffer (i.e. required amount of data)
+ * If any file is already opened, it will be closed and a session message (close notification)
+ * will be send too. The function will try to open the next file in the list and makes sure
+ * that it contains at least one IPFIX Message. Otherwise, it will be skipped and another file
+ * will be used. When a suitable file is found, a new Transport Session will created and
+ * particular session message (open notification) will be sent. Preparation of the file that
+ * follows is started in the background.
  *
+ * @warning
+ *   As the function sends notification to other plugins further in the pipeline, it must have
+ *   permission to pass messages. Therefore, this function cannot be called within
+ *   ipx_plugin_init().
+ * @param[in] data Plugin data
  * @return #IPX_OK on success
- * @return #IPX_ERR_EOF if the end-of-file has been reached (no more data)
- * @return #IPX_ERR_FORMAT if the end-of-file has been reached but the internal
- *   buffer doesn't contain required amount of data
+ * @return #IPX_ERR_EOF if no more files are available
+ * @return #iPX_ERR_NOMEM in case of a memory allocation error
  */
 static int
-next_chunk(struct plugin_data *data, uint8_t *out, uint16_t out_size)
+next_file(struct plugin_data *data)
 {
-    size_t buffer_avail = data->buffer_valid - data->buffer_offset;
-    uint8_t *reader_ptr = &data->buffer_data[data->buffer_offset];
-
-    size_t new_size;
-    uint8_t *new_ptr;
-    size_t ret;
+    struct file_map *map_new = NULL;
+    size_t idx_next;
+    int rc;
 
-    // Check if the chunk is fully in the buffer
-    if (buffer_avail >= out_size) {
-        memcpy(out, reader_ptr, out_size);
-        data->buffer_offset += out_size;
-        return IPX_OK;
+    // Signalize close of the current Transport Session
+    session_close(data->ctx, data->current_ts);
+    data->current_ts = NULL;
+    if (data->current_map) {
+        // Messages that are still in the pipeline keep the mapping
+        file_map_unref(data->current_map);
+        data->current_map = NULL;
+        data->current_name = NULL;
     }
 
-    // We need to load new data to the buffer
-    if (buffer_avail > 0) {
-        // A fragment of an unprocessed IPFIX Message must be preserved
-        memcpy(data->buffer_data, reader_ptr, buffer_avail);
-        data->buffer_valid = buffer_avail;
+    // Get the new file (prepared in the background, if possible)
+    if (prefetch_finish(data)) {
+        rc = data->prefetch.rc;
+        map_new = data->prefetch.map;
+        idx_next = data->prefetch.idx_next;
+        data->prefetch.map = NULL;
     } else {
-        data->buffer_valid = 0;
+        rc = file_find(data->ctx, &data->file_list, data->file_next_idx, data->cfg->bsize,
+            &map_new, &idx_next);
     }
 
-    new_size = data->buffer_size - data->buffer_valid;
-    new_ptr = &data->buffer_data[data->buffer_valid];
-    ret = fread(new_ptr, 1, new_size, data->current_file);
-    data->buffer_valid += ret;
-    data->buffer_offset = 0;
-
-    // Check whether the EOF has been reached
-    if (data->buffer_valid == 0 && feof(data->current_file)) {
-        return IPX_ERR_EOF;
+    if (rc != IPX_OK) {
+        data->file_next_idx = data->file_list.gl_pathc;
+        return rc;
     }
 
-    if (data->buffer_valid < out_size) {
-        return IPX_ERR_FORMAT;
+    data->file_next_idx = idx_next;
+    prefetch_start(data);
+
+    // Signalize open of the new Transport Session
+    data->current_ts = session_open(data->ctx, map_new->name);
+    if (!data->current_ts) {
+        file_map_unref(map_new);
+        return IPX_ERR_NOMEM;
     }
 
-    memcpy(out, data->buffer_data, out_size);
-    data->buffer_offset += out_size;
+    IPX_CTX_INFO(data->ctx, "Reading from file '%s'...", map_new->name);
+    data->current_map = map_new;
+    data->current_name = map_new->name;
+    data->current_offset = 0;
     return IPX_OK;
 }
 
 /**
  * @brief Get the next IPFIX Message from currently opened file
  *
+ * The Message is not copied, it refers directly to the mapping of the file, which is kept
+ * until the Message is destroyed.
  * @param[in]  data Plugin data
  * @param[out] msg  IPFIX Message extracted from the file
  * @return #IPX_OK on success
@@ -431,29 +517,40 @@ next_chunk(struct plugin_data *data, uint8_t *out, uint16_t out_size)
 static int
 next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
 {
+    struct file_map *map = data->current_map;
     struct fds_ipfix_msg_hdr ipfix_hdr;
     uint16_t ipfix_size;
-    uint8_t *ipfix_data = NULL;
+    uint8_t *ipfix_data;
 
     struct ipx_msg_ctx ipfix_ctx;
     ipx_msg_ipfix_t *ipfix_msg;
-    int ret;
 
-    if (!data->current_file) {
+    if (!map) {
+        return IPX_ERR_EOF;
+    }
+
+    // Keep the data ahead of the reader in memory (and make sure the file hasn't been truncated)
+    if (file_map_advise(map, data->current_offset, data->cfg->bsize) != IPX_OK) {
+        IPX_CTX_WARNING(data->ctx, "File '%s' has been truncated while being read! The rest "
+            "of the file is skipped.", data->current_name);
+        data->current_offset = map->size;
+        return IPX_ERR_EOF;
+    }
+
+    const size_t avail = map->size - data->current_offset;
+    if (avail == 0) {
         return IPX_ERR_EOF;
     }
 
     // Get the IPFIX Message header
-    ret = next_chunk(data, (uint8_t *) &ipfix_hdr, FDS_IPFIX_MSG_HDR_LEN);
-    if (ret != IPX_OK) {
-        if (ret == IPX_ERR_FORMAT) {
-            IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
+    if (avail < FDS_IPFIX_MSG_HDR_LEN) {
+        IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
             data->current_name);
-        }
-
-        return ret;
+        return IPX_ERR_FORMAT;
     }
 
+    ipfix_data = map->data + data->current_offset;
+    memcpy(&ipfix_hdr, ipfix_data, FDS_IPFIX_MSG_HDR_LEN);
     ipfix_size = ntohs(ipfix_hdr.length);
     if (ntohs(ipfix_hdr.version) != FDS_IPFIX_VERSION
             || ipfix_size < FDS_IPFIX_MSG_HDR_LEN) {
@@ -461,24 +558,10 @@ next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
         return IPX_ERR_FORMAT;
     }
 
-    ipfix_data = malloc(ipfix_size);
-    if (!ipfix_data) {
-        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        return IPX_ERR_NOMEM;
-    }
-    memcpy(ipfix_data, &ipfix_hdr, FDS_IPFIX_MSG_HDR_LEN);
-
-    // Get the rest of the IPFIX Message body
-    if (ipfix_size > FDS_IPFIX_MSG_HDR_LEN) {
-        uint8_t *data_ptr =  ipfix_data + FDS_IPFIX_MSG_HDR_LEN;
-        uint16_t size_remain = ipfix_size - FDS_IPFIX_MSG_HDR_LEN;
-
-        if (next_chunk(data, data_ptr, size_remain) != IPX_OK) {
-            IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
-                data->current_name);
-            free(ipfix_data);
-            return IPX_ERR_FORMAT;
-        }
+    if (avail < ipfix_size) {
+        IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (unexpected end of file)!",
+            data->current_name);
+        return IPX_ERR_FORMAT;
     }
 
     // Wrap the IPFIX Message
@@ -487,13 +570,16 @@ next_message(struct plugin_data *data, ipx_msg_ipfix_t **msg)
     ipfix_ctx.odid = ntohl(ipfix_hdr.odid);
     ipfix_ctx.stream = 0;
 
-    ipfix_msg = ipx_msg_ipfix_create(data->ctx, &ipfix_ctx, ipfix_data, ipfix_size);
+    file_map_ref(map);
+    ipfix_msg = ipx_msg_ipfix_create_ext(data->ctx, &ipfix_ctx, ipfix_data, ipfix_size,
+        &file_map_msg_free, map);
     if (!ipfix_msg) {
         IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(ipfix_data);
+        file_map_unref(map);
         return IPX_ERR_NOMEM;
     }
 
+    data->current_offset += ipfix_size;
     *msg = ipfix_msg;
     return IPX_OK;
 }
@@ -517,18 +603,8 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
-    // Initialize reader buffer
-    data->buffer_size = data->cfg->bsize;
-    data->buffer_data = malloc(sizeof(uint8_t) * data->buffer_size);
-    if (!data->buffer_data) {
-        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(data);
-        return IPX_ERR_DENIED;
-    }
-
     // Prepare list of all files to read
     if (files_list_get(ctx, data->cfg->path, &data->file_list) != IPX_OK) {
-        free(data->buffer_data);
         config_destroy(data->cfg);
         free(data);
         return IPX_ERR_DENIED;
@@ -545,14 +621,18 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 
     // Close the current session and file
     session_close(ctx, data->current_ts);
-    if (data->current_file) {
-        fclose(data->current_file);
+    if (data->current_map) {
+        file_map_unref(data->current_map);
+    }
+
+    // Wait for preparation of the next file and drop it
+    if (prefetch_finish(data) && data->prefetch.rc == IPX_OK) {
+        file_map_unref(data->prefetch.map);
     }
 
     // Final cleanup
     files_list_free(&data->file_list);
     config_destroy(data->cfg);
-    free(data->buffer_data);
     free(data);
 }
 
@@ -603,11 +683,11 @@ ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *se
 
     // Close the current session and file
     session_close(ctx, data->current_ts);
-    if (data->current_file) {
-        fclose(data->current_file);
+    if (data->current_map) {
+        file_map_unref(data->current_map);
     }
 
     data->current_ts = NULL;
-    data->current_file = NULL;
+    data->current_map = NULL;
     data->current_name = NULL;
 }
\ No newline at end of file
@@ -17,10 +17,11 @@
 #include <cstdint>   // uint16_t
 #include <cinttypes> // PRIu16
 #include <cstddef>   // size_t
+#include <vector>    // vector
 
 #include <unistd.h>     // pipe, write
 #include <sys/socket.h> // AF_INET, AF_INET6, SOCK_STREAM, sockaddr, socket, setsockopt, SOL_SOCKET,
-                        // SO_REUSEADDR, IPPROTO_IPV6, IPV6_V6ONLY, SOMAXCONN
+                        // SO_REUSEADDR, SO_REUSEPORT, IPPROTO_IPV6, IPV6_V6ONLY, SOMAXCONN
 #include <netinet/in.h> // INET6_ADDRSTRLEN, sockaddr_in, sockaddr_in6, inet_ntop, in6addr_any
 
 #include <ipfixcol2.h> // ipx_ctx_t, ipx_strerror, IPX_CTX_WARNING
@@ -30,14 +31,21 @@
 #include "UniqueFd.hpp"       // UniqueFd
 #include "IpAddress.hpp"      // IpAddress, IpVersion
 
+// Socket option for distribution of connections among multiple listening sockets
+#if defined(SO_REUSEPORT_LB)
+#define TCP_REUSEPORT SO_REUSEPORT_LB
+#elif defined(SO_REUSEPORT)
+#define TCP_REUSEPORT SO_REUSEPORT
+#endif
+
 namespace tcp_in {
 
-Acceptor::Acceptor(ClientManager &clients, ipx_ctx_t *ctx) :
+Acceptor::Acceptor(std::vector<ClientManager *> clients, ipx_ctx_t *ctx) :
     m_epoll(),
     m_sockets(),
     m_pipe_in(),
     m_pipe_out(),
-    m_clients(clients),
+    m_clients(std::move(clients)),
     m_thread(),
     m_ctx(ctx)
 {
@@ -112,6 +120,24 @@ UniqueFd Acceptor::bind_address(IpAddress &addr, uint16_t port, bool ipv6_only)
         );
     }
 
+    if (ipx_ctx_shards_get(m_ctx) > 1) {
+        // Copies of the instance in all pipeline shards listen on the same port
+#ifdef TCP_REUSEPORT
+        if (setsockopt(sd.get(), SOL_SOCKET, TCP_REUSEPORT, &on, sizeof(on)) == -1) {
+            ipx_strerror(errno, err_str);
+            throw std::runtime_error(
+                "Cannot turn on socket option SO_REUSEPORT required by multiple pipeline shards: "
+                + std::string(err_str)
+            );
+        }
+#else
+        throw std::runtime_error(
+            "Run-to-completion mode with multiple pipeline shards is not supported on this "
+            "platform (missing SO_REUSEPORT)"
+        );
+#endif
+    }
+
     if (addr.version == IpVersion::IP6) {
         int is_on = ipv6_only;
         if (setsockopt(sd.get(), IPPROTO_IPV6, IPV6_V6ONLY, &is_on, sizeof(is_on)) == -1) {
@@ -230,11 +256,22 @@ void Acceptor::mainloop() {
         }
 
         try {
-            m_clients.add_connection(std::move(new_sd));
+            select_clients().add_connection(std::move(new_sd));
         } catch (std::exception &ex) {
             IPX_CTX_ERROR(m_ctx, "Acceptor: %s", ex.what());
         }
     }
 }
 
+ClientManager &Acceptor::select_clients() noexcept {
+    ClientManager *best = m_clients[0];
+    for (auto clients : m_clients) {
+        if (clients->connection_count() < best->connection_count()) {
+            best = clients;
+        }
+    }
+
+    return *best;
+}
+
 } // namespace tcp_in
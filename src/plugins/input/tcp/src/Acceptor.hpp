@@ -31,11 +31,11 @@ public:
     /**
      * @brief Creates the acceptor thread.
      *
-     * @param clients Reference to client manager.
-     * @param config File configuration.
+     * @param clients Client managers. Each new connection is added to the one with the least
+     * connections.
      * @param ctx The plugin context.
      */
-    Acceptor(ClientManager &clients, ipx_ctx_t *ctx);
+    Acceptor(std::vector<ClientManager *> clients, ipx_ctx_t *ctx);
 
     // force that acceptor stays in its original memory (so that `this` pointer stays valid on the
     // other thread)
@@ -66,6 +66,9 @@ private:
     /** Runs on the other therad */
     void mainloop();
 
+    /** Selects the client manager with the least connections. */
+    ClientManager &select_clients() noexcept;
+
     /** File descriptor of epoll for accepting connections. */
     Epoll m_epoll;
     /** Sockets listened to by epoll. */
@@ -77,7 +80,7 @@ private:
     UniqueFd m_pipe_out;
 
     /** Accepted clients. */
-    ClientManager &m_clients;
+    std::vector<ClientManager *> m_clients;
     std::thread m_thread;
     ipx_ctx_t *m_ctx;
 };
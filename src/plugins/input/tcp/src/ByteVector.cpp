@@ -11,7 +11,8 @@
 #include "ByteVector.hpp"
 
 #include <memory>    // unique_ptr
-#include <cstdlib>   // realloc, size_t
+#include <cstdlib>   // malloc, realloc, size_t
+#include <algorithm> // copy_n
 #include <cstdint>   // uint8_t
 #include <stdexcept> // runtime_error
 #include <string>    // to_string
@@ -37,6 +38,23 @@ void ByteVector::reserve(size_t size) {
         return;
     }
 
+    if (m_data.get_deleter().free_cb) {
+        // borrowed memory cannot be reallocated, copy it to a new memory
+        std::unique_ptr<uint8_t [], FreeDestructor> new_ptr(
+            reinterpret_cast<uint8_t *>(malloc(size))
+        );
+
+        if (!new_ptr) {
+            throw std::runtime_error("Failed to allocate ByteVector of size " + std::to_string(size));
+        }
+
+        std::copy_n(m_data.get(), m_size, new_ptr.get());
+        // releases the borrowed memory
+        m_data = std::move(new_ptr);
+        m_capacity = size;
+        return;
+    }
+
     auto ptr = m_data.get();
     std::unique_ptr<uint8_t [], FreeDestructor> new_ptr(
         reinterpret_cast<uint8_t *>(realloc(ptr, size))
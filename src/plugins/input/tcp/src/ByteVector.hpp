@@ -15,11 +15,21 @@
 #include <cstdlib>   // free, size_t
 #include <algorithm> // std::swap
 
+#include <ipfixcol2.h> // ipx_msg_ipfix_free_cb
+
 namespace tcp_in {
 
+/** Releases the data by `free` or by a custom callback (if set). */
 struct FreeDestructor {
-    inline void operator()(void *p) noexcept {
-        free(p);
+    ipx_msg_ipfix_free_cb free_cb = nullptr;
+    void *free_arg = nullptr;
+
+    inline void operator()(uint8_t *p) noexcept {
+        if (free_cb) {
+            free_cb(free_arg, p);
+        } else {
+            free(p);
+        }
     }
 };
 
@@ -46,6 +56,28 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Creates vector that borrows memory not allocated by malloc (e.g. part of a larger
+     * buffer). The memory is released by the callback instead of `free`. If the vector has to
+     * grow, the data is copied to a newly allocated memory first.
+     * @param data Pointer to the data.
+     * @param size Size of the data.
+     * @param free_cb Callback that releases the data.
+     * @param free_arg Argument of the callback.
+     * @return The new vector.
+     */
+    static ByteVector borrow(
+        uint8_t *data,
+        size_t size,
+        ipx_msg_ipfix_free_cb free_cb,
+        void *free_arg
+    ) noexcept {
+        ByteVector result(data, size, size);
+        result.m_data.get_deleter().free_cb = free_cb;
+        result.m_data.get_deleter().free_arg = free_arg;
+        return result;
+    }
+
     /**
      * @brief Resizes the vector, if `new_size` is larger than current size the values of the new
      * data is undefined.
@@ -63,11 +95,25 @@ public:
 
     /**
      * @brief Releases the ownership of the data and returns pointer to it. This has the effect of
-     * emptying this vector.
+     * emptying this vector. If the data is not allocated by malloc, it must be released by the
+     * callback returned by `free_cb` (get it before calling this).
      * @return uint8_t*
      */
     uint8_t *take() noexcept;
 
+    /**
+     * @brief Gets the callback that releases the data.
+     * @return The callback or nullptr if the data is released by `free`.
+     */
+    ipx_msg_ipfix_free_cb free_cb() const noexcept {
+        return m_data.get_deleter().free_cb;
+    }
+
+    /** Gets the argument of the callback returned by `free_cb`. */
+    void *free_arg() const noexcept {
+        return m_data.get_deleter().free_arg;
+    }
+
     /**
      * @brief Checks whether there is some data in the vector.
      * @return true if there is no data, otherwise false.
@@ -18,23 +18,36 @@
 #include <cstddef>   // size_t
 #include <mutex>     // mutex, lock_guard
 #include <vector>    // vector
+#include <chrono>    // steady_clock, milliseconds
+#include <thread>    // this_thread
 
 #include <fcntl.h>      // fcntl, F_GETFL, F_SETFL, O_NONBLOCK
 #include <netinet/in.h> // INET6_ADDRSTRLEN
 
-#include <ipfixcol2.h> // ipx_strerror, ipx_ctx_t, ipx_session, IPX_CTX_INFO, IPX_CTX_WARNING
+#include <ipfixcol2.h> // ipx_strerror, ipx_ctx_t, ipx_session, IPX_CTX_*
 
 #include "Connection.hpp" // Connection
 #include "UniqueFd.hpp"   // UniqueFd
+#include "MsgSink.hpp"    // MsgSink
 
 namespace tcp_in {
 
-ClientManager::ClientManager(ipx_ctx_t *ctx, DecoderFactory factory) :
+ClientManager::ClientManager(
+    ipx_ctx_t *ctx,
+    DecoderFactory factory,
+    MsgSink &sink,
+    PauseLimits limits
+) :
     m_ctx(ctx),
     m_epoll(),
     m_mutex(),
     m_connections(),
-    m_factory(std::move(factory))
+    m_count(0),
+    m_factory(std::move(factory)),
+    m_sink(sink),
+    m_limits(limits),
+    m_paused(false),
+    m_pause_start()
 {}
 
 void ClientManager::add_connection(UniqueFd fd) {
@@ -66,8 +79,13 @@ void ClientManager::add_connection(UniqueFd fd) {
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
+    if (m_paused) {
+        connection->pause(std::chrono::steady_clock::now());
+    }
+
     auto con_ptr = connection.get();
     m_connections.push_back(std::move(connection));
+    m_count.store(m_connections.size(), std::memory_order_relaxed);
 
     m_epoll.add(borrowed_fd, con_ptr);
 }
@@ -86,7 +104,7 @@ void ClientManager::close_connection(const ipx_session *session) {
         return;
     }
 
-    close_connection_internal(i);
+    close_connection_internal(i, m_sink);
 }
 
 
@@ -112,16 +130,92 @@ size_t ClientManager::wait_for_connections(Connection **connections, int max_con
     return events.size();
 }
 
-void ClientManager::close_all_connections() {
+void ClientManager::receive() {
+    /** Maximum number of connections to process in one call to receive */
+    constexpr int MAX_CONNECTION_BATCH_SIZE = 16;
+    /** Delay before the output queue is checked again while reading is paused */
+    constexpr std::chrono::milliseconds PAUSE_DELAY(10);
+    std::array<Connection *, MAX_CONNECTION_BATCH_SIZE> connections{};
+
+    if (update_paused()) {
+        std::this_thread::sleep_for(PAUSE_DELAY);
+        return;
+    }
+
+    auto count = wait_for_connections(connections.begin(), connections.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        try {
+            if (!connections[i]->receive(m_sink)) {
+                // EOF reached
+                auto session = connections[i]->get_session();
+                IPX_CTX_INFO(m_ctx, "Closing %s", session->ident);
+                close_connection(session);
+            }
+        } catch (std::exception &ex) {
+            IPX_CTX_ERROR(m_ctx, "%s", ex.what());
+            auto session = connections[i]->get_session();
+            IPX_CTX_INFO(m_ctx, "Closing %s", session->ident);
+            close_connection(session);
+        }
+    }
+}
+
+bool ClientManager::update_paused() {
+    if (m_limits.high == 0) {
+        return false;
+    }
+
+    auto pressure = ipx_ctx_pressure_get(m_ctx);
+    if (!m_paused && pressure < m_limits.high) {
+        return false;
+    }
+
+    if (m_paused && pressure >= m_limits.low) {
+        return true;
+    }
+
+    // Change of the state
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_paused = !m_paused;
+    for (auto &con : m_connections) {
+        if (m_paused) {
+            con->pause(now);
+        } else {
+            con->resume(now);
+        }
+    }
+
+    if (m_paused) {
+        m_pause_start = now;
+        IPX_CTX_INFO(
+            m_ctx,
+            "Output queue is %u%% full, reading from %zu connection(s) paused.",
+            pressure,
+            m_connections.size()
+        );
+    } else {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_pause_start);
+        IPX_CTX_INFO(m_ctx, "Reading from connections resumed after %lld ms.",
+            static_cast<long long>(ms.count()));
+    }
+
+    return m_paused;
+}
+
+void ClientManager::close_all_connections(MsgSink &sink) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     while (m_connections.size() != 0) {
-        close_connection_internal(m_connections.size() - 1);
+        close_connection_internal(m_connections.size() - 1, sink);
     }
 }
 
 void ClientManager::close_connection_internal(
-    size_t connection_idx
+    size_t connection_idx,
+    MsgSink &sink
 ) noexcept {
     if (connection_idx != m_connections.size() - 1) {
         m_connections[connection_idx].swap(m_connections[m_connections.size() - 1]);
@@ -129,6 +223,20 @@ void ClientManager::close_connection_internal(
 
     auto con = m_connections[m_connections.size() - 1].get();
 
+    if (m_paused) {
+        con->resume(std::chrono::steady_clock::now());
+    }
+
+    auto paused = std::chrono::duration_cast<std::chrono::milliseconds>(con->get_paused());
+    if (paused.count() > 0) {
+        IPX_CTX_INFO(
+            m_ctx,
+            "Reading from %s was paused for %lld ms in total due to backpressure.",
+            con->get_session()->ident,
+            static_cast<long long>(paused.count())
+        );
+    }
+
     if (!m_epoll.remove(con->get_fd())) {
         const char *err_str;
         ipx_strerror(errno, err_str);
@@ -141,12 +249,13 @@ void ClientManager::close_connection_internal(
     }
 
     try {
-        con->close(m_ctx);
+        con->close(sink);
     } catch (std::exception &ex) {
         IPX_CTX_WARNING(m_ctx, "%s", ex.what());
     }
 
     m_connections.pop_back();
+    m_count.store(m_connections.size(), std::memory_order_relaxed);
 }
 
 } // namespace tcp_in
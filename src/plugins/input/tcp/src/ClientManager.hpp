@@ -13,12 +13,16 @@
 #include <vector>  // std::vector
 #include <memory>  // std::unique_ptr
 #include <mutex>   // std::mutex
+#include <atomic>  // std::atomic
 #include <cstddef> // size_t
+#include <chrono>  // std::chrono
 
 #include <ipfixcol2.h> // ipx_session, ipx_ctx_t
 
+#include "Config.hpp"     // PauseLimits
 #include "Connection.hpp" // Connection
 #include "DecoderFactory.hpp"    // Decoder
+#include "MsgSink.hpp"    // MsgSink
 #include "UniqueFd.hpp"   // UniqueFd
 #include "Epoll.hpp"      // Epoll
 
@@ -29,9 +33,13 @@ class ClientManager {
 public:
     /**
      * @brief Creates client manager with no clients.
+     * @param ctx The plugin context (used for logging).
+     * @param factory Factory for decoders of new connections.
+     * @param sink Destination of messages received from the connections.
+     * @param limits Occupancy of the output queue at which reading is paused and resumed.
      * @throws when fails to create epoll
      */
-    ClientManager(ipx_ctx_t *ctx, DecoderFactory factory);
+    ClientManager(ipx_ctx_t *ctx, DecoderFactory factory, MsgSink &sink, PauseLimits limits);
 
     /**
      * @brief Adds connection to the vector and epoll.
@@ -42,8 +50,7 @@ public:
 
     /**
      * @brief Removes connection from the vector based on its session. This is safe only for the
-     * main thread (not the acceptor thread).
-     * @param ctx Context used for closing sessions.
+     * thread that receives data from the connections (not the acceptor thread).
      * @param session session of the connection to remove.
      */
     void close_connection(const ipx_session *session);
@@ -58,17 +65,52 @@ public:
      */
     size_t wait_for_connections(Connection **connections, int max_connections);
 
-    /** Closes all connections. */
-    void close_all_connections();
+    /**
+     * @brief Waits for new data and receives it from all the connections with new data. The
+     * connections that reach EOF or fail are closed.
+     *
+     * While the output queue of the plugin is too full, no data is received (it is left in
+     * the kernel, so TCP flow control slows down the exporters) and the call only waits.
+     * @throws when fails to wait for connections
+     */
+    void receive();
+
+    /**
+     * @brief Gets the number of managed connections. Safe for any thread.
+     * @return Number of connections.
+     */
+    size_t connection_count() const noexcept {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Closes all connections.
+     * @param sink Destination of the events about closing the sessions.
+     */
+    void close_all_connections(MsgSink &sink);
 private:
+    /**
+     * @brief Pauses or resumes reading based on the occupancy of the output queue.
+     * @return true if reading is paused.
+     */
+    bool update_paused();
+
     /** Closes connection at the given index. DOES NOT SYNCHRONIZE */
-    void close_connection_internal(size_t connection_idx) noexcept;
+    void close_connection_internal(size_t connection_idx, MsgSink &sink) noexcept;
 
     ipx_ctx_t *m_ctx;
     Epoll m_epoll;
     std::mutex m_mutex;
     std::vector<std::unique_ptr<Connection>> m_connections;
+    /** Number of connections (readable without the mutex) */
+    std::atomic<size_t> m_count;
     DecoderFactory m_factory;
+    MsgSink &m_sink;
+    PauseLimits m_limits;
+    /** Reading from the connections is paused (modified under the mutex) */
+    bool m_paused;
+    /** Start of the current pause */
+    std::chrono::steady_clock::time_point m_pause_start;
 };
 
 } // namespace tcp_in
@@ -23,6 +23,10 @@
 #include "IpAddress.hpp" // IpAddress
 
 #define DEFAULT_PORT 4739
+#define DEFAULT_THREADS 1
+#define MAX_THREADS 64
+#define DEFAULT_PAUSE_HIGH 90
+#define DEFAULT_PAUSE_LOW 50
 
 namespace tcp_in {
 
@@ -30,23 +34,37 @@ namespace tcp_in {
  * <params>
  *  <localPort>...</localPort>                    <!-- optional -->
  *  <localIPAddress>...</localIPAddress>          <!-- optional, multiple times -->
+ *  <threads>...</threads>                        <!-- optional -->
+ *  <pauseHighWatermark>...</pauseHighWatermark>  <!-- optional -->
+ *  <pauseLowWatermark>...</pauseLowWatermark>    <!-- optional -->
  * </params>
  */
 
 enum ParamsXmlNodes {
     PARAM_PORT,
     PARAM_IPADDR,
+    PARAM_THREADS,
+    PARAM_PAUSE_HIGH,
+    PARAM_PAUSE_LOW,
 };
 
 static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
-    FDS_OPTS_ELEM(PARAM_PORT  , "localPort"     , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
-    FDS_OPTS_ELEM(PARAM_IPADDR, "localIPAddress", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT
-                                                                   | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(PARAM_PORT      , "localPort"         , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_IPADDR    , "localIPAddress"    , FDS_OPTS_T_STRING, FDS_OPTS_P_OPT
+                                                                           | FDS_OPTS_P_MULTI),
+    FDS_OPTS_ELEM(PARAM_THREADS   , "threads"           , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_PAUSE_HIGH, "pauseHighWatermark", FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(PARAM_PAUSE_LOW , "pauseLowWatermark" , FDS_OPTS_T_UINT  , FDS_OPTS_P_OPT),
     FDS_OPTS_END,
 };
 
-Config::Config(ipx_ctx *ctx, const char *params) : local_port(DEFAULT_PORT), local_addrs() {
+Config::Config(ipx_ctx *ctx, const char *params) :
+    local_port(DEFAULT_PORT),
+    local_addrs(),
+    threads(DEFAULT_THREADS),
+    pause{DEFAULT_PAUSE_HIGH, DEFAULT_PAUSE_LOW}
+{
     std::unique_ptr<fds_xml_t, decltype(&fds_xml_destroy)> xml(fds_xml_create(), &fds_xml_destroy);
     if (!xml) {
         throw std::runtime_error("Failed to create XML parser.");
@@ -92,11 +110,42 @@ void Config::parse_params(ipx_ctx *ctx, fds_xml_ctx_t *params) {
                 empty_address = true;
             }
             break;
+        case PARAM_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > MAX_THREADS) {
+                throw std::invalid_argument(
+                    "Number of threads must be in range from 1 to " + std::to_string(MAX_THREADS)
+                        + " but it was " + std::to_string(content->val_uint)
+                );
+            }
+            threads = content->val_uint;
+            break;
+        case PARAM_PAUSE_HIGH:
+        case PARAM_PAUSE_LOW:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > 100) {
+                throw std::invalid_argument(
+                    "Pause watermarks must be in range from 0 to 100 (percent) but it was "
+                        + std::to_string(content->val_uint)
+                );
+            }
+            if (content->id == PARAM_PAUSE_HIGH) {
+                pause.high = content->val_uint;
+            } else {
+                pause.low = content->val_uint;
+            }
+            break;
         default:
             throw std::invalid_argument("Unexpected element within <params>.");
         }
     }
 
+    if (pause.high != 0 && pause.low >= pause.high) {
+        throw std::invalid_argument(
+            "The low pause watermark must be smaller than the high pause watermark."
+        );
+    }
+
     if (empty_address && local_addrs.size() != 0) {
         IPX_CTX_WARNING(
             ctx,
@@ -21,10 +21,22 @@
 
 namespace tcp_in {
 
+/** Occupancy of the output queue at which reading from connections is paused and resumed */
+struct PauseLimits {
+    /** Occupancy (in percent) at which reading is paused, 0 means never */
+    unsigned high;
+    /** Occupancy (in percent) below which reading is resumed */
+    unsigned low;
+};
+
 /** TCP input plugin configuration */
 struct Config {
     uint16_t local_port;
     std::vector<IpAddress> local_addrs;
+    /** Number of threads receiving data from the connections */
+    uint16_t threads;
+    /** Backpressure limits */
+    PauseLimits pause;
 
     /**
      * @brief Parse configuration of the TCP plugin
@@ -17,12 +17,13 @@
 #include <sys/socket.h> // sockaddr_storage, socklen_t, getpeername, sockaddr, AF_INET, AF_INET6
 #include <netinet/in.h> // ntohs, sockaddr_in, sockaddr_in6, in_addr, IN6_IS_ADDR_V4MAPPED
 
-#include <ipfixcol2.h> // ipx_*, IPX_*, fds_ipfix_msg_hdr
+#include <ipfixcol2.h> // ipx_*, IPX_*
 
 #include "UniqueFd.hpp"   // UniqueFd
 #include "Decoder.hpp"    // Decoder
 #include "Connection.hpp" // Connection
 #include "ByteVector.hpp" // ByteVector
+#include "MsgSink.hpp"    // MsgSink
 
 namespace tcp_in {
 
@@ -91,7 +92,7 @@ Connection::Connection(UniqueFd fd, DecoderFactory &factory, ipx_ctx *ctx) :
     m_session = ipx_session_new_tcp(&net);
 }
 
-bool Connection::receive(ipx_ctx_t *ctx) {
+bool Connection::receive(MsgSink &sink) {
     if (!m_decoder) {
         m_decoder = m_factory.detect_decoder(m_fd.get());
         if (!m_decoder) {
@@ -106,69 +107,30 @@ bool Connection::receive(ipx_ctx_t *ctx) {
     }
 
     auto &buffer = m_decoder->decode();
-    buffer.process_decoded([=](ByteVector &&msg) { send_msg(ctx, std::move(msg)); });
+    buffer.process_decoded([&](ByteVector &&msg) { send_msg(sink, std::move(msg)); });
     return !buffer.is_eof_reached();
 }
 
-void Connection::send_msg(ipx_ctx_t *ctx, ByteVector &&msg) {
+void Connection::send_msg(MsgSink &sink, ByteVector &&msg) {
     if (m_new_connnection) {
         // Send information about new transform session
-        ipx_msg_session_t *session = ipx_msg_session_create(m_session, IPX_MSG_SESSION_OPEN);
-        if (!session) {
-            throw std::runtime_error(
-                "Failed to create new message session, closing connection "
-                    + std::string(m_session->ident)
-            );
-        }
-
-        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(session));
+        sink.session_open(m_session);
         m_new_connnection = false;
     }
 
-    ipx_msg_ctx msg_ctx;
-    msg_ctx.session = m_session;
-    msg_ctx.odid = ntohl(reinterpret_cast<const fds_ipfix_msg_hdr *>(msg.data())->odid);
-    msg_ctx.stream = 0; // Streams are not supported over TCP
-
-    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg.data(), msg.size());
-    if (!ipfix_msg) {
-        throw std::runtime_error(
-            "Failed to send message for session " + std::string(m_session->ident)
-        );
-    }
-
-    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(ipfix_msg));
-
-    // release the message data so that it is not freed by the destructor
-    msg.take();
+    sink.message(m_session, std::move(msg));
 }
 
-void Connection::close(ipx_ctx_t *ctx) {
+void Connection::close(MsgSink &sink) {
     if (m_new_connnection) {
         ipx_session_destroy(m_session);
         m_session = nullptr;
         return;
     }
 
-    ipx_msg_session_t *msg_session = ipx_msg_session_create(m_session, IPX_MSG_SESSION_CLOSE);
-    if (!msg_session) {
-        throw std::runtime_error(
-            "Failed to create message for closing session " + std::string(m_session->ident)
-        );
-    }
-
-    ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg_session));
-
-    ipx_msg_garbage_cb cb = reinterpret_cast<ipx_msg_garbage_cb>(&ipx_session_destroy);
-    ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(m_session, cb);
-    if (!msg_garbage) {
-        throw std::runtime_error(
-            "Failed create garbage message for session " + std::string(m_session->ident)
-        );
-    }
-
-    ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(msg_garbage));
+    ipx_session *session = m_session;
     m_session = nullptr;
+    sink.session_close(session);
 }
 
 Connection::~Connection() {
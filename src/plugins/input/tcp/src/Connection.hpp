@@ -11,12 +11,14 @@
 #pragma once
 
 #include <memory>  // std::unique_ptr
+#include <chrono>  // std::chrono
 
 #include <ipfixcol2.h> // ipx_ctx_t, ipx_session
 
 #include "ByteVector.hpp"     // ByteVector
 #include "Decoder.hpp"        // Decoder
 #include "DecoderFactory.hpp"
+#include "MsgSink.hpp"        // MsgSink
 #include "UniqueFd.hpp"       // UniqueFd
 
 namespace tcp_in {
@@ -36,18 +38,18 @@ public:
 
     /**
      * @brief Reads from the TCP session while there is data.
-     * @param ctx Ipx context (used to send the readed message)
+     * @param sink Destination of the readed messages
      * @returns false when eof has been reached
      * @throws when invalid data is received, when connection throws, it should be closed.
      */
-    bool receive(ipx_ctx_t *ctx);
+    bool receive(MsgSink &sink);
 
     /**
      * @brief Closes the session of this connection.
-     * @param ctx plugin context
+     * @param sink Destination of the event about closing the session
      * @throws when fails to create message about destroying the session
      */
-    void close(ipx_ctx_t *ctx);
+    void close(MsgSink &sink);
 
     /**
      * @brief Gets the file descriptor of the TCP connection
@@ -65,10 +67,31 @@ public:
         return *m_decoder;
     }
 
+    /**
+     * @brief Starts measuring the time for which reading from the connection is paused.
+     * @param now Current time.
+     */
+    inline void pause(std::chrono::steady_clock::time_point now) noexcept {
+        m_pause_start = now;
+    }
+
+    /**
+     * @brief Stops measuring the time for which reading from the connection is paused.
+     * @param now Current time.
+     */
+    inline void resume(std::chrono::steady_clock::time_point now) noexcept {
+        m_paused += now - m_pause_start;
+    }
+
+    /** Gets the total time for which reading from the connection has been paused. */
+    inline std::chrono::steady_clock::duration get_paused() const noexcept {
+        return m_paused;
+    }
+
     ~Connection();
 
 private:
-    void send_msg(ipx_ctx_t *ctx, ByteVector &&msg);
+    void send_msg(MsgSink &sink, ByteVector &&msg);
 
     /** TCP file descriptor */
     UniqueFd m_fd;
@@ -82,6 +105,10 @@ private:
     bool m_new_connnection = true;
     /** selected decoder or nullptr. */
     std::unique_ptr<Decoder> m_decoder = nullptr;
+    /** start of the current pause */
+    std::chrono::steady_clock::time_point m_pause_start;
+    /** total time for which reading has been paused */
+    std::chrono::steady_clock::duration m_paused = std::chrono::steady_clock::duration::zero();
 };
 
 } // namespace tcp_in
@@ -26,6 +26,7 @@
 #include "Decoder.hpp"      // Decoder
 #include "Lz4Decoder.hpp"   // LZ4_MAGIC, Lz4Decoder
 #include "IpfixDecoder.hpp" // IPFIX_MAGIC, IpfixDecoder
+#include "ZstdDecoder.hpp"  // ZSTD_MAGIC, ZstdDecoder
 
 #include <iostream>
 
@@ -76,6 +77,11 @@ std::unique_ptr<Decoder> DecoderFactory::detect_decoder(int fd) {
         return create_lz4_decoder(fd);
     }
 
+    // ZSTD decoder
+    if (magic_u32 == ZSTD_MAGIC) {
+        return create_zstd_decoder(fd);
+    }
+
     throw std::runtime_error("Failed to recognize the decoder.");
 }
 
@@ -87,5 +93,9 @@ std::unique_ptr<Decoder> DecoderFactory::create_lz4_decoder(int fd) {
     return std::unique_ptr<Decoder>(new Lz4Decoder(fd));
 }
 
+std::unique_ptr<Decoder> DecoderFactory::create_zstd_decoder(int fd) {
+    return std::unique_ptr<Decoder>(new ZstdDecoder(fd));
+}
+
 } // namespace tcp_in
 
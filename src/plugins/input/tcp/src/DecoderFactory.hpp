@@ -34,6 +34,7 @@ public:
 private:
     std::unique_ptr<Decoder> create_ipfix_decoder(int fd);
     std::unique_ptr<Decoder> create_lz4_decoder(int fd);
+    std::unique_ptr<Decoder> create_zstd_decoder(int fd);
 };
 
 } // namespace tcp_in
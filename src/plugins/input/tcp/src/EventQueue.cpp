@@ -0,0 +1,134 @@
+/**
+ * \file
+ * \brief Queue of events passed from a receiving thread to the plugin thread (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "EventQueue.hpp"
+
+#include <stdexcept> // runtime_error
+#include <string>    // string
+#include <thread>    // this_thread
+#include <chrono>    // microseconds
+#include <cerrno>    // errno, EINTR
+
+#include <fcntl.h>  // fcntl, F_GETFL, F_SETFL, O_NONBLOCK
+#include <unistd.h> // pipe, read, write
+
+#include <ipfixcol2.h> // ipx_strerror
+
+namespace tcp_in {
+
+EventQueue::EventQueue(size_t size) :
+    m_events(),
+    m_pipe_out(),
+    m_pipe_in(),
+    m_pad1(),
+    m_tail(0),
+    m_head_cache(0),
+    m_pad2(),
+    m_head(0),
+    m_notified(false)
+{
+    size_t pow2 = 1;
+    while (pow2 < size) {
+        pow2 <<= 1;
+    }
+    m_events.resize(pow2);
+
+    int fds[2];
+    if (pipe(fds) == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        throw std::runtime_error("Failed to create notification pipe: " + std::string(err_str));
+    }
+
+    m_pipe_out = UniqueFd(fds[0]);
+    m_pipe_in = UniqueFd(fds[1]);
+
+    for (int fd : fds) {
+        int flags = fcntl(fd, F_GETFL);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+void EventQueue::session_open(ipx_session *session) {
+    Event event;
+    event.type = Event::Type::OPEN;
+    event.session = session;
+    push(std::move(event));
+}
+
+void EventQueue::message(ipx_session *session, ByteVector &&msg) {
+    Event event;
+    event.type = Event::Type::MESSAGE;
+    event.session = session;
+    event.msg = std::move(msg);
+    push(std::move(event));
+}
+
+void EventQueue::session_close(ipx_session *session) {
+    Event event;
+    event.type = Event::Type::CLOSE;
+    event.session = session;
+    push(std::move(event));
+}
+
+void EventQueue::push(Event &&event) {
+    /** Delay before a full queue is checked again */
+    constexpr std::chrono::microseconds FULL_DELAY(50);
+
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    while (tail - m_head_cache >= m_events.size()) {
+        m_head_cache = m_head.load(std::memory_order_acquire);
+        if (tail - m_head_cache < m_events.size()) {
+            break;
+        }
+
+        // The queue is full -> make sure that the consumer is awake and wait for it
+        notify();
+        std::this_thread::sleep_for(FULL_DELAY);
+    }
+
+    m_events[tail & (m_events.size() - 1)] = std::move(event);
+    m_tail.store(tail + 1, std::memory_order_seq_cst);
+}
+
+void EventQueue::notify() noexcept {
+    if (m_head.load(std::memory_order_seq_cst) == m_tail.load(std::memory_order_relaxed)) {
+        // Nothing to consume
+        return;
+    }
+
+    if (m_notified.exchange(true, std::memory_order_seq_cst)) {
+        // Already notified
+        return;
+    }
+
+    const char byte = 0;
+    ssize_t ret;
+    do {
+        ret = write(m_pipe_in.get(), &byte, sizeof(byte));
+    } while (ret == -1 && errno == EINTR);
+    // Failure (i.e. a full pipe) means that the consumer has already been woken up
+}
+
+void EventQueue::pop_all(std::vector<Event> &events) {
+    // Clear the notification first, so new events cannot be missed
+    char buffer[64];
+    while (read(m_pipe_out.get(), buffer, sizeof(buffer)) > 0);
+    m_notified.store(false, std::memory_order_seq_cst);
+
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    const size_t tail = m_tail.load(std::memory_order_seq_cst);
+
+    for (size_t i = head; i != tail; ++i) {
+        events.push_back(std::move(m_events[i & (m_events.size() - 1)]));
+    }
+
+    m_head.store(tail, std::memory_order_release);
+}
+
+} // namespace tcp_in
@@ -0,0 +1,109 @@
+/**
+ * \file
+ * \brief Queue of events passed from a receiving thread to the plugin thread (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <atomic>  // std::atomic
+#include <vector>  // std::vector
+#include <cstddef> // size_t
+
+#include <ipfixcol2.h> // ipx_session
+
+#include "ByteVector.hpp" // ByteVector
+#include "MsgSink.hpp"    // MsgSink
+#include "UniqueFd.hpp"   // UniqueFd
+
+namespace tcp_in {
+
+/**
+ * Lock-free queue of events with exactly one producer (a receiving thread) and one consumer (the
+ * plugin thread). The consumer is woken up by a notification file descriptor.
+ */
+class EventQueue : public MsgSink {
+public:
+    /** Event passed through the queue */
+    struct Event {
+        enum class Type {
+            /** A new session has been opened */
+            OPEN,
+            /** A new IPFIX message */
+            MESSAGE,
+            /** A session has been closed */
+            CLOSE,
+        };
+
+        Type type = Type::OPEN;
+        ipx_session *session = nullptr;
+        /** The message (only Type::MESSAGE) */
+        ByteVector msg;
+    };
+
+    /**
+     * @brief Creates empty queue.
+     * @param size Capacity of the queue (rounded up to a power of two).
+     * @throws when fails to create the notification pipe
+     */
+    explicit EventQueue(size_t size);
+
+    EventQueue(const EventQueue &) = delete;
+    EventQueue &operator=(const EventQueue &) = delete;
+
+    /** Producer only. If the queue is full, waits until the consumer makes free space. */
+    void session_open(ipx_session *session) override;
+
+    /** Producer only. If the queue is full, waits until the consumer makes free space. */
+    void message(ipx_session *session, ByteVector &&msg) override;
+
+    /** Producer only. If the queue is full, waits until the consumer makes free space. */
+    void session_close(ipx_session *session) override;
+
+    /**
+     * @brief Wakes up the consumer if new events have been added (producer only). Should be
+     * called after a batch of events has been added.
+     */
+    void notify() noexcept;
+
+    /**
+     * @brief Gets the notification file descriptor. It is readable if there might be new events
+     * in the queue.
+     */
+    int get_fd() const noexcept {
+        return m_pipe_out.get();
+    }
+
+    /**
+     * @brief Takes all the events from the queue (consumer only). The notification descriptor is
+     * cleared first, so events added later are always signaled again.
+     * @param events Where to move the events (appended).
+     */
+    void pop_all(std::vector<Event> &events);
+
+private:
+    void push(Event &&event);
+
+    std::vector<Event> m_events;
+    /** Notification pipe read end */
+    UniqueFd m_pipe_out;
+    /** Notification pipe write end */
+    UniqueFd m_pipe_in;
+
+    /** Keeps the indices of the producer and the consumer on different cache lines */
+    char m_pad1[64];
+    /** Index of the next event to add (modified only by the producer) */
+    std::atomic<size_t> m_tail;
+    /** Index of the oldest event (cached by the producer) */
+    size_t m_head_cache;
+
+    char m_pad2[64];
+    /** Index of the oldest event (modified only by the consumer) */
+    std::atomic<size_t> m_head;
+    /** The consumer has been notified and hasn't cleared the notification yet */
+    std::atomic<bool> m_notified;
+};
+
+} // namespace tcp_in
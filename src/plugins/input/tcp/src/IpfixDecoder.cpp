@@ -11,76 +11,135 @@
 #include "IpfixDecoder.hpp"
 
 #include <stdexcept> // runtime_error
-#include <string>    // string
+#include <string>    // string, to_string
+#include <algorithm> // copy_n
+#include <cstring>   // memmove
+#include <cstdint>   // UINT16_MAX
 #include <errno.h>   // errno, EWOULDBLOCK, EAGAIN
 #include <stddef.h>  // size_t
 
-#include <unistd.h> // read
+#include <sys/socket.h> // recv
+#include <netinet/in.h> // ntohs
 
 #include <ipfixcol2.h> // fds_ipfix_msg_hdr, ipx_strerror
 
 #include "DecodeBuffer.hpp" // DecodeBuffer
-#include "read_until_n.hpp" // read_until_n
+#include "RecvChunk.hpp"    // RecvChunk
 
 namespace tcp_in {
 
+/** Size of chunks for receiving data */
+static constexpr size_t CHUNK_SIZE = 256 * 1024;
+/**
+ * Minimal free space in a chunk before receiving. It is the maximum size of IPFIX message, so
+ * the rest of the current message always fits.
+ */
+static constexpr size_t CHUNK_MIN_SPACE = UINT16_MAX;
+
 DecodeBuffer &IpfixDecoder::decode() {
-    while (!m_decoded.enough_data()) {
-        // Read the header of the message.
-        if (!read_header()) {
-            // There is not enough data to read the whole header.
+    bool more = true;
+    while (true) {
+        slice_messages();
+        if (!more || m_decoded.enough_data()) {
             break;
         }
 
-        // Read the body of the message.
-        if (!read_body()) {
-            // There is not enough data to read the whole body of the message.
-            break;
-        }
+        more = receive();
     }
 
-    if (m_decoded.is_eof_reached() && m_part_readed.size() != 0) {
+    if (m_decoded.is_eof_reached() && m_end != m_begin) {
         throw std::runtime_error("Received incomplete message.");
     }
 
     return m_decoded;
 }
 
-bool IpfixDecoder::read_header() {
-    if (m_msg_size != 0) {
-        // The header is already read, but the message body is incomplete.
-        return true;
+IpfixDecoder::~IpfixDecoder() {
+    if (m_chunk) {
+        m_chunk->unref();
     }
+}
 
-    // Read the header
-    if (!read_until_n(sizeof(fds_ipfix_msg_hdr))) {
-        // There is not enough data to read the whole header.
-        return false;
-    }
+void IpfixDecoder::slice_messages() {
+    constexpr size_t HDR_SIZE = sizeof(fds_ipfix_msg_hdr);
+
+    // All complete messages must be sliced, more data may never come to wake up the decoder.
+    while (m_end - m_begin >= HDR_SIZE) {
+        auto hdr = reinterpret_cast<const fds_ipfix_msg_hdr *>(m_chunk->data() + m_begin);
+        size_t msg_size = ntohs(hdr->length);
+        if (msg_size < HDR_SIZE) {
+            throw std::runtime_error(
+                "Received message with invalid length " + std::to_string(msg_size)
+            );
+        }
+
+        if (m_end - m_begin < msg_size) {
+            // The message is incomplete
+            return;
+        }
 
-    // The header has been read, load the size of the message.
-    auto hdr = reinterpret_cast<fds_ipfix_msg_hdr *>(m_part_readed.data());
-    m_msg_size = ntohs(hdr->length);
-    return true;
+        m_decoded.add(m_chunk->slice(m_begin, msg_size));
+        m_begin += msg_size;
+    }
 }
 
-bool IpfixDecoder::read_body() {
-    // Read the body.
-    if (!read_until_n(m_msg_size)) {
-        // There is not enough data to read the whole body
+bool IpfixDecoder::receive() {
+    prepare_chunk();
+
+    size_t space = m_chunk->capacity() - m_end;
+    auto res = recv(m_fd, m_chunk->data() + m_end, space, 0);
+    if (res == -1) {
+        int err = errno;
+        if (err == EWOULDBLOCK || err == EAGAIN) {
+            return false;
+        }
+
+        const char *err_str;
+        ipx_strerror(err, err_str);
+        throw std::runtime_error("Failed to read from descriptor: " + std::string(err_str));
+    }
+
+    if (res == 0) {
+        m_decoded.signal_eof();
         return false;
     }
 
-    // Whole message has been read. Add it to the decode buffer.
-    m_decoded.add(std::move(m_part_readed));
-    m_part_readed = ByteVector();
-    m_msg_size = 0;
-    return true;
+    m_end += res;
+    // Short read means that the socket has been drained
+    return static_cast<size_t>(res) == space;
 }
 
-bool IpfixDecoder::read_until_n(size_t n) {
-    return ::read_until_n(n, m_fd, m_part_readed, m_decoded);
+void IpfixDecoder::prepare_chunk() {
+    if (!m_chunk) {
+        m_chunk = RecvChunk::create(CHUNK_SIZE);
+        return;
+    }
+
+    const size_t pending = m_end - m_begin;
+    const bool shared = m_chunk->is_shared();
+
+    if (pending == 0 && !shared) {
+        // Nothing references the data, reuse the chunk from the start
+        m_begin = m_end = 0;
+        return;
+    }
+
+    if (m_chunk->capacity() - m_end >= CHUNK_MIN_SPACE) {
+        return;
+    }
+
+    // Move the incomplete message to the start of a chunk
+    if (shared) {
+        RecvChunk *chunk = RecvChunk::create(CHUNK_SIZE);
+        std::copy_n(m_chunk->data() + m_begin, pending, chunk->data());
+        m_chunk->unref();
+        m_chunk = chunk;
+    } else {
+        std::memmove(m_chunk->data(), m_chunk->data() + m_begin, pending);
+    }
+
+    m_begin = 0;
+    m_end = pending;
 }
 
 } // namespace tcp_in
-
@@ -15,21 +15,30 @@
 
 #include "Decoder.hpp"      // Decoder
 #include "DecodeBuffer.hpp" // DecodeBuffer
-#include "ByteVector.hpp"   // ByteVector
+#include "RecvChunk.hpp"    // RecvChunk
 
 namespace tcp_in {
 
 /** Identifies data for which this decoder should be used. */
 constexpr uint16_t IPFIX_MAGIC = 10;
 
-/** Decoder for basic IPFX data. */
+/**
+ * Decoder for basic IPFX data.
+ *
+ * Data is received in large blocks into a chunk and complete messages are passed on as slices of
+ * the chunk, so there is only one system call for many messages and the messages are not copied.
+ * Only a message that doesn't fit into the rest of the chunk is moved to a new chunk.
+ */
 class IpfixDecoder : public Decoder {
 public:
     /**
      * @brief Creates ipfix decoder.
      * @param fd TCP connection file descriptor.
      */
-    IpfixDecoder(int fd) : m_fd(fd), m_decoded(), m_part_readed(), m_msg_size(0) {}
+    IpfixDecoder(int fd) : m_fd(fd), m_decoded(), m_chunk(nullptr), m_begin(0), m_end(0) {}
+
+    IpfixDecoder(const IpfixDecoder &) = delete;
+    IpfixDecoder &operator=(const IpfixDecoder &) = delete;
 
     virtual DecodeBuffer &decode() override;
 
@@ -37,20 +46,28 @@ public:
         return "IPFIX";
     }
 
+    virtual ~IpfixDecoder() override;
+
 private:
-    /** returns true if there was enough data to read the header or if the header is already read */
-    bool read_header();
-    /** returns true if there was enough data to read the body */
-    bool read_body();
-    /** returns true if there was enough data to read to the given amount */
-    bool read_until_n(size_t n);
+    /** Moves all complete messages from the chunk to the decode buffer. */
+    void slice_messages();
+    /**
+     * @brief Receives data to the chunk.
+     * @returns true if the socket may have more data (the receive filled the whole free space).
+     */
+    bool receive();
+    /** Makes sure that the chunk has enough free space for the rest of the current message. */
+    void prepare_chunk();
 
     int m_fd;
     DecodeBuffer m_decoded;
 
-    ByteVector m_part_readed;
-    /** Final size of the whole IPFIX message. When 0 IPIFX header is not fully read. */
-    size_t m_msg_size;
+    /** Chunk with received data (nullptr until the first receive) */
+    RecvChunk *m_chunk;
+    /** Offset of the first byte in the chunk that is not a part of a sliced message */
+    size_t m_begin;
+    /** Offset of the end of the received data in the chunk */
+    size_t m_end;
 };
 
 } // namespace tcp_in
@@ -22,8 +22,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     "Input plugins for IPFIX/NetFlow v5/v9 over Transmission Control Protocol.",
     // Plugin type (input plugin)
     IPX_PT_INPUT,
-    // Configuration flags (unused)
-    0,
+    // Configuration flags (instances of pipeline shards share listening sockets)
+    IPX_PF_SHARDABLE,
     // Plugin version string
     "3.0.0",
     // Minimal IPFIXcol version string
@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \brief Destination of messages received from TCP connections (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "MsgSink.hpp"
+
+#include <stdexcept> // runtime_error
+#include <string>    // string
+
+#include <netinet/in.h> // ntohl
+
+#include <ipfixcol2.h> // ipx_*, fds_ipfix_msg_hdr
+
+#include "ByteVector.hpp" // ByteVector
+
+namespace tcp_in {
+
+void CtxSink::session_open(ipx_session *session) {
+    ipx_msg_session_t *msg_session = ipx_msg_session_create(session, IPX_MSG_SESSION_OPEN);
+    if (!msg_session) {
+        throw std::runtime_error(
+            "Failed to create new message session, closing connection "
+                + std::string(session->ident)
+        );
+    }
+
+    ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg_session));
+}
+
+void CtxSink::message(ipx_session *session, ByteVector &&msg) {
+    ipx_msg_ctx msg_ctx;
+    msg_ctx.session = session;
+    msg_ctx.odid = ntohl(reinterpret_cast<const fds_ipfix_msg_hdr *>(msg.data())->odid);
+    msg_ctx.stream = 0; // Streams are not supported over TCP
+
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create_ext(m_ctx, &msg_ctx, msg.data(), msg.size(),
+        msg.free_cb(), msg.free_arg());
+    if (!ipfix_msg) {
+        throw std::runtime_error(
+            "Failed to send message for session " + std::string(session->ident)
+        );
+    }
+
+    ipx_ctx_msg_pass(m_ctx, ipx_msg_ipfix2base(ipfix_msg));
+
+    // release the message data so that it is not freed by the destructor
+    msg.take();
+}
+
+void CtxSink::session_close(ipx_session *session) {
+    ipx_msg_session_t *msg_session = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+    if (!msg_session) {
+        throw std::runtime_error(
+            "Failed to create message for closing session " + std::string(session->ident)
+        );
+    }
+
+    ipx_ctx_msg_pass(m_ctx, ipx_msg_session2base(msg_session));
+
+    ipx_msg_garbage_cb cb = reinterpret_cast<ipx_msg_garbage_cb>(&ipx_session_destroy);
+    ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(session, cb);
+    if (!msg_garbage) {
+        throw std::runtime_error(
+            "Failed create garbage message for session " + std::string(session->ident)
+        );
+    }
+
+    ipx_ctx_msg_pass(m_ctx, ipx_msg_garbage2base(msg_garbage));
+}
+
+} // namespace tcp_in
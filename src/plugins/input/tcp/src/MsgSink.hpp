@@ -0,0 +1,65 @@
+/**
+ * \file
+ * \brief Destination of messages received from TCP connections (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <ipfixcol2.h> // ipx_ctx_t, ipx_session
+
+#include "ByteVector.hpp" // ByteVector
+
+namespace tcp_in {
+
+/** Destination of messages and session events produced by connections. */
+class MsgSink {
+public:
+    virtual ~MsgSink() = default;
+
+    /**
+     * @brief Announces that a new session has been opened.
+     * @param session The new session.
+     * @throws when fails to deliver the event
+     */
+    virtual void session_open(ipx_session *session) = 0;
+
+    /**
+     * @brief Delivers a complete IPFIX message received in the session.
+     * @param session Session of the message.
+     * @param msg The message (taken by the sink on success).
+     * @throws when fails to deliver the message
+     */
+    virtual void message(ipx_session *session, ByteVector &&msg) = 0;
+
+    /**
+     * @brief Announces that a session has been closed. The sink is responsible for destroying
+     * the session.
+     * @param session The closed session.
+     * @throws when fails to deliver the event
+     */
+    virtual void session_close(ipx_session *session) = 0;
+};
+
+/** Sink that passes the messages directly to the collector. Usable only by the plugin thread. */
+class CtxSink : public MsgSink {
+public:
+    /**
+     * @brief Creates sink passing messages to the given context.
+     * @param ctx The plugin context.
+     */
+    CtxSink(ipx_ctx_t *ctx) : m_ctx(ctx) {}
+
+    void session_open(ipx_session *session) override;
+
+    void message(ipx_session *session, ByteVector &&msg) override;
+
+    void session_close(ipx_session *session) override;
+
+private:
+    ipx_ctx_t *m_ctx;
+};
+
+} // namespace tcp_in
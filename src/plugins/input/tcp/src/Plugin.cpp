@@ -10,63 +10,134 @@
 
 #include "Plugin.hpp"
 
-#include <array>     // array
-#include <stdexcept> // exception
-#include <cstddef>   // size_t
+#include <stdexcept> // exception, runtime_error
+#include <string>    // string
+#include <memory>    // unique_ptr
+#include <vector>    // vector
+#include <cerrno>    // errno
 
-#include <ipfixcol2.h> // ipx_ctx_t, IPX_CTX_ERROR, IPX_CTX_INFO, IPX_CTX_WARNING, ipx_session
+#include <ipfixcol2.h> // ipx_ctx_t, ipx_strerror, IPX_CTX_WARNING, ipx_session, ipx_ctx_feedback_fd_get
 
 #include "Config.hpp"         // Config
 #include "DecoderFactory.hpp" // DecoderFactory
-#include "Connection.hpp"     // Connection
+#include "Worker.hpp"         // Worker
 
 namespace tcp_in {
 
 Plugin::Plugin(ipx_ctx_t *ctx, Config &config) :
     m_ctx(ctx),
-    m_clients(ctx, DecoderFactory()),
-    m_acceptor(m_clients, ctx)
+    m_sink(ctx),
+    m_clients(ctx, DecoderFactory(), m_sink, config.pause),
+    m_workers(create_workers(ctx, config.threads, config.pause)),
+    m_workers_epoll(),
+    m_acceptor(client_managers(), ctx)
 {
     m_acceptor.bind_addresses(config);
+
+    for (auto &worker : m_workers) {
+        m_workers_epoll.add(worker->get_fd(), nullptr);
+        worker->start();
+    }
+
+    // Wake up immediately when the parser wants to close a session (requests are processed
+    // by the collector after return from get())
+    int feedback_fd = ipx_ctx_feedback_fd_get(ctx);
+    if (!m_workers.empty() && feedback_fd >= 0) {
+        m_workers_epoll.add(feedback_fd, nullptr);
+    }
+
     m_acceptor.start();
 }
 
+std::vector<std::unique_ptr<Worker>> Plugin::create_workers(
+    ipx_ctx_t *ctx,
+    unsigned threads,
+    PauseLimits limits
+) {
+    std::vector<std::unique_ptr<Worker>> workers;
+    if (threads <= 1) {
+        return workers;
+    }
+
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(new Worker(ctx, DecoderFactory(), limits));
+    }
+
+    return workers;
+}
+
+std::vector<ClientManager *> Plugin::client_managers() {
+    std::vector<ClientManager *> managers;
+    if (m_workers.empty()) {
+        managers.push_back(&m_clients);
+        return managers;
+    }
+
+    for (auto &worker : m_workers) {
+        managers.push_back(&worker->get_clients());
+    }
+
+    return managers;
+}
+
 void Plugin::get() {
-    /** Maximum number of connections to process in one call to get */
-    constexpr int MAX_CONNECTION_BATCH_SIZE = 16;
-    std::array<Connection *, MAX_CONNECTION_BATCH_SIZE> connections{};
-
-    auto count = m_clients.wait_for_connections(connections.begin(), connections.size());
-
-    for (size_t i = 0; i < count; ++i) {
-        try {
-            if (!connections[i]->receive(m_ctx)) {
-                // EOF reached
-                auto session = connections[i]->get_session();
-                IPX_CTX_INFO(m_ctx, "Closing %s", session->ident);
-                m_clients.close_connection(session);
-            }
-        } catch (std::exception &ex) {
-            IPX_CTX_ERROR(m_ctx, "%s", ex.what());
-            auto session = connections[i]->get_session();
-            IPX_CTX_INFO(m_ctx, "Closing %s", session->ident);
-            m_clients.close_connection(session);
-        }
+    if (!m_workers.empty()) {
+        get_from_workers();
+        return;
+    }
+
+    m_clients.receive();
+}
+
+void Plugin::get_from_workers() {
+    // timeout for waiting for new events (in milliseconds)
+    constexpr int GETTER_TIMEOUT = 10;
+
+    // one more for the feedback of the parser
+    std::vector<epoll_event> events(m_workers.size() + 1);
+
+    int ev_valid = m_workers_epoll.wait(events.data(), events.size(), GETTER_TIMEOUT);
+    if (ev_valid == -1) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        throw std::runtime_error("Failed to wait for new data: " + std::string(err_str));
+    }
+
+    if (ev_valid == 0) {
+        return;
+    }
+
+    for (auto &worker : m_workers) {
+        worker->consume(m_sink);
     }
 }
 
 void Plugin::close_session(const ipx_session *session) noexcept {
-    m_clients.close_connection(session);
+    if (m_workers.empty()) {
+        m_clients.close_connection(session);
+        return;
+    }
+
+    try {
+        for (auto &worker : m_workers) {
+            worker->request_close(session);
+        }
+    } catch (std::exception &ex) {
+        IPX_CTX_WARNING(m_ctx, "%s", ex.what());
+    }
 }
 
 Plugin::~Plugin() {
     try {
         m_acceptor.stop();
-        m_clients.close_all_connections();
+        for (auto &worker : m_workers) {
+            worker->stop(m_sink);
+            worker->get_clients().close_all_connections(m_sink);
+        }
+        m_clients.close_all_connections(m_sink);
     } catch (std::exception &ex) {
         IPX_CTX_WARNING(m_ctx, "%s", ex.what());
     }
 }
 
 } // namespace tcp_in
-
@@ -10,11 +10,17 @@
 
 #pragma once
 
+#include <memory> // std::unique_ptr
+#include <vector> // std::vector
+
 #include <ipfixcol2.h> // ipx_ctx_t, ipx_session
 
-#include "Config.hpp"        // Config
+#include "Config.hpp"        // Config, PauseLimits
 #include "ClientManager.hpp" // ClientManager
 #include "Acceptor.hpp"      // Acceptor
+#include "Epoll.hpp"         // Epoll
+#include "MsgSink.hpp"       // CtxSink
+#include "Worker.hpp"        // Worker
 
 namespace tcp_in {
 
@@ -50,8 +56,34 @@ public:
 
     ~Plugin();
 private:
+    /**
+     * @brief Creates receiving threads (not started).
+     * @param ctx The plugin context.
+     * @param threads Number of threads. No threads are created if the value is 1, because the
+     * connections are received directly by the plugin thread.
+     * @param limits Occupancy of the output queue at which the threads pause reading.
+     */
+    static std::vector<std::unique_ptr<Worker>> create_workers(
+        ipx_ctx_t *ctx,
+        unsigned threads,
+        PauseLimits limits
+    );
+
+    /** Gets the client managers that receive new connections. */
+    std::vector<ClientManager *> client_managers();
+
+    /** Passes events from the workers to the collector. */
+    void get_from_workers();
+
     ipx_ctx_t *m_ctx;
+    /** Passes messages to the collector. */
+    CtxSink m_sink;
+    /** Connections received directly by the plugin thread (only without workers). */
     ClientManager m_clients;
+    /** Receiving threads (empty if the connections are received by the plugin thread). */
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    /** Waits for events from the workers. */
+    Epoll m_workers_epoll;
     /** Acceptor thread. */
     Acceptor m_acceptor;
 };
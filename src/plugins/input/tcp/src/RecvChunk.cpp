@@ -0,0 +1,50 @@
+/**
+ * \file
+ * \brief Reference counted buffer for receiving data (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "RecvChunk.hpp"
+
+#include <new>       // placement new
+#include <cstdlib>   // malloc, free
+#include <stdexcept> // runtime_error
+#include <string>    // to_string
+
+#include "ByteVector.hpp" // ByteVector
+
+namespace tcp_in {
+
+RecvChunk *RecvChunk::create(size_t capacity) {
+    void *mem = malloc(sizeof(RecvChunk) + capacity);
+    if (!mem) {
+        throw std::runtime_error(
+            "Failed to allocate receive buffer of size " + std::to_string(capacity)
+        );
+    }
+
+    return new (mem) RecvChunk(capacity);
+}
+
+void RecvChunk::unref() noexcept {
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    this->~RecvChunk();
+    free(this);
+}
+
+ByteVector RecvChunk::slice(size_t offset, size_t size) noexcept {
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+    return ByteVector::borrow(data() + offset, size, &RecvChunk::release, this);
+}
+
+void RecvChunk::release(void *chunk, uint8_t *data) noexcept {
+    (void) data;
+    static_cast<RecvChunk *>(chunk)->unref();
+}
+
+} // namespace tcp_in
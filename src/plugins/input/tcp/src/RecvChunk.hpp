@@ -0,0 +1,75 @@
+/**
+ * \file
+ * \brief Reference counted buffer for receiving data (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <atomic>  // std::atomic
+#include <cstdint> // uint8_t
+#include <cstddef> // size_t
+
+#include "ByteVector.hpp" // ByteVector
+
+namespace tcp_in {
+
+/**
+ * Buffer for receiving large blocks of data. Complete messages inside the buffer can be passed
+ * on without copying (see `slice`). The buffer is freed when the owner and all the slices
+ * release it.
+ */
+class RecvChunk {
+public:
+    /**
+     * @brief Allocates new chunk. The caller holds the only reference.
+     * @param capacity Size of the data part of the chunk.
+     * @return The new chunk.
+     * @throws std::runtime_error when fails to allocate the chunk
+     */
+    static RecvChunk *create(size_t capacity);
+
+    RecvChunk(const RecvChunk &) = delete;
+    RecvChunk &operator=(const RecvChunk &) = delete;
+
+    /** Releases a reference to the chunk. The chunk is freed with the last reference. */
+    void unref() noexcept;
+
+    /**
+     * @brief Checks whether there are references other than the caller's one (i.e. slices).
+     * @return true if the chunk is shared.
+     */
+    bool is_shared() const noexcept {
+        return m_refs.load(std::memory_order_acquire) != 1;
+    }
+
+    uint8_t *data() noexcept {
+        return reinterpret_cast<uint8_t *>(this + 1);
+    }
+
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    /**
+     * @brief Creates vector that references part of the chunk. The vector holds a reference to
+     * the chunk until it is destroyed or until its data is released by its callback.
+     * @param offset Offset of the part.
+     * @param size Size of the part.
+     * @return The vector.
+     */
+    ByteVector slice(size_t offset, size_t size) noexcept;
+
+private:
+    explicit RecvChunk(size_t capacity) : m_refs(1), m_capacity(capacity) {}
+
+    /** Callback of slices (matches `ipx_msg_ipfix_free_cb`) */
+    static void release(void *chunk, uint8_t *data) noexcept;
+
+    std::atomic<size_t> m_refs;
+    size_t m_capacity;
+};
+
+} // namespace tcp_in
@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \brief Thread receiving data from a subset of TCP connections (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "Worker.hpp"
+
+#include <stdexcept> // runtime_error, exception
+#include <thread>    // thread, this_thread
+#include <chrono>    // milliseconds
+#include <mutex>     // mutex, lock_guard
+#include <vector>    // vector
+
+#include <ipfixcol2.h> // ipx_ctx_t, ipx_session, ipx_session_destroy, IPX_CTX_*
+
+#include "EventQueue.hpp" // EventQueue
+#include "ByteVector.hpp" // ByteVector
+#include "MsgSink.hpp"    // MsgSink
+
+namespace tcp_in {
+
+/** Capacity of the queue of events between the worker and the plugin thread */
+static constexpr size_t WORKER_QUEUE_SIZE = 4096;
+
+/** Sink that drops all the events (used when the events cannot be passed to the collector). */
+class DiscardSink : public MsgSink {
+public:
+    void session_open(ipx_session *) override {}
+
+    void message(ipx_session *, ByteVector &&) override {}
+
+    void session_close(ipx_session *session) override {
+        ipx_session_destroy(session);
+    }
+};
+
+Worker::Worker(ipx_ctx_t *ctx, DecoderFactory factory, PauseLimits limits) :
+    m_ctx(ctx),
+    m_queue(WORKER_QUEUE_SIZE),
+    m_clients(ctx, std::move(factory), m_queue, limits),
+    m_events(),
+    m_close(),
+    m_close_mutex(),
+    m_close_pending(false),
+    m_stop(false),
+    m_finished(false),
+    m_thread()
+{}
+
+void Worker::start() {
+    if (m_thread.joinable()) {
+        throw std::runtime_error("Worker thread is already running.");
+    }
+
+    m_stop = false;
+    m_finished = false;
+    m_thread = std::thread([=]() { mainloop(); });
+}
+
+void Worker::stop(MsgSink &sink) {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    m_stop = true;
+
+    // The thread may wait for free space in the queue
+    while (!m_finished) {
+        drain(sink);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    m_thread.join();
+    drain(sink);
+}
+
+void Worker::request_close(const ipx_session *session) {
+    std::lock_guard<std::mutex> lock(m_close_mutex);
+    m_close.push_back(session);
+    m_close_pending = true;
+}
+
+void Worker::consume(MsgSink &sink) {
+    drain(sink);
+}
+
+void Worker::mainloop() {
+    try {
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            if (m_close_pending.load(std::memory_order_relaxed)) {
+                close_requested();
+            }
+
+            m_clients.receive();
+            m_queue.notify();
+        }
+    } catch (std::exception &ex) {
+        IPX_CTX_ERROR(m_ctx, "Receiving thread terminated: %s", ex.what());
+    }
+
+    m_queue.notify();
+    m_finished = true;
+}
+
+void Worker::close_requested() {
+    std::vector<const ipx_session *> sessions;
+    {
+        std::lock_guard<std::mutex> lock(m_close_mutex);
+        sessions.swap(m_close);
+        m_close_pending = false;
+    }
+
+    for (auto session : sessions) {
+        m_clients.close_connection(session);
+    }
+}
+
+void Worker::drain(MsgSink &sink) {
+    m_events.clear();
+    m_queue.pop_all(m_events);
+
+    for (auto &event : m_events) {
+        try {
+            switch (event.type) {
+            case EventQueue::Event::Type::OPEN:
+                sink.session_open(event.session);
+                break;
+            case EventQueue::Event::Type::MESSAGE:
+                sink.message(event.session, std::move(event.msg));
+                break;
+            case EventQueue::Event::Type::CLOSE:
+                sink.session_close(event.session);
+                break;
+            }
+        } catch (std::exception &ex) {
+            IPX_CTX_ERROR(m_ctx, "%s", ex.what());
+        }
+    }
+
+    m_events.clear();
+}
+
+Worker::~Worker() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    // Not stopped properly -> events cannot be passed anymore
+    DiscardSink discard;
+    stop(discard);
+    m_clients.close_all_connections(discard);
+}
+
+} // namespace tcp_in
@@ -0,0 +1,118 @@
+/**
+ * \file
+ * \brief Thread receiving data from a subset of TCP connections (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <atomic>  // std::atomic
+#include <mutex>   // std::mutex
+#include <thread>  // std::thread
+#include <vector>  // std::vector
+
+#include <ipfixcol2.h> // ipx_ctx_t, ipx_session
+
+#include "ClientManager.hpp"  // ClientManager
+#include "DecoderFactory.hpp" // DecoderFactory
+#include "EventQueue.hpp"     // EventQueue
+#include "MsgSink.hpp"        // MsgSink
+
+namespace tcp_in {
+
+/**
+ * Thread that receives and decodes data from its own connections. Messages are passed to the
+ * plugin thread through a queue, because only the plugin thread can pass them to the collector.
+ */
+class Worker {
+public:
+    /**
+     * @brief Creates the worker with no connections. The thread is not started.
+     * @param ctx The plugin context.
+     * @param factory Factory for decoders of new connections.
+     * @param limits Occupancy of the output queue at which reading is paused and resumed.
+     * @throws when fails to create epoll or the queue
+     */
+    Worker(ipx_ctx_t *ctx, DecoderFactory factory, PauseLimits limits);
+
+    // force that worker stays in its original memory (so that `this` pointer stays valid on the
+    // other thread)
+    Worker(const Worker &) = delete;
+    Worker(Worker &&) = delete;
+
+    /** Gets the manager of connections of this worker (new connections are added to it). */
+    ClientManager &get_clients() noexcept {
+        return m_clients;
+    }
+
+    /** Gets file descriptor that is readable when there might be new events from the worker. */
+    int get_fd() const noexcept {
+        return m_queue.get_fd();
+    }
+
+    /**
+     * @brief Starts the worker thread.
+     * @throws When the thread is already started.
+     */
+    void start();
+
+    /**
+     * @brief Stops the worker thread. Events produced until the thread exits are passed to the
+     * given sink (plugin thread only).
+     * @param sink Destination of the events.
+     */
+    void stop(MsgSink &sink);
+
+    /**
+     * @brief Asks the worker to close the connection of the given session. Sessions of other
+     * workers are ignored. Safe for any thread.
+     * @param session Session to close.
+     */
+    void request_close(const ipx_session *session);
+
+    /**
+     * @brief Passes events produced by the worker to the given sink (plugin thread only).
+     * @param sink Destination of the events.
+     */
+    void consume(MsgSink &sink);
+
+    ~Worker();
+
+private:
+    /** Runs on the other thread */
+    void mainloop();
+
+    /** Closes connections requested by `request_close`. Runs on the other thread. */
+    void close_requested();
+
+    /**
+     * @brief Takes events from the queue and passes them to the sink.
+     * @param sink Destination of the events.
+     */
+    void drain(MsgSink &sink);
+
+    ipx_ctx_t *m_ctx;
+    /** Events produced by the connections of this worker. */
+    EventQueue m_queue;
+    /** Connections of this worker. */
+    ClientManager m_clients;
+    /** Buffer for events taken from the queue (plugin thread only). */
+    std::vector<EventQueue::Event> m_events;
+
+    /** Sessions to close. */
+    std::vector<const ipx_session *> m_close;
+    /** Protects `m_close`. */
+    std::mutex m_close_mutex;
+    /** `m_close` is not empty. */
+    std::atomic<bool> m_close_pending;
+
+    /** Set to stop the thread. */
+    std::atomic<bool> m_stop;
+    /** Set by the thread when it exits. */
+    std::atomic<bool> m_finished;
+    std::thread m_thread;
+};
+
+} // namespace tcp_in
@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \brief Zstandard decoder for tcp plugin (source file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "ZstdDecoder.hpp"
+
+#include <cstdint>   // uint32_t
+#include <stdexcept> // runtime_error
+#include <cstddef>   // size_t
+#include <cerrno>    // errno, EWOULDBLOCK, EAGAIN
+#include <string>    // string, to_string
+#include <algorithm> // max
+
+#include <sys/socket.h> // recv
+#include <netinet/in.h> // ntohl
+#include <zstd.h>       // ZSTD_*
+
+#include <ipfixcol2.h> // ipx_strerror
+
+#include "DecodeBuffer.hpp" // DecodeBuffer
+#include "read_until_n.hpp" // read_until_n
+
+namespace tcp_in {
+
+/** Largest window (log2 of its size) accepted from a compressor (limits memory per connection) */
+static constexpr uint32_t ZSTD_WINDOW_LOG_LIMIT = 27;
+
+struct __attribute__((__packed__)) zstd_start_header {
+    uint32_t magic;
+    /** log2 of the window size used by the compressor */
+    uint32_t window_log;
+};
+
+ZstdDecoder::ZstdDecoder(int fd) :
+    m_fd(fd),
+    m_decoded(),
+    m_decoder(ZSTD_createDCtx()),
+    m_started(false),
+    m_header(),
+    m_compressed(ZSTD_DStreamInSize()),
+    m_compressed_size(0),
+    m_compressed_pos(0),
+    m_decompressed(ZSTD_DStreamOutSize())
+{
+    if (!m_decoder) {
+        throw std::runtime_error("ZSTD Decoder: Failed to create stream decoder");
+    }
+}
+
+DecodeBuffer &ZstdDecoder::decode() {
+    while (!m_decoded.enough_data()) {
+        if (!m_started && !read_start_header()) {
+            // There is not enough data to read the whole start header.
+            break;
+        }
+
+        if (m_compressed_pos == m_compressed_size && !receive()) {
+            // There is no more data.
+            break;
+        }
+
+        decompress();
+    }
+
+    if (m_decoded.is_eof_reached() && m_header.size() != 0) {
+        throw std::runtime_error("Incomplete compressed message received");
+    }
+
+    return m_decoded;
+}
+
+bool ZstdDecoder::read_start_header() {
+    /** start header size */
+    constexpr size_t SCH_SIZE = sizeof(zstd_start_header);
+
+    if (!::read_until_n(SCH_SIZE, m_fd, m_header, m_decoded)) {
+        // There is not enough data to read the whole start header.
+        return false;
+    }
+
+    auto hdr = reinterpret_cast<zstd_start_header *>(m_header.data());
+    auto window_log = ntohl(hdr->window_log);
+    m_header.clear();
+
+    if (window_log > ZSTD_WINDOW_LOG_LIMIT) {
+        throw std::runtime_error(
+            "ZSTD Decoder: Window size 2^" + std::to_string(window_log) + " is too large"
+        );
+    }
+
+    // Reject frames with larger windows than announced
+    auto bounds = ZSTD_dParam_getBounds(ZSTD_d_windowLogMax);
+    size_t res = ZSTD_DCtx_setParameter(
+        m_decoder.get(),
+        ZSTD_d_windowLogMax,
+        std::max<int>(window_log, bounds.lowerBound)
+    );
+    if (ZSTD_isError(res)) {
+        throw std::runtime_error(
+            "ZSTD Decoder: Failed to set window size: " + std::string(ZSTD_getErrorName(res))
+        );
+    }
+
+    m_started = true;
+    return true;
+}
+
+bool ZstdDecoder::receive() {
+    auto res = recv(m_fd, m_compressed.data(), m_compressed.size(), 0);
+    if (res == -1) {
+        int err = errno;
+        if (err == EWOULDBLOCK || err == EAGAIN) {
+            return false;
+        }
+
+        const char *err_str;
+        ipx_strerror(err, err_str);
+        throw std::runtime_error("Failed to read from descriptor: " + std::string(err_str));
+    }
+
+    if (res == 0) {
+        m_decoded.signal_eof();
+        return false;
+    }
+
+    m_compressed_size = res;
+    m_compressed_pos = 0;
+    return true;
+}
+
+void ZstdDecoder::decompress() {
+    ZSTD_inBuffer in = {m_compressed.data(), m_compressed_size, m_compressed_pos};
+    ZSTD_outBuffer out = {m_decompressed.data(), m_decompressed.size(), 0};
+
+    // Continue while there is input or while the output buffer is filled (the decoder may hold
+    // more decompressed data)
+    do {
+        out.pos = 0;
+        size_t res = ZSTD_decompressStream(m_decoder.get(), &out, &in);
+        if (ZSTD_isError(res)) {
+            throw std::runtime_error(
+                "ZSTD Decoder: decompression failed: " + std::string(ZSTD_getErrorName(res))
+            );
+        }
+
+        // Copy the decompressed data into the decode buffer
+        m_decoded.read_from(m_decompressed.data(), out.pos);
+    } while (in.pos < in.size || out.pos == out.size);
+
+    m_compressed_pos = in.pos;
+}
+
+} // namespace tcp_in
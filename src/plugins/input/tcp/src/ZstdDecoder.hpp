@@ -0,0 +1,101 @@
+/**
+ * \file
+ * \brief Zstandard decoder for tcp plugin (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <memory>  // std::unique_ptr
+#include <cstdint> // uint8_t, uint32_t
+#include <vector>  // std::vector
+#include <cstddef> // size_t
+
+#include <zstd.h> // ZSTD_DCtx, ZSTD_freeDCtx
+
+#include "Decoder.hpp"      // Decoder
+#include "DecodeBuffer.hpp" // DecodeBuffer
+
+namespace tcp_in {
+
+/** Byte sequence at the start of zstd stream. Used to determine what decoder should be used */
+constexpr uint32_t ZSTD_MAGIC = 0x5a535444;
+
+struct ZstdDecodeDestructor {
+    inline void operator()(ZSTD_DCtx *p) noexcept {
+        ZSTD_freeDCtx(p);
+    }
+};
+
+/**
+ * Decoder for Zstandard stream compression.
+ *
+ * The stream starts with a start header (magic and the window size used by the compressor)
+ * followed by a Zstandard stream. The compressor flushes the stream after each IPFIX message, so
+ * the messages can be decoded as soon as they are received.
+ */
+class ZstdDecoder : public Decoder {
+public:
+    /**
+     * @brief Creates zstd decoder.
+     * @param fd TCP connection file descriptor.
+     * @throws when fails to create stream decoder
+     */
+    ZstdDecoder(int fd);
+
+    /**
+     * @brief Decodes the received data until there is no data or when enough data is decoded
+     * @return decoded data
+     * @throws when fails to read from file descriptor
+     * @throws when fails to decompress the data
+     */
+    virtual DecodeBuffer &decode() override;
+
+    virtual const char *get_name() const override {
+        return "ZSTD";
+    }
+
+private:
+    /**
+     * @brief reads the start header and configures the stream, returns true if whole header is
+     * readed
+     * @return true if whole header is readed
+     * @throws when fails to read from file descriptor or when the header is invalid
+     */
+    bool read_start_header();
+    /**
+     * @brief receives the next block of compressed data
+     * @return true if any data has been received
+     * @throws when fails to read from file descriptor
+     */
+    bool receive();
+    /**
+     * @brief decompresses all the received data and writes it to the decode buffer
+     * @throws when decompression fails
+     */
+    void decompress();
+
+    int m_fd;
+    DecodeBuffer m_decoded;
+
+    std::unique_ptr<ZSTD_DCtx, ZstdDecodeDestructor> m_decoder;
+
+    /** true when the start header has been read */
+    bool m_started;
+    /** incomplete start header */
+    std::vector<uint8_t> m_header;
+
+    /** received compressed data */
+    std::vector<uint8_t> m_compressed;
+    /** size of valid data in `m_compressed` */
+    size_t m_compressed_size;
+    /** position of the first byte in `m_compressed` that is not decompressed yet */
+    size_t m_compressed_pos;
+
+    /** buffer for decompressed data */
+    std::vector<uint8_t> m_decompressed;
+};
+
+} // namespace tcp_in
@@ -53,6 +53,18 @@
 #define LIFETIME_DATA_DEF (1800)
 /** Default Options Template Lifetime                                                            */
 #define LIFETIME_OPTS_DEF (1800)
+/** Default number of datagrams received by a single system call                                 */
+#define BATCH_SIZE_DEF (32)
+/** Maximum number of datagrams received by a single system call                                 */
+#define BATCH_SIZE_MAX (1024)
+/** Default size of a datagram buffer (enough for jumbo frames)                                  */
+#define BUFFER_SIZE_DEF (9216)
+/** Minimal size of a datagram buffer                                                            */
+#define BUFFER_SIZE_MIN (512)
+/** Default number of receiving threads                                                          */
+#define THREADS_DEF (1)
+/** Maximum number of receiving threads                                                          */
+#define THREADS_MAX (64)
 
 /*
  * <params>
@@ -61,6 +73,13 @@
  *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
  *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
  *  <connectionTimeout>...</connectionTimeout>    <!-- optional                  -->
+ *  <batchSize>...</batchSize>                    <!-- optional                  -->
+ *  <bufferSize>...</bufferSize>                  <!-- optional                  -->
+ *  <threads>...</threads>                        <!-- optional                  -->
+ *  <rateLimit>...</rateLimit>                    <!-- optional                  -->
+ *  <rateBurst>...</rateBurst>                    <!-- optional                  -->
+ *  <shedThreshold>...</shedThreshold>            <!-- optional                  -->
+ *  <shedTopExporters>...</shedTopExporters>      <!-- optional                  -->
  * </params>
  */
 
@@ -70,7 +89,14 @@ enum params_xml_nodes {
     NODE_IPADDR,
     NODE_LT_DATA,
     NODE_LT_OPTS,
-    NODE_TIMEOUT
+    NODE_TIMEOUT,
+    NODE_BATCH,
+    NODE_BUFFER,
+    NODE_THREADS,
+    NODE_RATE_LIMIT,
+    NODE_RATE_BURST,
+    NODE_SHED_THRESHOLD,
+    NODE_SHED_TOP
 };
 
 /** Definition of the \<params\> node  */
@@ -81,6 +107,13 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_LT_DATA, "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_LT_OPTS, "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_TIMEOUT, "connectionTimeout",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BATCH,   "batchSize",               FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BUFFER,  "bufferSize",              FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_THREADS, "threads",                 FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE_LIMIT,     "rateLimit",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_RATE_BURST,     "rateBurst",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SHED_THRESHOLD, "shedThreshold",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SHED_TOP,       "shedTopExporters", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -187,6 +220,71 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct udp_config *cfg)
             }
             cfg->timeout_conn = (uint16_t) content->val_uint;
             break;
+        case NODE_BATCH:
+            // Number of datagrams received at once
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > BATCH_SIZE_MAX) {
+                IPX_CTX_ERROR(ctx, "Batch size must be between 1..%d", BATCH_SIZE_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->batch_size = (uint16_t) content->val_uint;
+            break;
+        case NODE_BUFFER:
+            // Size of a datagram buffer
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < BUFFER_SIZE_MIN || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Buffer size must be between %d..%" PRIu16, BUFFER_SIZE_MIN,
+                    UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->buffer_size = (uint16_t) content->val_uint;
+            break;
+        case NODE_THREADS:
+            // Number of receiving threads
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > THREADS_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of threads must be between 1..%d", THREADS_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->threads = (uint16_t) content->val_uint;
+            break;
+        case NODE_RATE_LIMIT:
+            // Maximum rate of messages per exporter
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Rate limit must be between 0..%" PRIu32, UINT32_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->rate_limit = (uint32_t) content->val_uint;
+            break;
+        case NODE_RATE_BURST:
+            // Maximum burst of messages per exporter
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Rate burst must be between 1..%" PRIu32, UINT32_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->rate_burst = (uint32_t) content->val_uint;
+            break;
+        case NODE_SHED_THRESHOLD:
+            // Pressure of the pipeline to start shedding
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > 100) {
+                IPX_CTX_ERROR(ctx, "Shed threshold must be between 0..100", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->shed_threshold = (uint8_t) content->val_uint;
+            break;
+        case NODE_SHED_TOP:
+            // Number of the heaviest exporters to shed
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > CONFIG_SHED_TOP_MAX) {
+                IPX_CTX_ERROR(ctx, "Number of shed exporters must be between 1..%d",
+                    CONFIG_SHED_TOP_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->shed_top = (uint16_t) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -208,6 +306,13 @@ config_default_set(struct udp_config *cfg)
     cfg->timeout_conn = CONN_TIMEOUT_DEF;
     cfg->lifetime_data = LIFETIME_DATA_DEF;
     cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->batch_size = BATCH_SIZE_DEF;
+    cfg->buffer_size = BUFFER_SIZE_DEF;
+    cfg->threads = THREADS_DEF;
+    cfg->rate_limit = 0;
+    cfg->rate_burst = 0;
+    cfg->shed_threshold = 0;
+    cfg->shed_top = 1;
 }
 
 struct udp_config *
@@ -253,6 +358,11 @@ config_parse(ipx_ctx_t *ctx, const char *params)
         return NULL;
     }
 
+    if (cfg->rate_burst == 0) {
+        // By default, allow a burst of messages of one second
+        cfg->rate_burst = (cfg->rate_limit != 0) ? cfg->rate_limit : 1;
+    }
+
     return cfg;
 }
 
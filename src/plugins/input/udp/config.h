@@ -45,6 +45,9 @@
 #include <ipfixcol2.h>
 #include "stdint.h"
 
+/** Maximum number of the heaviest exporters to shed                                             */
+#define CONFIG_SHED_TOP_MAX (256)
+
 /** Parsed IP address */
 struct udp_ipaddr_rec {
     /** Version of IP address (AF_INET or AF_INET6)                                              */
@@ -67,6 +70,21 @@ struct udp_config {
     uint16_t lifetime_opts;
     /** Connection timeout                                                                       */
     uint16_t timeout_conn;
+    /** Maximum number of datagrams received by a single system call                             */
+    uint16_t batch_size;
+    /** Size of a receive buffer of a single datagram [bytes]                                    */
+    uint16_t buffer_size;
+    /** Number of receiving threads (i.e. sockets per local address)                             */
+    uint16_t threads;
+
+    /** Maximum rate of messages per exporter [messages per second] (0 = unlimited)              */
+    uint32_t rate_limit;
+    /** Maximum burst of messages per exporter above the rate limit                              */
+    uint32_t rate_burst;
+    /** Pressure of the pipeline [%] to start shedding of the heaviest exporters (0 = never)     */
+    uint8_t shed_threshold;
+    /** Number of the heaviest exporters to shed                                                  */
+    uint16_t shed_top;
 
     struct {
         /** Size of the array                                                                    */
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief Queue of received datagrams passed between threads
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "handoff.h"
+
+/** Delay before the producer checks a full queue again [nanoseconds]           */
+#define HANDOFF_FULL_DELAY (50000L)
+/** Expected size of a cache line                                               */
+#define HANDOFF_CACHE_LINE (64)
+
+/** Queue of events */
+struct udp_handoff {
+    /** Capacity of the queue (power of two)                                     */
+    size_t size;
+    /** Ring of events                                                           */
+    struct handoff_event *events;
+    /** Notification pipe (read end, write end)                                  */
+    int pipe_fd[2];
+
+    /** Index of the next event to add (modified only by the producer)          */
+    size_t tail __attribute__((aligned(HANDOFF_CACHE_LINE)));
+    /** Index of the oldest event (cached by the producer)                       */
+    size_t head_cache;
+
+    /** Index of the oldest event (modified only by the consumer)               */
+    size_t head __attribute__((aligned(HANDOFF_CACHE_LINE)));
+    /** The consumer has been notified and hasn't cleared the notification yet  */
+    bool notified;
+};
+
+udp_handoff_t *
+handoff_create(size_t size)
+{
+    struct udp_handoff *queue = calloc(1, sizeof(*queue));
+    if (!queue) {
+        return NULL;
+    }
+
+    size_t pow2 = 1;
+    while (pow2 < size) {
+        pow2 <<= 1;
+    }
+
+    queue->size = pow2;
+    queue->events = calloc(pow2, sizeof(*queue->events));
+    if (!queue->events) {
+        free(queue);
+        return NULL;
+    }
+
+    if (pipe(queue->pipe_fd) == -1) {
+        free(queue->events);
+        free(queue);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+        int flags = fcntl(queue->pipe_fd[i], F_GETFL);
+        fcntl(queue->pipe_fd[i], F_SETFL, flags | O_NONBLOCK);
+    }
+
+    return queue;
+}
+
+void
+handoff_destroy(udp_handoff_t *queue)
+{
+    if (!queue) {
+        return;
+    }
+
+    close(queue->pipe_fd[0]);
+    close(queue->pipe_fd[1]);
+    free(queue->events);
+    free(queue);
+}
+
+int
+handoff_fd(const udp_handoff_t *queue)
+{
+    return queue->pipe_fd[0];
+}
+
+bool
+handoff_push(udp_handoff_t *queue, const struct handoff_event *event, const bool *stop)
+{
+    const size_t tail = queue->tail;
+
+    while (tail - queue->head_cache >= queue->size) {
+        queue->head_cache = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        if (tail - queue->head_cache < queue->size) {
+            break;
+        }
+
+        // The queue is full -> make sure that the consumer is awake and wait for it
+        if (__atomic_load_n(stop, __ATOMIC_RELAXED)) {
+            return false;
+        }
+
+        handoff_notify(queue);
+        const struct timespec delay = {0, HANDOFF_FULL_DELAY};
+        nanosleep(&delay, NULL);
+    }
+
+    queue->events[tail & (queue->size - 1)] = *event;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_SEQ_CST);
+    return true;
+}
+
+void
+handoff_notify(udp_handoff_t *queue)
+{
+    if (__atomic_load_n(&queue->head, __ATOMIC_SEQ_CST) == queue->tail) {
+        // Nothing to consume
+        return;
+    }
+
+    if (__atomic_exchange_n(&queue->notified, true, __ATOMIC_SEQ_CST)) {
+        // Already notified
+        return;
+    }
+
+    const char byte = 0;
+    ssize_t ret;
+    do {
+        ret = write(queue->pipe_fd[1], &byte, sizeof(byte));
+    } while (ret == -1 && errno == EINTR);
+    // Failure (i.e. a full pipe) means that the consumer has already been woken up
+}
+
+size_t
+handoff_pop(udp_handoff_t *queue, struct handoff_event *events, size_t max)
+{
+    // Clear the notification first, so new events cannot be missed
+    char buffer[64];
+    while (read(queue->pipe_fd[0], buffer, sizeof(buffer)) > 0);
+    __atomic_store_n(&queue->notified, false, __ATOMIC_SEQ_CST);
+
+    const size_t head = queue->head;
+    const size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_SEQ_CST);
+    size_t cnt = tail - head;
+    if (cnt > max) {
+        cnt = max;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        events[i] = queue->events[(head + i) & (queue->size - 1)];
+    }
+
+    __atomic_store_n(&queue->head, head + cnt, __ATOMIC_RELEASE);
+    return cnt;
+}
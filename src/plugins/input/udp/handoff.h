@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @brief Queue of received datagrams passed between threads (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef UDP_HANDOFF_H
+#define UDP_HANDOFF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/** Internal type of the queue */
+typedef struct udp_handoff udp_handoff_t;
+
+/** Type of an event */
+enum handoff_type {
+    /** A new IPFIX/NetFlow message                                       */
+    HANDOFF_MSG,
+    /** A new Transport Session has been opened                           */
+    HANDOFF_SESSION_OPEN,
+    /** A Transport Session has been closed                               */
+    HANDOFF_SESSION_CLOSE
+};
+
+/** Event passed through the queue */
+struct handoff_event {
+    /** Type of the event                                                 */
+    enum handoff_type type;
+    /** Transport Session                                                 */
+    struct ipx_session *session;
+    /** Observation Domain ID of the message (only #HANDOFF_MSG)          */
+    uint32_t odid;
+    /** Size of the message (only #HANDOFF_MSG)                           */
+    uint16_t size;
+    /** Message (only #HANDOFF_MSG)                                       */
+    uint8_t *data;
+};
+
+/**
+ * @brief Create a new queue
+ *
+ * The queue has exactly one producer (a receiving thread) and one consumer (the thread of the
+ * plugin instance). The consumer is woken up by a notification file descriptor.
+ * @param[in] size Capacity of the queue (rounded up to a power of two)
+ * @return Pointer or NULL (memory allocation error or failed to create a pipe)
+ */
+udp_handoff_t *
+handoff_create(size_t size);
+
+/**
+ * @brief Destroy a queue
+ * @note Events still in the queue are lost.
+ * @param[in] queue Queue
+ */
+void
+handoff_destroy(udp_handoff_t *queue);
+
+/**
+ * @brief Get a notification file descriptor
+ *
+ * The descriptor is readable if there might be new events in the queue. It is supposed to be
+ * added to the epoll of the consumer.
+ * @param[in] queue Queue
+ * @return File descriptor
+ */
+int
+handoff_fd(const udp_handoff_t *queue);
+
+/**
+ * @brief Add an event into the queue (producer only)
+ *
+ * If the queue is full, the function waits until the consumer makes free space or until
+ * the \p stop flag is set.
+ * @param[in] queue Queue
+ * @param[in] event Event
+ * @param[in] stop  Flag to stop waiting
+ * @return True on success. False if the \p stop flag has been set before the event could be
+ *   added.
+ */
+bool
+handoff_push(udp_handoff_t *queue, const struct handoff_event *event, const bool *stop);
+
+/**
+ * @brief Wake up the consumer if new events have been added (producer only)
+ *
+ * Should be called after a batch of events has been added.
+ * @param[in] queue Queue
+ */
+void
+handoff_notify(udp_handoff_t *queue);
+
+/**
+ * @brief Get events from the queue (consumer only)
+ *
+ * The notification descriptor is cleared first, therefore, all events added after the function
+ * returns an empty result are always signaled again.
+ * @param[in]  queue  Queue
+ * @param[out] events Array of events to fill
+ * @param[in]  max    Size of the array
+ * @return Number of events filled
+ */
+size_t
+handoff_pop(udp_handoff_t *queue, struct handoff_event *events, size_t max);
+
+#endif // UDP_HANDOFF_H
@@ -0,0 +1,209 @@
+/**
+ * @file
+ * @brief Slab of reusable datagram buffers
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "slab.h"
+
+/** Special value of the return stack of a closed slab                          */
+#define SLAB_CLOSED ((struct slab_buf *) (uintptr_t) 1)
+
+/** Header of a buffer (the buffer itself immediately follows)                  */
+struct slab_buf {
+    union {
+        struct {
+            /** Slab that owns the buffer (NULL for one-off buffers)             */
+            struct udp_slab *owner;
+            /** Next buffer in a list of unused buffers                          */
+            struct slab_buf *next;
+        };
+        /** Keep the buffer suitably aligned for any type                        */
+        max_align_t align;
+    };
+};
+
+/** Slab of buffers */
+struct udp_slab {
+    /** Size of each buffer                                                      */
+    size_t buf_size;
+    /** Maximum number of unused buffers in the list                             */
+    size_t keep_max;
+
+    /** List of unused buffers (accessed only by the producer)                   */
+    struct slab_buf *head;
+    /** Number of buffers in the list                                            */
+    size_t cnt;
+
+    /**
+     * Lock-free stack of buffers returned by other threads
+     * \note The producer always takes all of them at once. The stack is set to #SLAB_CLOSED
+     *   after the slab has been closed.
+     */
+    struct slab_buf *returned;
+    /** Number of references (the producer + all buffers allocated by the slab) */
+    unsigned int refs;
+};
+
+udp_slab_t *
+slab_create(size_t buf_size, size_t keep_max)
+{
+    struct udp_slab *slab = calloc(1, sizeof(*slab));
+    if (!slab) {
+        return NULL;
+    }
+
+    slab->buf_size = buf_size;
+    slab->keep_max = keep_max;
+    slab->refs = 1;
+    return slab;
+}
+
+/**
+ * @brief Release a reference to the slab and free it if it was the last one
+ * @param[in] slab Slab
+ */
+static void
+slab_unref(struct udp_slab *slab)
+{
+    if (__atomic_sub_fetch(&slab->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(slab);
+    }
+}
+
+/**
+ * @brief Free a buffer allocated by the slab
+ * @param[in] buf Buffer header
+ */
+static void
+slab_buf_free(struct slab_buf *buf)
+{
+    struct udp_slab *slab = buf->owner;
+    free(buf);
+    slab_unref(slab);
+}
+
+/**
+ * @brief Move buffers returned by other threads into the list of unused buffers
+ * @param[in] slab Slab
+ */
+static void
+slab_collect(struct udp_slab *slab)
+{
+    // Avoid modification of the shared cache line if nothing has been returned
+    if (__atomic_load_n(&slab->returned, __ATOMIC_RELAXED) == NULL) {
+        return;
+    }
+
+    struct slab_buf *buf = __atomic_exchange_n(&slab->returned, NULL, __ATOMIC_ACQUIRE);
+    assert(buf != SLAB_CLOSED);
+
+    while (buf != NULL) {
+        struct slab_buf *next = buf->next;
+        if (slab->cnt < slab->keep_max) {
+            buf->next = slab->head;
+            slab->head = buf;
+            slab->cnt++;
+        } else {
+            slab_buf_free(buf);
+        }
+        buf = next;
+    }
+}
+
+void
+slab_destroy(udp_slab_t *slab)
+{
+    if (!slab) {
+        return;
+    }
+
+    // From now, returned buffers are immediately freed
+    struct slab_buf *buf = __atomic_exchange_n(&slab->returned, SLAB_CLOSED, __ATOMIC_ACQ_REL);
+    while (buf != NULL) {
+        struct slab_buf *next = buf->next;
+        slab_buf_free(buf);
+        buf = next;
+    }
+
+    buf = slab->head;
+    while (buf != NULL) {
+        struct slab_buf *next = buf->next;
+        slab_buf_free(buf);
+        buf = next;
+    }
+    slab->head = NULL;
+    slab->cnt = 0;
+
+    // Release the reference of the producer
+    slab_unref(slab);
+}
+
+uint8_t *
+slab_get(udp_slab_t *slab)
+{
+    if (!slab->head) {
+        slab_collect(slab);
+    }
+
+    struct slab_buf *buf = slab->head;
+    if (buf != NULL) {
+        slab->head = buf->next;
+        slab->cnt--;
+        return (uint8_t *) (buf + 1);
+    }
+
+    buf = malloc(sizeof(*buf) + slab->buf_size);
+    if (!buf) {
+        return NULL;
+    }
+
+    __atomic_add_fetch(&slab->refs, 1, __ATOMIC_RELAXED);
+    buf->owner = slab;
+    buf->next = NULL;
+    return (uint8_t *) (buf + 1);
+}
+
+uint8_t *
+slab_get_once(size_t size)
+{
+    struct slab_buf *buf = malloc(sizeof(*buf) + size);
+    if (!buf) {
+        return NULL;
+    }
+
+    buf->owner = NULL;
+    buf->next = NULL;
+    return (uint8_t *) (buf + 1);
+}
+
+void
+slab_put(void *arg, uint8_t *data)
+{
+    (void) arg;
+    struct slab_buf *buf = ((struct slab_buf *) data) - 1;
+    struct udp_slab *slab = buf->owner;
+    if (!slab) {
+        // One-off buffer
+        free(buf);
+        return;
+    }
+
+    struct slab_buf *head = __atomic_load_n(&slab->returned, __ATOMIC_RELAXED);
+    do {
+        if (head == SLAB_CLOSED) {
+            // The producer doesn't exist anymore
+            slab_buf_free(buf);
+            return;
+        }
+        buf->next = head;
+    } while (!__atomic_compare_exchange_n(&slab->returned, &head, buf, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    // Since now the slab cannot be accessed (it might be already closed and freed)
+}
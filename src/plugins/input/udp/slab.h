@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Slab of reusable datagram buffers (header file)
+ *
+ * Copyright: (C) 2026 CESNET, z.s.p.o.
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef UDP_SLAB_H
+#define UDP_SLAB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Internal type of the slab */
+typedef struct udp_slab udp_slab_t;
+
+/**
+ * @brief Create a new slab of buffers
+ *
+ * The slab belongs to a single producer (i.e. the thread of the plugin instance) that is the
+ * only one allowed to take buffers out of the slab. However, buffers can be returned by any
+ * thread (see slab_put()).
+ * @param[in] buf_size Size of each buffer
+ * @param[in] keep_max Maximum number of unused buffers kept in the slab
+ * @return Pointer or NULL (memory allocation error)
+ */
+udp_slab_t *
+slab_create(size_t buf_size, size_t keep_max);
+
+/**
+ * @brief Close the slab
+ *
+ * Unused buffers are freed immediately. Buffers still in use (e.g. datagrams processed by other
+ * plugins) are freed as soon as they are returned. The slab itself is freed after the last
+ * buffer has been returned.
+ * @param[in] slab Slab
+ */
+void
+slab_destroy(udp_slab_t *slab);
+
+/**
+ * @brief Get a buffer from the slab
+ * @warning Only the producer of the slab is allowed to call this function.
+ * @param[in] slab Slab
+ * @return Pointer to the buffer (of the size given to slab_create()) or NULL (memory allocation
+ *   error)
+ */
+uint8_t *
+slab_get(udp_slab_t *slab);
+
+/**
+ * @brief Get a one-off buffer of any size
+ *
+ * The buffer is not kept in the slab for reuse, it is freed as soon as it is returned by
+ * slab_put(). It's intended for rare datagrams that don't fit into regular buffers of the slab.
+ * @param[in] size Size of the buffer
+ * @return Pointer to the buffer or NULL (memory allocation error)
+ */
+uint8_t *
+slab_get_once(size_t size);
+
+/**
+ * @brief Return a buffer into its slab
+ *
+ * The function is thread-safe and its prototype matches #ipx_msg_ipfix_free_cb, so it can be
+ * used directly as a callback of ipx_msg_ipfix_create_ext().
+ * @param[in] arg  Ignored (the slab is determined from the buffer)
+ * @param[in] data Buffer obtained by slab_get() or slab_get_once()
+ */
+void
+slab_put(void *arg, uint8_t *data);
+
+#endif // UDP_SLAB_H
@@ -39,6 +39,7 @@
  *
  */
 
+#define _GNU_SOURCE // recvmmsg()
 #include <ipfixcol2.h>
 
 #include <sys/types.h>
@@ -52,8 +53,11 @@
 #include <pthread.h>
 #include <errno.h>
 #include <inttypes.h>
-#include <sys/ioctl.h>
+#include <string.h>
+#include <time.h>
 #include "config.h"
+#include "handoff.h"
+#include "slab.h"
 
 /** Identification of an invalid socket descriptor                                               */
 #define INVALID_FD        (-1)
@@ -65,6 +69,27 @@
 #define TIMER_INTERVAL    (2)
 /** Required minimal size of receive buffer size [bytes] (otherwise produces a warning message)  */
 #define UDP_RMEM_REQ      (1024*1024)
+/** Maximum number of unused datagram buffers kept for reuse                                    */
+#define RECV_SLAB_KEEP    (1024)
+/** Size of control data of a received datagram [bytes] (i.e. counter of dropped datagrams)     */
+#define RECV_CTRL_SIZE    (CMSG_SPACE(sizeof(uint32_t)))
+/** Maximum size of a received datagram [bytes] (the rest of the buffer goes to the spill area)  */
+#define RECV_DGRAM_MAX    (UINT16_MAX)
+/** Number of I/O vectors of a slot (a buffer from the slab and a part of the spill area)        */
+#define RECV_IOV_CNT      (2)
+/** Default size of the index of active Transport Sessions (MUST be a power of two)            */
+#define ACTIVE_INDEX_DEF  (64)
+/** Number of tokens of a token bucket consumed by a single message                             */
+#define TOKEN_UNIT        (1000000ULL)
+/** Capacity of a queue of events from a receiving thread to the instance thread                */
+#define HANDOFF_SIZE      (4096)
+
+/** Socket option to distribute datagrams among sockets bound to the same address and port      */
+#if defined(SO_REUSEPORT_LB)
+#define UDP_REUSEPORT     SO_REUSEPORT_LB
+#elif defined(SO_REUSEPORT)
+#define UDP_REUSEPORT     SO_REUSEPORT
+#endif
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -74,8 +99,8 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "udp",
     // Brief description of plugin
     .dsc = "Input plugins for IPFIX/NetFlow v5/v9 over User Datagram Protocol.",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (instances of pipeline shards share listening sockets)
+    .flags = IPX_PF_SHARDABLE,
     // Plugin version string (like "1.2.3")
     .version = "2.1.0",
     // Minimal IPFIXcol version string (like "1.2.3")
@@ -149,15 +174,42 @@ struct udp_source {
     /** Description of  the Transport Session                                                    */
     struct ipx_session *session;
 
-    /** Timestamp of check when the source was last seen                                         */
+    /** Monotonic timestamp when the source was last seen (precision of the timer)                */
     time_t last_seen;
-    /** Number of received messages since last check                                             */
-    uint32_t msg_cnt;
     /** No message has been received from the Session yet                                        */
     bool new_connection;
+
+    /** Hash of the local socket and the remote address                                          */
+    uint64_t hash;
+    /** Position in the array of active sources                                                  */
+    size_t pos;
+    /** Next source in the same slot of the timing wheel                                         */
+    struct udp_source *wheel_next;
+
+    struct {
+        /** Available tokens (#TOKEN_UNIT per message)                                           */
+        uint64_t tokens;
+        /** Monotonic time of the last refill [microseconds]                                     */
+        uint64_t ts;
+    } bucket; /**< Token bucket of the rate limit                                                */
+
+    /** Number of messages received since the last timer event                                   */
+    uint32_t load_cnt;
+    /** Average number of messages received per timer interval                                   */
+    uint32_t load;
+    /** The source is among the heaviest exporters (i.e. shed if the pipeline is overloaded)     */
+    bool heavy;
 };
 
-/** Instance data                                                                                */
+struct udp_worker;
+
+/**
+ * \brief Instance data
+ *
+ * The same structure also describes each additional receiving thread. Such thread has its own
+ * sockets, datagram buffers and table of Transport Sessions, but it cannot pass messages
+ * directly. Instead, it hands them over to the thread of the instance via a queue.
+ */
 struct udp_data {
     /** Parsed configuration parameters                                                          */
     struct udp_config *config;
@@ -183,7 +235,93 @@ struct udp_data {
         size_t cnt;
         /** Array of active sources (identification and corresponding Transport Session)         */
         struct udp_source **sources;
+
+        /** Size of the index (power of two)                                                     */
+        size_t index_size;
+        /**
+         * Index of active sources by their hash (open addressing with linear probing, unused
+         * items are NULL)
+         */
+        struct udp_source **index;
+        /** The most recently found source (can be NULL)                                         */
+        struct udp_source *last;
     } active; /**< Active connections                                                            */
+
+    struct {
+        /** Number of slots (each covers #TIMER_INTERVAL seconds)                                */
+        size_t cnt;
+        /** Slots (lists of sources that might expire at the corresponding time)                 */
+        struct udp_source **slots;
+        /** The last processed tick (i.e. monotonic time divided by #TIMER_INTERVAL)             */
+        uint64_t tick;
+        /** Monotonic time of the last timer event                                               */
+        time_t now;
+    } wheel; /**< Timing wheel of inactivity timeouts of active sources                          */
+
+    struct {
+        /** Monotonic time of the currently processed batch of datagrams [microseconds]           */
+        uint64_t now;
+        /** The pipeline is overloaded, i.e. messages of the heaviest exporters are shed         */
+        bool overloaded;
+
+        /** Total number of messages dropped due to rate limits                                  */
+        uint64_t rate_limit;
+        /** Total number of messages shed due to overload                                        */
+        uint64_t overload;
+        /** Total number of dropped messages (of both types) already logged                      */
+        uint64_t logged;
+    } admission; /**< Admission control of messages                                              */
+
+    struct {
+        /** Slab of reusable datagram buffers                                                    */
+        udp_slab_t *slab;
+        /** Number of slots (i.e. maximum number of datagrams received at once)                  */
+        size_t cnt;
+        /** Message headers of the slots                                                         */
+        struct mmsghdr *hdrs;
+        /**
+         * I/O vectors of the slots (#RECV_IOV_CNT per slot), i.e. a buffer from the slab (a base
+         * is NULL if the buffer has been passed on) and a part of the spill area
+         */
+        struct iovec *iovs;
+        /** Spill area of datagrams bigger than buffers of the slab (shared by all batches)      */
+        uint8_t *spill;
+        /** Size of the spill area per slot (0 = buffers of the slab have the maximum size)      */
+        size_t spill_size;
+        /** Source addresses of the slots                                                        */
+        struct sockaddr_storage *addrs;
+        /** Control data of the slots (#RECV_CTRL_SIZE bytes per slot)                           */
+        uint8_t *ctrls;
+
+        /** Last reported numbers of dropped datagrams (one per listening socket)                */
+        uint32_t *drops;
+        /** Total number of dropped datagrams already logged                                     */
+        uint64_t drops_logged;
+        /** Counter of dropped datagrams (shared with additional receiving threads, can be NULL) */
+        ipx_metric_t *drops_metric;
+    } recv; /**< Batched reception of datagrams                                                  */
+
+    struct {
+        /** Size of the array                                                                    */
+        size_t cnt;
+        /** Array of additional receiving threads                                                */
+        struct udp_worker *items;
+    } workers; /**< Additional receiving threads (only in the instance thread)                   */
+
+    /** Queue of events to the instance thread (NULL in the instance thread itself)              */
+    udp_handoff_t *handoff;
+    /** Stop flag of an additional receiving thread                                              */
+    bool stop;
+};
+
+/** Additional receiving thread                                                                  */
+struct udp_worker {
+    /** Thread identification                                                                    */
+    pthread_t thread;
+    /** The thread is running                                                                    */
+    bool running;
+    /** Receiving data of the thread                                                             */
+    struct udp_data *data;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -197,11 +335,13 @@ struct udp_data {
  * \param[in] addrlen  Size of the address
  * \param[in] ipv6only Accept only IPv6 addresses (only for AF_INET6 and the wildcard address)
  * \param[in] rbuffer  Change the receive buffer size (ignored, if zero or negative)
+ * \param[in] group    Allow binding of other sockets to the same address and port (i.e. socket
+ *   group of multiple receiving threads and/or instances of pipeline shards)
  * \return On failure returns #INVALID_FD. Otherwise returns valid socket descriptor.
  */
 static int
 address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, bool ipv6only,
-    int rbuffer)
+    int rbuffer, bool group)
 {
     sa_family_t family = addr->sa_family;
     assert(family == AF_INET || family == AF_INET6);
@@ -223,6 +363,28 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
             "the port can be used again. (error: %s)", err_str);
     }
 
+#ifdef UDP_REUSEPORT
+    // Distribute datagrams among sockets of all receiving threads
+    if (group && setsockopt(sd, SOL_SOCKET, UDP_REUSEPORT, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Cannot turn on socket option SO_REUSEPORT required by multiple "
+            "receiving threads or pipeline shards: %s", err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+#else
+    assert(!group);
+#endif
+
+#ifdef SO_RXQ_OVFL
+    // Get the number of datagrams dropped due to a full receive buffer with each datagram
+    if (setsockopt(sd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Cannot turn on socket option SO_RXQ_OVFL. Number of dropped "
+            "datagrams will not be reported. (error: %s)", err_str);
+    }
+#endif
+
     // Make sure that IPv6 only is disabled
     if (family == AF_INET6) {
         if (!ipv6only && setsockopt(sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == -1) {
@@ -307,6 +469,8 @@ listener_bind(struct udp_data *instance)
     // Create a poll and new array of binded sockets
     const char *err_str;
     const size_t socket_cnt = instance->config->local_addrs.cnt;
+    // Sockets are shared by receiving threads and by copies of the instance in other shards
+    const bool group = instance->config->threads > 1 || ipx_ctx_shards_get(instance->ctx) > 1;
     int *sockets = malloc(sizeof(*sockets) * ((socket_cnt == 0) ? 1 : socket_cnt));
     if (!sockets) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
@@ -322,7 +486,7 @@ listener_bind(struct udp_data *instance)
         addr.sin6_addr = in6addr_any;
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr, sizeof(addr), false,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, group);
         if (sd == INVALID_FD) {
             free(sockets);
             return IPX_ERR_DENIED;
@@ -375,7 +539,7 @@ listener_bind(struct udp_data *instance)
         }
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr_helper, addrlen, ipv6only,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, group);
         if (sd == INVALID_FD) {
             // Failed
             break;
@@ -431,6 +595,9 @@ listener_unbind(struct udp_data *instance)
     instance->listen.cnt = 0;
 }
 
+static int
+listener_open(struct udp_data *instance);
+
 /**
  * \brief Initialize local IP addresses to listen on
  *
@@ -495,6 +662,22 @@ listener_init(struct udp_data *instance)
             "more details!", sock_rmax);
     }
 
+    return listener_open(instance);
+}
+
+/**
+ * \brief Bind local IP addresses and arm a timer
+ *
+ * \note The maximum size of the socket receive buffer MUST be already determined.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (typically failed to bind to a port)
+ */
+static int
+listener_open(struct udp_data *instance)
+{
+    const char *err_str;
+
     // Create epoll and bind all sockets
     instance->listen.epoll_fd = epoll_create(1);
     if (instance->listen.epoll_fd == INVALID_FD) {
@@ -570,6 +753,328 @@ listener_destroy(struct udp_data *instance)
     close(instance->listen.timer_fd);
 }
 
+/**
+ * \brief Process an event (i.e. generate and pass corresponding messages)
+ *
+ * \warning Only the thread of the instance is allowed to call this function.
+ * \param[in] ctx   Instance context
+ * \param[in] event Event to process
+ * \return True on success.
+ * \return False if the event has not been passed (the caller is responsible for its content).
+ */
+static bool
+event_process(ipx_ctx_t *ctx, const struct handoff_event *event)
+{
+    struct ipx_session *session = event->session;
+
+    switch (event->type) {
+    case HANDOFF_SESSION_OPEN: {
+        // Send information about the new Transport Session
+        ipx_msg_session_t *msg = ipx_msg_session_create(session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_WARNING(ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
+                session->ident, __FILE__, __LINE__);
+        } else {
+            ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg));
+        }
+        return true;
+    }
+    case HANDOFF_SESSION_CLOSE: {
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(ctx, "Failed to create a Session message! (%s:%d)",
+                __FILE__, __LINE__);
+            return false;
+        }
+
+        // Pass the message and put the Session into the garbage
+        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg_sess));
+
+        ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+        ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(session, cb);
+        if (!msg_garbage) {
+            IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        } else {
+            ipx_ctx_msg_pass(ctx, ipx_msg_garbage2base(msg_garbage));
+        }
+        return true;
+    }
+    case HANDOFF_MSG: {
+        // Create a message wrapper and pass the message
+        struct ipx_msg_ctx msg_ctx;
+        msg_ctx.session = session;
+        msg_ctx.odid = event->odid;
+        msg_ctx.stream = 0; // Streams are not supported over UDP
+
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create_ext(ctx, &msg_ctx, event->data, event->size,
+            &slab_put, NULL);
+        if (!msg) {
+            IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return false;
+        }
+
+        ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
+        return true;
+    }
+    default:
+        assert(false);
+        return false;
+    }
+}
+
+/**
+ * \brief Output an event
+ *
+ * The event is processed immediately by the thread of the instance. Additional receiving
+ * threads hand the event over to the thread of the instance.
+ * \param[in] instance Instance data
+ * \param[in] event    Event
+ * \return True on success.
+ * \return False if the event has not been passed (the caller is responsible for its content).
+ */
+static bool
+event_output(struct udp_data *instance, const struct handoff_event *event)
+{
+    if (instance->handoff != NULL) {
+        return handoff_push(instance->handoff, event, &instance->stop);
+    }
+
+    return event_process(instance->ctx, event);
+}
+
+/**
+ * \brief Get the current monotonic time
+ * \return Number of seconds
+ */
+static time_t
+clock_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+/**
+ * \brief Get the current monotonic time with precision of microseconds
+ * \return Number of microseconds
+ */
+static uint64_t
+clock_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec) * 1000000ULL + ((uint64_t) ts.tv_nsec) / 1000U;
+}
+
+/**
+ * \brief Mix bits of a hash (finalizer of MurmurHash3)
+ * \param[in] hash Hash value
+ * \return Mixed value
+ */
+static inline uint64_t
+active_mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * \brief Calculate a hash of a local socket and a remote address
+ * \param[in] src_fd Socket descriptor of local address
+ * \param[in] addr   Remote IPv4/IPv6 address and port
+ * \return Hash value
+ */
+static uint64_t
+active_hash(int src_fd, const struct sockaddr *addr)
+{
+    uint64_t hash = ((uint64_t) (unsigned int) src_fd) << 32;
+
+    if (addr->sa_family == AF_INET) {
+        const struct sockaddr_in *addr_v4 = (const struct sockaddr_in *) addr;
+        hash |= ((uint64_t) addr_v4->sin_port) << 16;
+        hash = active_mix(hash ^ AF_INET);
+        return active_mix(hash ^ addr_v4->sin_addr.s_addr);
+    }
+
+    assert(addr->sa_family == AF_INET6);
+    const struct sockaddr_in6 *addr_v6 = (const struct sockaddr_in6 *) addr;
+    uint64_t parts[2];
+    memcpy(parts, &addr_v6->sin6_addr, sizeof(parts));
+    hash |= ((uint64_t) addr_v6->sin6_port) << 16;
+    hash = active_mix(hash ^ AF_INET6);
+    hash = active_mix(hash ^ parts[0]);
+    return active_mix(hash ^ parts[1]);
+}
+
+/**
+ * \brief Check if a record of a Transport Session belongs to a local socket and a remote address
+ * \param[in] src    Record of the Transport Session
+ * \param[in] src_fd Socket descriptor of local address
+ * \param[in] addr   Remote IPv4/IPv6 address and port
+ * \return True or false
+ */
+static bool
+active_match(const struct udp_source *src, int src_fd, const struct sockaddr *addr)
+{
+    if (src->local_fd != src_fd) {
+        return false; // Different local socket
+    }
+
+    if (src->src_addr.ss_family != addr->sa_family) {
+        return false; // Different IP address family (IPv4 vs IPv6)
+    }
+
+    if (addr->sa_family == AF_INET) {
+        // IPv4 addresses
+        const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
+        const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
+        return to_find->sin_port == to_cmp->sin_port
+            && memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) == 0;
+    }
+
+    // IPv6 addresses
+    assert(addr->sa_family == AF_INET6);
+    const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
+    const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
+    return to_find->sin6_port == to_cmp->sin6_port
+        && memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) == 0;
+}
+
+/**
+ * \brief Insert a record into the index of active Transport Sessions
+ *
+ * The index is enlarged, if necessary, to keep its load factor at most 50%.
+ * \param[in] instance Instance data
+ * \param[in] src      Record to insert (with calculated hash)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+active_index_add(struct udp_data *instance, struct udp_source *src)
+{
+    if (2 * (instance->active.cnt + 1) > instance->active.index_size) {
+        const size_t size_new = (instance->active.index_size == 0)
+            ? ACTIVE_INDEX_DEF : 2 * instance->active.index_size;
+        struct udp_source **index_new = calloc(size_new, sizeof(*index_new));
+        if (!index_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        // Rehash all records
+        for (size_t i = 0; i < instance->active.index_size; ++i) {
+            struct udp_source *item = instance->active.index[i];
+            if (!item) {
+                continue;
+            }
+
+            size_t pos = item->hash & (size_new - 1);
+            while (index_new[pos] != NULL) {
+                pos = (pos + 1) & (size_new - 1);
+            }
+            index_new[pos] = item;
+        }
+
+        free(instance->active.index);
+        instance->active.index = index_new;
+        instance->active.index_size = size_new;
+    }
+
+    const size_t mask = instance->active.index_size - 1;
+    size_t pos = src->hash & mask;
+    while (instance->active.index[pos] != NULL) {
+        pos = (pos + 1) & mask;
+    }
+
+    instance->active.index[pos] = src;
+    return IPX_OK;
+}
+
+/**
+ * \brief Remove a record from the index of active Transport Sessions
+ *
+ * Following records of the same cluster are shifted back, so the index never contains
+ * deleted items.
+ * \param[in] instance Instance data
+ * \param[in] src      Record to remove
+ */
+static void
+active_index_del(struct udp_data *instance, const struct udp_source *src)
+{
+    const size_t mask = instance->active.index_size - 1;
+    size_t hole = src->hash & mask;
+    while (instance->active.index[hole] != src) {
+        assert(instance->active.index[hole] != NULL);
+        hole = (hole + 1) & mask;
+    }
+
+    size_t pos = hole;
+    while (true) {
+        pos = (pos + 1) & mask;
+        struct udp_source *item = instance->active.index[pos];
+        if (!item) {
+            break;
+        }
+
+        // Can the item be moved into the hole? (i.e. its home is not in the range (hole, pos])
+        const size_t home = item->hash & mask;
+        const bool in_range = (hole <= pos)
+            ? (home > hole && home <= pos)
+            : (home > hole || home <= pos);
+        if (in_range) {
+            continue;
+        }
+
+        instance->active.index[hole] = item;
+        hole = pos;
+    }
+
+    instance->active.index[hole] = NULL;
+}
+
+/**
+ * \brief Schedule an inactivity check of a record of a Transport Session
+ *
+ * The record is added to the slot of the timing wheel, which is processed right after
+ * the inactivity timeout of the record (based on its last occurrence) would expire.
+ * \param[in] instance Instance data
+ * \param[in] src      Record of the Transport Session
+ */
+static void
+active_wheel_add(struct udp_data *instance, struct udp_source *src)
+{
+    const uint64_t deadline = (uint64_t) (src->last_seen + instance->config->timeout_conn);
+    const size_t slot = (deadline / TIMER_INTERVAL + 1) % instance->wheel.cnt;
+    src->wheel_next = instance->wheel.slots[slot];
+    instance->wheel.slots[slot] = src;
+}
+
+/**
+ * \brief Initialize structures of active Transport Sessions
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+active_init(struct udp_data *instance)
+{
+    // The timeout of a new source never exceeds the range of the wheel
+    instance->wheel.cnt = instance->config->timeout_conn / TIMER_INTERVAL + 3;
+    instance->wheel.slots = calloc(instance->wheel.cnt, sizeof(*instance->wheel.slots));
+    if (!instance->wheel.slots) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    instance->wheel.now = clock_now();
+    instance->wheel.tick = (uint64_t) instance->wheel.now / TIMER_INTERVAL;
+    return IPX_OK;
+}
+
 /**
  * \brief Add a new record of a Transport Session
  *
@@ -659,9 +1164,12 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
     rec2add->local_fd = src_fd;
     memcpy(&rec2add->src_addr, src_addr, src_addrlen);
     rec2add->session = session;
-    rec2add->last_seen = time(NULL); // now!
-    rec2add->msg_cnt = 0;
+    rec2add->last_seen = clock_now(); // now!
     rec2add->new_connection = true; // Session Message hasn't been send yet
+    rec2add->hash = active_hash(src_fd, src_addr);
+    rec2add->pos = instance->active.cnt;
+    rec2add->bucket.tokens = ((uint64_t) cfg->rate_burst) * TOKEN_UNIT;
+    rec2add->bucket.ts = instance->admission.now;
 
     // Append the list of active connections
     const size_t new_size = (instance->active.cnt + 1) * sizeof(struct udp_source *);
@@ -673,10 +1181,19 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
         return NULL;
     }
 
+    instance->active.sources = new_sources;
+    if (active_index_add(instance, rec2add) != IPX_OK) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(rec2add);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
     IPX_CTX_INFO(instance->ctx, "New exporter connected from '%s'.", src_addr_str);
     new_sources[instance->active.cnt] = rec2add;
-    instance->active.sources = new_sources;
     instance->active.cnt++;
+    active_wheel_add(instance, rec2add);
+    instance->active.last = rec2add;
     return rec2add;
 }
 
@@ -685,8 +1202,7 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
  *
  * Generate and pass a Session Message - connect event (if necessary) and remove the corresponding
  * session (defined by an index) from the list.
- * \note After removing of the Session the array of active Transport Sessions is not order by
- *   activity anymore.
+ * \note The record is NOT removed from the timing wheel, i.e. the caller is responsible for it.
  * \param[in] instance Instance data
  * \param[in] idx      Index of the instance to remove
  */
@@ -694,7 +1210,19 @@ static void
 active_remove_by_id(struct udp_data *instance, size_t idx)
 {
     struct udp_source *src = instance->active.sources[idx];
-    IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
+    const uint64_t drops_limit = src->session->udp.drops.rate_limit;
+    const uint64_t drops_overload = src->session->udp.drops.overload;
+    if (drops_limit != 0 || drops_overload != 0) {
+        IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed! (dropped messages: %" PRIu64
+            " over the rate limit, %" PRIu64 " due to overload)", src->session->ident,
+            drops_limit, drops_overload);
+    } else {
+        IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
+    }
+    active_index_del(instance, src);
+    if (instance->active.last == src) {
+        instance->active.last = NULL;
+    }
 
     // Have we received at least one valid record?
     if (src->new_connection) {
@@ -702,26 +1230,14 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
         ipx_session_destroy(src->session);
     } else {
         // Generate a Session message (order of the messages MUST be preserved)
-        ipx_msg_session_t *msg_sess = ipx_msg_session_create(src->session, IPX_MSG_SESSION_CLOSE);
-        if (!msg_sess) {
-            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
-                "plugins will not be informed about the closed Transport Session '%s' (%s:%d)",
-                src->session->ident, __FILE__, __LINE__);
+        struct handoff_event event = {HANDOFF_SESSION_CLOSE, src->session, 0, 0, NULL};
+        if (!event_output(instance, &event)) {
             /* Do not pass and definitely do NOT free the session structure because it still can be
              * used by other plugins. Remove it only from the local table!
-             * NO RETURN HERE!
              */
-        } else {
-            // Pass the message and put the Session into the garbage
-            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg_sess));
-
-            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
-            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(src->session, cb);
-            if (!msg_garbage) {
-                IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-            } else {
-                ipx_ctx_msg_pass(instance->ctx, ipx_msg_garbage2base(msg_garbage));
-            }
+            IPX_CTX_WARNING(instance->ctx, "Instances of plugins will not be informed about "
+                "the closed Transport Session '%s' (%s:%d)", src->session->ident,
+                __FILE__, __LINE__);
         }
     }
 
@@ -733,6 +1249,7 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
     } else {
         // Replace it with the last one
         instance->active.sources[idx] = instance->active.sources[instance->active.cnt - 1];
+        instance->active.sources[idx]->pos = idx;
         instance->active.cnt--;
     }
 }
@@ -740,6 +1257,8 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
 /**
  * \brief Find a record of an active Transport Session
  *
+ * The most recently found record is checked first. Otherwise, the record is looked up in
+ * the index.
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor of local address on which the source data come
  * \param[in] addr     Remote IPv4/IPv6 Address to find
@@ -748,55 +1267,28 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
 static struct udp_source *
 active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
 {
-    size_t idx;
-
-    // The array is not sorted, we have to go through
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        struct udp_source *src = instance->active.sources[idx];
-        if (src->local_fd != src_fd) {
-            continue; // Different local socket
-        }
-
-        if (src->src_addr.ss_family != addr->sa_family) {
-            continue; // Different IP address family (IPv4 vs IPv6)
-        }
-
-        if (addr->sa_family == AF_INET) {
-            // IPv4 addresses
-            const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
-            const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
-            if (to_find->sin_port != to_cmp->sin_port) {
-                continue; // Different ports
-            }
-
-            if (memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        } else {
-            // IPv6 addresses
-            assert(addr->sa_family == AF_INET6);
-            const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
-            const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
-            if (to_find->sin6_port != to_cmp->sin6_port) {
-                continue; // Different ports
-            }
-
-            if (memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        }
+    // Bursts of messages usually come from the same exporter
+    struct udp_source *src = instance->active.last;
+    if (src != NULL && active_match(src, src_fd, addr)) {
+        return src;
     }
 
-    if (idx == instance->active.cnt) {
-        // Not found
+    if (instance->active.cnt == 0) {
         return NULL;
     }
 
-    return instance->active.sources[idx];
+    const uint64_t hash = active_hash(src_fd, addr);
+    const size_t mask = instance->active.index_size - 1;
+    for (size_t pos = hash & mask; (src = instance->active.index[pos]) != NULL;
+            pos = (pos + 1) & mask) {
+        if (src->hash == hash && active_match(src, src_fd, addr)) {
+            instance->active.last = src;
+            return src;
+        }
+    }
+
+    // Not found
+    return NULL;
 }
 
 /**
@@ -823,74 +1315,162 @@ active_get(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
 }
 
 /**
- * \brief Compare 2 active Transport Session by activity
+ * \brief Decide whether a message of a source should be accepted
  *
- * \note The sessions are primary sorted by number of messages received since the last reset of
- * counters. Secondary, if the both counters are zero, the sessions are sorted by the timestamp
- * of their last occurrence.
- * \param p1 First Transport Session
- * \param p2 Second Transport Session
- * \return
- *   The comparison function returns an integer less than, equal to, or greater than zero if the
- *   first Session is considered to be respectively more, equal to, or less active than the
- *   second.
+ * First, the message must fit into the rate limit of the exporter (token bucket). Second,
+ * if the pipeline is overloaded, messages of the heaviest exporters are shed. Counters of
+ * dropped messages of the Transport Session are updated.
+ * \param[in] instance Instance data
+ * \param[in] src      Source of the message
+ * \return True if the message should be processed. False if it should be dropped.
  */
-static int
-active_cmp_activity(const void *p1, const void *p2)
+static bool
+admission_check(struct udp_data *instance, struct udp_source *src)
 {
-    const struct udp_source *left =  *(const struct udp_source **) p1;
-    const struct udp_source *right = *(const struct udp_source **) p2;
+    const struct udp_config *cfg = instance->config;
+    struct ipx_session_udp *udp = &src->session->udp;
+    src->load_cnt++;
+
+    if (cfg->rate_limit != 0) {
+        // Refill the bucket
+        const uint64_t capacity = ((uint64_t) cfg->rate_burst) * TOKEN_UNIT;
+        const uint64_t elapsed = instance->admission.now - src->bucket.ts;
+        uint64_t tokens = src->bucket.tokens;
+        if (elapsed >= capacity / cfg->rate_limit) {
+            tokens = capacity;
+        } else {
+            tokens += elapsed * cfg->rate_limit; // Can't overflow (see the condition above)
+            tokens = (tokens > capacity) ? capacity : tokens;
+        }
+        src->bucket.ts = instance->admission.now;
 
-    // Primary, compare by number of messages since the last reset of counter
-    if (left->msg_cnt != right->msg_cnt) {
-        return (left->msg_cnt > right->msg_cnt) ? (-1) : 1; // Sort in descending order
-    }
+        if (tokens < TOKEN_UNIT) {
+            src->bucket.tokens = tokens;
+            __atomic_store_n(&udp->drops.rate_limit, udp->drops.rate_limit + 1, __ATOMIC_RELAXED);
+            instance->admission.rate_limit++;
+            return false;
+        }
 
-    if (left->msg_cnt != 0) {
-        // Both have the same non-zero value of counters,
-        return 0;
+        src->bucket.tokens = tokens - TOKEN_UNIT;
     }
 
-    assert(left->msg_cnt == 0 && right->msg_cnt == 0);
-    // Secondary, compare by the last seen timestamps
-    if (left->last_seen == right->last_seen) {
-        return 0;
+    if (instance->admission.overloaded && src->heavy) {
+        // Drop the newest message of the heaviest exporters first
+        __atomic_store_n(&udp->drops.overload, udp->drops.overload + 1, __ATOMIC_RELAXED);
+        instance->admission.overload++;
+        return false;
     }
 
-    return (left->last_seen > right->last_seen) ? (-1) : 1;
+    return true;
 }
 
 /**
- * \brief Sort all active Transport Session by activity and reset activity counters
+ * \brief Update load of all sources and determine the heaviest exporters
  *
- * The most active Transport Session go to the front. Activity is compared by number of received
- * IPFIX Messages since the last restart of counters.
+ * The function iterates over all active sources, therefore, it's called (on timer events)
+ * only if shedding is enabled.
  * \param[in] instance Instance data
  */
 static void
-active_sort_and_reset(struct udp_data *instance)
+admission_update(struct udp_data *instance)
 {
-    const size_t rec_size = sizeof(*instance->active.sources);
-    qsort(instance->active.sources, instance->active.cnt, rec_size, &active_cmp_activity);
+    const size_t top_max = instance->config->shed_top;
+    uint32_t top[CONFIG_SHED_TOP_MAX]; // Loads of the heaviest sources in descending order
+    size_t top_cnt = 0;
 
-    time_t now = time(NULL);
     for (size_t i = 0; i < instance->active.cnt; ++i) {
         struct udp_source *src = instance->active.sources[i];
-        if (src->msg_cnt == 0) {
-            // No new messages since the last check
-            continue;
+        // Exponential moving average of the number of messages per timer interval
+        src->load = (uint32_t) (((uint64_t) src->load + src->load_cnt) / 2);
+        src->load_cnt = 0;
+
+        size_t pos = top_cnt;
+        while (pos > 0 && top[pos - 1] < src->load) {
+            if (pos < top_max) {
+                top[pos] = top[pos - 1];
+            }
+            pos--;
         }
 
-        src->last_seen = now;
-        src->msg_cnt = 0;
+        if (pos < top_max) {
+            top[pos] = src->load;
+            if (top_cnt < top_max) {
+                top_cnt++;
+            }
+        }
+    }
+
+    const uint32_t threshold = (top_cnt > 0) ? top[top_cnt - 1] : 0;
+    for (size_t i = 0; i < instance->active.cnt; ++i) {
+        struct udp_source *src = instance->active.sources[i];
+        src->heavy = (src->load > 0 && src->load >= threshold);
+    }
+}
+
+/**
+ * \brief Report messages dropped by admission control since the last report
+ * \param[in] instance Instance data
+ */
+static void
+admission_report(struct udp_data *instance)
+{
+    const uint64_t total = instance->admission.rate_limit + instance->admission.overload;
+    if (total == instance->admission.logged) {
+        return;
+    }
+
+    IPX_CTX_WARNING(instance->ctx, "%" PRIu64 " message(s) have been dropped by admission "
+        "control (total: %" PRIu64 " over rate limits of exporters, %" PRIu64 " shed due to "
+        "overload of the pipeline).", total - instance->admission.logged,
+        instance->admission.rate_limit, instance->admission.overload);
+    instance->admission.logged = total;
+}
+
+/**
+ * \brief Close inactive Transport Sessions
+ *
+ * Only slots of the timing wheel that have expired since the last call are processed. Sources
+ * seen since they have been scheduled are just rescheduled.
+ * \param[in] instance Instance data
+ */
+static void
+active_expire(struct udp_data *instance)
+{
+    const time_t now = clock_now();
+    const uint64_t tick_now = (uint64_t) now / TIMER_INTERVAL;
+    instance->wheel.now = now;
+
+    uint64_t tick = instance->wheel.tick;
+    if (tick_now - tick > instance->wheel.cnt) {
+        // Process each slot at most once
+        tick = tick_now - instance->wheel.cnt;
+    }
+
+    while (tick < tick_now) {
+        tick++;
+        const size_t slot = tick % instance->wheel.cnt;
+        struct udp_source *src = instance->wheel.slots[slot];
+        instance->wheel.slots[slot] = NULL;
+
+        while (src != NULL) {
+            struct udp_source *next = src->wheel_next;
+            if (src->last_seen + instance->config->timeout_conn < now) {
+                // Remove and generate Session message - close event, if necessary
+                active_remove_by_id(instance, src->pos);
+            } else {
+                active_wheel_add(instance, src);
+            }
+            src = next;
+        }
     }
+
+    instance->wheel.tick = tick_now;
 }
 
 /**
  * \brief Process a timer event
  *
- * Sort all sources by their activity (number of messages sent between timer events) and
- * close inactive Transport Sessions.
+ * Close inactive Transport Sessions and report datagrams dropped by the kernel.
  * \param[in] instance Instance data
  * \param[in] fd       File descriptor of a timer
  */
@@ -909,109 +1489,161 @@ process_timer(struct udp_data *instance, int fd)
         return;
     }
 
-    // The inactive Transport Sessions will be at the end of the (sorted) array
-    active_sort_and_reset(instance);
+    active_expire(instance);
+    if (instance->config->shed_threshold != 0) {
+        admission_update(instance);
+    }
+    admission_report(instance);
 
-    time_t now = time(NULL);
-    size_t idx;
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        if (instance->active.sources[idx]->last_seen + instance->config->timeout_conn >= now) {
-            continue;
-        }
+    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
+        instance->active.cnt);
 
-        // Close this Session and all that follows
-        break;
+    // Report datagrams dropped by the kernel
+    uint64_t drops_total = 0;
+    for (size_t idx = 0; idx < instance->listen.cnt; ++idx) {
+        drops_total += instance->recv.drops[idx];
     }
 
-    while (idx < instance->active.cnt) {
-        // Remove and generate Session message - close event, if necessary
-        assert(instance->active.sources[idx]->last_seen + instance->config->timeout_conn < now);
-        active_remove_by_id(instance, idx);
+    if (drops_total > instance->recv.drops_logged) {
+        IPX_CTX_WARNING(instance->ctx, "%" PRIu64 " datagram(s) have been dropped due to a full "
+            "socket receive buffer (total: %" PRIu64 "). Consider increasing of the maximum socket "
+            "receive buffer size.", drops_total - instance->recv.drops_logged, drops_total);
+        instance->recv.drops_logged = drops_total;
     }
-
-    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
-        instance->active.cnt);
 }
 
 /**
- * \brief Get an IPFIX/NetFlow message from a socket and pass it
- * \param[in] instance Instance data
- * \param[in] sd       File descriptor of the socket
+ * \brief Initialize batched reception of datagrams
+ * \param[in] instance Instance data (with already initialized listener)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
-static void
-process_socket(struct udp_data *instance, int sd)
+static int
+recv_init(struct udp_data *instance)
 {
-    const char *err_str;
-    ssize_t ret;
-
-    // Get size of the message
-    int msg_size;
-#if defined(__FreeBSD__) || defined(__OpenBSD__)
-    // ioctl(FIONREAD) on Linux returns the size of the next datagram available to read,
-    // ioctl(FIONREAD) on *BSD returns the _total_ size of _all_ datagrams available to read
-    ret = recv(sd, NULL, 0, MSG_PEEK | MSG_TRUNC);
-    if (ret == -1) {
-        ipx_strerror(errno, err_str);
-        IPX_CTX_ERROR(instance->ctx, "Unable to get size of a next datagram. recv() failed: %s",
-            err_str);
-        return;
+    const size_t cnt = instance->config->batch_size;
+    const size_t spill_size = RECV_DGRAM_MAX - instance->config->buffer_size;
+    instance->recv.cnt = cnt;
+    instance->recv.slab = slab_create(instance->config->buffer_size, RECV_SLAB_KEEP);
+    instance->recv.hdrs = calloc(cnt, sizeof(*instance->recv.hdrs));
+    instance->recv.iovs = calloc(cnt * RECV_IOV_CNT, sizeof(*instance->recv.iovs));
+    instance->recv.spill = (spill_size > 0) ? malloc(cnt * spill_size) : NULL;
+    instance->recv.spill_size = spill_size;
+    instance->recv.addrs = calloc(cnt, sizeof(*instance->recv.addrs));
+    instance->recv.ctrls = calloc(cnt, RECV_CTRL_SIZE);
+    instance->recv.drops = calloc(instance->listen.cnt, sizeof(*instance->recv.drops));
+    instance->recv.drops_logged = 0;
+
+    if (!instance->recv.slab || !instance->recv.hdrs || !instance->recv.iovs
+            || (spill_size > 0 && !instance->recv.spill)
+            || !instance->recv.addrs || !instance->recv.ctrls || !instance->recv.drops) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
     }
-    msg_size = ret;
-#else
-    if (ioctl(sd, FIONREAD, &msg_size) == -1) {
-        ipx_strerror(errno, err_str);
-        IPX_CTX_ERROR(instance->ctx, "Unable to get size of a next datagram. ioctl() failed: %s",
-            err_str);
-        return;
+
+    // Buffers are assigned to the slots before each reception, bigger datagrams spill over
+    for (size_t i = 0; i < cnt; ++i) {
+        struct iovec *iov = &instance->recv.iovs[i * RECV_IOV_CNT];
+        iov[1].iov_base = (spill_size > 0) ? &instance->recv.spill[i * spill_size] : NULL;
+        iov[1].iov_len = spill_size;
+
+        struct msghdr *hdr = &instance->recv.hdrs[i].msg_hdr;
+        hdr->msg_name = &instance->recv.addrs[i];
+        hdr->msg_iov = iov;
+        hdr->msg_iovlen = (spill_size > 0) ? RECV_IOV_CNT : 1;
+        hdr->msg_control = &instance->recv.ctrls[i * RECV_CTRL_SIZE];
     }
-#endif
 
-    if (msg_size < (int) sizeof(uint16_t) || msg_size > UINT16_MAX) {
-        // Remove the malformed message from the buffer
-        uint16_t mini_buffer;
-        ret = recvfrom(sd, &mini_buffer, sizeof(mini_buffer), 0, NULL, NULL);
-        if (ret == -1) {
-            ipx_strerror(errno, err_str);
-            IPX_CTX_WARNING(instance->ctx, "An error has occurred during reading a malformed "
-                "message. recvfrom() failed: %s", err_str);
-            return;
-        }
+    return IPX_OK;
+}
 
-        IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%d bytes long)", msg_size);
-        return;
+/**
+ * \brief Destroy structures for batched reception of datagrams
+ *
+ * \note Buffers already passed on are freed as soon as the corresponding messages are destroyed.
+ * \param[in] instance Instance data
+ */
+static void
+recv_destroy(struct udp_data *instance)
+{
+    if (instance->recv.iovs != NULL) {
+        for (size_t i = 0; i < instance->recv.cnt; ++i) {
+            struct iovec *iov = &instance->recv.iovs[i * RECV_IOV_CNT];
+            if (iov->iov_base != NULL) {
+                slab_put(NULL, iov->iov_base);
+            }
+        }
     }
 
-    // Allocate the buffer
-    uint8_t *buffer = malloc(msg_size * sizeof(uint8_t));
-    if (!buffer) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        return;
-    }
+    slab_destroy(instance->recv.slab);
+    free(instance->recv.drops);
+    free(instance->recv.ctrls);
+    free(instance->recv.addrs);
+    free(instance->recv.spill);
+    free(instance->recv.iovs);
+    free(instance->recv.hdrs);
+}
 
-    // Get the message
-    struct sockaddr_storage addr;
-    socklen_t addr_len = sizeof(addr);
-    ret = recvfrom(sd, buffer, (size_t) msg_size, 0, (struct sockaddr *) &addr, &addr_len);
-    if (ret == -1) {
-        // Failed
-        ipx_strerror(errno, err_str);
-        IPX_CTX_ERROR(instance->ctx, "Failed to read a datagram. recvfrom() failed %s", err_str);
-        free(buffer);
-        return;
+/**
+ * \brief Update the number of datagrams dropped by the kernel on a socket
+ *
+ * The number is extracted from control data of a received datagram, if present.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ * \param[in] hdr      Header of the received datagram
+ */
+static void
+recv_drops_update(struct udp_data *instance, int sd, struct msghdr *hdr)
+{
+#ifdef SO_RXQ_OVFL
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_RXQ_OVFL) {
+            continue;
+        }
+
+        uint32_t drops;
+        memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+        for (size_t i = 0; i < instance->listen.cnt; ++i) {
+            if (instance->listen.sockets[i] == sd) {
+                // The counter of the kernel can wrap around
+                ipx_ctx_metric_add(instance->recv.drops_metric,
+                    (uint32_t) (drops - instance->recv.drops[i]));
+                instance->recv.drops[i] = drops;
+                break;
+            }
+        }
     }
+#else
+    (void) instance;
+    (void) sd;
+    (void) hdr;
+#endif
+}
 
-    if (ret != msg_size) {
-        IPX_CTX_ERROR(instance->ctx, "Read operation failed! Got %zu of %zu bytes!",
-            (size_t) ret, (size_t) msg_size);
-        free(buffer);
-        return;
+/**
+ * \brief Process a received IPFIX/NetFlow message and pass it
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ * \param[in] addr     Source address of the message
+ * \param[in] buffer   Buffer with the message (from the slab)
+ * \param[in] msg_size Size of the message
+ * \return True if the buffer has been passed on (i.e. it MUST NOT be reused anymore).
+ * \return False if the message has been dropped (i.e. the buffer can be reused).
+ */
+static bool
+process_datagram(struct udp_data *instance, int sd, const struct sockaddr *addr,
+    uint8_t *buffer, uint16_t msg_size)
+{
+    if (msg_size < sizeof(uint16_t)) {
+        IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%" PRIu16 " bytes long)",
+            msg_size);
+        return false;
     }
 
     // Find the source
-    struct udp_source *source = active_get(instance, sd, (struct sockaddr *) &addr);
+    struct udp_source *source = active_get(instance, sd, addr);
     if (!source) { // Memory allocation error!
-        free(buffer);
-        return;
+        return false;
     }
 
     // Check NetFlow/IPFIX header length and extract ODID/Source ID
@@ -1029,7 +1661,7 @@ process_socket(struct udp_data *instance, int sd)
         msg_odid = ntohl(((const struct fds_ipfix_msg_hdr *) buffer)->odid);
         break;
     case NF9_HDR_VERSION: // NetFlow v9
-        if (msg_size < (int) NF9_HDR_LEN) {
+        if (msg_size < NF9_HDR_LEN) {
             is_len_ok = false;
             break;
         }
@@ -1037,7 +1669,7 @@ process_socket(struct udp_data *instance, int sd)
         msg_odid = ntohl(((const struct nf9_msg_hdr *) buffer)->source_id);
         break;
     case NF5_HDR_VERSION: // NetFlow v5
-        if (msg_size < (int) NF5_HDR_LEN) {
+        if (msg_size < NF5_HDR_LEN) {
             is_len_ok = false;
             break;
         }
@@ -1053,38 +1685,388 @@ process_socket(struct udp_data *instance, int sd)
     if (!is_len_ok) {
         IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
             "The message will be dropped!", source->session->ident);
-        free(buffer);
-        return;
+        return false;
+    }
+
+    if (!admission_check(instance, source)) {
+        return false;
     }
 
     if (source->new_connection) {
         // Send information about the new Transport Session
         source->new_connection = false;
-        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
-        if (!msg) {
-            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
-                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
-                source->session->ident, __FILE__, __LINE__);
-        } else {
-            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg));
+        struct handoff_event event = {HANDOFF_SESSION_OPEN, source->session, 0, 0, NULL};
+        event_output(instance, &event);
+    }
+
+    // Pass the message
+    struct handoff_event event = {HANDOFF_MSG, source->session, msg_odid, msg_size, buffer};
+    if (!event_output(instance, &event)) {
+        return false;
+    }
+
+    source->last_seen = instance->wheel.now;
+    return true;
+}
+
+
+/**
+ * \brief Get IPFIX/NetFlow messages from a socket and pass them
+ *
+ * Up to a batch of datagrams is received by a single system call directly into buffers of
+ * the slab, which are passed on without copying. Rare datagrams bigger than the buffers spill
+ * over into the spill area and they are copied into a one-off buffer.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ */
+static void
+process_socket(struct udp_data *instance, int sd)
+{
+    const char *err_str;
+    const size_t buffer_size = instance->config->buffer_size;
+
+    // Assign buffers to slots that don't have any
+    size_t slot_cnt;
+    for (slot_cnt = 0; slot_cnt < instance->recv.cnt; ++slot_cnt) {
+        struct iovec *iov = &instance->recv.iovs[slot_cnt * RECV_IOV_CNT];
+        if (iov->iov_base == NULL && (iov->iov_base = slab_get(instance->recv.slab)) == NULL) {
+            IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            break;
         }
+
+        iov->iov_len = buffer_size;
+        struct msghdr *hdr = &instance->recv.hdrs[slot_cnt].msg_hdr;
+        hdr->msg_namelen = sizeof(instance->recv.addrs[slot_cnt]);
+        hdr->msg_controllen = RECV_CTRL_SIZE;
+        hdr->msg_flags = 0;
     }
 
-    // Create a message wrapper and pass the message
-    struct ipx_msg_ctx msg_ctx;
-    msg_ctx.session = source->session;
-    msg_ctx.odid = msg_odid;
-    msg_ctx.stream = 0; // Streams are not supported over UDP
+    if (slot_cnt == 0) {
+        return;
+    }
 
-    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, (uint16_t) msg_size);
-    if (!msg) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(buffer);
+    // Get the messages
+    int ret = recvmmsg(sd, instance->recv.hdrs, (unsigned int) slot_cnt, MSG_DONTWAIT, NULL);
+    if (ret == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return;
+        }
+
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to read datagrams. recvmmsg() failed: %s", err_str);
         return;
     }
 
-    ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
-    source->msg_cnt++;
+    // Common state of admission control for the whole batch
+    const uint8_t shed_threshold = instance->config->shed_threshold;
+    instance->admission.now = clock_now_us();
+    instance->admission.overloaded = (shed_threshold != 0
+        && ipx_ctx_pressure_get(instance->ctx) >= shed_threshold);
+
+    for (int i = 0; i < ret; ++i) {
+        struct mmsghdr *mmsg = &instance->recv.hdrs[i];
+        struct iovec *iov = &instance->recv.iovs[i * RECV_IOV_CNT];
+        const struct sockaddr *addr = (const struct sockaddr *) &instance->recv.addrs[i];
+        const size_t msg_len = mmsg->msg_len;
+        recv_drops_update(instance, sd, &mmsg->msg_hdr);
+
+        if ((mmsg->msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            IPX_CTX_WARNING(instance->ctx, "Received a datagram bigger than %d bytes. The "
+                "datagram has been dropped!", RECV_DGRAM_MAX);
+            continue;
+        }
+
+        if (msg_len <= buffer_size) {
+            if (process_datagram(instance, sd, addr, iov->iov_base, (uint16_t) msg_len)) {
+                // The buffer has been passed on
+                iov->iov_base = NULL;
+            }
+            continue;
+        }
+
+        // The datagram has spilled over, the buffer from the slab stays in the slot
+        uint8_t *buffer = slab_get_once(msg_len);
+        if (!buffer) {
+            IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            continue;
+        }
+
+        memcpy(buffer, iov[0].iov_base, buffer_size);
+        memcpy(buffer + buffer_size, iov[1].iov_base, msg_len - buffer_size);
+        if (!process_datagram(instance, sd, addr, buffer, (uint16_t) msg_len)) {
+            slab_put(NULL, buffer);
+        }
+    }
+}
+
+/**
+ * \brief Pass all events handed over by an additional receiving thread
+ * \param[in] instance Instance data
+ * \param[in] worker   Receiving thread
+ */
+static void
+worker_consume(struct udp_data *instance, struct udp_worker *worker)
+{
+    struct handoff_event events[GETTER_MAX_EVENTS];
+    size_t cnt;
+
+    while ((cnt = handoff_pop(worker->data->handoff, events, GETTER_MAX_EVENTS)) > 0) {
+        for (size_t i = 0; i < cnt; ++i) {
+            if (!event_process(instance->ctx, &events[i]) && events[i].type == HANDOFF_MSG) {
+                // The message has not been passed -> return the buffer
+                slab_put(NULL, events[i].data);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Wait for events on local sockets and process them
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on a fatal failure
+ */
+static int
+listener_poll(struct udp_data *instance)
+{
+    // Process messages from up to 16 sockets (including the timer)
+    struct epoll_event ev[GETTER_MAX_EVENTS];
+    int ev_valid = epoll_wait(instance->listen.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
+    if (ev_valid == -1) {
+        // Failed
+        int error_code = errno;
+        const char *err_str;
+        ipx_strerror(error_code, err_str);
+        IPX_CTX_ERROR(instance->ctx, "epoll_wait() failed: %s", err_str);
+        if (error_code == EINTR) {
+            return IPX_OK;
+        }
+        // Fatal error -> stop the plugin
+        return IPX_ERR_DENIED;
+    }
+
+    if (ev_valid == 0) {
+        // Timeout
+        return IPX_OK;
+    }
+
+    // Process all events
+    assert(ev_valid > 0 && ev_valid <= GETTER_MAX_EVENTS);
+    for (int i = 0; i < ev_valid; ++i) {
+        int sd = ev[i].data.fd;
+
+        if (sd == instance->listen.timer_fd) {
+            // Timer event
+            process_timer(instance, sd);
+            continue;
+        }
+
+        size_t idx;
+        for (idx = 0; idx < instance->workers.cnt; ++idx) {
+            if (handoff_fd(instance->workers.items[idx].data->handoff) == sd) {
+                break;
+            }
+        }
+
+        if (idx < instance->workers.cnt) {
+            // Events from an additional receiving thread
+            worker_consume(instance, &instance->workers.items[idx]);
+            continue;
+        }
+
+        process_socket(instance, sd);
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Close all sockets and Transport Sessions and free receiving data
+ *
+ * \note Session messages are passed directly, therefore, the function MUST be called only by
+ *   the thread of the instance.
+ * \param[in] data Receiving data (of the instance or of a stopped receiving thread)
+ */
+static void
+receiver_destroy(struct udp_data *data)
+{
+    // Unbind all local IP addresses and disarm the timer
+    listener_destroy(data);
+    recv_destroy(data);
+
+    // Close all Transport Session (this generates Session messages per each active Session)
+    data->handoff = NULL;
+    while (data->active.cnt > 0) {
+        active_remove_by_id(data, 0);
+    }
+    free(data->active.sources);
+    free(data->active.index);
+    free(data->wheel.slots);
+}
+
+/**
+ * \brief Main loop of an additional receiving thread
+ * \param[in] arg Receiving data of the thread
+ * \return NULL
+ */
+static void *
+worker_main(void *arg)
+{
+    struct udp_data *data = (struct udp_data *) arg;
+
+    while (!__atomic_load_n(&data->stop, __ATOMIC_RELAXED)) {
+        if (listener_poll(data) != IPX_OK) {
+            IPX_CTX_ERROR(data->ctx, "A receiving thread has been stopped due to a fatal "
+                "failure!", '\0');
+            break;
+        }
+
+        // Wake up the thread of the instance
+        handoff_notify(data->handoff);
+    }
+
+    handoff_notify(data->handoff);
+    return NULL;
+}
+
+/**
+ * \brief Stop all additional receiving threads and destroy them
+ *
+ * Events already handed over by the threads are passed and their Transport Sessions are closed.
+ * \param[in] instance Instance data
+ */
+static void
+workers_stop(struct udp_data *instance)
+{
+    for (size_t i = 0; i < instance->workers.cnt; ++i) {
+        struct udp_worker *worker = &instance->workers.items[i];
+        if (worker->running) {
+            __atomic_store_n(&worker->data->stop, true, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (size_t i = 0; i < instance->workers.cnt; ++i) {
+        struct udp_worker *worker = &instance->workers.items[i];
+        if (worker->running) {
+            pthread_join(worker->thread, NULL);
+        }
+
+        epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_DEL, handoff_fd(worker->data->handoff),
+            NULL);
+        worker_consume(instance, worker);
+        udp_handoff_t *handoff = worker->data->handoff;
+        receiver_destroy(worker->data);
+        handoff_destroy(handoff);
+        free(worker->data);
+    }
+
+    free(instance->workers.items);
+    instance->workers.items = NULL;
+    instance->workers.cnt = 0;
+}
+
+/**
+ * \brief Create a new additional receiving thread
+ *
+ * The thread binds its own sockets to the same local addresses as the instance (i.e. they
+ * form a socket group) and hands received messages over to the thread of the instance.
+ * \param[in] instance Instance data
+ * \param[in] worker   Uninitialized description of the thread
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+worker_start(struct udp_data *instance, struct udp_worker *worker)
+{
+    const char *err_str;
+    struct udp_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = instance->ctx;
+    data->config = instance->config;
+    data->listen.rmem_size = instance->listen.rmem_size;
+    data->handoff = handoff_create(HANDOFF_SIZE);
+    if (!data->handoff) {
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a queue of a receiving thread! (%s:%d)",
+            __FILE__, __LINE__);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (listener_open(data) != IPX_OK) {
+        handoff_destroy(data->handoff);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    if (active_init(data) != IPX_OK || recv_init(data) != IPX_OK) {
+        free(data->wheel.slots);
+        recv_destroy(data);
+        listener_destroy(data);
+        handoff_destroy(data->handoff);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // From now, the thread is destroyed by workers_stop()
+    data->recv.drops_metric = instance->recv.drops_metric;
+    worker->data = data;
+    worker->running = false;
+    instance->workers.cnt++;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = handoff_fd(data->handoff);
+    if (epoll_ctl(instance->listen.epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to add a queue to epoll: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    int rc = pthread_create(&worker->thread, NULL, &worker_main, data);
+    if (rc != 0) {
+        ipx_strerror(rc, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to start a receiving thread: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    worker->running = true;
+    return IPX_OK;
+}
+
+/**
+ * \brief Start additional receiving threads (if configured)
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure (all threads are stopped)
+ */
+static int
+workers_start(struct udp_data *instance)
+{
+    const size_t cnt = instance->config->threads - 1U;
+    if (cnt == 0) {
+        return IPX_OK;
+    }
+
+    instance->workers.items = calloc(cnt, sizeof(*instance->workers.items));
+    if (!instance->workers.items) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    for (size_t i = 0; i < cnt; ++i) {
+        if (worker_start(instance, &instance->workers.items[instance->workers.cnt]) != IPX_OK) {
+            workers_stop(instance);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    IPX_CTX_INFO(instance->ctx, "Datagrams are received by %zu threads.", cnt + 1);
+    return IPX_OK;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1109,6 +2091,22 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+#ifndef UDP_REUSEPORT
+    if (data->config->threads > 1) {
+        IPX_CTX_WARNING(ctx, "Multiple receiving threads are not supported on this platform "
+            "(missing SO_REUSEPORT). Only one thread will be used.", '\0');
+        data->config->threads = 1;
+    }
+
+    if (ipx_ctx_shards_get(ctx) > 1) {
+        IPX_CTX_ERROR(ctx, "Run-to-completion mode with multiple pipeline shards is not "
+            "supported on this platform (missing SO_REUSEPORT).", '\0');
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+#endif
+
     // Bind to local addresses and arm a timer
     if (listener_init(data) != IPX_OK) {
         config_destroy(data->config);
@@ -1116,6 +2114,30 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Prepare a table of sources and buffers for reception of datagrams
+    if (active_init(data) != IPX_OK || recv_init(data) != IPX_OK) {
+        free(data->wheel.slots);
+        recv_destroy(data);
+        listener_destroy(data);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Datagrams dropped by the kernel (both by the instance and additional receiving threads)
+    data->recv.drops_metric = ipx_ctx_metric_create(ctx, IPX_METRIC_COUNTER,
+        "udp_kernel_drops_total", "Datagrams dropped by the kernel due to a full socket "
+        "receive buffer", NULL);
+
+    // Start additional receiving threads
+    if (workers_start(data) != IPX_OK) {
+        receiver_destroy(data);
+        ipx_ctx_metric_destroy(data->recv.drops_metric);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
 }
@@ -1125,15 +2147,12 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     (void) ctx;
     struct udp_data *data = (struct udp_data *) cfg;
-    // Unbind all local IP addresses and disarm the timer
-    listener_destroy(data);
-
-    // Close all Transport Session (this generates Session messages per each active Session)
-    while (data->active.cnt > 0) {
-        active_remove_by_id(data, 0);
-    }
-    free(data->active.sources);
+    // Stop additional receiving threads and pass everything they have received
+    workers_stop(data);
+    // Close sockets and all Transport Sessions
+    receiver_destroy(data);
 
+    ipx_ctx_metric_destroy(data->recv.drops_metric);
     config_destroy(data->config);
     free(data);
 }
@@ -1141,43 +2160,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 int
 ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
 {
+    (void) ctx;
     struct udp_data *data = (struct udp_data *) cfg;
-
-
-    // Process messages from up to 16 sockets (including the timer)
-    struct epoll_event ev[GETTER_MAX_EVENTS];
-    int ev_valid = epoll_wait(data->listen.epoll_fd, ev, GETTER_MAX_EVENTS, GETTER_TIMEOUT);
-    if (ev_valid == -1) {
-        // Failed
-        int error_code = errno;
-        const char *err_str;
-        ipx_strerror(error_code, err_str);
-        IPX_CTX_ERROR(ctx, "epoll_wait() failed: %s", err_str);
-        if (error_code == EINTR) {
-            return IPX_OK;
-        }
-        // Fatal error -> stop the plugin
-        return IPX_ERR_DENIED;
-    }
-
-    if (ev_valid == 0) {
-        // Timeout
-        return IPX_OK;
-    }
-
-    // Process all events
-    assert(ev_valid > 0 && ev_valid <= GETTER_MAX_EVENTS);
-    for (int i = 0; i < ev_valid; ++i) {
-        int sd = ev[i].data.fd;
-
-        if (sd == data->listen.timer_fd) {
-            // Timer event
-            process_timer(data, sd);
-            continue;
-        }
-
-        process_socket(data, sd);
-    }
-
-    return IPX_OK;
+    return listener_poll(data);
 }
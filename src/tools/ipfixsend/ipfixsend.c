@@ -90,6 +90,7 @@ void usage()
     printf("  -R num     Real-time sending\n");
     printf("             Allow speed-up sending 'num' times (realtime: 1.0)\n");
     printf("  -O num     Rewrite Observation Domain ID (ODID)\n");
+    printf("  -z         Compress the stream with Zstandard (TCP only)\n");
     printf("\n");
 }
 
@@ -121,6 +122,7 @@ int main(int argc, char** argv)
     int     packets_s = 0;
     double  realtime_s = 0.0;
     bool    precache = false;
+    bool    compress = false;
 
     bool    odid_rewrite = false;
     long    odid_new;
@@ -132,7 +134,7 @@ int main(int argc, char** argv)
 
     // Parse parameters
     int c;
-    while ((c = getopt(argc, argv, "hci:d:p:t:n:s:S:R:O:")) != -1) {
+    while ((c = getopt(argc, argv, "hczi:d:p:t:n:s:S:R:O:")) != -1) {
         switch (c) {
         case 'h':
             usage();
@@ -152,6 +154,9 @@ int main(int argc, char** argv)
         case 'c':
             precache = true;
             break;
+        case 'z':
+            compress = true;
+            break;
         case 'n':
             loops = atoi(optarg);
             break;
@@ -232,6 +237,13 @@ int main(int argc, char** argv)
         reader_header_autoupdate(reader, true);
     }
 
+    if (compress && siso_set_compression(sender, "zstd") != SISO_OK) {
+        fprintf(stderr, "Compression error: %s\n", siso_get_last_err(sender));
+        siso_destroy(sender);
+        reader_destroy(reader);
+        return 1;
+    }
+
     // Create connection
     int ret = siso_create_connection(sender, ip, port, type);
     if (ret != SISO_OK) {
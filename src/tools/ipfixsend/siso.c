@@ -56,6 +56,9 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <strings.h>
+#include <arpa/inet.h>
+
+#include <zstd.h>
 
 /**
  * \brief Check that a pointer is not null. Otherwise returns #SISO_ERR
@@ -80,6 +83,12 @@
  * \return Minimum
  */
 #define SISO_MIN(frst, scnd) ((frst) > (scnd) ? (scnd) : (frst))
+/** Magic number at the start of a Zstandard compressed stream (see the TCP input plugin) */
+#define SISO_ZSTD_MAGIC 0x5a535444
+/** Zstandard compression level                                              */
+#define SISO_ZSTD_LEVEL 3
+/** Zstandard window size (log2), the collector keeps the window per stream  */
+#define SISO_ZSTD_WINDOW_LOG 20
 
 /** Accepted connection types                */
 enum siso_conn_type {
@@ -89,20 +98,33 @@ enum siso_conn_type {
    SC_UNKNOWN,
 };
 
+/** Accepted compression types               */
+enum siso_comp_type {
+    SC_COMP_NONE,
+    SC_COMP_ZSTD,
+    SC_COMP_UNKNOWN,
+};
+
 /** Message indexes                           */
 enum SISO_ERRORS {
     SISO_ERR_OK,
     SISO_ERR_TYPE,
     SISO_ERR_CONNECT,
-    SISO_ERR_CONFIG
+    SISO_ERR_CONFIG,
+    SISO_ERR_COMP_TYPE,
+    SISO_ERR_COMP_CONN,
+    SISO_ERR_COMP_INIT
 };
 
 /** Error message  */
 static const char *siso_messages[] = {
-    [SISO_ERR_OK]      = "Everything OK",
-    [SISO_ERR_TYPE]    = "Unknown connection type",
-    [SISO_ERR_CONNECT] = "Unable to create a new socket and connect to a destination.",
-    [SISO_ERR_CONFIG]  = "Configuration information is missing."
+    [SISO_ERR_OK]        = "Everything OK",
+    [SISO_ERR_TYPE]      = "Unknown connection type",
+    [SISO_ERR_CONNECT]   = "Unable to create a new socket and connect to a destination.",
+    [SISO_ERR_CONFIG]    = "Configuration information is missing.",
+    [SISO_ERR_COMP_TYPE] = "Unknown compression type",
+    [SISO_ERR_COMP_CONN] = "Compression is supported only over TCP",
+    [SISO_ERR_COMP_INIT] = "Unable to initialize the compressor."
 };
 
 /** Supported connection types      */
@@ -112,6 +134,12 @@ static const char *siso_sc_types[] = {
     [SC_SCTP] = "SCTP"
 };
 
+/** Supported compression types     */
+static const char *siso_comp_types[] = {
+    [SC_COMP_NONE] = "none",
+    [SC_COMP_ZSTD] = "zstd"
+};
+
 /**
  * \brief Main sisolib structure
  */
@@ -123,6 +151,10 @@ struct sisoconf_s {
     uint64_t max_speed;         /**< max sending speed */
     uint64_t act_speed;         /**< actual speed */
     struct timeval begin, end;  /**< start/end time for limited transfers */
+    enum siso_comp_type comp;   /**< stream compression */
+    ZSTD_CCtx *zstd;            /**< Zstandard compression context */
+    char *zstd_buf;             /**< buffer for compressed data */
+    size_t zstd_buf_size;       /**< size of the buffer */
 };
 
 /**
@@ -154,6 +186,8 @@ void siso_destroy(sisoconf *conf)
         freeaddrinfo(conf->servinfo);
     }
 
+    ZSTD_freeCCtx(conf->zstd);
+    free(conf->zstd_buf);
     free(conf);
 }
 
@@ -240,6 +274,158 @@ void siso_set_speed_str(sisoconf* conf, const char* limit)
     }
 }
 
+/**
+ * \brief Set compression of the stream
+ */
+int siso_set_compression(sisoconf *conf, const char *type)
+{
+    CHECK_PTR(conf);
+
+    int i;
+    for (i = 0; i < (int) SC_COMP_UNKNOWN; ++i) {
+        if (!strcasecmp(type, siso_comp_types[i])) {
+            break;
+        }
+    }
+
+    if (i == (int) SC_COMP_UNKNOWN) {
+        conf->last_error = siso_messages[SISO_ERR_COMP_TYPE];
+        return SISO_ERR;
+    }
+
+    conf->comp = (enum siso_comp_type) i;
+    if (conf->comp != SC_COMP_ZSTD || conf->zstd != NULL) {
+        return SISO_OK;
+    }
+
+    conf->zstd = ZSTD_createCCtx();
+    conf->zstd_buf_size = ZSTD_CStreamOutSize();
+    conf->zstd_buf = malloc(conf->zstd_buf_size);
+    if (!conf->zstd || !conf->zstd_buf
+            || ZSTD_isError(ZSTD_CCtx_setParameter(conf->zstd, ZSTD_c_compressionLevel,
+                SISO_ZSTD_LEVEL))
+            || ZSTD_isError(ZSTD_CCtx_setParameter(conf->zstd, ZSTD_c_windowLog,
+                SISO_ZSTD_WINDOW_LOG))) {
+        ZSTD_freeCCtx(conf->zstd);
+        free(conf->zstd_buf);
+        conf->zstd = NULL;
+        conf->zstd_buf = NULL;
+        conf->comp = SC_COMP_NONE;
+        conf->last_error = siso_messages[SISO_ERR_COMP_INIT];
+        return SISO_ERR;
+    }
+
+    return SISO_OK;
+}
+
+/**
+ * \brief Send data without compression
+ */
+static int siso_send_raw(sisoconf *conf, const char *data, ssize_t length)
+{
+    // Pointer to data to be sent
+    const char *ptr = data;
+
+    // data sent per cycle
+    ssize_t sent_now = 0;
+
+    // Size of remaining data
+    ssize_t todo = length;
+
+    while (todo > 0) {
+        // Send data
+        switch (conf->type) {
+        case SC_UDP:
+            sent_now = send(conf->sockfd, ptr, SISO_MIN(todo, SISO_UDP_MAX),
+                MSG_NOSIGNAL);
+            break;
+        case SC_TCP:
+        case SC_SCTP:
+            sent_now = send(conf->sockfd, ptr, todo, MSG_NOSIGNAL);
+            break;
+        default:
+            break;
+        }
+
+        // Check for errors
+        if (sent_now == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                // Connection broken, close...
+                conf->last_error = PERROR_LAST;
+                siso_close_connection(conf);
+                return SISO_ERR;
+            }
+
+            // Probably a signal occurred. Try again.
+            continue;
+        }
+
+        // Skip sent data
+        ptr  += sent_now;
+        todo -= sent_now;
+
+        // check speed limit
+        conf->act_speed += sent_now;
+        if (conf->max_speed && conf->act_speed >= conf->max_speed) {
+            gettimeofday(&(conf->end), NULL);
+
+            // Should sleep?
+            double elapsed = conf->end.tv_usec - conf->begin.tv_usec;
+            if (elapsed < 1000000.0) {
+                usleep(1000000.0 - elapsed);
+                gettimeofday(&(conf->end), NULL);
+            }
+
+            // reinit values
+            conf->begin = conf->end;
+            conf->act_speed = 0;
+        }
+
+    }
+
+    return SISO_OK;
+}
+
+/**
+ * \brief Start a new compressed stream (on a new connection)
+ */
+static int siso_start_compression(sisoconf *conf)
+{
+    if (conf->comp != SC_COMP_ZSTD) {
+        return SISO_OK;
+    }
+
+    // The previous stream (if any) has been interrupted
+    ZSTD_CCtx_reset(conf->zstd, ZSTD_reset_session_only);
+
+    const uint32_t hdr[2] = {htonl(SISO_ZSTD_MAGIC), htonl(SISO_ZSTD_WINDOW_LOG)};
+    return siso_send_raw(conf, (const char *) hdr, sizeof(hdr));
+}
+
+/**
+ * \brief Compress and send data (flushed, so the receiver can decompress it immediately)
+ */
+static int siso_send_zstd(sisoconf *conf, const char *data, ssize_t length)
+{
+    ZSTD_inBuffer in = {data, (size_t) length, 0};
+    size_t remaining;
+
+    do {
+        ZSTD_outBuffer out = {conf->zstd_buf, conf->zstd_buf_size, 0};
+        remaining = ZSTD_compressStream2(conf->zstd, &out, &in, ZSTD_e_flush);
+        if (ZSTD_isError(remaining)) {
+            conf->last_error = ZSTD_getErrorName(remaining);
+            return SISO_ERR;
+        }
+
+        if (out.pos > 0 && siso_send_raw(conf, conf->zstd_buf, out.pos) != SISO_OK) {
+            return SISO_ERR;
+        }
+    } while (remaining != 0);
+
+    return SISO_OK;
+}
+
 /**
  * \brief Get server information
  */
@@ -329,6 +515,11 @@ int siso_create_connection(sisoconf* conf, const char* ip, const char *port, con
     int ret = siso_decode_type(conf, type);
     CHECK_RETVAL(ret);
 
+    if (conf->comp != SC_COMP_NONE && conf->type != SC_TCP) {
+        conf->last_error = siso_messages[SISO_ERR_COMP_CONN];
+        return SISO_ERR;
+    }
+
     // Get server info
     ret = siso_getaddrinfo(conf, ip, port);
     CHECK_RETVAL(ret);
@@ -337,7 +528,7 @@ int siso_create_connection(sisoconf* conf, const char* ip, const char *port, con
     ret = siso_create_socket(conf);
     CHECK_RETVAL(ret);
 
-    return SISO_OK;
+    return siso_start_compression(conf);
 }
 
 /**
@@ -360,7 +551,10 @@ int siso_reconnect(sisoconf *conf)
     }
 
     siso_close_connection(conf);
-    return siso_create_socket(conf);
+    int ret = siso_create_socket(conf);
+    CHECK_RETVAL(ret);
+
+    return siso_start_compression(conf);
 }
 
 /**
@@ -370,65 +564,9 @@ int siso_send(sisoconf *conf, const char *data, ssize_t length)
 {
     CHECK_PTR(conf);
 
-    // Pointer to data to be sent
-    const char *ptr = data;
-
-    // data sent per cycle
-    ssize_t sent_now = 0;
-
-    // Size of remaining data
-    ssize_t todo = length;
-
-    while (todo > 0) {
-        // Send data
-        switch (conf->type) {
-        case SC_UDP:
-            sent_now = send(conf->sockfd, ptr, SISO_MIN(todo, SISO_UDP_MAX),
-                MSG_NOSIGNAL);
-            break;
-        case SC_TCP:
-        case SC_SCTP:
-            sent_now = send(conf->sockfd, ptr, todo, MSG_NOSIGNAL);
-            break;
-        default:
-            break;
-        }
-
-        // Check for errors
-        if (sent_now == -1) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                // Connection broken, close...
-                conf->last_error = PERROR_LAST;
-                siso_close_connection(conf);
-                return SISO_ERR;
-            }
-
-            // Probably a signal occurred. Try again.
-            continue;
-        }
-
-        // Skip sent data
-        ptr  += sent_now;
-        todo -= sent_now;
-
-        // check speed limit
-        conf->act_speed += sent_now;
-        if (conf->max_speed && conf->act_speed >= conf->max_speed) {
-            gettimeofday(&(conf->end), NULL);
-
-            // Should sleep?
-            double elapsed = conf->end.tv_usec - conf->begin.tv_usec;
-            if (elapsed < 1000000.0) {
-                usleep(1000000.0 - elapsed);
-                gettimeofday(&(conf->end), NULL);
-            }
-
-            // reinit values
-            conf->begin = conf->end;
-            conf->act_speed = 0;
-        }
-
+    if (conf->comp == SC_COMP_ZSTD) {
+        return siso_send_zstd(conf, data, length);
     }
 
-    return SISO_OK;
+    return siso_send_raw(conf, data, length);
 }
@@ -151,6 +151,18 @@ void siso_set_speed(sisoconf* conf, uint32_t limit, enum siso_units units);
  */
 void siso_set_speed_str(sisoconf* conf, const char* limit);
 
+/**
+ * \brief Set compression of the stream
+ *
+ * Must be called before siso_create_connection(). Compression is supported only over TCP.
+ * The compressed stream starts with a header that allows the collector to detect
+ * the compression.
+ * \param[in] conf sisoconf configuration
+ * \param[in] type compression type ("none" or "zstd", case insensitive)
+ * \return #SISO_OK or #SISO_ERR and sets error message (see siso_get_last_err() for details)
+ */
+int siso_set_compression(sisoconf *conf, const char *type);
+
 /**
  * \brief Create new connection
  *
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+
+extern "C" {
+#include <core/context.h>
+#include <core/ring.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Messages are never dereferenced by the ring, therefore, fake pointers can be used
+static ipx_msg_t *
+msg_fake(uintptr_t idx)
+{
+    return reinterpret_cast<ipx_msg_t *>(idx + 1);
+}
+
+// Consumer of a ring buffer in the direct mode (messages are not used in the test)
+static void
+consumer_dummy(void *arg, ipx_msg_t *msg)
+{
+    (void) arg;
+    (void) msg;
+}
+
+// Pressure is the occupancy of the output buffer of the instance
+TEST(Context, pressure)
+{
+    ipx_ctx_t *input = ipx_ctx_create("Input", nullptr);
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(ring, nullptr);
+
+    // Not connected
+    EXPECT_EQ(ipx_ctx_pressure_get(input), 0U);
+
+    ipx_ctx_ring_dst_set(input, ring);
+    for (uintptr_t i = 0; i < 64; ++i) {
+        ipx_ring_push(ring, msg_fake(i));
+    }
+    EXPECT_EQ(ipx_ctx_pressure_get(input), 50U);
+
+    for (uintptr_t i = 0; i < 64; ++i) {
+        ASSERT_EQ(ipx_ring_pop(ring), msg_fake(i));
+    }
+    ipx_ring_destroy(ring);
+    ipx_ctx_destroy(input);
+}
+
+// In the run-to-completion mode, the first buffer with its own reader is checked
+TEST(Context, pressureShard)
+{
+    // Input -> parser -> intermediate (same thread) -> output manager (shared by shards)
+    ipx_ctx_t *input = ipx_ctx_create("Input", nullptr);
+    ipx_ctx_t *parser = ipx_ctx_create("Input (parser)", nullptr);
+    ipx_ctx_t *inter = ipx_ctx_create("Intermediate", nullptr);
+    ipx_ring_t *parser_ring = ipx_ring_init(128, false);
+    ipx_ring_t *inter_ring = ipx_ring_init(128, false);
+    ipx_ring_t *outmgr_ring = ipx_ring_init(128, true);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(parser, nullptr);
+    ASSERT_NE(inter, nullptr);
+    ASSERT_NE(parser_ring, nullptr);
+    ASSERT_NE(inter_ring, nullptr);
+    ASSERT_NE(outmgr_ring, nullptr);
+
+    ipx_ctx_ring_dst_set(input, parser_ring);
+    ipx_ctx_ring_dst_set(parser, inter_ring);
+    ipx_ctx_ring_dst_set(inter, outmgr_ring);
+    // The same as ipx_ctx_run() does for instances without their own thread
+    ipx_ring_direct_set(parser_ring, &consumer_dummy, parser);
+    ipx_ring_direct_set(inter_ring, &consumer_dummy, inter);
+    EXPECT_EQ(ipx_ctx_pressure_get(input), 0U);
+
+    // Outputs cannot keep up -> the pressure must exceed a typical shedding threshold
+    for (uintptr_t i = 0; i < 120; ++i) {
+        ipx_ring_push(outmgr_ring, msg_fake(i));
+    }
+    EXPECT_GE(ipx_ctx_pressure_get(input), 90U);
+    EXPECT_EQ(ipx_ctx_pressure_get(input), ipx_ring_usage(outmgr_ring));
+    EXPECT_EQ(ipx_ctx_pressure_get(parser), ipx_ring_usage(outmgr_ring));
+
+    for (uintptr_t i = 0; i < 120; ++i) {
+        ASSERT_EQ(ipx_ring_pop(outmgr_ring), msg_fake(i));
+    }
+
+    ipx_ring_direct_set(parser_ring, nullptr, nullptr);
+    ipx_ring_direct_set(inter_ring, nullptr, nullptr);
+    ipx_ring_destroy(outmgr_ring);
+    ipx_ring_destroy(inter_ring);
+    ipx_ring_destroy(parser_ring);
+    ipx_ctx_destroy(inter);
+    ipx_ctx_destroy(parser);
+    ipx_ctx_destroy(input);
+}
+
+// Shedding of an input (e.g. UDP) in the run-to-completion mode triggers when outputs are slow
+TEST(Context, sheddingShard)
+{
+    // Same condition as in admission control of the UDP input
+    const unsigned int shed_threshold = 90;
+    auto overloaded = [shed_threshold](const ipx_ctx_t *ctx) {
+        return ipx_ctx_pressure_get(ctx) >= shed_threshold;
+    };
+
+    ipx_ctx_t *input = ipx_ctx_create("Input", nullptr);
+    ipx_ctx_t *parser = ipx_ctx_create("Input (parser)", nullptr);
+    ipx_ring_t *parser_ring = ipx_ring_init(128, false);
+    ipx_ring_t *outmgr_ring = ipx_ring_init(128, true);
+    ASSERT_NE(input, nullptr);
+    ASSERT_NE(parser, nullptr);
+    ASSERT_NE(parser_ring, nullptr);
+    ASSERT_NE(outmgr_ring, nullptr);
+
+    ipx_ctx_ring_dst_set(input, parser_ring);
+    ipx_ctx_ring_dst_set(parser, outmgr_ring);
+    ipx_ring_direct_set(parser_ring, &consumer_dummy, parser);
+
+    uintptr_t pushed = 0;
+    while (!overloaded(input)) {
+        ASSERT_LT(pushed, 128U) << "Shedding never triggered";
+        ipx_ring_push(outmgr_ring, msg_fake(pushed++));
+    }
+    EXPECT_GE(pushed, 115U);
+
+    // Outputs caught up
+    for (uintptr_t i = 0; i < pushed; ++i) {
+        ASSERT_EQ(ipx_ring_pop(outmgr_ring), msg_fake(i));
+    }
+    EXPECT_FALSE(overloaded(input));
+
+    ipx_ring_direct_set(parser_ring, nullptr, nullptr);
+    ipx_ring_destroy(outmgr_ring);
+    ipx_ring_destroy(parser_ring);
+    ipx_ctx_destroy(parser);
+    ipx_ctx_destroy(input);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+extern "C" {
+#include <core/hugepage.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Without huge pages, memory is allocated on the heap
+TEST(Hugepage, disabled)
+{
+    ASSERT_FALSE(ipx_hugepage_enabled());
+
+    struct ipx_hugepage_mem mem;
+    ASSERT_EQ(ipx_hugepage_alloc(&mem, 100), IPX_OK);
+    EXPECT_NE(mem.addr, nullptr);
+    EXPECT_EQ(mem.backing, IPX_HUGEPAGE_HEAP);
+    EXPECT_GE(mem.size, 100U);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mem.addr) % 64U, 0U);
+    memset(mem.addr, 0, mem.size);
+
+    struct ipx_hugepage_stats stats;
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, 0U);
+
+    ipx_hugepage_free(&mem);
+    EXPECT_EQ(mem.addr, nullptr);
+    ipx_hugepage_free(&mem);
+}
+
+// With huge pages, memory is aligned and rounded up to huge pages (whatever backs it)
+TEST(Hugepage, enabled)
+{
+    ipx_hugepage_enable(true);
+    ASSERT_TRUE(ipx_hugepage_enabled());
+
+    struct ipx_hugepage_mem mem_a;
+    struct ipx_hugepage_mem mem_b;
+    ASSERT_EQ(ipx_hugepage_alloc(&mem_a, 1), IPX_OK);
+    ASSERT_EQ(ipx_hugepage_alloc(&mem_b, IPX_HUGEPAGE_SIZE + 1), IPX_OK);
+    ipx_hugepage_enable(false);
+
+    EXPECT_NE(mem_a.backing, IPX_HUGEPAGE_HEAP);
+    EXPECT_EQ(mem_a.size, IPX_HUGEPAGE_SIZE);
+    EXPECT_EQ(mem_b.size, 2U * IPX_HUGEPAGE_SIZE);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mem_a.addr) % IPX_HUGEPAGE_SIZE, 0U);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mem_b.addr) % IPX_HUGEPAGE_SIZE, 0U);
+    memset(mem_b.addr, 0xFF, mem_b.size);
+
+    struct ipx_hugepage_stats stats;
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, 3U * IPX_HUGEPAGE_SIZE);
+    EXPECT_LE(stats.hugetlb + stats.thp, stats.total);
+
+    ipx_hugepage_free(&mem_a);
+    ipx_hugepage_free(&mem_b);
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, 0U);
+    EXPECT_EQ(stats.hugetlb, 0U);
+    EXPECT_EQ(stats.thp, 0U);
+}
+
+// Mapped memory never shares pages with other objects (even without huge pages)
+TEST(Hugepage, mapped)
+{
+    ASSERT_FALSE(ipx_hugepage_enabled());
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+    struct ipx_hugepage_mem mem;
+    ASSERT_EQ(ipx_hugepage_alloc_mapped(&mem, 100), IPX_OK);
+    EXPECT_EQ(mem.backing, IPX_HUGEPAGE_PAGES);
+    EXPECT_EQ(mem.size, page_size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mem.addr) % page_size, 0U);
+    memset(mem.addr, 0xFF, mem.size);
+
+    // Not allocated from huge pages
+    struct ipx_hugepage_stats stats;
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, 0U);
+
+    ipx_hugepage_free(&mem);
+    EXPECT_EQ(mem.addr, nullptr);
+}
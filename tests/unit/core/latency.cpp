@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+
+extern "C" {
+#include <core/latency.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+static std::unique_ptr<struct ipx_lat_hist>
+hist_create()
+{
+    std::unique_ptr<struct ipx_lat_hist> hist(new struct ipx_lat_hist);
+    ipx_lat_hist_reset(hist.get());
+    return hist;
+}
+
+// Empty histogram
+TEST(LatHist, empty)
+{
+    auto hist = hist_create();
+    EXPECT_EQ(hist->cnt, 0U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 50.0), 0U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 100.0), 0U);
+}
+
+// Small values are recorded exactly
+TEST(LatHist, exact)
+{
+    auto hist = hist_create();
+    for (uint64_t i = 1; i <= 10; ++i) {
+        ipx_lat_hist_add(hist.get(), i);
+    }
+
+    EXPECT_EQ(hist->cnt, 10U);
+    EXPECT_EQ(hist->sum, 55U);
+    EXPECT_EQ(hist->max, 10U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 0.0), 1U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 50.0), 5U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 90.0), 9U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 100.0), 10U);
+}
+
+// Relative error of large values is bounded
+TEST(LatHist, precision)
+{
+    const uint64_t values[] = {17, 1000, 123456, 987654321, UINT64_MAX / 3, UINT64_MAX};
+    for (uint64_t value : values) {
+        auto hist = hist_create();
+        ipx_lat_hist_add(hist.get(), 1);
+        ipx_lat_hist_add(hist.get(), value);
+
+        // The upper bound of the bucket is capped by the maximum
+        EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 100.0), value);
+        uint64_t median = ipx_lat_hist_percentile(hist.get(), 50.0);
+        EXPECT_EQ(median, 1U);
+
+        // Value just below the maximum falls into the same bucket (or the previous one)
+        ipx_lat_hist_add(hist.get(), value - value / 32);
+        uint64_t p50 = ipx_lat_hist_percentile(hist.get(), 50.0);
+        EXPECT_LE(p50, value);
+        EXPECT_GE(p50, value - value / 32);
+    }
+}
+
+// Percentiles of a uniform distribution
+TEST(LatHist, uniform)
+{
+    auto hist = hist_create();
+    for (uint64_t i = 1; i <= 100000; ++i) {
+        ipx_lat_hist_add(hist.get(), i * 1000);
+    }
+
+    const double pcts[] = {50.0, 90.0, 99.0, 99.9};
+    for (double pct : pcts) {
+        const double expected = pct * 1000.0 * 1000.0;
+        const double value = (double) ipx_lat_hist_percentile(hist.get(), pct);
+        EXPECT_GE(value, expected * 0.99);
+        EXPECT_LE(value, expected * 1.07);
+    }
+
+    ipx_lat_hist_reset(hist.get());
+    EXPECT_EQ(hist->cnt, 0U);
+    EXPECT_EQ(hist->max, 0U);
+    EXPECT_EQ(ipx_lat_hist_percentile(hist.get(), 99.0), 0U);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <core/message_pool.h>
+#include <core/message_ipfix.h>
+#include <core/hugepage.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+static const size_t REC_SIZE = IPX_MSG_IPFIX_BASE_REC_SIZE;
+
+// Returned wrappers must be reused by the producer
+TEST(MsgPool, reuse)
+{
+    ipx_msg_pool_t *pool = ipx_msg_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    struct ipx_msg_ipfix *msg = ipx_msg_pool_ipfix_get(pool, REC_SIZE);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(msg->rec_info.cnt_alloc, (uint32_t) REC_DEF_CNT);
+    EXPECT_EQ(msg->rec_info.rec_size, REC_SIZE);
+    msg->rec_info.cnt_valid = 10;
+    ipx_msg_pool_ipfix_put(msg);
+
+    struct ipx_msg_ipfix *msg2 = ipx_msg_pool_ipfix_get(pool, REC_SIZE);
+    ASSERT_EQ(msg2, msg);
+    EXPECT_EQ(msg2->rec_info.cnt_valid, 0U);
+
+    struct ipx_msg_pool_stats stats;
+    ipx_msg_pool_stats_get(pool, &stats);
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.misses, 1U);
+
+    // Wrappers with a different size of records cannot be reused
+    ipx_msg_pool_ipfix_put(msg2);
+    struct ipx_msg_ipfix *msg3 = ipx_msg_pool_ipfix_get(pool, REC_SIZE + 8);
+    ASSERT_NE(msg3, nullptr);
+    EXPECT_EQ(msg3->rec_info.rec_size, REC_SIZE + 8);
+    ipx_msg_pool_ipfix_put(msg3);
+
+    ipx_msg_pool_stats_get(pool, &stats);
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.misses, 2U);
+    ipx_msg_pool_destroy(pool);
+}
+
+// Wrappers returned by other threads (even after the pool has been closed) must not leak
+TEST(MsgPool, returnFromThreads)
+{
+    const size_t thread_cnt = 4;
+    const size_t msg_cnt = 1000;
+    ipx_msg_pool_t *pool = ipx_msg_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    for (size_t round = 0; round < 2; ++round) {
+        std::vector<struct ipx_msg_ipfix *> msgs;
+        for (size_t i = 0; i < thread_cnt * msg_cnt; ++i) {
+            struct ipx_msg_ipfix *msg = ipx_msg_pool_ipfix_get(pool, REC_SIZE);
+            ASSERT_NE(msg, nullptr);
+            msgs.push_back(msg);
+        }
+
+        if (round == 1) {
+            // Close the pool while the wrappers are still in use
+            ipx_msg_pool_destroy(pool);
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_cnt; ++t) {
+            threads.emplace_back([&msgs, t, msg_cnt]() {
+                for (size_t i = 0; i < msg_cnt; ++i) {
+                    ipx_msg_pool_ipfix_put(msgs[t * msg_cnt + i]);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+// Wrappers carved out of huge page slabs must be reused and moved instead of reallocated
+TEST(MsgPool, slabs)
+{
+    ipx_hugepage_enable(true);
+    ipx_msg_pool_t *pool = ipx_msg_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    struct ipx_msg_ipfix *msg = ipx_msg_pool_ipfix_get(pool, REC_SIZE);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_TRUE(msg->pool.slab);
+    EXPECT_GE(msg->rec_info.cnt_alloc, (uint32_t) REC_DEF_CNT);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(msg) % 64U, 0U);
+
+    struct ipx_hugepage_stats stats;
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, IPX_HUGEPAGE_SIZE);
+
+    // Fill all records and add more of them
+    const uint32_t cnt_alloc = msg->rec_info.cnt_alloc;
+    memset(msg->recs, 0xAB, cnt_alloc * REC_SIZE);
+    msg->rec_info.cnt_valid = cnt_alloc;
+    struct ipx_msg_ipfix *msg_slab = msg;
+    ASSERT_EQ(ipx_msg_ipfix_reserve_drecs(&msg, 10), IPX_OK);
+    ASSERT_NE(msg, msg_slab);
+    EXPECT_FALSE(msg->pool.slab);
+    EXPECT_EQ(msg->pool.owner, pool);
+    EXPECT_EQ(msg->rec_info.cnt_valid, cnt_alloc);
+    EXPECT_GE(msg->rec_info.cnt_alloc, cnt_alloc + 10);
+    const uint8_t *last = reinterpret_cast<const uint8_t *>(msg->recs) + cnt_alloc * REC_SIZE - 1;
+    EXPECT_EQ(*last, 0xAB);
+
+    // The original slot has been returned to the pool
+    struct ipx_msg_ipfix *msg2 = ipx_msg_pool_ipfix_get(pool, REC_SIZE);
+    ASSERT_EQ(msg2, msg_slab);
+    EXPECT_TRUE(msg2->pool.slab);
+    EXPECT_EQ(msg2->rec_info.cnt_valid, 0U);
+
+    ipx_msg_pool_ipfix_put(msg2);
+    ipx_msg_pool_destroy(pool);
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, IPX_HUGEPAGE_SIZE); // The moved wrapper still holds the pool
+
+    ipx_msg_pool_ipfix_put(msg);
+    ipx_hugepage_stats_get(&stats);
+    EXPECT_EQ(stats.total, 0U);
+    ipx_hugepage_enable(false);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <core/metrics.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/// Get all metrics in the text format
+static std::string
+metrics_dump()
+{
+    char *data = nullptr;
+    size_t size = 0;
+    FILE *out = open_memstream(&data, &size);
+    EXPECT_NE(out, nullptr);
+    EXPECT_EQ(ipx_metrics_write(out), IPX_OK);
+    fclose(out);
+
+    std::string res(data, size);
+    free(data);
+    return res;
+}
+
+// Empty registry
+TEST(Metrics, empty)
+{
+    EXPECT_EQ(metrics_dump(), "");
+}
+
+// Counter without labels
+TEST(Metrics, counter)
+{
+    ipx_metric_t *metric = ipx_metric_create(IPX_METRIC_COUNTER, "test_total", "Test", nullptr);
+    ASSERT_NE(metric, nullptr);
+    EXPECT_EQ(metrics_dump(), "# HELP test_total Test\n# TYPE test_total counter\ntest_total 0\n");
+
+    ipx_ctx_metric_add(metric, 10);
+    ipx_ctx_metric_add(metric, 5);
+    EXPECT_EQ(metrics_dump(), "# HELP test_total Test\n# TYPE test_total counter\ntest_total 15\n");
+
+    ipx_ctx_metric_destroy(metric);
+    EXPECT_EQ(metrics_dump(), "");
+}
+
+// Counter updated by multiple threads
+TEST(Metrics, counterThreads)
+{
+    ipx_metric_t *metric = ipx_metric_create(IPX_METRIC_COUNTER, "test_total", "Test", nullptr);
+    ASSERT_NE(metric, nullptr);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 16; ++i) {
+        threads.emplace_back([metric]() {
+            for (int j = 0; j < 10000; ++j) {
+                ipx_ctx_metric_add(metric, 1);
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_NE(metrics_dump().find("\ntest_total 160000\n"), std::string::npos);
+    ipx_ctx_metric_destroy(metric);
+}
+
+// Gauges with labels (one family)
+TEST(Metrics, gaugeLabels)
+{
+    const char *labels_a[] = {"instance", "a", nullptr};
+    const char *labels_b[] = {"instance", "b", "odid", "1", nullptr};
+    ipx_metric_t *metric_a = ipx_metric_create(IPX_METRIC_GAUGE, "test_gauge", "Test", labels_a);
+    ipx_metric_t *metric_b = ipx_metric_create(IPX_METRIC_GAUGE, "test_gauge", "Test", labels_b);
+    ASSERT_NE(metric_a, nullptr);
+    ASSERT_NE(metric_b, nullptr);
+
+    ipx_ctx_metric_set(metric_a, -5);
+    ipx_ctx_metric_set(metric_b, 7);
+    EXPECT_EQ(metrics_dump(), "# HELP test_gauge Test\n# TYPE test_gauge gauge\n"
+        "test_gauge{instance=\"a\"} -5\ntest_gauge{instance=\"b\",odid=\"1\"} 7\n");
+
+    ipx_ctx_metric_destroy(metric_a);
+    EXPECT_EQ(metrics_dump(), "# HELP test_gauge Test\n# TYPE test_gauge gauge\n"
+        "test_gauge{instance=\"b\",odid=\"1\"} 7\n");
+    ipx_ctx_metric_destroy(metric_b);
+}
+
+// Escaping of label values and descriptions
+TEST(Metrics, escape)
+{
+    const char *labels[] = {"exporter", "a\"b\\c\nd", nullptr};
+    ipx_metric_t *metric = ipx_metric_create(IPX_METRIC_GAUGE, "test_gauge", "A \"b\"\n", labels);
+    ASSERT_NE(metric, nullptr);
+    EXPECT_EQ(metrics_dump(), "# HELP test_gauge A \"b\"\\n\n# TYPE test_gauge gauge\n"
+        "test_gauge{exporter=\"a\\\"b\\\\c\\nd\"} 0\n");
+    ipx_ctx_metric_destroy(metric);
+}
+
+// Value provided by a callback
+TEST(Metrics, callback)
+{
+    uint64_t value = 42;
+    ipx_metric_cb cb = [](const void *arg) {
+        return *static_cast<const uint64_t *>(arg);
+    };
+
+    ipx_metric_t *metric = ipx_metric_create_cb(IPX_METRIC_COUNTER, "test_total", "Test",
+        nullptr, cb, &value);
+    ASSERT_NE(metric, nullptr);
+    EXPECT_NE(metrics_dump().find("\ntest_total 42\n"), std::string::npos);
+    value = 50;
+    EXPECT_NE(metrics_dump().find("\ntest_total 50\n"), std::string::npos);
+    ipx_ctx_metric_destroy(metric);
+}
+
+// Invalid names and type conflicts
+TEST(Metrics, invalid)
+{
+    const char *labels[] = {"in-valid", "a", nullptr};
+    EXPECT_EQ(ipx_metric_create(IPX_METRIC_GAUGE, "0test", "Test", nullptr), nullptr);
+    EXPECT_EQ(ipx_metric_create(IPX_METRIC_GAUGE, "test-gauge", "Test", nullptr), nullptr);
+    EXPECT_EQ(ipx_metric_create(IPX_METRIC_GAUGE, "test_gauge", "Test", labels), nullptr);
+
+    ipx_metric_t *metric = ipx_metric_create(IPX_METRIC_GAUGE, "test_metric", "Test", nullptr);
+    ASSERT_NE(metric, nullptr);
+    EXPECT_EQ(ipx_metric_create(IPX_METRIC_COUNTER, "test_metric", "Test", nullptr), nullptr);
+    ipx_ctx_metric_destroy(metric);
+    EXPECT_EQ(metrics_dump(), "");
+}
+
+// Updates of metrics that failed to be created are ignored
+TEST(Metrics, nullMetric)
+{
+    ipx_metric_t *metric = ipx_metric_create(IPX_METRIC_COUNTER, "0test", "Test", nullptr);
+    ASSERT_EQ(metric, nullptr);
+    ipx_ctx_metric_add(metric, 1);
+    ipx_ctx_metric_set(metric, 1);
+    ipx_ctx_metric_destroy(metric);
+    EXPECT_EQ(metrics_dump(), "");
+}
@@ -0,0 +1,179 @@
+// Microbenchmark of the parser: messages with many small Data Sets (typical for exporters with
+// multiple Templates) are parsed repeatedly and throughput is printed. Compare the results of
+// the binary built with and without a modification of the parser.
+// It's not a unit test (i.e. not run by "make test"), build it by "make bench_parser" and run it
+// in the build directory of this file.
+#include <gtest/gtest.h>
+#include <MsgGen.h>
+#include <ipfixcol2/session.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/parser.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Number of different Templates used by the exporter */
+static const uint16_t TMPLT_CNT = 8;
+/** First Template ID */
+static const uint16_t TMPLT_ID = 256;
+/** Number of parsed messages in each scenario */
+static const unsigned int MSG_CNT = 20000;
+
+class Bench : public ::testing::Test {
+protected:
+    fds_iemgr_t *iemgr = nullptr;
+    ipx_parser_t *parser = nullptr;
+    ipx_session *session = nullptr;
+    ipx_ctx_t *ctx = nullptr;
+    uint32_t seq_num = 0;
+
+    void SetUp() override {
+        ipx_session_net net_cfg;
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = 60000;
+        net_cfg.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+
+        parser = ipx_parser_create("Benchmark (parser)", IPX_VERB_ERROR);
+        iemgr = fds_iemgr_create();
+        ctx = ipx_ctx_create("Benchmark", nullptr);
+        session = ipx_session_new_tcp(&net_cfg);
+        ASSERT_NE(parser, nullptr);
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_NE(ctx, nullptr);
+        ASSERT_NE(session, nullptr);
+        ASSERT_EQ(fds_iemgr_read_file(iemgr, "data/iana_part.xml", false), FDS_OK);
+
+        ipx_msg_garbage_t *garbage;
+        ASSERT_EQ(ipx_parser_ie_source(parser, iemgr, &garbage), IPX_OK);
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+
+        // Define all Templates
+        ipfix_set set_tmplts(FDS_IPFIX_SET_TMPLT);
+        for (uint16_t i = 0; i < TMPLT_CNT; ++i) {
+            ipfix_trec trec(TMPLT_ID + i);
+            trec.add_field(8, 4);  // sourceIPv4Address
+            trec.add_field(12, 4); // destinationIPv4Address
+            trec.add_field(1, 8);  // octetDeltaCount
+            trec.add_field(2, 8);  // packetDeltaCount
+            set_tmplts.add_rec(trec);
+        }
+
+        ipfix_msg msg;
+        msg.add_set(set_tmplts);
+        ASSERT_EQ(parse(msg), 0U);
+    }
+
+    void TearDown() override {
+        ipx_session_destroy(session);
+        ipx_parser_destroy(parser);
+        fds_iemgr_destroy(iemgr);
+        ipx_ctx_destroy(ctx);
+    }
+
+    /**
+     * @brief Parse a message and return number of parsed Data Records
+     * @note The message is not modified and can be parsed again
+     */
+    uint32_t parse(ipfix_msg &msg) {
+        msg.set_seq(seq_num);
+        const uint16_t msg_size = msg.size();
+        uint8_t *msg_data = static_cast<uint8_t *>(malloc(msg_size));
+        if (!msg_data) {
+            throw std::bad_alloc();
+        }
+        memcpy(msg_data, static_cast<const ipfix_msg &>(msg).front(), msg_size);
+
+        struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        if (!ipfix_msg) {
+            free(msg_data);
+            throw std::bad_alloc();
+        }
+
+        ipx_msg_garbage_t *garbage;
+        if (ipx_parser_process(parser, &ipfix_msg, &garbage) != IPX_OK) {
+            ipx_msg_ipfix_destroy(ipfix_msg);
+            throw std::runtime_error("Failed to parse a message!");
+        }
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+
+        uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
+        seq_num += rec_cnt;
+        ipx_msg_ipfix_destroy(ipfix_msg);
+        return rec_cnt;
+    }
+
+    /**
+     * @brief Create a message with Data Sets of the given number of records
+     * @param[in] set_cnt  Number of Data Sets (Templates are used in round-robin fashion)
+     * @param[in] rec_cnt  Number of Data Records per Set
+     */
+    static ipfix_msg create_msg(unsigned int set_cnt, unsigned int rec_cnt) {
+        ipfix_msg msg;
+        for (unsigned int s = 0; s < set_cnt; ++s) {
+            ipfix_set set_data(TMPLT_ID + (s % TMPLT_CNT));
+            for (unsigned int r = 0; r < rec_cnt; ++r) {
+                ipfix_drec drec;
+                drec.append_ip("10.0.0.1");
+                drec.append_ip("10.0.0.2");
+                drec.append_uint(1000 + r, 8);
+                drec.append_uint(10 + r, 8);
+                set_data.add_rec(drec);
+            }
+            msg.add_set(set_data);
+        }
+        return msg;
+    }
+
+    /** Run a scenario and print its throughput */
+    void run(const std::string &name, unsigned int set_cnt, unsigned int rec_cnt) {
+        ipfix_msg msg = create_msg(set_cnt, rec_cnt);
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < MSG_CNT; ++i) {
+            ASSERT_EQ(parse(msg), set_cnt * rec_cnt);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        std::cout << "[ BENCH    ] " << name << ": "
+            << ns / MSG_CNT << " ns/message, "
+            << ns / (MSG_CNT * set_cnt) << " ns/Data Set" << std::endl;
+    }
+};
+
+// One Data Set with many records (lookup of the Template is negligible)
+TEST_F(Bench, singleDataSet)
+{
+    run("1 Data Set x 32 records", 1, 32);
+}
+
+// Many small Data Sets (lookup of the Template is performed for each of them)
+TEST_F(Bench, manySmallDataSets)
+{
+    run("32 Data Sets x 1 record", 32, 1);
+}
+
+// Many tiny Data Sets in a large message
+TEST_F(Bench, manyTinyDataSetsLarge)
+{
+    run("256 Data Sets x 1 record", 256, 1);
+}
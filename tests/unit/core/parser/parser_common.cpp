@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <vector>
 #include <MsgGen.h>
 #include <ipfixcol2/session.h>
 
@@ -162,4 +163,270 @@ TEST_P(Common, simple)
 }
 
 
-// Max message (65000 records in one message)...
\ No newline at end of file
+// Identical (Options) Template definitions must not be added to the Template manager again
+TEST_P(Common, identicalTemplateRefresh)
+{
+    ipfix_trec trec(256);
+    trec.add_field(8, 4);  // SRC IPv4 address
+    trec.add_field(12, 4); // DSC IPv4 address
+    trec.add_field(1, 4);  // bytes
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    for (int i = 0; i < 3; ++i) {
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+        ipfix_msg msg;
+        msg.add_set(set_tmplts);
+
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        ASSERT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage *garbage;
+        ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        if (i > 0) {
+            // Nothing has been changed
+            EXPECT_EQ(garbage, nullptr);
+        }
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+        ipx_msg_ipfix_destroy(ipfix_msg);
+    }
+
+    struct ipx_parser_stats stats;
+    ipx_parser_stats_get(parser, &stats);
+    EXPECT_EQ(stats.tmplt_defs, 3U);
+    EXPECT_EQ(stats.tmplt_refresh_suppressed, 2U);
+}
+
+// Over UDP, identical definitions are not suppressed after a half of the Template lifetime
+TEST(ParserUdp, identicalTemplateRefreshLifetime)
+{
+    ipx_session_net net_cfg;
+    net_cfg.l3_proto = AF_INET;
+    net_cfg.port_src = 60000;
+    net_cfg.port_dst = 4739;
+    ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+    ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+
+    const uint16_t lifetime = 60;
+    ipx_parser_t *parser = ipx_parser_create("UDP context (parser)", IPX_VERB_DEBUG);
+    ipx_ctx_t *ctx = ipx_ctx_create("UDP context", nullptr);
+    ipx_session *session = ipx_session_new_udp(&net_cfg, lifetime, lifetime);
+    ASSERT_NE(parser, nullptr);
+    ASSERT_NE(ctx, nullptr);
+    ASSERT_NE(session, nullptr);
+
+    ipfix_trec trec(256);
+    trec.add_field(8, 4);  // SRC IPv4 address
+    trec.add_field(12, 4); // DSC IPv4 address
+    trec.add_field(1, 4);  // bytes
+
+    // Export Time of the definitions and expected number of suppressed refreshes
+    const uint32_t start = 1000000;
+    const struct {
+        uint32_t exp_time;
+        uint64_t suppressed;
+    } steps[] = {
+        {start, 0},                        // New definition
+        {start + lifetime / 4, 1},         // Refresh within the first half of the lifetime
+        {start + lifetime / 2, 1},         // Refresh after a half of the lifetime -> re-added
+        {start + lifetime / 2 + 1, 2},     // Lifetime has been restarted by the previous one
+        {start + lifetime + 1, 2}          // Re-added again
+    };
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    for (const auto &step : steps) {
+        ipfix_set set_tmplts(2);
+        set_tmplts.add_rec(trec);
+        ipfix_msg msg;
+        msg.set_exp(step.exp_time);
+        msg.add_set(set_tmplts);
+
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        ASSERT_NE(ipfix_msg, nullptr);
+
+        ipx_msg_garbage *garbage;
+        ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+        ipx_msg_ipfix_destroy(ipfix_msg);
+
+        struct ipx_parser_stats stats;
+        ipx_parser_stats_get(parser, &stats);
+        EXPECT_EQ(stats.tmplt_refresh_suppressed, step.suppressed)
+            << "Export Time: " << step.exp_time;
+    }
+
+    ipx_session_destroy(session);
+    ipx_parser_destroy(parser);
+    ipx_ctx_destroy(ctx);
+}
+
+
+// Same as the hash of parser records (used only to create collisions in the index on purpose)
+static size_t
+rec_hash(const struct ipx_session *session, uint32_t odid)
+{
+    uint64_t hash = ((uint64_t) (uintptr_t) session) ^ ((uint64_t) odid << 32);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return (size_t) hash;
+}
+
+// Count Transport Sessions known to the parser
+static void
+session_count(ipx_parser_t *parser, const struct ipx_session *ts, void *data)
+{
+    (void) parser;
+    (void) ts;
+    ++*reinterpret_cast<size_t *>(data);
+}
+
+// Removal of many Transport Sessions, including sessions in the middle of a collision chain
+TEST(ParserSessions, removeFromCollisionChain)
+{
+    // 64 records -> the index is rebuilt several times up to 128 slots
+    const size_t session_cnt = 64;
+    const size_t index_mask = 127;
+    // Sessions [0, chain_cnt) share the same home slot near the end, so the chain wraps around
+    const size_t chain_cnt = 16;
+    const size_t chain_home = 124;
+
+    ipx_parser_t *parser = ipx_parser_create("Sessions context (parser)", IPX_VERB_ERROR);
+    ipx_ctx_t *ctx = ipx_ctx_create("Sessions context", nullptr);
+    ASSERT_NE(parser, nullptr);
+    ASSERT_NE(ctx, nullptr);
+
+    std::vector<struct ipx_session *> sessions;
+    std::vector<uint32_t> odids;
+    for (size_t i = 0; i < session_cnt; ++i) {
+        ipx_session_net net_cfg;
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = static_cast<uint16_t>(10000 + i);
+        net_cfg.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+        struct ipx_session *session = ipx_session_new_udp(&net_cfg, 0, 0);
+        ASSERT_NE(session, nullptr);
+
+        uint32_t odid = 1;
+        if (i < chain_cnt) {
+            while ((rec_hash(session, odid) & index_mask) != chain_home) {
+                ++odid;
+            }
+        }
+
+        sessions.push_back(session);
+        odids.push_back(odid);
+    }
+
+    ipfix_trec trec(256);
+    trec.add_field(8, 4);  // SRC IPv4 address
+    trec.add_field(1, 4);  // bytes
+
+    // Send a message with a data record (and optionally the template) from a session
+    auto send = [&](size_t i, bool with_tmplt, uint32_t seq) -> int {
+        ipfix_drec drec;
+        drec.append_ip("127.0.0.1");
+        drec.append_uint(i, 4);
+        ipfix_set set_data(256);
+        set_data.add_rec(drec);
+
+        ipfix_msg msg;
+        msg.set_odid(odids[i]);
+        msg.set_seq(seq);
+        if (with_tmplt) {
+            ipfix_set set_tmplts(2);
+            set_tmplts.add_rec(trec);
+            msg.add_set(set_tmplts);
+        }
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {sessions[i], odids[i], 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+        if (!ipfix_msg) {
+            return -1;
+        }
+
+        ipx_msg_garbage *garbage;
+        if (ipx_parser_process(parser, &ipfix_msg, &garbage) != IPX_OK) {
+            return -1;
+        }
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+
+        // Records are decoded only if the template of the session is known
+        int drec_cnt = static_cast<int>(ipx_msg_ipfix_get_drec_cnt(ipfix_msg));
+        ipx_msg_ipfix_destroy(ipfix_msg);
+        return drec_cnt;
+    };
+
+    for (size_t i = 0; i < session_cnt; ++i) {
+        ASSERT_EQ(send(i, true, 0), 1) << "Session " << i;
+    }
+
+    // Remove every other session of the chain (i.e. from its middle) and a few others
+    auto removed = [chain_cnt](size_t i) {
+        return (i < chain_cnt) ? (i % 2 == 1) : (i % 5 == 0);
+    };
+    size_t removed_cnt = 0;
+    for (size_t i = 0; i < session_cnt; ++i) {
+        if (!removed(i)) {
+            continue;
+        }
+
+        ipx_msg_garbage *garbage = nullptr;
+        ASSERT_EQ(ipx_parser_session_remove(parser, sessions[i], &garbage), IPX_OK);
+        ASSERT_NE(garbage, nullptr);
+        ipx_msg_garbage_destroy(garbage);
+        ++removed_cnt;
+    }
+
+    // Removed sessions are not found anymore
+    size_t remaining_cnt = 0;
+    ipx_parser_session_for(parser, &session_count, &remaining_cnt);
+    EXPECT_EQ(remaining_cnt, session_cnt - removed_cnt);
+    for (size_t i = 0; i < session_cnt; ++i) {
+        if (!removed(i)) {
+            continue;
+        }
+
+        ipx_msg_garbage *garbage = nullptr;
+        EXPECT_EQ(ipx_parser_session_remove(parser, sessions[i], &garbage), IPX_ERR_NOTFOUND)
+            << "Session " << i;
+    }
+
+    // Remaining sessions (incl. those moved back in the chain) still have their templates
+    for (size_t i = 0; i < session_cnt; ++i) {
+        if (!removed(i)) {
+            EXPECT_EQ(send(i, false, 1), 1) << "Session " << i;
+        }
+    }
+
+    // A removed session starts from scratch (i.e. without the template)
+    EXPECT_EQ(send(1, false, 1), 0);
+
+    for (size_t i = 0; i < session_cnt; ++i) {
+        ipx_msg_garbage *garbage = nullptr;
+        if (ipx_parser_session_remove(parser, sessions[i], &garbage) == IPX_OK && garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+        ipx_session_destroy(sessions[i]);
+    }
+    ipx_parser_destroy(parser);
+    ipx_ctx_destroy(ctx);
+}
+
+// Max message (65000 records in one message)...
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+extern "C" {
+#include <core/placement.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/// Parse a list of CPUs and format it back
+static std::string
+cpus_roundtrip(const char *str)
+{
+    uint64_t cpus[IPX_PLACEMENT_WORDS];
+    EXPECT_EQ(ipx_placement_cpus_parse(str, cpus), IPX_OK);
+
+    char buf[256];
+    ipx_placement_cpus_print(cpus, buf, sizeof(buf));
+    return buf;
+}
+
+// Valid lists of CPUs
+TEST(Placement, cpusParse)
+{
+    uint64_t cpus[IPX_PLACEMENT_WORDS];
+    ASSERT_EQ(ipx_placement_cpus_parse("0-3,8,64", cpus), IPX_OK);
+    EXPECT_EQ(cpus[0], UINT64_C(0x10F));
+    EXPECT_EQ(cpus[1], UINT64_C(1));
+    for (unsigned int i = 2; i < IPX_PLACEMENT_WORDS; ++i) {
+        EXPECT_EQ(cpus[i], 0U);
+    }
+
+    EXPECT_EQ(cpus_roundtrip("0"), "0");
+    EXPECT_EQ(cpus_roundtrip("0-3,8,10-11"), "0-3,8,10-11");
+    EXPECT_EQ(cpus_roundtrip("8,0-3"), "0-3,8");
+    EXPECT_EQ(cpus_roundtrip("1,2,3,5"), "1-3,5");
+    EXPECT_EQ(cpus_roundtrip("0-63\n"), "0-63");
+    EXPECT_EQ(cpus_roundtrip(" 4 , 6-7 "), "4,6-7");
+    EXPECT_EQ(cpus_roundtrip("1023"), "1023");
+}
+
+// Invalid lists of CPUs
+TEST(Placement, cpusInvalid)
+{
+    uint64_t cpus[IPX_PLACEMENT_WORDS];
+    EXPECT_EQ(ipx_placement_cpus_parse("", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse(",", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse("1,", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse("1-", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse("3-1", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse("-1", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse("a", cpus), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_placement_cpus_parse("1024", cpus), IPX_ERR_FORMAT);
+}
+
+// Default placement
+TEST(Placement, isDefault)
+{
+    struct ipx_placement placement = IPX_PLACEMENT_INIT;
+    EXPECT_TRUE(ipx_placement_is_default(&placement));
+    EXPECT_EQ(ipx_placement_affinity_set(&placement), IPX_OK);
+
+    placement.numa_node = 0;
+    EXPECT_FALSE(ipx_placement_is_default(&placement));
+    placement.numa_node = -1;
+    placement.priority = 1;
+    EXPECT_FALSE(ipx_placement_is_default(&placement));
+    placement.priority = 0;
+    placement.cpus[0] = 1;
+    EXPECT_FALSE(ipx_placement_is_default(&placement));
+}
+
+// Restrict a thread to the first CPU
+TEST(Placement, affinity)
+{
+    std::thread thread([]() {
+        struct ipx_placement placement = IPX_PLACEMENT_INIT;
+        ASSERT_EQ(ipx_placement_cpus_parse("0", placement.cpus), IPX_OK);
+        ASSERT_EQ(ipx_placement_affinity_set(&placement), IPX_OK);
+
+        char buf[512];
+        ipx_placement_describe(buf, sizeof(buf));
+        EXPECT_EQ(std::string(buf).find("CPUs: 0,"), 0U) << buf;
+    });
+    thread.join();
+}
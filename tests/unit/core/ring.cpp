@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include <core/ring.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Messages are never dereferenced by the ring, therefore, fake pointers can be used
+static ipx_msg_t *
+msg_encode(uintptr_t writer, uintptr_t idx)
+{
+    return reinterpret_cast<ipx_msg_t *>((writer << 32) | (idx + 1));
+}
+
+class Ring : public ::testing::TestWithParam<enum ipx_ring_type> {
+protected:
+    enum ipx_ring_type type_backup;
+
+    void SetUp() override {
+        type_backup = ipx_ring_type_get();
+        ipx_ring_type_set(GetParam());
+    }
+
+    void TearDown() override {
+        ipx_ring_type_set(type_backup);
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(Core, Ring,
+    ::testing::Values(IPX_RING_TYPE_LOCKED, IPX_RING_TYPE_LOCKFREE));
+
+TEST(RingType, global_set_and_get)
+{
+    enum ipx_ring_type backup = ipx_ring_type_get();
+    ipx_ring_type_set(IPX_RING_TYPE_LOCKFREE);
+    EXPECT_EQ(ipx_ring_type_get(), IPX_RING_TYPE_LOCKFREE);
+    ipx_ring_type_set(IPX_RING_TYPE_LOCKED);
+    EXPECT_EQ(ipx_ring_type_get(), IPX_RING_TYPE_LOCKED);
+    ipx_ring_type_set(backup);
+}
+
+// Single writer, single reader, messages must keep their order
+TEST_P(Ring, singleWriter)
+{
+    const uintptr_t msg_cnt = 200000;
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(ring, nullptr);
+
+    std::thread writer([&]() {
+        for (uintptr_t i = 0; i < msg_cnt; ++i) {
+            ipx_ring_push(ring, msg_encode(0, i));
+        }
+    });
+
+    for (uintptr_t i = 0; i < msg_cnt; ++i) {
+        ASSERT_EQ(ipx_ring_pop(ring), msg_encode(0, i));
+    }
+
+    writer.join();
+    ipx_ring_destroy(ring);
+}
+
+// Multiple writers, single reader, messages of each writer must keep their order
+TEST_P(Ring, multiWriter)
+{
+    const uintptr_t writer_cnt = 4;
+    const uintptr_t msg_cnt = 100000;
+    ipx_ring_t *ring = ipx_ring_init(256, true);
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<std::thread> writers;
+    for (uintptr_t w = 0; w < writer_cnt; ++w) {
+        writers.emplace_back([ring, w, msg_cnt]() {
+            for (uintptr_t i = 0; i < msg_cnt; ++i) {
+                ipx_ring_push(ring, msg_encode(w, i));
+            }
+        });
+    }
+
+    std::vector<uintptr_t> expected(writer_cnt, 0);
+    for (uintptr_t i = 0; i < writer_cnt * msg_cnt; ++i) {
+        uintptr_t value = reinterpret_cast<uintptr_t>(ipx_ring_pop(ring));
+        uintptr_t w = value >> 32;
+        ASSERT_LT(w, writer_cnt);
+        ASSERT_EQ(value, reinterpret_cast<uintptr_t>(msg_encode(w, expected[w])));
+        expected[w]++;
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    ipx_ring_destroy(ring);
+}
+
+// Batches of messages must keep their order and a batch pop must never wait for a full batch
+TEST_P(Ring, batch)
+{
+    const uintptr_t msg_cnt = 200000;
+    const uint32_t batch_max = 32;
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(ring, nullptr);
+
+    std::thread writer([&]() {
+        ipx_msg_t *msgs[batch_max];
+        uintptr_t idx = 0;
+        while (idx < msg_cnt) {
+            uint32_t cnt = 0;
+            while (cnt < (idx % batch_max) + 1 && idx < msg_cnt) {
+                msgs[cnt++] = msg_encode(0, idx++);
+            }
+            ipx_ring_push_batch(ring, msgs, cnt);
+        }
+    });
+
+    ipx_msg_t *msgs[batch_max];
+    uintptr_t idx = 0;
+    while (idx < msg_cnt) {
+        uint32_t cnt = ipx_ring_pop_batch(ring, msgs, batch_max);
+        ASSERT_GE(cnt, 1U);
+        ASSERT_LE(cnt, batch_max);
+        for (uint32_t i = 0; i < cnt; ++i) {
+            ASSERT_EQ(msgs[i], msg_encode(0, idx++));
+        }
+    }
+
+    writer.join();
+    ipx_ring_destroy(ring);
+}
+
+// In the direct mode, messages are passed to the consumer immediately by the writer
+TEST_P(Ring, direct)
+{
+    const uintptr_t msg_cnt = 1000;
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<ipx_msg_t *> received;
+    auto consumer = [](void *arg, ipx_msg_t *msg) {
+        static_cast<std::vector<ipx_msg_t *> *>(arg)->push_back(msg);
+    };
+    EXPECT_EQ(ipx_ring_direct_arg(ring), nullptr);
+    ipx_ring_direct_set(ring, consumer, &received);
+    EXPECT_EQ(ipx_ring_direct_arg(ring), &received);
+
+    ipx_msg_t *msgs[4];
+    for (uintptr_t i = 0; i < msg_cnt; ++i) {
+        ipx_ring_push(ring, msg_encode(0, i));
+        ASSERT_EQ(received.size(), i + 1);
+    }
+
+    for (uintptr_t i = 0; i < 4; ++i) {
+        msgs[i] = msg_encode(0, msg_cnt + i);
+    }
+    ipx_ring_push_batch(ring, msgs, 4);
+
+    ASSERT_EQ(received.size(), msg_cnt + 4);
+    for (uintptr_t i = 0; i < msg_cnt + 4; ++i) {
+        EXPECT_EQ(received[i], msg_encode(0, i));
+    }
+
+    ipx_ring_direct_set(ring, nullptr, nullptr);
+    ipx_ring_destroy(ring);
+}
+
+// Occupancy of the ring is reported in percent
+TEST_P(Ring, usage)
+{
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(ring, nullptr);
+    EXPECT_EQ(ipx_ring_usage(ring), 0U);
+
+    for (uintptr_t i = 0; i < 64; ++i) {
+        ipx_ring_push(ring, msg_encode(0, i));
+    }
+    EXPECT_EQ(ipx_ring_usage(ring), 50U);
+
+    for (uintptr_t i = 0; i < 64; ++i) {
+        ASSERT_EQ(ipx_ring_pop(ring), msg_encode(0, i));
+    }
+    if (GetParam() == IPX_RING_TYPE_LOCKFREE) {
+        EXPECT_EQ(ipx_ring_usage(ring), 0U);
+    } else {
+        // The reader returns space to writers only in blocks
+        EXPECT_LE(ipx_ring_usage(ring), 50U);
+    }
+
+    ipx_ring_destroy(ring);
+}
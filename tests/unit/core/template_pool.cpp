@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include <ipfixcol2.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Raw Template definition with two fields (all values in network byte order)
+static std::vector<uint8_t>
+tmplt_raw(uint16_t id, uint16_t field_len)
+{
+    return {
+        uint8_t(id >> 8), uint8_t(id), 0, 2,     // Template ID, Field Count
+        0, 8, 0, 4,                              // sourceIPv4Address
+        0, 1, uint8_t(field_len >> 8), uint8_t(field_len) // octetDeltaCount
+    };
+}
+
+static int free_cnt = 0;
+
+static void
+data_free(void *data)
+{
+    free_cnt++;
+    free(data);
+}
+
+// Identical definitions must share the same interned Template
+TEST(TmpltPool, intern)
+{
+    ipx_tmplt_pool_t *pool = ipx_tmplt_pool_create(&data_free);
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<uint8_t> def_a = tmplt_raw(256, 8);
+    std::vector<uint8_t> def_b = tmplt_raw(256, 4);
+    ipx_tmplt_ref_t *ref1, *ref2, *ref3;
+    ASSERT_EQ(ipx_tmplt_pool_get_raw(pool, FDS_TYPE_TEMPLATE, def_a.data(), def_a.size(), &ref1),
+        IPX_OK);
+    ASSERT_EQ(ipx_tmplt_pool_get_raw(pool, FDS_TYPE_TEMPLATE, def_a.data(), def_a.size(), &ref2),
+        IPX_OK);
+    ASSERT_EQ(ipx_tmplt_pool_get_raw(pool, FDS_TYPE_TEMPLATE, def_b.data(), def_b.size(), &ref3),
+        IPX_OK);
+    EXPECT_EQ(ref1, ref2);
+    EXPECT_NE(ref1, ref3);
+    EXPECT_EQ(ipx_tmplt_ref_template(ref1)->id, 256);
+
+    // Lookup by a parsed Template
+    ipx_tmplt_ref_t *ref4;
+    ASSERT_EQ(ipx_tmplt_pool_get(pool, ipx_tmplt_ref_template(ref3), &ref4), IPX_OK);
+    EXPECT_EQ(ref3, ref4);
+
+    struct ipx_tmplt_pool_stats stats;
+    ipx_tmplt_pool_stats_get(pool, &stats);
+    EXPECT_EQ(stats.tmplts, 2U);
+    EXPECT_EQ(stats.refs, 4U);
+    EXPECT_EQ(stats.hits, 2U);
+    EXPECT_EQ(stats.misses, 2U);
+
+    // User data are freed together with the last reference
+    free_cnt = 0;
+    ipx_tmplt_ref_data_set(pool, ref1, malloc(16));
+    ipx_tmplt_pool_put(pool, ref1);
+    EXPECT_NE(ipx_tmplt_ref_data_get(ref2), nullptr);
+    EXPECT_EQ(free_cnt, 0);
+    ipx_tmplt_pool_put(pool, ref2);
+    EXPECT_EQ(free_cnt, 1);
+
+    ipx_tmplt_pool_stats_get(pool, &stats);
+    EXPECT_EQ(stats.tmplts, 1U);
+    EXPECT_EQ(stats.refs, 2U);
+
+    // Invalid definition
+    ipx_tmplt_ref_t *ref5;
+    std::vector<uint8_t> def_bad = {1, 0, 0, 1};
+    EXPECT_EQ(ipx_tmplt_pool_get_raw(pool, FDS_TYPE_TEMPLATE, def_bad.data(), def_bad.size(),
+        &ref5), IPX_ERR_FORMAT);
+
+    ipx_tmplt_pool_put(pool, ref3);
+    ipx_tmplt_pool_destroy(pool); // ref4 is freed here
+}
+
+// The pool must keep working after many distinct definitions (buckets are resized)
+TEST(TmpltPool, many)
+{
+    ipx_tmplt_pool_t *pool = ipx_tmplt_pool_create(nullptr);
+    ASSERT_NE(pool, nullptr);
+
+    const uint16_t cnt = 1000;
+    std::vector<ipx_tmplt_ref_t *> refs;
+    for (uint16_t i = 0; i < cnt; ++i) {
+        std::vector<uint8_t> def = tmplt_raw(256 + i, 8);
+        ipx_tmplt_ref_t *ref;
+        ASSERT_EQ(ipx_tmplt_pool_get_raw(pool, FDS_TYPE_TEMPLATE, def.data(), def.size(), &ref),
+            IPX_OK);
+        refs.push_back(ref);
+    }
+
+    for (uint16_t i = 0; i < cnt; ++i) {
+        std::vector<uint8_t> def = tmplt_raw(256 + i, 8);
+        ipx_tmplt_ref_t *ref;
+        ASSERT_EQ(ipx_tmplt_pool_get_raw(pool, FDS_TYPE_TEMPLATE, def.data(), def.size(), &ref),
+            IPX_OK);
+        EXPECT_EQ(ref, refs[i]);
+        ipx_tmplt_pool_put(pool, ref);
+        ipx_tmplt_pool_put(pool, refs[i]);
+    }
+
+    struct ipx_tmplt_pool_stats stats;
+    ipx_tmplt_pool_stats_get(pool, &stats);
+    EXPECT_EQ(stats.tmplts, 0U);
+    EXPECT_EQ(stats.refs, 0U);
+    ipx_tmplt_pool_destroy(pool);
+}
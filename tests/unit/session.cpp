@@ -45,6 +45,8 @@ net_tester(fds_session_type stype, uint8_t af_family, const std::string &src_ip,
     if (session->type == FDS_SESSION_UDP) {
         EXPECT_EQ(session->udp.lifetime.tmplts, lt_data);
         EXPECT_EQ(session->udp.lifetime.opts_tmplts, lt_opts);
+        EXPECT_EQ(session->udp.drops.rate_limit, 0U);
+        EXPECT_EQ(session->udp.drops.overload, 0U);
     }
 
     const ipx_session_net *net;